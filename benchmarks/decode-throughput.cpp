@@ -0,0 +1,155 @@
+// Decodes the same images over and over through the asset loader, once per
+// thread count, and reports how many megabytes of pixels came out per second.
+//
+// decode-throughput [--copies <n>] [--max-threads <n>] <image>...
+
+#include <cstdlib>
+#include <cstring>
+
+#include <chrono>
+#include <string>
+
+#include "asset-loader.hpp"
+#include "common.hpp"
+#include "thread-pool.hpp"
+
+namespace
+{
+
+struct run_result_t
+{
+    double seconds;
+    size_t decoded_bytes;
+    size_t failed_count;
+};
+
+auto run(
+    uint32_t p_thread_count,
+    std::span<const std::string_view> p_paths,
+    uint32_t p_copies
+) -> run_result_t
+{
+    // Only the PNGs themselves, and without any device-specific work.
+    const vulkan_scene::image_decode_options_t options{
+        .generate_mips = false,
+        .mips_on_cpu = false,
+        .use_compressed_variants = false,
+        .sampleable_formats = {},
+    };
+
+    vulkan_scene::thread_pool_t thread_pool{p_thread_count};
+    vulkan_scene::asset_loader_t asset_loader{thread_pool};
+
+    const auto start_time = std::chrono::steady_clock::now();
+
+    for (uint32_t copy = 0; copy < p_copies; copy++)
+    {
+        for (const auto path : p_paths)
+        {
+            asset_loader.load_image(std::string{path}, options);
+        }
+    }
+
+    run_result_t result{
+        .seconds = 0.0,
+        .decoded_bytes = 0,
+        .failed_count = 0,
+    };
+
+    while (const auto loaded = asset_loader.next_image())
+    {
+        if (loaded->image.has_value())
+        {
+            result.decoded_bytes += loaded->image->data.size();
+        }
+        else
+        {
+            result.failed_count++;
+        }
+    }
+
+    result.seconds = std::chrono::duration<double>(
+                         std::chrono::steady_clock::now() - start_time
+    )
+                         .count();
+
+    return result;
+}
+
+} // namespace
+
+auto main(int argc, char** argv) -> int
+{
+    auto copies = static_cast<uint32_t>(16);
+    auto max_threads = vulkan_scene::get_default_thread_count();
+    std::vector<std::string_view> paths;
+
+    for (const char* const* arg = argv + 1; arg < argv + argc; arg++)
+    {
+        const auto has_value = arg + 1 < argv + argc;
+
+        if (std::strcmp(*arg, "--copies") == 0 && has_value)
+        {
+            arg++;
+            copies = std::max(
+                static_cast<uint32_t>(std::strtoul(*arg, nullptr, 10)), 1u
+            );
+        }
+        else if (std::strcmp(*arg, "--max-threads") == 0 && has_value)
+        {
+            arg++;
+            max_threads = std::max(
+                static_cast<uint32_t>(std::strtoul(*arg, nullptr, 10)), 1u
+            );
+        }
+        else
+        {
+            paths.push_back(*arg);
+        }
+    }
+
+    if (paths.empty())
+    {
+        std::cerr << "Usage: " << argv[0]
+                  << " [--copies <n>] [--max-threads <n>] <image>...\n";
+        return EXIT_FAILURE;
+    }
+
+    // Powers of two, and the maximum itself if it isn't one.
+    std::vector<uint32_t> thread_counts;
+    for (uint32_t count = 1; count < max_threads; count *= 2)
+    {
+        thread_counts.push_back(count);
+    }
+    thread_counts.push_back(max_threads);
+
+    std::cout << "[INFO]: Decoding " << paths.size() * copies
+              << " images per run.\n";
+
+    double single_thread_throughput = 0.0;
+
+    for (const auto thread_count : thread_counts)
+    {
+        const auto result = run(thread_count, paths, copies);
+        if (result.failed_count > 0)
+        {
+            vulkan_scene::print_error(
+                result.failed_count, " images failed to decode."
+            );
+            return EXIT_FAILURE;
+        }
+
+        const auto throughput =
+            static_cast<double>(result.decoded_bytes) / 1e6 / result.seconds;
+        if (thread_count == 1)
+        {
+            single_thread_throughput = throughput;
+        }
+
+        std::cout << "[INFO]: " << thread_count << " thread(s): " << throughput
+                  << " MB/s (" << throughput / single_thread_throughput
+                  << "x), " << result.seconds * 1000.0 << " ms.\n";
+    }
+
+    return EXIT_SUCCESS;
+}
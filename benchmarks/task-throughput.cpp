@@ -0,0 +1,155 @@
+// Runs empty tasks through the thread pool, once per thread count, and
+// reports how many of them it gets through per second. Unlike the renderer
+// benchmarks, this doesn't need a GPU.
+//
+// task-throughput [--tasks <n>] [--max-threads <n>]
+
+#include <cstdlib>
+#include <cstring>
+
+#include <chrono>
+
+#include "thread-pool.hpp"
+
+namespace
+{
+
+struct run_result_t
+{
+    double seconds;
+    uint64_t steal_count;
+};
+
+template <typename F>
+auto run(uint32_t p_thread_count, F&& p_body) -> run_result_t
+{
+    vulkan_scene::thread_pool_t thread_pool{p_thread_count};
+
+    const auto start_time = std::chrono::steady_clock::now();
+    p_body(thread_pool);
+    thread_pool.wait_idle();
+
+    return run_result_t{
+        .seconds = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - start_time
+        )
+                       .count(),
+        .steal_count = thread_pool.steal_count(),
+    };
+}
+
+auto print_result(
+    std::string_view p_name,
+    uint32_t p_thread_count,
+    uint32_t p_task_count,
+    const run_result_t& p_result
+) -> void
+{
+    std::cout << "[INFO]: " << p_name << ", " << p_thread_count
+              << " thread(s): "
+              << static_cast<double>(p_task_count) / p_result.seconds / 1e6
+              << " M tasks/s, " << p_result.steal_count << " steals.\n";
+}
+
+} // namespace
+
+auto main(int argc, char** argv) -> int
+{
+    auto task_count = static_cast<uint32_t>(1000000);
+    auto max_threads = vulkan_scene::get_default_thread_count();
+
+    for (const char* const* arg = argv + 1; arg < argv + argc; arg++)
+    {
+        const auto has_value = arg + 1 < argv + argc;
+
+        if (std::strcmp(*arg, "--tasks") == 0 && has_value)
+        {
+            arg++;
+            task_count = std::max(
+                static_cast<uint32_t>(std::strtoul(*arg, nullptr, 10)), 1u
+            );
+        }
+        else if (std::strcmp(*arg, "--max-threads") == 0 && has_value)
+        {
+            arg++;
+            max_threads = std::max(
+                static_cast<uint32_t>(std::strtoul(*arg, nullptr, 10)), 1u
+            );
+        }
+        else
+        {
+            std::cerr << "Usage: " << argv[0]
+                      << " [--tasks <n>] [--max-threads <n>]\n";
+            return EXIT_FAILURE;
+        }
+    }
+
+    // Powers of two, and the maximum itself if it isn't one.
+    std::vector<uint32_t> thread_counts;
+    for (uint32_t count = 1; count < max_threads; count *= 2)
+    {
+        thread_counts.push_back(count);
+    }
+    thread_counts.push_back(max_threads);
+
+    std::atomic<uint32_t> counter = 0;
+    const auto task = [&counter]
+    { counter.fetch_add(1, std::memory_order_relaxed); };
+
+    for (const auto thread_count : thread_counts)
+    {
+        // Submitted from outside, which spreads the tasks across the workers
+        // and needs little stealing.
+        print_result(
+            "submit", thread_count, task_count,
+            run(thread_count,
+                [&](vulkan_scene::thread_pool_t& p_thread_pool)
+                {
+                    for (uint32_t i = 0; i < task_count; i++)
+                    {
+                        p_thread_pool.submit(task);
+                    }
+                })
+        );
+
+        // Submitted from a single task, so they all start out on one deque
+        // and the other workers only get any by stealing.
+        print_result(
+            "spawn", thread_count, task_count,
+            run(thread_count,
+                [&](vulkan_scene::thread_pool_t& p_thread_pool)
+                {
+                    p_thread_pool.submit(
+                        [&]
+                        {
+                            for (uint32_t i = 0; i < task_count; i++)
+                            {
+                                p_thread_pool.submit(task);
+                            }
+                        }
+                    );
+                })
+        );
+
+        // One range per task, which is the overhead that parallel_for adds.
+        print_result(
+            "parallel_for", thread_count, task_count,
+            run(thread_count,
+                [&](vulkan_scene::thread_pool_t& p_thread_pool)
+                {
+                    p_thread_pool.parallel_for(
+                        0, task_count, 1,
+                        [&](uint32_t, uint32_t) { task(); }
+                    );
+                })
+        );
+    }
+
+    if (counter != task_count * 3 * thread_counts.size())
+    {
+        std::cerr << "[ERROR]: Some of the tasks didn't run.\n";
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -1,8 +1,17 @@
 #version 450
 
+#extension GL_EXT_nonuniform_qualifier : require
+
 layout (location = 0) out vec4 out_color;
 
-layout (binding = 1) uniform sampler2D texture_sampler;
+// Every texture there is, in the texture table's set.
+layout (set = 1, binding = 0) uniform sampler2D textures[];
+
+// Comes after what the vertex shaders use. See push_constants_t.
+layout (push_constant) uniform push_constants_t
+{
+    layout (offset = 96) uint texture_index;
+} push_constants;
 
 layout (location = 0) in vec2 uv;
 layout (location = 1) in vec3 normal;
@@ -10,5 +19,5 @@ layout (location = 1) in vec3 normal;
 void main()
 {
     float diffuse_factor = max(dot(normalize(normal), vec3(1.0, 0.0, 0.0)), 0.01);
-    out_color = diffuse_factor * vec4(1.0, 1.0, 0.0, 1.0) * texture(texture_sampler, uv);
+    out_color = diffuse_factor * vec4(1.0, 1.0, 0.0, 1.0) * texture(textures[push_constants.texture_index], uv);
 }
@@ -9,17 +9,44 @@ layout (binding = 0) uniform uniform_buffer_t
 layout (push_constant) uniform push_constants_t 
 {
     mat4 model;
+
+#ifdef PACKED_VERTICES
+    // Turns the packed positions back into where they were in the mesh. See
+    // vertex_quantization_t.
+    vec4 position_offset;
+    vec4 position_scale;
+#endif
 } push_constants;
 
+#ifdef PACKED_VERTICES
+layout (location = 0) in vec4 a_packed_position;
+layout (location = 1) in vec2 a_uv;
+layout (location = 2) in vec2 a_packed_normal;
+
+// Unfolds a normal in octahedral encoding, the same way unpack_vertex does.
+vec3 decode_octahedral(vec2 encoded)
+{
+    vec3 normal = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+    float fold = max(-normal.z, 0.0);
+    normal.xy += mix(vec2(fold), vec2(-fold), greaterThanEqual(normal.xy, vec2(0.0)));
+    return normalize(normal);
+}
+#else
 layout (location = 0) in vec3 a_position;
 layout (location = 1) in vec2 a_uv;
 layout (location = 2) in vec3 a_normal;
+#endif
 
 layout (location = 0) out vec2 uv;
 layout (location = 1) out vec3 normal;
 
 void main()
 {
+#ifdef PACKED_VERTICES
+    vec3 a_position = push_constants.position_offset.xyz + push_constants.position_scale.xyz * a_packed_position.xyz;
+    vec3 a_normal = decode_octahedral(a_packed_normal);
+#endif
+
     gl_Position = uniform_buffer.projection * uniform_buffer.view * push_constants.model * vec4(a_position.x, a_position.y, a_position.z, 1.0);
     uv = a_uv;
     normal = vec3(push_constants.model * vec4(a_normal, 1.0));
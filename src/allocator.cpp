@@ -0,0 +1,351 @@
+#include "common.hpp"
+
+#include "allocator.hpp"
+
+namespace
+{
+
+// Every memory type has one pool per strategy.
+auto pool_index(
+    uint32_t p_memory_type, vulkan_scene::allocation_strategy_t p_strategy
+) noexcept -> uint32_t
+{
+    return p_memory_type * 2 +
+           (p_strategy == vulkan_scene::allocation_strategy_t::LINEAR ? 1 : 0);
+}
+
+} // namespace
+
+namespace vulkan_scene
+{
+
+auto find_buffer_memory_type(
+    VkPhysicalDevice p_device,
+    uint32_t p_type_filter,
+    VkMemoryPropertyFlags p_memory_properties
+) -> kirho::result_t<uint32_t, kirho::empty_t>
+{
+    using result_t = kirho::result_t<uint32_t, kirho::empty_t>;
+
+    VkPhysicalDeviceMemoryProperties memory_properties;
+    vkGetPhysicalDeviceMemoryProperties(p_device, &memory_properties);
+
+    for (uint32_t i = 0; i < memory_properties.memoryTypeCount; i++)
+    {
+        const auto follows_filter = (p_type_filter & (1 << i)) != 0;
+        const auto has_properties =
+            (memory_properties.memoryTypes[i].propertyFlags &
+             p_memory_properties) == p_memory_properties;
+
+        if (follows_filter && has_properties)
+        {
+            return result_t::success(i);
+        }
+    }
+
+    return result_t::error(kirho::empty_t{});
+}
+
+memory_allocator_t::memory_allocator_t(
+    VkPhysicalDevice p_physical_device,
+    VkDevice p_device,
+    VkDeviceSize p_block_size
+) noexcept
+    : m_physical_device(p_physical_device), m_device(p_device),
+      m_block_size(p_block_size), m_allocation_count(0)
+{
+    vkGetPhysicalDeviceMemoryProperties(
+        p_physical_device, &m_memory_properties
+    );
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(p_physical_device, &properties);
+
+    m_granularity = properties.limits.bufferImageGranularity;
+    m_max_allocation_count = properties.limits.maxMemoryAllocationCount;
+
+    for (uint32_t i = 0; i < m_memory_properties.memoryTypeCount; i++)
+    {
+        m_pools.push_back(pool_t{
+            .memory_type = i,
+            .strategy = allocation_strategy_t::FREE_LIST,
+            .blocks = {},
+        });
+        m_pools.push_back(pool_t{
+            .memory_type = i,
+            .strategy = allocation_strategy_t::LINEAR,
+            .blocks = {},
+        });
+    }
+}
+
+memory_allocator_t::~memory_allocator_t()
+{
+    for (const auto& pool : m_pools)
+    {
+        for (const auto& block : pool.blocks)
+        {
+            if (block.memory == VK_NULL_HANDLE)
+            {
+                continue;
+            }
+
+            if (!block.allocator.empty())
+            {
+                print_error(
+                    "A memory block of type ", pool.memory_type, " still has ",
+                    block.allocator.stats().allocation_count,
+                    " allocation(s) in it."
+                );
+            }
+
+            vkFreeMemory(m_device, block.memory, nullptr);
+        }
+    }
+}
+
+auto memory_allocator_t::create_block(pool_t& p_pool, VkDeviceSize p_size) noexcept
+    -> kirho::result_t<uint32_t, VkResult>
+{
+    using result_t = kirho::result_t<uint32_t, VkResult>;
+
+    if (m_allocation_count >= m_max_allocation_count)
+    {
+        print_error(
+            "Reached maxMemoryAllocationCount (", m_max_allocation_count,
+            ") while creating a memory block."
+        );
+        return result_t::error(VK_ERROR_TOO_MANY_OBJECTS);
+    }
+
+    const VkMemoryAllocateInfo alloc_info{
+        .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+        .pNext = nullptr,
+        .allocationSize = p_size,
+        .memoryTypeIndex = p_pool.memory_type,
+    };
+
+    VkDeviceMemory memory;
+    auto result = vkAllocateMemory(m_device, &alloc_info, nullptr, &memory);
+    if (result != VK_SUCCESS)
+    {
+        print_error(
+            "Failed to allocate a memory block. Vulkan error ", result, '.'
+        );
+        return result_t::error(result);
+    }
+
+    void* mapped = nullptr;
+
+    const auto property_flags =
+        m_memory_properties.memoryTypes[p_pool.memory_type].propertyFlags;
+    if ((property_flags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) != 0)
+    {
+        result = vkMapMemory(m_device, memory, 0, VK_WHOLE_SIZE, 0, &mapped);
+        if (result != VK_SUCCESS)
+        {
+            print_error(
+                "Failed to map a memory block. Vulkan error ", result, '.'
+            );
+            vkFreeMemory(m_device, memory, nullptr);
+            return result_t::error(result);
+        }
+    }
+
+    m_allocation_count++;
+
+    block_t block{
+        .memory = memory,
+        .mapped = mapped,
+        .allocator = sub_allocator_t{p_size, p_pool.strategy, m_granularity},
+    };
+
+    // Reuse the slot of a block that has been freed, if there is one.
+    for (uint32_t i = 0; i < p_pool.blocks.size(); i++)
+    {
+        if (p_pool.blocks[i].memory == VK_NULL_HANDLE)
+        {
+            p_pool.blocks[i] = block;
+            return result_t::success(i);
+        }
+    }
+
+    p_pool.blocks.push_back(block);
+    return result_t::success(static_cast<uint32_t>(p_pool.blocks.size() - 1));
+}
+
+auto memory_allocator_t::allocate(
+    const VkMemoryRequirements& p_requirements,
+    VkMemoryPropertyFlags p_properties,
+    resource_kind_t p_kind,
+    allocation_strategy_t p_strategy
+) noexcept -> kirho::result_t<allocation_t, VkResult>
+{
+    using result_t = kirho::result_t<allocation_t, VkResult>;
+
+    const auto memory_type_result = find_buffer_memory_type(
+        m_physical_device, p_requirements.memoryTypeBits, p_properties
+    );
+    {
+        kirho::empty_t empty{};
+        if (memory_type_result.is_error(empty))
+        {
+            print_error("Could not find a suitable memory type.");
+            return result_t::error(VK_ERROR_UNKNOWN);
+        }
+    }
+    const auto memory_type = memory_type_result.unwrap();
+
+    const auto index = pool_index(memory_type, p_strategy);
+    auto& pool = m_pools[index];
+
+    const auto make_allocation = [&](uint32_t p_block, VkDeviceSize p_offset)
+    {
+        const auto& block = pool.blocks[p_block];
+        return allocation_t{
+            .memory = block.memory,
+            .offset = p_offset,
+            .size = p_requirements.size,
+            .mapped = block.mapped == nullptr
+                          ? nullptr
+                          : static_cast<uint8_t*>(block.mapped) + p_offset,
+            .pool = index,
+            .block = p_block,
+        };
+    };
+
+    for (uint32_t i = 0; i < pool.blocks.size(); i++)
+    {
+        auto& block = pool.blocks[i];
+        if (block.memory == VK_NULL_HANDLE)
+        {
+            continue;
+        }
+
+        const auto offset_result = block.allocator.allocate(
+            p_requirements.size, p_requirements.alignment, p_kind
+        );
+
+        kirho::empty_t empty{};
+        if (!offset_result.is_error(empty))
+        {
+            return result_t::success(make_allocation(i, offset_result.unwrap())
+            );
+        }
+    }
+
+    // Small heaps (such as the host-visible part of VRAM on some cards)
+    // shouldn't be eaten up by a single block.
+    const auto heap_size =
+        m_memory_properties
+            .memoryHeaps[m_memory_properties.memoryTypes[memory_type].heapIndex]
+            .size;
+    const auto block_size = std::max(
+        std::min(m_block_size, heap_size / 8), p_requirements.size
+    );
+
+    const auto block_result = create_block(pool, block_size);
+
+    VkResult result;
+    if (block_result.is_error(result))
+    {
+        return result_t::error(result);
+    }
+
+    const auto block = block_result.unwrap();
+
+    const auto offset_result = pool.blocks[block].allocator.allocate(
+        p_requirements.size, p_requirements.alignment, p_kind
+    );
+    {
+        kirho::empty_t empty{};
+        if (offset_result.is_error(empty))
+        {
+            // Can't really happen, as the block is at least as big as the
+            // allocation and starts out aligned.
+            print_error("Failed to allocate from a brand new memory block.");
+            return result_t::error(VK_ERROR_OUT_OF_DEVICE_MEMORY);
+        }
+    }
+
+    return result_t::success(make_allocation(block, offset_result.unwrap()));
+}
+
+auto memory_allocator_t::free(const allocation_t& p_allocation) noexcept -> void
+{
+    auto& pool = m_pools.at(p_allocation.pool);
+    auto& block = pool.blocks.at(p_allocation.block);
+
+    block.allocator.free(p_allocation.offset);
+
+    if (!block.allocator.empty())
+    {
+        return;
+    }
+
+    // Keep one empty block around per pool, so that allocating and freeing
+    // a single resource over and over doesn't hit the driver every time.
+    const auto live_block_count = std::ranges::count_if(
+        pool.blocks,
+        [](const block_t& p_block) { return p_block.memory != VK_NULL_HANDLE; }
+    );
+
+    if (live_block_count > 1)
+    {
+        vkFreeMemory(m_device, block.memory, nullptr);
+        block.memory = VK_NULL_HANDLE;
+        block.mapped = nullptr;
+        m_allocation_count--;
+    }
+}
+
+auto memory_allocator_t::print_stats() const noexcept -> void
+{
+    constexpr auto MEBIBYTE = 1024.0 * 1024.0;
+
+    for (const auto& pool : m_pools)
+    {
+        sub_allocator_stats_t total{};
+        uint64_t block_count = 0;
+        double worst_fragmentation = 0.0;
+
+        for (const auto& block : pool.blocks)
+        {
+            if (block.memory == VK_NULL_HANDLE)
+            {
+                continue;
+            }
+
+            const auto stats = block.allocator.stats();
+            total.size += stats.size;
+            total.used += stats.used;
+            total.allocation_count += stats.allocation_count;
+            total.free_range_count += stats.free_range_count;
+            worst_fragmentation =
+                std::max(worst_fragmentation, stats.fragmentation());
+            block_count++;
+        }
+
+        if (block_count == 0)
+        {
+            continue;
+        }
+
+        std::cout << "[INFO]: Memory type " << pool.memory_type << " ("
+                  << (pool.strategy == allocation_strategy_t::LINEAR
+                          ? "linear"
+                          : "free list")
+                  << "): " << block_count << " block(s), "
+                  << total.used / MEBIBYTE << " of " << total.size / MEBIBYTE
+                  << " MiB used by " << total.allocation_count
+                  << " allocation(s), " << total.free_range_count
+                  << " free range(s), worst block fragmentation "
+                  << worst_fragmentation * 100.0 << "%.\n";
+    }
+
+    std::cout << "[INFO]: " << m_allocation_count << " of "
+              << m_max_allocation_count
+              << " device memory allocations in use.\n";
+}
+
+} // namespace vulkan_scene
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include "sub-allocator.hpp"
+
+namespace vulkan_scene
+{
+
+constexpr VkDeviceSize DEFAULT_MEMORY_BLOCK_SIZE = 64 * 1024 * 1024;
+
+// A piece of a larger VkDeviceMemory block.
+struct allocation_t
+{
+    VkDeviceMemory memory;
+    VkDeviceSize offset;
+    VkDeviceSize size;
+
+    // Host-visible memory stays mapped for its whole lifetime. This points to
+    // the start of the allocation in that case, and is null otherwise.
+    void* mapped;
+
+    uint32_t pool;
+    uint32_t block;
+};
+
+auto find_buffer_memory_type(
+    VkPhysicalDevice p_device,
+    uint32_t p_type_filter,
+    VkMemoryPropertyFlags p_memory_properties
+) -> kirho::result_t<uint32_t, kirho::empty_t>;
+
+// Hands out pieces of large VkDeviceMemory blocks, so that we don't need a
+// vkAllocateMemory call (and one of the few maxMemoryAllocationCount slots) per
+// resource. There is one pool of blocks per memory type and strategy.
+class memory_allocator_t
+{
+  public:
+    memory_allocator_t(
+        VkPhysicalDevice p_physical_device,
+        VkDevice p_device,
+        VkDeviceSize p_block_size = DEFAULT_MEMORY_BLOCK_SIZE
+    ) noexcept;
+
+    memory_allocator_t(const memory_allocator_t&) = delete;
+    memory_allocator_t& operator=(const memory_allocator_t&) = delete;
+
+    ~memory_allocator_t();
+
+    auto allocate(
+        const VkMemoryRequirements& p_requirements,
+        VkMemoryPropertyFlags p_properties,
+        resource_kind_t p_kind,
+        allocation_strategy_t p_strategy = allocation_strategy_t::FREE_LIST
+    ) noexcept -> kirho::result_t<allocation_t, VkResult>;
+
+    auto free(const allocation_t& p_allocation) noexcept -> void;
+
+    // Prints the usage and fragmentation of every pool that has any blocks.
+    auto print_stats() const noexcept -> void;
+
+    auto physical_device() const noexcept -> VkPhysicalDevice
+    {
+        return m_physical_device;
+    }
+
+  private:
+    struct block_t
+    {
+        // Blocks that have been given back to the driver are null, so that
+        // the indices of the remaining ones stay stable.
+        VkDeviceMemory memory;
+        void* mapped;
+        sub_allocator_t allocator;
+    };
+
+    struct pool_t
+    {
+        uint32_t memory_type;
+        allocation_strategy_t strategy;
+        std::vector<block_t> blocks;
+    };
+
+    auto create_block(pool_t& p_pool, VkDeviceSize p_size) noexcept
+        -> kirho::result_t<uint32_t, VkResult>;
+
+    VkPhysicalDevice m_physical_device;
+    VkDevice m_device;
+    VkDeviceSize m_block_size;
+
+    VkPhysicalDeviceMemoryProperties m_memory_properties;
+    VkDeviceSize m_granularity;
+    uint32_t m_max_allocation_count;
+    uint32_t m_allocation_count;
+
+    std::vector<pool_t> m_pools;
+};
+
+} // namespace vulkan_scene
@@ -0,0 +1,349 @@
+#include <filesystem>
+
+#include <stb_image.h>
+
+#include "common.hpp"
+#include "cpu-trace.hpp"
+#include "ktx2.hpp"
+
+#include "asset-loader.hpp"
+
+namespace
+{
+
+using vulkan_scene::decoded_image_t;
+using vulkan_scene::image_decode_options_t;
+using vulkan_scene::ktx2_texture_t;
+using vulkan_scene::print_error;
+
+// Compressed versions of a texture that texture-compressor (or any other KTX2
+// tool) may have put next to it, best looking first.
+struct compressed_variant_t
+{
+    std::string_view extension;
+    VkFormat format;
+};
+
+constexpr std::array<compressed_variant_t, 3> COMPRESSED_VARIANTS{{
+    {".bc7.ktx2", VK_FORMAT_BC7_SRGB_BLOCK},
+    {".astc.ktx2", VK_FORMAT_ASTC_4x4_SRGB_BLOCK},
+    {".bc1.ktx2", VK_FORMAT_BC1_RGB_SRGB_BLOCK},
+}};
+
+auto can_sample_linear(
+    VkPhysicalDevice p_physical_device, VkFormat p_format
+) noexcept -> bool
+{
+    VkFormatProperties format_properties;
+    vkGetPhysicalDeviceFormatProperties(
+        p_physical_device, p_format, &format_properties
+    );
+
+    constexpr VkFormatFeatureFlags sample_features =
+        VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT |
+        VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+
+    return (format_properties.optimalTilingFeatures & sample_features) ==
+           sample_features;
+}
+
+auto is_sampleable(
+    const image_decode_options_t& p_options, VkFormat p_format
+) noexcept -> bool
+{
+    // Every device can sample RGBA8.
+    return p_format == VK_FORMAT_R8G8B8A8_SRGB ||
+           p_format == VK_FORMAT_R8G8B8A8_UNORM ||
+           std::find(
+               p_options.sampleable_formats.begin(),
+               p_options.sampleable_formats.end(), p_format
+           ) != p_options.sampleable_formats.end();
+}
+
+// Uses the levels that came with the texture rather than generating any.
+auto decode_ktx2(
+    ktx2_texture_t&& p_texture, const image_decode_options_t& p_options
+) noexcept -> decoded_image_t
+{
+    if (!p_options.generate_mips)
+    {
+        p_texture.levels.resize(1);
+        p_texture.data.resize(p_texture.levels.front().size);
+    }
+
+    const auto level_count = static_cast<uint32_t>(p_texture.levels.size());
+
+    return decoded_image_t{
+        .format = p_texture.format,
+        .extent =
+            VkExtent2D{
+                .width = p_texture.width,
+                .height = p_texture.height,
+            },
+        .level_count = level_count,
+        .levels = std::move(p_texture.levels),
+        .data = std::move(p_texture.data),
+    };
+}
+
+// Looks for the first compressed variant of p_file_path that exists and that
+// the device can sample from.
+auto find_compressed_variant(
+    std::string_view p_file_path, const image_decode_options_t& p_options
+) noexcept -> std::optional<ktx2_texture_t>
+{
+    for (const auto& variant : COMPRESSED_VARIANTS)
+    {
+        if (!is_sampleable(p_options, variant.format))
+        {
+            continue;
+        }
+
+        const auto path = std::filesystem::path{p_file_path}
+                              .replace_extension(variant.extension)
+                              .string();
+
+        std::error_code error;
+        if (!std::filesystem::exists(path, error))
+        {
+            continue;
+        }
+
+        const auto texture_result = vulkan_scene::read_ktx2(path);
+
+        kirho::empty_t read_error;
+        if (texture_result.is_error(read_error))
+        {
+            continue;
+        }
+
+        auto texture = texture_result.unwrap();
+
+        // The name is only a hint, the file has the final say.
+        if (!is_sampleable(p_options, texture.format))
+        {
+            continue;
+        }
+
+        // Compare against what the same levels would take up as RGBA8.
+        size_t uncompressed_size = 0;
+        for (const auto& level : texture.levels)
+        {
+            uncompressed_size +=
+                static_cast<size_t>(level.width) * level.height * 4;
+        }
+
+        std::cout << "[INFO]: Using " << path << " instead of " << p_file_path
+                  << " (" << texture.data.size() / 1024 << " KiB instead of "
+                  << uncompressed_size / 1024 << " KiB).\n";
+
+        return texture;
+    }
+
+    return std::nullopt;
+}
+
+} // namespace
+
+namespace vulkan_scene
+{
+
+auto get_image_decode_options(
+    VkPhysicalDevice p_physical_device,
+    bool p_generate_mips,
+    bool p_use_compressed_variants
+) noexcept -> image_decode_options_t
+{
+    // Blitting is much faster, but it needs linear filtering support for the
+    // format. Otherwise, the whole chain gets built on the CPU and uploaded.
+    VkFormatProperties format_properties;
+    vkGetPhysicalDeviceFormatProperties(
+        p_physical_device, VK_FORMAT_R8G8B8A8_SRGB, &format_properties
+    );
+
+    constexpr VkFormatFeatureFlags blit_features =
+        VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT |
+        VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+    const auto can_blit =
+        (format_properties.optimalTilingFeatures & blit_features) ==
+        blit_features;
+
+    image_decode_options_t options{
+        .generate_mips = p_generate_mips,
+        .mips_on_cpu = !can_blit,
+        .use_compressed_variants = p_use_compressed_variants,
+        .sampleable_formats = {},
+    };
+
+    for (const auto& variant : COMPRESSED_VARIANTS)
+    {
+        if (can_sample_linear(p_physical_device, variant.format))
+        {
+            options.sampleable_formats.push_back(variant.format);
+        }
+    }
+
+    return options;
+}
+
+auto decode_image(
+    std::string_view p_file_path, const image_decode_options_t& p_options
+) noexcept -> kirho::result_t<decoded_image_t, kirho::empty_t>
+{
+    using result_t = kirho::result_t<decoded_image_t, kirho::empty_t>;
+
+    if (std::filesystem::path{p_file_path}.extension() == ".ktx2")
+    {
+        const auto texture_result = read_ktx2(p_file_path);
+
+        kirho::empty_t error;
+        if (texture_result.is_error(error))
+        {
+            return result_t::error(error);
+        }
+
+        auto texture = texture_result.unwrap();
+        if (!is_sampleable(p_options, texture.format))
+        {
+            print_error("This device can't sample from ", p_file_path, '.');
+            return result_t::error(kirho::empty_t{});
+        }
+
+        return result_t::success(decode_ktx2(std::move(texture), p_options));
+    }
+
+    if (p_options.use_compressed_variants)
+    {
+        auto texture = find_compressed_variant(p_file_path, p_options);
+        if (texture.has_value())
+        {
+            return result_t::success(
+                decode_ktx2(std::move(*texture), p_options)
+            );
+        }
+    }
+
+    constexpr auto fixed_channels = 4;
+
+    int width, height, channels;
+    const auto pixels = stbi_load(
+        p_file_path.data(), &width, &height, &channels, fixed_channels
+    );
+
+    if (pixels == nullptr)
+    {
+        print_error("Failed to load ", p_file_path, '.');
+        return result_t::error(kirho::empty_t{});
+    }
+
+    const VkExtent2D extent{
+        .width = static_cast<uint32_t>(width),
+        .height = static_cast<uint32_t>(height),
+    };
+
+    const auto level_count =
+        p_options.generate_mips ? mip_level_count(extent.width, extent.height)
+                                : 1;
+
+    decoded_image_t image{
+        .format = VK_FORMAT_R8G8B8A8_SRGB,
+        .extent = extent,
+        .level_count = level_count,
+        .levels = {},
+        .data = {},
+    };
+
+    if (level_count > 1 && p_options.mips_on_cpu)
+    {
+        image.data = generate_mip_chain(
+            pixels, extent.width, extent.height, level_count, true
+        );
+        image.levels =
+            mip_chain_layout(extent.width, extent.height, level_count);
+    }
+    else
+    {
+        image.levels = mip_chain_layout(extent.width, extent.height, 1);
+        image.data.assign(pixels, pixels + image.levels.front().size);
+    }
+
+    stbi_image_free(pixels);
+
+    return result_t::success(std::move(image));
+}
+
+asset_loader_t::asset_loader_t(thread_pool_t& p_thread_pool) noexcept
+    : m_thread_pool(p_thread_pool), m_requested_count(0),
+      m_handed_out_count(0)
+{
+}
+
+asset_loader_t::~asset_loader_t()
+{
+    std::unique_lock lock{m_mutex};
+    m_image_done.wait(
+        lock,
+        [this]
+        { return m_handed_out_count + m_done.size() == m_requested_count; }
+    );
+}
+
+auto asset_loader_t::load_image(
+    std::string p_file_path, image_decode_options_t p_options
+) -> size_t
+{
+    size_t index;
+    {
+        const std::lock_guard lock{m_mutex};
+        index = m_requested_count++;
+    }
+
+    m_thread_pool.submit(
+        [this, index, file_path = std::move(p_file_path),
+         options = std::move(p_options)]
+        {
+            cpu_trace_scope_t trace_scope{"decode image"};
+            const auto image_result = decode_image(file_path, options);
+            trace_scope.end();
+
+            loaded_image_t loaded{
+                .index = index,
+                .image = std::nullopt,
+            };
+
+            kirho::empty_t error;
+            if (!image_result.is_error(error))
+            {
+                loaded.image = image_result.unwrap();
+            }
+
+            // Notifying under the lock keeps the destructor from finishing
+            // (and destroying the condition variable) in between.
+            const std::lock_guard lock{m_mutex};
+            m_done.push_back(std::move(loaded));
+            m_image_done.notify_all();
+        }
+    );
+
+    return index;
+}
+
+auto asset_loader_t::next_image() -> std::optional<loaded_image_t>
+{
+    std::unique_lock lock{m_mutex};
+
+    if (m_handed_out_count == m_requested_count)
+    {
+        return std::nullopt;
+    }
+
+    m_image_done.wait(lock, [this] { return !m_done.empty(); });
+
+    auto loaded = std::move(m_done.front());
+    m_done.pop_front();
+    m_handed_out_count++;
+
+    return loaded;
+}
+
+} // namespace vulkan_scene
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+#include <vulkan/vulkan.h>
+
+#include "mipmap.hpp"
+#include "thread-pool.hpp"
+
+namespace vulkan_scene
+{
+
+// Pixels that are ready to be handed to create_image.
+struct decoded_image_t
+{
+    VkFormat format;
+    VkExtent2D extent;
+
+    // The number of levels that the image gets. Those that aren't in levels
+    // get blitted from the last one that is, on the GPU.
+    uint32_t level_count;
+    std::vector<mip_level_t> levels;
+    std::vector<uint8_t> data;
+};
+
+// Everything that decoding needs to know about the device, gathered up front
+// so that the worker threads never have to touch Vulkan.
+struct image_decode_options_t
+{
+    bool generate_mips;
+
+    // Set if RGBA8 can't be blitted with linear filtering, in which case the
+    // whole chain gets built while decoding.
+    bool mips_on_cpu;
+
+    // Whether compressed variants next to an image are used instead of it.
+    bool use_compressed_variants;
+
+    // The block-compressed formats that the device can sample from.
+    std::vector<VkFormat> sampleable_formats;
+};
+
+auto get_image_decode_options(
+    VkPhysicalDevice p_physical_device,
+    bool p_generate_mips,
+    bool p_use_compressed_variants
+) noexcept -> image_decode_options_t;
+
+// Reads an image from disk and gets it ready for uploading. KTX2 files are
+// taken as they are, premade mips included. For anything else, a compressed
+// variant next to the file (such as can-pooper.bc7.ktx2 for can-pooper.png) is
+// preferred if there is one in a format that the device can sample from.
+auto decode_image(
+    std::string_view p_file_path, const image_decode_options_t& p_options
+) noexcept -> kirho::result_t<decoded_image_t, kirho::empty_t>;
+
+struct loaded_image_t
+{
+    // What load_image returned for this image.
+    size_t index;
+
+    // Empty if decoding failed. The error has been printed already.
+    std::optional<decoded_image_t> image;
+};
+
+// Decodes images on a thread pool and hands them back as soon as each one is
+// done, so that the first ones can be uploaded while the rest are still being
+// decoded.
+class asset_loader_t
+{
+  public:
+    explicit asset_loader_t(thread_pool_t& p_thread_pool) noexcept;
+
+    asset_loader_t(const asset_loader_t&) = delete;
+    asset_loader_t& operator=(const asset_loader_t&) = delete;
+
+    // Waits for any images that are still being decoded, since they write
+    // into the loader once they're done.
+    ~asset_loader_t();
+
+    // Starts decoding in the background and returns the index that the image
+    // is going to be handed back with.
+    auto load_image(std::string p_file_path, image_decode_options_t p_options)
+        -> size_t;
+
+    // Blocks until the next image is done, in whatever order they finish.
+    // Returns nothing once every image has been handed out.
+    auto next_image() -> std::optional<loaded_image_t>;
+
+  private:
+    thread_pool_t& m_thread_pool;
+
+    std::mutex m_mutex;
+    std::condition_variable m_image_done;
+    std::deque<loaded_image_t> m_done;
+    size_t m_requested_count;
+    size_t m_handed_out_count;
+};
+
+} // namespace vulkan_scene
@@ -0,0 +1,109 @@
+#include <cmath>
+#include <fstream>
+#include <numbers>
+
+#include "common.hpp"
+#include "statistics.hpp"
+
+#include "benchmark.hpp"
+
+namespace
+{
+
+auto write_sample_stats(
+    std::ostream& p_stream, const vulkan_scene::sample_stats_t& p_stats
+) -> void
+{
+    p_stream << "{\"count\":" << p_stats.count << ",\"min\":" << p_stats.min
+             << ",\"mean\":" << p_stats.mean << ",\"median\":" << p_stats.median
+             << ",\"p95\":" << p_stats.p95 << ",\"p99\":" << p_stats.p99
+             << ",\"max\":" << p_stats.max << '}';
+}
+
+} // namespace
+
+namespace vulkan_scene
+{
+
+auto get_benchmark_pose(uint64_t p_frame) noexcept -> benchmark_pose_t
+{
+    const auto time = static_cast<double>(p_frame) * BENCHMARK_TIMESTEP;
+
+    // A full turn every eight seconds while tilting up and down and moving in
+    // and out a little, so that the draw order and the amount of overdraw keep
+    // changing.
+    return benchmark_pose_t{
+        .yaw = static_cast<float>(time * std::numbers::pi / 4.0),
+        .pitch = static_cast<float>(
+            std::sin(time * 0.5) * std::numbers::pi / 6.0
+        ),
+        .distance_scale =
+            static_cast<float>(1.0 + 0.25 * std::sin(time * 0.25)),
+    };
+}
+
+auto write_benchmark_report(
+    std::string_view p_file_path,
+    const benchmark_info_t& p_info,
+    std::span<const double> p_frame_times,
+    const gpu_profiler_t& p_gpu_profiler
+) -> kirho::result_t<kirho::empty_t, kirho::empty_t>
+{
+    using result_t = kirho::result_t<kirho::empty_t, kirho::empty_t>;
+
+    std::ofstream file_stream{std::string{p_file_path}};
+    if (!file_stream)
+    {
+        print_error("Failed to open ", p_file_path, " for writing.");
+        return result_t::error(kirho::empty_t{});
+    }
+
+    file_stream << "{\n  \"device\": ";
+    write_json_string(file_stream, p_info.device_name);
+    file_stream << ",\n  \"width\": " << p_info.extent.width
+                << ",\n  \"height\": " << p_info.extent.height
+                << ",\n  \"frames_in_flight\": " << p_info.frames_in_flight
+                << ",\n  \"object_count\": " << p_info.object_count
+                << ",\n  \"frames\": " << p_frame_times.size()
+                << ",\n  \"timestep_ms\": " << BENCHMARK_TIMESTEP * 1000.0;
+
+    file_stream << ",\n  \"frame_time_ms\": ";
+    write_sample_stats(file_stream, get_sample_stats(p_frame_times));
+
+    const auto histogram =
+        get_histogram(p_frame_times, BENCHMARK_HISTOGRAM_BUCKETS);
+
+    file_stream << ",\n  \"frame_time_histogram\": {\"start_ms\":"
+                << histogram.start
+                << ",\"bucket_width_ms\":" << histogram.bucket_width
+                << ",\"counts\":[";
+    for (size_t i = 0; i < histogram.counts.size(); i++)
+    {
+        file_stream << (i > 0 ? "," : "") << histogram.counts[i];
+    }
+    file_stream << "]}";
+
+    // Empty if the device can't do timestamps.
+    file_stream << ",\n  \"gpu_time_ms\": {";
+    for (uint32_t i = 0; i < p_gpu_profiler.scopes.size(); i++)
+    {
+        file_stream << (i > 0 ? ",\n    " : "\n    ");
+        write_json_string(file_stream, p_gpu_profiler.scopes[i].name);
+        file_stream << ": ";
+        write_sample_stats(file_stream, get_gpu_scope_stats(p_gpu_profiler, i));
+    }
+    file_stream << "\n  }\n}\n";
+
+    if (!file_stream)
+    {
+        print_error("Failed to write to ", p_file_path, '.');
+        return result_t::error(kirho::empty_t{});
+    }
+
+    std::cout << "[INFO]: Wrote the benchmark report to " << p_file_path
+              << ".\n";
+
+    return result_t::success(kirho::empty_t{});
+}
+
+} // namespace vulkan_scene
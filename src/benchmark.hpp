@@ -0,0 +1,54 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+#include <vulkan/vulkan.h>
+
+#include "gpu-profiler.hpp"
+
+namespace vulkan_scene
+{
+
+constexpr std::string_view DEFAULT_BENCHMARK_REPORT_PATH =
+    "benchmark-report.json";
+
+// Benchmarks advance the scene by the same amount every frame, no matter how
+// long the frame actually took, so that every run renders the same images.
+constexpr double BENCHMARK_TIMESTEP = 1.0 / 60.0;
+
+constexpr uint32_t BENCHMARK_HISTOGRAM_BUCKETS = 32;
+
+// Where the scripted camera is at a given frame of a benchmark.
+struct benchmark_pose_t
+{
+    // Rotation of the scene around the Y and X axes, in radians.
+    float yaw;
+    float pitch;
+
+    // Multiplies the distance between the camera and the scene.
+    float distance_scale;
+};
+
+auto get_benchmark_pose(uint64_t p_frame) noexcept -> benchmark_pose_t;
+
+// What the benchmark ran on and with, to tell the reports apart.
+struct benchmark_info_t
+{
+    std::string device_name;
+    VkExtent2D extent;
+    uint32_t frames_in_flight;
+    uint32_t object_count;
+};
+
+// Writes the frame time statistics and histogram of a benchmark run, and the
+// GPU times of every profiler scope, as JSON. The frame times are in
+// milliseconds.
+auto write_benchmark_report(
+    std::string_view p_file_path,
+    const benchmark_info_t& p_info,
+    std::span<const double> p_frame_times,
+    const gpu_profiler_t& p_gpu_profiler
+) -> kirho::result_t<kirho::empty_t, kirho::empty_t>;
+
+} // namespace vulkan_scene
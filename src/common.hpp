@@ -1,5 +1,7 @@
 #pragma once
 
+#include <string_view>
+
 #define DEBUG_PRINT(x) std::cout << #x " = " << x << std::endl
 
 namespace vulkan_scene
@@ -12,4 +14,29 @@ auto print_error(T... args) noexcept
     (std::cerr << ... << args) << "\033[0m\n";
 }
 
+// Rounds p_value up to the next multiple of p_alignment, which must be a power
+// of two.
+template <std::unsigned_integral T>
+constexpr auto align_up(T p_value, T p_alignment) noexcept -> T
+{
+    return (p_value + p_alignment - 1) & ~(p_alignment - 1);
+}
+
+// Writes the string as a quoted JSON string. Control characters aren't
+// escaped, since none of the strings we write have any.
+inline auto write_json_string(std::ostream& p_stream, std::string_view p_string)
+    -> void
+{
+    p_stream << '"';
+    for (const auto character : p_string)
+    {
+        if (character == '"' || character == '\\')
+        {
+            p_stream << '\\';
+        }
+        p_stream << character;
+    }
+    p_stream << '"';
+}
+
 } // namespace vulkan_scene
@@ -0,0 +1,255 @@
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+#include <string>
+
+#include "common.hpp"
+
+#include "cpu-trace.hpp"
+
+namespace
+{
+
+using clock = std::chrono::steady_clock;
+
+struct trace_event_t
+{
+    const char* name;
+
+    // Nanoseconds since the start of the program.
+    int64_t start;
+    int64_t end;
+};
+
+// A trace_event_t in a ring buffer, which a reader may copy while the owning
+// thread overwrites it. The fields are atomics so that this isn't a data race,
+// and the reader finds out from the head afterwards whether it got a torn
+// event.
+struct trace_slot_t
+{
+    std::atomic<const char*> name;
+    std::atomic<int64_t> start;
+    std::atomic<int64_t> end;
+};
+
+// Only the thread that owns the buffer writes to it. The head is published
+// after every event, so a reader knows which slots hold finished events.
+struct trace_buffer_t
+{
+    uint32_t thread_id;
+    std::string thread_name;
+
+    std::unique_ptr<trace_slot_t[]> events;
+    std::atomic<uint64_t> head;
+};
+
+const auto trace_epoch = clock::now();
+
+std::atomic<bool> trace_enabled = false;
+
+// Buffers stay around after their thread has exited, so that its events
+// still make it into the trace.
+std::mutex trace_buffers_mutex;
+std::vector<std::unique_ptr<trace_buffer_t>> trace_buffers;
+
+thread_local trace_buffer_t* thread_buffer = nullptr;
+
+// Kept separately, so that naming a thread doesn't allocate a buffer for it.
+thread_local std::string thread_name;
+
+auto get_trace_time() noexcept -> int64_t
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               clock::now() - trace_epoch
+    )
+        .count();
+}
+
+// Only takes the lock the first time a thread records something.
+auto get_thread_buffer() -> trace_buffer_t&
+{
+    if (thread_buffer == nullptr)
+    {
+        auto buffer = std::make_unique<trace_buffer_t>();
+        buffer->events = std::make_unique<trace_slot_t[]>(
+            vulkan_scene::CPU_TRACE_CAPACITY
+        );
+        buffer->head = 0;
+        buffer->thread_name = thread_name;
+
+        const std::lock_guard lock{trace_buffers_mutex};
+        buffer->thread_id = static_cast<uint32_t>(trace_buffers.size());
+        thread_buffer = buffer.get();
+        trace_buffers.push_back(std::move(buffer));
+    }
+
+    return *thread_buffer;
+}
+
+} // namespace
+
+namespace vulkan_scene
+{
+
+auto enable_cpu_trace(bool p_enable) noexcept -> void
+{
+    trace_enabled.store(p_enable, std::memory_order_relaxed);
+}
+
+auto is_cpu_trace_enabled() noexcept -> bool
+{
+    return trace_enabled.load(std::memory_order_relaxed);
+}
+
+auto set_cpu_trace_thread_name(std::string_view p_name) -> void
+{
+    thread_name = p_name;
+
+    if (thread_buffer != nullptr)
+    {
+        const std::lock_guard lock{trace_buffers_mutex};
+        thread_buffer->thread_name = p_name;
+    }
+}
+
+cpu_trace_scope_t::cpu_trace_scope_t(const char* p_name) noexcept
+    : m_name(is_cpu_trace_enabled() ? p_name : nullptr),
+      m_start(m_name != nullptr ? get_trace_time() : 0)
+{
+}
+
+auto cpu_trace_scope_t::end() noexcept -> void
+{
+    if (m_name == nullptr)
+    {
+        return;
+    }
+
+    const auto end_time = get_trace_time();
+
+    auto& buffer = get_thread_buffer();
+    const auto head = buffer.head.load(std::memory_order_relaxed);
+
+    // Pairs with the fence in write_cpu_trace. A reader that sees any of the
+    // stores below also sees that the head has moved past the event that was
+    // in the slot before, and so knows to leave it out.
+    std::atomic_thread_fence(std::memory_order_release);
+
+    auto& slot = buffer.events[head % CPU_TRACE_CAPACITY];
+    slot.name.store(m_name, std::memory_order_relaxed);
+    slot.start.store(m_start, std::memory_order_relaxed);
+    slot.end.store(end_time, std::memory_order_relaxed);
+
+    buffer.head.store(head + 1, std::memory_order_release);
+
+    m_name = nullptr;
+}
+
+auto write_cpu_trace(std::string_view p_file_path)
+    -> kirho::result_t<kirho::empty_t, kirho::empty_t>
+{
+    using result_t = kirho::result_t<kirho::empty_t, kirho::empty_t>;
+
+    std::ofstream file_stream{std::string{p_file_path}};
+    if (!file_stream)
+    {
+        print_error("Failed to open ", p_file_path, " for writing.");
+        return result_t::error(kirho::empty_t{});
+    }
+
+    // Chrome wants microseconds, and the default precision would round them
+    // to the nearest second or so after a few minutes.
+    file_stream << std::fixed << std::setprecision(3);
+    file_stream << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+    auto first_event = true;
+    const auto separate = [&file_stream, &first_event]
+    {
+        if (!first_event)
+        {
+            file_stream << ",\n";
+        }
+        first_event = false;
+    };
+
+    size_t event_count = 0;
+
+    const std::lock_guard lock{trace_buffers_mutex};
+    for (const auto& buffer : trace_buffers)
+    {
+        separate();
+        file_stream << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,"
+                    << "\"tid\":" << buffer->thread_id
+                    << ",\"args\":{\"name\":";
+        write_json_string(
+            file_stream,
+            buffer->thread_name.empty()
+                ? "thread " + std::to_string(buffer->thread_id)
+                : buffer->thread_name
+        );
+        file_stream << "}}";
+
+        const auto head = buffer->head.load(std::memory_order_acquire);
+        const auto count =
+            std::min(head, static_cast<uint64_t>(CPU_TRACE_CAPACITY));
+
+        std::vector<trace_event_t> events(
+            static_cast<size_t>(count), trace_event_t{}
+        );
+        for (uint64_t i = 0; i < count; i++)
+        {
+            const auto& slot =
+                buffer->events[(head - count + i) % CPU_TRACE_CAPACITY];
+
+            events[i] = trace_event_t{
+                .name = slot.name.load(std::memory_order_relaxed),
+                .start = slot.start.load(std::memory_order_relaxed),
+                .end = slot.end.load(std::memory_order_relaxed),
+            };
+        }
+
+        // Anything that the thread has wrapped around to while it was being
+        // copied may be half written, including the slot it's writing now.
+        std::atomic_thread_fence(std::memory_order_acquire);
+        const auto new_head = buffer->head.load(std::memory_order_relaxed);
+        const auto first_intact = static_cast<int64_t>(new_head) + 1 -
+                                  static_cast<int64_t>(CPU_TRACE_CAPACITY);
+        const auto overwritten = std::clamp(
+            first_intact - static_cast<int64_t>(head - count),
+            static_cast<int64_t>(0), static_cast<int64_t>(count)
+        );
+
+        for (auto event = events.begin() + overwritten; event != events.end();
+             event++)
+        {
+            separate();
+            file_stream << "{\"name\":";
+            write_json_string(file_stream, event->name);
+            file_stream << ",\"ph\":\"X\",\"pid\":1,\"tid\":"
+                        << buffer->thread_id
+                        << ",\"ts\":" << static_cast<double>(event->start) / 1e3
+                        << ",\"dur\":"
+                        << static_cast<double>(event->end - event->start) / 1e3
+                        << '}';
+
+            event_count++;
+        }
+    }
+
+    file_stream << "]}\n";
+
+    if (!file_stream)
+    {
+        print_error("Failed to write to ", p_file_path, '.');
+        return result_t::error(kirho::empty_t{});
+    }
+
+    std::cout << "[INFO]: Wrote " << event_count << " trace events to "
+              << p_file_path << ".\n";
+
+    return result_t::success(kirho::empty_t{});
+}
+
+} // namespace vulkan_scene
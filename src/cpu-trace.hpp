@@ -0,0 +1,53 @@
+#pragma once
+
+#include <string_view>
+
+namespace vulkan_scene
+{
+
+// How many events each thread keeps. Once a thread's buffer is full, its
+// oldest events get overwritten.
+constexpr size_t CPU_TRACE_CAPACITY = 32768;
+
+// Tracing is off until this is called. While it's off, trace scopes don't do
+// anything beyond checking a flag.
+auto enable_cpu_trace(bool p_enable) noexcept -> void;
+
+auto is_cpu_trace_enabled() noexcept -> bool;
+
+// Names the calling thread in the trace. Threads that don't have a name show
+// up by their number.
+auto set_cpu_trace_thread_name(std::string_view p_name) -> void;
+
+// Times everything between its construction and its destruction (or the call
+// to end) as one event. Every thread records into a ring buffer of its own, so
+// recording never takes a lock. The name has to outlive the trace, which
+// string literals do.
+class cpu_trace_scope_t
+{
+  public:
+    explicit cpu_trace_scope_t(const char* p_name) noexcept;
+
+    cpu_trace_scope_t(const cpu_trace_scope_t&) = delete;
+    cpu_trace_scope_t& operator=(const cpu_trace_scope_t&) = delete;
+
+    ~cpu_trace_scope_t()
+    {
+        end();
+    }
+
+    // Ends the event before the scope does. Does nothing the second time.
+    auto end() noexcept -> void;
+
+  private:
+    const char* m_name;
+    int64_t m_start;
+};
+
+// Writes the events of every thread as Chrome trace JSON, which both
+// chrome://tracing and Perfetto open. Threads may keep recording while this
+// runs, but the events they overwrite in the meantime are left out.
+auto write_cpu_trace(std::string_view p_file_path)
+    -> kirho::result_t<kirho::empty_t, kirho::empty_t>;
+
+} // namespace vulkan_scene
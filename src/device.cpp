@@ -53,6 +53,73 @@ const auto MESSENGER_CREATE_INFO = VkDebugUtilsMessengerCreateInfoEXT{
 
 const auto DEVICE_EXTENSIONS = std::array<const char*, 1>{"VK_KHR_swapchain"};
 
+// Descriptor indexing is only core since Vulkan 1.2, so older devices need the
+// extension, along with the one that it depends on.
+const auto DESCRIPTOR_INDEXING_EXTENSIONS = std::array<const char*, 2>{
+    "VK_EXT_descriptor_indexing", "VK_KHR_maintenance3"};
+
+auto is_device_extension_available(
+    VkPhysicalDevice p_physical_device, const char* p_extension
+) noexcept -> bool
+{
+    auto extension_count = static_cast<uint32_t>(0);
+    vkEnumerateDeviceExtensionProperties(
+        p_physical_device, nullptr, &extension_count, nullptr
+    );
+
+    auto available_extensions =
+        std::vector<VkExtensionProperties>(extension_count);
+    vkEnumerateDeviceExtensionProperties(
+        p_physical_device, nullptr, &extension_count,
+        available_extensions.data()
+    );
+
+    return std::any_of(
+        available_extensions.begin(), available_extensions.end(),
+        [p_extension](const VkExtensionProperties& p_available_extension)
+        {
+            return std::strcmp(
+                       p_available_extension.extensionName, p_extension
+                   ) == 0;
+        }
+    );
+}
+
+// Prefers a family that can do nothing but transfers, since those usually map
+// to the copy engines of the GPU. Failing that, a family without graphics
+// support (like an async compute one) still keeps uploads off the graphics
+// queue. Otherwise, uploads share the graphics family.
+auto find_transfer_family(
+    std::span<const VkQueueFamilyProperties> p_queue_families,
+    uint32_t p_graphics_family
+) noexcept -> uint32_t
+{
+    auto transfer_family = std::optional<uint32_t>();
+
+    for (uint32_t i = 0; i < p_queue_families.size(); i++)
+    {
+        const auto flags = p_queue_families[i].queueFlags;
+
+        if ((flags & VK_QUEUE_TRANSFER_BIT) == 0 ||
+            (flags & VK_QUEUE_GRAPHICS_BIT) != 0)
+        {
+            continue;
+        }
+
+        if ((flags & VK_QUEUE_COMPUTE_BIT) == 0)
+        {
+            return i;
+        }
+
+        if (!transfer_family.has_value())
+        {
+            transfer_family = i;
+        }
+    }
+
+    return transfer_family.value_or(p_graphics_family);
+}
+
 } // namespace
 
 namespace vulkan_scene
@@ -73,8 +140,9 @@ auto destroy_debug_messenger(
     // Nothing we can do if function turned out to be null.
 }
 
-auto create_vulkan_instance(bool p_enable_validation) noexcept
-    -> kirho::result_t<VkInstance, VkResult>
+auto create_vulkan_instance(
+    bool p_enable_validation, bool p_enable_surfaces
+) noexcept -> kirho::result_t<VkInstance, VkResult>
 {
     using result_t_t = kirho::result_t<VkInstance, VkResult>;
 
@@ -88,9 +156,13 @@ auto create_vulkan_instance(bool p_enable_validation) noexcept
         .apiVersion = VK_API_VERSION_1_2,
     };
 
+    // Headless instances don't present anything, so they don't need the
+    // surface extensions (and GLFW might not even be initialized).
     auto glfw_extension_count = static_cast<uint32_t>(0);
     const auto glfw_extensions =
-        glfwGetRequiredInstanceExtensions(&glfw_extension_count);
+        p_enable_surfaces
+            ? glfwGetRequiredInstanceExtensions(&glfw_extension_count)
+            : nullptr;
 
     auto enabled_layers = std::vector<const char*>();
     auto enabled_extensions = std::vector<const char*>(
@@ -179,9 +251,17 @@ auto choose_physical_device(
         p_instance, &device_count, physical_devices.data()
     );
 
+    // Without a surface, we are rendering offscreen. The graphics queue then
+    // doubles as the "present" queue and the swapchain extension is optional.
+    const auto headless = p_surface == VK_NULL_HANDLE;
+    const auto required_extensions =
+        headless ? std::span<const char* const>{}
+                 : std::span<const char* const>{DEVICE_EXTENSIONS};
+
     auto chosen_device = static_cast<VkPhysicalDevice>(VK_NULL_HANDLE);
     auto graphics_family = std::optional<uint32_t>();
     auto present_family = std::optional<uint32_t>();
+    auto transfer_family = static_cast<uint32_t>(0);
 
     for (const auto device : physical_devices)
     {
@@ -204,13 +284,21 @@ auto choose_physical_device(
                 graphics_family = static_cast<uint32_t>(i);
             }
 
-            auto present_support = static_cast<VkBool32>(VK_FALSE);
-            vkGetPhysicalDeviceSurfaceSupportKHR(
-                device, static_cast<uint32_t>(i), p_surface, &present_support
-            );
-            if (present_support == VK_TRUE)
+            if (headless)
             {
-                present_family = static_cast<uint32_t>(i);
+                present_family = graphics_family;
+            }
+            else
+            {
+                auto present_support = static_cast<VkBool32>(VK_FALSE);
+                vkGetPhysicalDeviceSurfaceSupportKHR(
+                    device, static_cast<uint32_t>(i), p_surface,
+                    &present_support
+                );
+                if (present_support == VK_TRUE)
+                {
+                    present_family = static_cast<uint32_t>(i);
+                }
             }
 
             auto extension_count = static_cast<uint32_t>(0);
@@ -226,7 +314,7 @@ auto choose_physical_device(
 
             auto found_unsupported_extension = false;
 
-            for (const auto extension : DEVICE_EXTENSIONS)
+            for (const auto extension : required_extensions)
             {
                 auto found_extension = false;
 
@@ -258,6 +346,8 @@ auto choose_physical_device(
         if (graphics_family.has_value() && present_family.has_value())
         {
             chosen_device = device;
+            transfer_family =
+                find_transfer_family(queue_families, graphics_family.value());
             break;
         }
     }
@@ -291,8 +381,15 @@ auto choose_physical_device(
     std::cout << "[INFO]: Selected the " << device_properties.deviceName
               << " graphics card.\n";
 
+    if (transfer_family != graphics_family.value())
+    {
+        std::cout << "[INFO]: Using queue family " << transfer_family
+                  << " for transfers.\n";
+    }
+
     return result_t_t::success(physical_device{
-        chosen_device, graphics_family.value(), present_family.value()});
+        chosen_device, graphics_family.value(), present_family.value(),
+        transfer_family});
 }
 
 auto create_debug_messenger(VkInstance p_instance) noexcept
@@ -326,7 +423,10 @@ auto create_debug_messenger(VkInstance p_instance) noexcept
 auto create_logical_device(
     VkPhysicalDevice p_physical_device,
     uint32_t p_graphics_family,
-    uint32_t p_present_family
+    uint32_t p_present_family,
+    uint32_t p_transfer_family,
+    bool p_enable_swapchain,
+    bool p_enable_descriptor_indexing
 ) noexcept -> kirho::result_t<logical_device, VkResult>
 {
     using result_t_t = kirho::result_t<logical_device, VkResult>;
@@ -334,45 +434,140 @@ auto create_logical_device(
     auto queue_infos = std::vector<VkDeviceQueueCreateInfo>();
     const auto queue_priority = 1.0f;
 
-    if (p_graphics_family == p_present_family)
+    // Every family only gets one queue, even if it is used for several things.
+    for (const auto family :
+         {p_graphics_family, p_present_family, p_transfer_family})
     {
+        const auto already_added = std::any_of(
+            queue_infos.begin(), queue_infos.end(),
+            [family](const VkDeviceQueueCreateInfo& p_info)
+            { return p_info.queueFamilyIndex == family; }
+        );
+        if (already_added)
+        {
+            continue;
+        }
+
         queue_infos.push_back(VkDeviceQueueCreateInfo{
             .sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
             .pNext = nullptr,
             .flags = 0,
-            .queueFamilyIndex = p_graphics_family,
+            .queueFamilyIndex = family,
             .queueCount = 1,
             .pQueuePriorities = &queue_priority,
         });
     }
-    else
+
+    // Block-compressed formats only work if their feature is turned on, so
+    // enable whichever ones the device has. Textures pick their format based
+    // on the format properties, which already take these into account. The
+    // same goes for the pipeline statistics used to measure overdraw, and for
+    // counting them in secondary command buffers.
+    VkPhysicalDeviceFeatures supported_features;
+    vkGetPhysicalDeviceFeatures(p_physical_device, &supported_features);
+
+    const auto enabled_features = VkPhysicalDeviceFeatures{
+        .textureCompressionASTC_LDR =
+            supported_features.textureCompressionASTC_LDR,
+        .textureCompressionBC = supported_features.textureCompressionBC,
+        .pipelineStatisticsQuery = supported_features.pipelineStatisticsQuery,
+        .shaderSampledImageArrayDynamicIndexing =
+            p_enable_descriptor_indexing ? VK_TRUE : VK_FALSE,
+        .inheritedQueries = supported_features.inheritedQueries,
+    };
+
+    auto enabled_extensions = std::vector<const char*>();
+    if (p_enable_swapchain)
     {
-        auto queue_info = VkDeviceQueueCreateInfo{
-            .sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
+        enabled_extensions.insert(
+            enabled_extensions.end(), DEVICE_EXTENSIONS.begin(),
+            DEVICE_EXTENSIONS.end()
+        );
+    }
+
+    // The texture table is a runtime-sized array of textures that only gets
+    // partially filled, and that may be written to while it is bound. Unlike
+    // the features above, there's no way around these for anything that uses
+    // one. The shaders pick a texture with an index from the push constants,
+    // which also takes dynamic indexing.
+    if (p_enable_descriptor_indexing)
+    {
+        if (!supported_features.shaderSampledImageArrayDynamicIndexing)
+        {
+            print_error(
+                "The device doesn't support dynamically indexing arrays of "
+                "textures."
+            );
+            return result_t_t::error(VK_ERROR_FEATURE_NOT_PRESENT);
+        }
+
+        VkPhysicalDeviceProperties properties;
+        vkGetPhysicalDeviceProperties(p_physical_device, &properties);
+
+        if (properties.apiVersion < VK_API_VERSION_1_2)
+        {
+            for (const auto extension : DESCRIPTOR_INDEXING_EXTENSIONS)
+            {
+                if (!is_device_extension_available(
+                        p_physical_device, extension
+                    ))
+                {
+                    print_error(
+                        "The device supports neither Vulkan 1.2 nor ",
+                        extension, '.'
+                    );
+                    return result_t_t::error(VK_ERROR_EXTENSION_NOT_PRESENT);
+                }
+
+                enabled_extensions.push_back(extension);
+            }
+        }
+
+        VkPhysicalDeviceDescriptorIndexingFeatures supported_indexing_features{
+            .sType =
+                VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES,
             .pNext = nullptr,
-            .flags = 0,
-            .queueFamilyIndex = p_graphics_family,
-            .queueCount = 1,
-            .pQueuePriorities = &queue_priority,
         };
 
-        queue_infos.push_back(queue_info);
-        queue_info.queueFamilyIndex = p_present_family;
-        queue_infos.push_back(queue_info);
+        VkPhysicalDeviceFeatures2 supported_features_2{
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
+            .pNext = &supported_indexing_features,
+        };
+        vkGetPhysicalDeviceFeatures2(p_physical_device, &supported_features_2);
+
+        if (!supported_indexing_features
+                 .descriptorBindingSampledImageUpdateAfterBind ||
+            !supported_indexing_features
+                 .descriptorBindingUpdateUnusedWhilePending ||
+            !supported_indexing_features.descriptorBindingPartiallyBound ||
+            !supported_indexing_features.runtimeDescriptorArray)
+        {
+            print_error("The device doesn't support descriptor indexing.");
+            return result_t_t::error(VK_ERROR_FEATURE_NOT_PRESENT);
+        }
     }
 
+    const auto indexing_features = VkPhysicalDeviceDescriptorIndexingFeatures{
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES,
+        .pNext = nullptr,
+        .descriptorBindingSampledImageUpdateAfterBind = VK_TRUE,
+        .descriptorBindingUpdateUnusedWhilePending = VK_TRUE,
+        .descriptorBindingPartiallyBound = VK_TRUE,
+        .runtimeDescriptorArray = VK_TRUE,
+    };
+
     const auto device_info = VkDeviceCreateInfo{
         .sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
-        .pNext = nullptr,
+        .pNext = p_enable_descriptor_indexing ? &indexing_features : nullptr,
         .flags = 0,
         .queueCreateInfoCount = static_cast<uint32_t>(queue_infos.size()),
         .pQueueCreateInfos = queue_infos.data(),
         .enabledLayerCount = 0,
         .ppEnabledLayerNames = nullptr,
         .enabledExtensionCount =
-            static_cast<uint32_t>(DEVICE_EXTENSIONS.size()),
-        .ppEnabledExtensionNames = DEVICE_EXTENSIONS.data(),
-        .pEnabledFeatures = nullptr,
+            static_cast<uint32_t>(enabled_extensions.size()),
+        .ppEnabledExtensionNames = enabled_extensions.data(),
+        .pEnabledFeatures = &enabled_features,
     };
 
     auto device = static_cast<VkDevice>(VK_NULL_HANDLE);
@@ -392,10 +587,14 @@ auto create_logical_device(
     VkQueue present_queue;
     vkGetDeviceQueue(device, p_present_family, 0, &present_queue);
 
+    VkQueue transfer_queue;
+    vkGetDeviceQueue(device, p_transfer_family, 0, &transfer_queue);
+
     return result_t_t::success(logical_device{
         .device = device,
         .graphics_queue = graphics_queue,
         .present_queue = present_queue,
+        .transfer_queue = transfer_queue,
     });
 }
 
@@ -407,7 +606,7 @@ auto create_command_pool(VkDevice p_device, uint32_t p_queue_family) noexcept
     const VkCommandPoolCreateInfo pool_info{
         .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
         .pNext = nullptr,
-        .flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT,
+        .flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
         .queueFamilyIndex = p_queue_family,
     };
 
@@ -475,8 +674,9 @@ auto create_fence(VkDevice p_device) noexcept
     return result_tt::success(fence);
 }
 
-auto create_command_buffer(VkDevice p_device, VkCommandPool p_pool) noexcept
-    -> kirho::result_t<VkCommandBuffer, VkResult>
+auto create_command_buffer(
+    VkDevice p_device, VkCommandPool p_pool, VkCommandBufferLevel p_level
+) noexcept -> kirho::result_t<VkCommandBuffer, VkResult>
 {
     using result_t = kirho::result_t<VkCommandBuffer, VkResult>;
 
@@ -484,7 +684,7 @@ auto create_command_buffer(VkDevice p_device, VkCommandPool p_pool) noexcept
         .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
         .pNext = nullptr,
         .commandPool = p_pool,
-        .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+        .level = p_level,
         .commandBufferCount = 1,
     };
 
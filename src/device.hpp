@@ -10,6 +10,9 @@ struct physical_device
     VkPhysicalDevice device;
     uint32_t graphics_family;
     uint32_t present_family;
+
+    // Equal to graphics_family if the device has no separate transfer family.
+    uint32_t transfer_family;
 };
 
 struct logical_device
@@ -17,28 +20,39 @@ struct logical_device
     VkDevice device;
     VkQueue graphics_queue;
     VkQueue present_queue;
+    VkQueue transfer_queue;
 };
 
-auto create_vulkan_instance(bool enable_validation) noexcept
-    -> kirho::result_t<VkInstance, VkResult>;
+auto create_vulkan_instance(
+    bool enable_validation, bool enable_surfaces = true
+) noexcept -> kirho::result_t<VkInstance, VkResult>;
 
 auto create_debug_messenger(VkInstance instance) noexcept
     -> kirho::result_t<VkDebugUtilsMessengerEXT, VkResult>;
 
+// Pass VK_NULL_HANDLE as the surface to pick a device for headless rendering.
 auto choose_physical_device(
     VkInstance p_instance, VkSurfaceKHR p_surface
 ) noexcept -> kirho::result_t<physical_device, kirho::empty_t>;
 
+// Descriptor indexing is only needed for texture tables, so it has to be asked
+// for. The device creation fails if it isn't supported then.
 auto create_logical_device(
     VkPhysicalDevice p_physical_device,
     uint32_t p_graphics_family,
-    uint32_t p_present_family
+    uint32_t p_present_family,
+    uint32_t p_transfer_family,
+    bool p_enable_swapchain = true,
+    bool p_enable_descriptor_indexing = false
 ) noexcept -> kirho::result_t<logical_device, VkResult>;
 
 auto destroy_debug_messenger(
     VkInstance p_instance, VkDebugUtilsMessengerEXT p_messenger
 ) noexcept -> void;
 
+// The pool is transient, and its command buffers can't be reset one by one.
+// Reset the whole pool with vkResetCommandPool instead, once the GPU is done
+// with all of them.
 auto create_command_pool(VkDevice p_device, uint32_t p_queue_family) noexcept
     -> kirho::result_t<VkCommandPool, VkResult>;
 
@@ -48,7 +62,10 @@ auto create_semaphore(VkDevice p_device) noexcept
 auto create_fence(VkDevice p_device) noexcept
     -> kirho::result_t<VkFence, VkResult>;
 
-auto create_command_buffer(VkDevice p_device, VkCommandPool p_pool) noexcept
-    -> kirho::result_t<VkCommandBuffer, VkResult>;
+auto create_command_buffer(
+    VkDevice p_device,
+    VkCommandPool p_pool,
+    VkCommandBufferLevel p_level = VK_COMMAND_BUFFER_LEVEL_PRIMARY
+) noexcept -> kirho::result_t<VkCommandBuffer, VkResult>;
 
 } // namespace vulkan_scene
@@ -0,0 +1,154 @@
+#include "common.hpp"
+#include "cpu-trace.hpp"
+#include "device.hpp"
+#include "thread-pool.hpp"
+
+#include "draw-recorder.hpp"
+
+namespace vulkan_scene
+{
+
+auto create_draw_recorder(
+    VkDevice p_device,
+    uint32_t p_queue_family,
+    uint32_t p_partition_count,
+    uint32_t p_frame_count
+) noexcept -> kirho::result_t<draw_recorder_t, VkResult>
+{
+    using result_t = kirho::result_t<draw_recorder_t, VkResult>;
+
+    draw_recorder_t recorder{
+        .partition_count = p_partition_count,
+        .command_pools = {},
+        .command_buffers = {},
+    };
+
+    const auto buffer_count = p_partition_count * p_frame_count;
+    recorder.command_pools.reserve(buffer_count);
+    recorder.command_buffers.reserve(buffer_count);
+
+    for (uint32_t i = 0; i < buffer_count; i++)
+    {
+        VkResult error;
+
+        const auto pool_result = create_command_pool(p_device, p_queue_family);
+        if (pool_result.is_error(error))
+        {
+            destroy_draw_recorder(p_device, recorder);
+            return result_t::error(error);
+        }
+
+        recorder.command_pools.push_back(pool_result.unwrap());
+
+        const auto buffer_result = create_command_buffer(
+            p_device, recorder.command_pools.back(),
+            VK_COMMAND_BUFFER_LEVEL_SECONDARY
+        );
+        if (buffer_result.is_error(error))
+        {
+            destroy_draw_recorder(p_device, recorder);
+            return result_t::error(error);
+        }
+
+        recorder.command_buffers.push_back(buffer_result.unwrap());
+    }
+
+    return result_t::success(recorder);
+}
+
+auto record_draws(
+    VkDevice p_device,
+    draw_recorder_t& p_recorder,
+    thread_pool_t& p_thread_pool,
+    uint32_t p_frame_index,
+    const VkCommandBufferInheritanceInfo& p_inheritance,
+    uint32_t p_draw_count,
+    const record_draws_t& p_record
+) noexcept -> kirho::result_t<std::span<const VkCommandBuffer>, VkResult>
+{
+    using result_t =
+        kirho::result_t<std::span<const VkCommandBuffer>, VkResult>;
+
+    const auto partition_count = p_recorder.partition_count;
+    const auto first_buffer = p_frame_index * partition_count;
+
+    // Every partition only writes its own slot.
+    std::vector<VkResult> results(partition_count, VK_SUCCESS);
+
+    p_thread_pool.parallel_for(
+        0, partition_count, 1,
+        [&](uint32_t p_partition, uint32_t)
+        {
+            cpu_trace_scope_t trace{"record draws"};
+
+            // The partitions differ in size by one draw at most.
+            const auto first_draw = static_cast<uint32_t>(
+                static_cast<uint64_t>(p_draw_count) * p_partition /
+                partition_count
+            );
+            const auto end_draw = static_cast<uint32_t>(
+                static_cast<uint64_t>(p_draw_count) * (p_partition + 1) /
+                partition_count
+            );
+
+            const auto command_pool =
+                p_recorder.command_pools[first_buffer + p_partition];
+            const auto command_buffer =
+                p_recorder.command_buffers[first_buffer + p_partition];
+
+            // Resetting the whole pool is cheaper than resetting the buffer,
+            // and the pool holds nothing else.
+            auto result = vkResetCommandPool(p_device, command_pool, 0);
+
+            const VkCommandBufferBeginInfo begin_info{
+                .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+                .pNext = nullptr,
+                .flags = VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT |
+                         VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+                .pInheritanceInfo = &p_inheritance,
+            };
+
+            if (result == VK_SUCCESS)
+            {
+                result = vkBeginCommandBuffer(command_buffer, &begin_info);
+            }
+
+            if (result == VK_SUCCESS)
+            {
+                p_record(command_buffer, first_draw, end_draw - first_draw);
+                result = vkEndCommandBuffer(command_buffer);
+            }
+
+            results[p_partition] = result;
+        }
+    );
+
+    for (const auto result : results)
+    {
+        if (result != VK_SUCCESS)
+        {
+            print_error(
+                "Failed to record a secondary command buffer. Vulkan error ",
+                result, '.'
+            );
+            return result_t::error(result);
+        }
+    }
+
+    return result_t::success(std::span<const VkCommandBuffer>{
+        p_recorder.command_buffers.data() + first_buffer, partition_count
+    });
+}
+
+auto destroy_draw_recorder(
+    VkDevice p_device, const draw_recorder_t& p_recorder
+) noexcept -> void
+{
+    // Destroying a pool frees the command buffers that came from it.
+    for (const auto command_pool : p_recorder.command_pools)
+    {
+        vkDestroyCommandPool(p_device, command_pool, nullptr);
+    }
+}
+
+} // namespace vulkan_scene
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <functional>
+
+#include <vulkan/vulkan.h>
+
+namespace vulkan_scene
+{
+
+class thread_pool_t;
+
+// Records a list of draws on the threads of a thread pool, split into one
+// secondary command buffer per partition. A command pool can only be used by
+// one thread at a time, so every partition gets its own pool for each frame in
+// flight.
+struct draw_recorder_t
+{
+    uint32_t partition_count;
+
+    // Both indexed by frame_index * partition_count + partition.
+    std::vector<VkCommandPool> command_pools;
+    std::vector<VkCommandBuffer> command_buffers;
+};
+
+// Records the draws from p_first_draw to p_first_draw + p_draw_count into a
+// secondary command buffer that has already begun. The buffer inherits nothing
+// but the render pass, so everything else must be bound again.
+using record_draws_t = std::function<void(
+    VkCommandBuffer p_command_buffer,
+    uint32_t p_first_draw,
+    uint32_t p_draw_count
+)>;
+
+auto create_draw_recorder(
+    VkDevice p_device,
+    uint32_t p_queue_family,
+    uint32_t p_partition_count,
+    uint32_t p_frame_count
+) noexcept -> kirho::result_t<draw_recorder_t, VkResult>;
+
+// Splits the draws evenly between the partitions and records them on the
+// thread pool, with the calling thread recording the first one. The returned
+// command buffers must be executed inside of the render pass in p_inheritance,
+// which has to be begun with VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS.
+// Only call this once the fence of the frame has been waited on.
+auto record_draws(
+    VkDevice p_device,
+    draw_recorder_t& p_recorder,
+    thread_pool_t& p_thread_pool,
+    uint32_t p_frame_index,
+    const VkCommandBufferInheritanceInfo& p_inheritance,
+    uint32_t p_draw_count,
+    const record_draws_t& p_record
+) noexcept -> kirho::result_t<std::span<const VkCommandBuffer>, VkResult>;
+
+auto destroy_draw_recorder(
+    VkDevice p_device, const draw_recorder_t& p_recorder
+) noexcept -> void;
+
+} // namespace vulkan_scene
@@ -0,0 +1,120 @@
+#include "common.hpp"
+#include "device.hpp"
+
+#include "frame.hpp"
+
+namespace vulkan_scene
+{
+
+auto create_frames(
+    VkDevice p_device, uint32_t p_queue_family, uint32_t p_frame_count
+) noexcept -> kirho::result_t<std::vector<frame_t>, VkResult>
+{
+    using result_t = kirho::result_t<std::vector<frame_t>, VkResult>;
+
+    std::vector<frame_t> frames;
+    frames.reserve(p_frame_count);
+
+    for (uint32_t i = 0; i < p_frame_count; i++)
+    {
+        VkResult error;
+
+        const auto command_pool_result =
+            create_command_pool(p_device, p_queue_family);
+        if (command_pool_result.is_error(error))
+        {
+            destroy_frames(p_device, frames);
+            return result_t::error(error);
+        }
+
+        const auto command_pool = command_pool_result.unwrap();
+
+        const auto command_buffer_result =
+            create_command_buffer(p_device, command_pool);
+        if (command_buffer_result.is_error(error))
+        {
+            vkDestroyCommandPool(p_device, command_pool, nullptr);
+            destroy_frames(p_device, frames);
+            return result_t::error(error);
+        }
+
+        const auto fence_result = create_fence(p_device);
+        if (fence_result.is_error(error))
+        {
+            vkDestroyCommandPool(p_device, command_pool, nullptr);
+            destroy_frames(p_device, frames);
+            return result_t::error(error);
+        }
+
+        const auto image_available_result = create_semaphore(p_device);
+
+        frames.push_back(frame_t{
+            .command_pool = command_pool,
+            .command_buffer = command_buffer_result.unwrap(),
+            .fence = fence_result.unwrap(),
+            .image_available_semaphore =
+                image_available_result.is_error(error)
+                    ? VK_NULL_HANDLE
+                    : image_available_result.unwrap(),
+        });
+
+        if (image_available_result.is_error(error))
+        {
+            destroy_frames(p_device, frames);
+            return result_t::error(error);
+        }
+    }
+
+    return result_t::success(frames);
+}
+
+auto destroy_frames(VkDevice p_device, const std::vector<frame_t>& p_frames)
+    noexcept -> void
+{
+    for (const auto& frame : p_frames)
+    {
+        vkDestroySemaphore(p_device, frame.image_available_semaphore, nullptr);
+        vkDestroyFence(p_device, frame.fence, nullptr);
+
+        // Destroying the pool frees the command buffer as well.
+        vkDestroyCommandPool(p_device, frame.command_pool, nullptr);
+    }
+}
+
+auto create_render_done_semaphores(
+    VkDevice p_device, uint32_t p_image_count
+) noexcept -> kirho::result_t<std::vector<VkSemaphore>, VkResult>
+{
+    using result_t = kirho::result_t<std::vector<VkSemaphore>, VkResult>;
+
+    std::vector<VkSemaphore> semaphores;
+    semaphores.reserve(p_image_count);
+
+    for (uint32_t i = 0; i < p_image_count; i++)
+    {
+        VkResult error;
+
+        const auto semaphore_result = create_semaphore(p_device);
+        if (semaphore_result.is_error(error))
+        {
+            destroy_render_done_semaphores(p_device, semaphores);
+            return result_t::error(error);
+        }
+
+        semaphores.push_back(semaphore_result.unwrap());
+    }
+
+    return result_t::success(semaphores);
+}
+
+auto destroy_render_done_semaphores(
+    VkDevice p_device, const std::vector<VkSemaphore>& p_semaphores
+) noexcept -> void
+{
+    for (const auto semaphore : p_semaphores)
+    {
+        vkDestroySemaphore(p_device, semaphore, nullptr);
+    }
+}
+
+} // namespace vulkan_scene
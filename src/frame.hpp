@@ -0,0 +1,40 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+namespace vulkan_scene
+{
+
+constexpr uint32_t DEFAULT_FRAMES_IN_FLIGHT = 2;
+
+// Everything that a single frame needs to be recorded and submitted while the
+// GPU is still busy with the previous ones.
+struct frame_t
+{
+    // The frame's command buffer is the only one in its pool, so the pool gets
+    // reset as a whole once the fence says that the GPU is done with it.
+    VkCommandPool command_pool;
+    VkCommandBuffer command_buffer;
+    VkFence fence;
+    VkSemaphore image_available_semaphore;
+};
+
+auto create_frames(
+    VkDevice p_device, uint32_t p_queue_family, uint32_t p_frame_count
+) noexcept -> kirho::result_t<std::vector<frame_t>, VkResult>;
+
+auto destroy_frames(VkDevice p_device, const std::vector<frame_t>& p_frames)
+    noexcept -> void;
+
+// The semaphores that presentation waits on, one per swapchain image. The
+// fence of a frame doesn't say when presenting it has consumed its semaphore,
+// but acquiring the same image again does, so these can't belong to a frame.
+auto create_render_done_semaphores(
+    VkDevice p_device, uint32_t p_image_count
+) noexcept -> kirho::result_t<std::vector<VkSemaphore>, VkResult>;
+
+auto destroy_render_done_semaphores(
+    VkDevice p_device, const std::vector<VkSemaphore>& p_semaphores
+) noexcept -> void;
+
+} // namespace vulkan_scene
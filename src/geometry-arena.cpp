@@ -0,0 +1,214 @@
+#include <cstring>
+
+#include "common.hpp"
+
+#include "geometry-arena.hpp"
+
+namespace vulkan_scene
+{
+
+auto create_geometry_arena(
+    memory_allocator_t& p_allocator,
+    VkDevice p_device,
+    upload_queue_t& p_upload_queue,
+    uint32_t p_vertex_size,
+    VkIndexType p_index_type,
+    uint32_t p_vertex_capacity,
+    uint32_t p_index_capacity
+) noexcept -> kirho::result_t<geometry_arena_t, VkResult>
+{
+    using result_t = kirho::result_t<geometry_arena_t, VkResult>;
+
+    VkResult error;
+
+    const auto vertex_buffer_result = create_buffer(
+        p_allocator, p_device, p_upload_queue, buffer_type_t::VERTEX, nullptr,
+        static_cast<VkDeviceSize>(p_vertex_capacity) * p_vertex_size
+    );
+    if (vertex_buffer_result.is_error(error))
+    {
+        return result_t::error(error);
+    }
+
+    const auto vertex_buffer = vertex_buffer_result.unwrap();
+
+    const auto index_buffer_result = create_index_buffer(
+        p_allocator, p_device, p_upload_queue, p_index_type, nullptr,
+        p_index_capacity
+    );
+    if (index_buffer_result.is_error(error))
+    {
+        destroy_buffer(p_device, p_allocator, vertex_buffer);
+        return result_t::error(error);
+    }
+
+    return result_t::success(geometry_arena_t{
+        .vertex_buffer = vertex_buffer,
+        .index_buffer = index_buffer_result.unwrap(),
+        .vertex_size = p_vertex_size,
+        .vertex_allocator =
+            sub_allocator_t{
+                p_vertex_capacity, allocation_strategy_t::FREE_LIST
+            },
+        .index_allocator =
+            sub_allocator_t{p_index_capacity, allocation_strategy_t::FREE_LIST},
+    });
+}
+
+auto add_geometry(
+    geometry_arena_t& p_arena,
+    upload_queue_t& p_upload_queue,
+    const void* p_vertices,
+    uint32_t p_vertex_count,
+    VkIndexType p_index_type,
+    const void* p_indices,
+    uint32_t p_index_count,
+    std::span<const submesh_t> p_submeshes
+) noexcept -> kirho::result_t<geometry_t, VkResult>
+{
+    using result_t = kirho::result_t<geometry_t, VkResult>;
+
+    const auto arena_index_type = p_arena.index_buffer.index_type;
+    if (p_index_type != arena_index_type &&
+        p_index_type != VK_INDEX_TYPE_UINT16)
+    {
+        print_error(
+            "32-bit indices don't fit into a geometry arena with 16-bit ones."
+        );
+        return result_t::error(VK_ERROR_FORMAT_NOT_SUPPORTED);
+    }
+
+    kirho::empty_t allocation_error;
+
+    const auto first_vertex_result = p_arena.vertex_allocator.allocate(
+        p_vertex_count, 1, resource_kind_t::LINEAR
+    );
+    if (first_vertex_result.is_error(allocation_error))
+    {
+        print_error(
+            "The geometry arena has no room for ", p_vertex_count, " vertices."
+        );
+        return result_t::error(VK_ERROR_OUT_OF_DEVICE_MEMORY);
+    }
+
+    const auto first_vertex =
+        static_cast<uint32_t>(first_vertex_result.unwrap());
+
+    const auto first_index_result = p_arena.index_allocator.allocate(
+        p_index_count, 1, resource_kind_t::LINEAR
+    );
+    if (first_index_result.is_error(allocation_error))
+    {
+        p_arena.vertex_allocator.free(first_vertex);
+
+        print_error(
+            "The geometry arena has no room for ", p_index_count, " indices."
+        );
+        return result_t::error(VK_ERROR_OUT_OF_DEVICE_MEMORY);
+    }
+
+    const auto first_index = static_cast<uint32_t>(first_index_result.unwrap());
+
+    geometry_t geometry{
+        .first_vertex = first_vertex,
+        .vertex_count = p_vertex_count,
+        .first_index = first_index,
+        .index_count = p_index_count,
+        .submeshes = {},
+    };
+
+    // The indices stay relative to their submesh's vertex offset, so only the
+    // offsets have to move.
+    geometry.submeshes.reserve(p_submeshes.size());
+    for (const auto& submesh : p_submeshes)
+    {
+        geometry.submeshes.push_back(submesh_t{
+            .first_index = submesh.first_index + first_index,
+            .index_count = submesh.index_count,
+            .vertex_offset =
+                submesh.vertex_offset + static_cast<int32_t>(first_vertex),
+        });
+    }
+
+    std::vector<uint32_t> widened_indices;
+    if (p_index_type != arena_index_type)
+    {
+        widened_indices.resize(p_index_count);
+        for (uint32_t i = 0; i < p_index_count; i++)
+        {
+            uint16_t index;
+            std::memcpy(
+                &index,
+                static_cast<const uint8_t*>(p_indices) + i * sizeof(index),
+                sizeof(index)
+            );
+            widened_indices[i] = index;
+        }
+
+        p_indices = widened_indices.data();
+    }
+
+    const auto index_size = get_index_size(arena_index_type);
+
+    VkResult error;
+
+    const auto vertex_upload_result = upload_buffer(
+        p_upload_queue, p_arena.vertex_buffer,
+        static_cast<VkDeviceSize>(first_vertex) * p_arena.vertex_size,
+        p_vertices,
+        static_cast<VkDeviceSize>(p_vertex_count) * p_arena.vertex_size
+    );
+    if (vertex_upload_result.is_error(error))
+    {
+        remove_geometry(p_arena, geometry);
+        return result_t::error(error);
+    }
+
+    const auto index_upload_result = upload_buffer(
+        p_upload_queue, p_arena.index_buffer,
+        static_cast<VkDeviceSize>(first_index) * index_size, p_indices,
+        static_cast<VkDeviceSize>(p_index_count) * index_size
+    );
+    if (index_upload_result.is_error(error))
+    {
+        remove_geometry(p_arena, geometry);
+        return result_t::error(error);
+    }
+
+    return result_t::success(geometry);
+}
+
+auto remove_geometry(
+    geometry_arena_t& p_arena, const geometry_t& p_geometry
+) noexcept -> void
+{
+    p_arena.vertex_allocator.free(p_geometry.first_vertex);
+    p_arena.index_allocator.free(p_geometry.first_index);
+}
+
+auto bind_geometry_arena(
+    VkCommandBuffer p_command_buffer, const geometry_arena_t& p_arena
+) noexcept -> void
+{
+    const VkDeviceSize offset = 0;
+    vkCmdBindVertexBuffers(
+        p_command_buffer, 0, 1, &p_arena.vertex_buffer.buffer, &offset
+    );
+
+    vkCmdBindIndexBuffer(
+        p_command_buffer, p_arena.index_buffer.buffer, 0,
+        p_arena.index_buffer.index_type
+    );
+}
+
+auto destroy_geometry_arena(
+    VkDevice p_device,
+    memory_allocator_t& p_allocator,
+    const geometry_arena_t& p_arena
+) noexcept -> void
+{
+    destroy_buffer(p_device, p_allocator, p_arena.index_buffer);
+    destroy_buffer(p_device, p_allocator, p_arena.vertex_buffer);
+}
+
+} // namespace vulkan_scene
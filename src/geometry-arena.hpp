@@ -0,0 +1,87 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include "graphics.hpp"
+#include "mesh.hpp"
+#include "sub-allocator.hpp"
+#include "upload-queue.hpp"
+
+namespace vulkan_scene
+{
+
+constexpr uint32_t DEFAULT_GEOMETRY_ARENA_VERTEX_CAPACITY = 1024 * 1024;
+constexpr uint32_t DEFAULT_GEOMETRY_ARENA_INDEX_CAPACITY = 4 * 1024 * 1024;
+
+// A mesh's place in a geometry arena.
+struct geometry_t
+{
+    // In vertices and indices, which is what the sub-allocators count in.
+    uint32_t first_vertex;
+    uint32_t vertex_count;
+    uint32_t first_index;
+    uint32_t index_count;
+
+    // The submeshes of the mesh, moved to where it ended up, so that they can
+    // go straight into draws with the arena's buffers bound.
+    std::vector<submesh_t> submeshes;
+};
+
+// One vertex buffer and one index buffer that every mesh gets sub-allocated
+// from, so that drawing any number of meshes only binds them once. All of the
+// vertices have the same format, and all of the indices the same type.
+struct geometry_arena_t
+{
+    buffer_t vertex_buffer;
+    buffer_t index_buffer;
+    uint32_t vertex_size;
+
+    // Free lists that count in vertices and indices instead of bytes.
+    sub_allocator_t vertex_allocator;
+    sub_allocator_t index_allocator;
+};
+
+auto create_geometry_arena(
+    memory_allocator_t& p_allocator,
+    VkDevice p_device,
+    upload_queue_t& p_upload_queue,
+    uint32_t p_vertex_size,
+    VkIndexType p_index_type,
+    uint32_t p_vertex_capacity = DEFAULT_GEOMETRY_ARENA_VERTEX_CAPACITY,
+    uint32_t p_index_capacity = DEFAULT_GEOMETRY_ARENA_INDEX_CAPACITY
+) noexcept -> kirho::result_t<geometry_arena_t, VkResult>;
+
+// Finds room for the mesh and uploads it, which only arrives once the upload
+// queue has been flushed. 16-bit indices get widened if the arena has 32-bit
+// ones, but not the other way around. Fails without touching the arena if
+// there isn't enough room left.
+auto add_geometry(
+    geometry_arena_t& p_arena,
+    upload_queue_t& p_upload_queue,
+    const void* p_vertices,
+    uint32_t p_vertex_count,
+    VkIndexType p_index_type,
+    const void* p_indices,
+    uint32_t p_index_count,
+    std::span<const submesh_t> p_submeshes
+) noexcept -> kirho::result_t<geometry_t, VkResult>;
+
+// The space gets reused by the next add_geometry, so the frames that draw the
+// mesh have to be done first.
+auto remove_geometry(
+    geometry_arena_t& p_arena, const geometry_t& p_geometry
+) noexcept -> void;
+
+// Binds the vertex buffer to binding 0 and the index buffer. Other vertex
+// bindings are left alone.
+auto bind_geometry_arena(
+    VkCommandBuffer p_command_buffer, const geometry_arena_t& p_arena
+) noexcept -> void;
+
+auto destroy_geometry_arena(
+    VkDevice p_device,
+    memory_allocator_t& p_allocator,
+    const geometry_arena_t& p_arena
+) noexcept -> void;
+
+} // namespace vulkan_scene
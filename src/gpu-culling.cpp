@@ -0,0 +1,420 @@
+#include <cstddef>
+
+#include "common.hpp"
+
+#include "gpu-culling.hpp"
+
+namespace vulkan_scene
+{
+
+namespace
+{
+
+struct culling_push_constants_t
+{
+    glm::mat4 model_view_projection;
+    uint32_t object_count;
+};
+
+constexpr std::array CULLING_BINDINGS{
+    // The bounding spheres.
+    VkDescriptorSetLayoutBinding{
+        .binding = 0,
+        .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+        .descriptorCount = 1,
+        .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+        .pImmutableSamplers = nullptr,
+    },
+    // The visible instances.
+    VkDescriptorSetLayoutBinding{
+        .binding = 1,
+        .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+        .descriptorCount = 1,
+        .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+        .pImmutableSamplers = nullptr,
+    },
+    // The draw command.
+    VkDescriptorSetLayoutBinding{
+        .binding = 2,
+        .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+        .descriptorCount = 1,
+        .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+        .pImmutableSamplers = nullptr,
+    },
+};
+
+auto create_culling_descriptors(
+    VkDevice p_device, gpu_culling_t& p_culling
+) noexcept -> VkResult
+{
+    const VkDescriptorSetLayoutCreateInfo set_layout_info{
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+        .pNext = nullptr,
+        .flags = 0,
+        .bindingCount = static_cast<uint32_t>(CULLING_BINDINGS.size()),
+        .pBindings = CULLING_BINDINGS.data(),
+    };
+
+    auto result = vkCreateDescriptorSetLayout(
+        p_device, &set_layout_info, nullptr, &p_culling.descriptor_set_layout
+    );
+    if (result != VK_SUCCESS)
+    {
+        print_error(
+            "Failed to create a descriptor set layout. Vulkan error ", result,
+            '.'
+        );
+        return result;
+    }
+
+    const auto set_count = static_cast<uint32_t>(p_culling.frames.size());
+
+    const VkDescriptorPoolSize pool_size{
+        .type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+        .descriptorCount =
+            static_cast<uint32_t>(CULLING_BINDINGS.size()) * set_count,
+    };
+
+    const VkDescriptorPoolCreateInfo pool_info{
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+        .pNext = nullptr,
+        .flags = 0,
+        .maxSets = set_count,
+        .poolSizeCount = 1,
+        .pPoolSizes = &pool_size,
+    };
+
+    result = vkCreateDescriptorPool(
+        p_device, &pool_info, nullptr, &p_culling.descriptor_pool
+    );
+    if (result != VK_SUCCESS)
+    {
+        print_error(
+            "Failed to create a descriptor pool. Vulkan error ", result, '.'
+        );
+        return result;
+    }
+
+    for (auto& frame : p_culling.frames)
+    {
+        const VkDescriptorSetAllocateInfo set_info{
+            .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+            .pNext = nullptr,
+            .descriptorPool = p_culling.descriptor_pool,
+            .descriptorSetCount = 1,
+            .pSetLayouts = &p_culling.descriptor_set_layout,
+        };
+
+        result = vkAllocateDescriptorSets(
+            p_device, &set_info, &frame.descriptor_set
+        );
+        if (result != VK_SUCCESS)
+        {
+            print_error(
+                "Failed to allocate a descriptor set. Vulkan error ", result
+            );
+            return result;
+        }
+
+        const std::array buffer_infos{
+            VkDescriptorBufferInfo{
+                .buffer = p_culling.bounding_spheres.buffer,
+                .offset = 0,
+                .range = VK_WHOLE_SIZE,
+            },
+            VkDescriptorBufferInfo{
+                .buffer = frame.instances.buffer,
+                .offset = 0,
+                .range = VK_WHOLE_SIZE,
+            },
+            VkDescriptorBufferInfo{
+                .buffer = frame.draw_commands.buffer,
+                .offset = 0,
+                .range = VK_WHOLE_SIZE,
+            },
+        };
+
+        std::array<VkWriteDescriptorSet, CULLING_BINDINGS.size()> set_writes;
+        for (uint32_t i = 0; i < set_writes.size(); i++)
+        {
+            set_writes[i] = VkWriteDescriptorSet{
+                .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+                .pNext = nullptr,
+                .dstSet = frame.descriptor_set,
+                .dstBinding = i,
+                .dstArrayElement = 0,
+                .descriptorCount = 1,
+                .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                .pImageInfo = nullptr,
+                .pBufferInfo = &buffer_infos[i],
+                .pTexelBufferView = nullptr,
+            };
+        }
+
+        vkUpdateDescriptorSets(
+            p_device, static_cast<uint32_t>(set_writes.size()),
+            set_writes.data(), 0, nullptr
+        );
+    }
+
+    return VK_SUCCESS;
+}
+
+} // namespace
+
+auto create_gpu_culling(
+    memory_allocator_t& p_allocator,
+    VkDevice p_device,
+    upload_queue_t& p_upload_queue,
+    VkShaderModule p_compute_shader,
+    VkPipelineCache p_cache,
+    std::span<const scene_object_t> p_objects,
+    std::span<const submesh_t> p_submeshes,
+    uint32_t p_frame_count
+) noexcept -> kirho::result_t<gpu_culling_t, VkResult>
+{
+    using result_t = kirho::result_t<gpu_culling_t, VkResult>;
+
+    gpu_culling_t culling{
+        .descriptor_set_layout = VK_NULL_HANDLE,
+        .descriptor_pool = VK_NULL_HANDLE,
+        .pipeline_layout = VK_NULL_HANDLE,
+        .pipeline = VK_NULL_HANDLE,
+        .bounding_spheres = {},
+        .object_count = static_cast<uint32_t>(p_objects.size()),
+        .draw_commands = {},
+        .frames = {},
+    };
+
+    culling.draw_commands.reserve(p_submeshes.size());
+    for (const auto& submesh : p_submeshes)
+    {
+        culling.draw_commands.push_back(VkDrawIndexedIndirectCommand{
+            .indexCount = submesh.index_count,
+            .instanceCount = 0,
+            .firstIndex = submesh.first_index,
+            .vertexOffset = submesh.vertex_offset,
+            .firstInstance = 0,
+        });
+    }
+
+    std::vector<glm::vec4> bounding_spheres;
+    bounding_spheres.reserve(p_objects.size());
+    for (const auto& object : p_objects)
+    {
+        bounding_spheres.emplace_back(
+            object.position, OBJECT_BOUNDING_RADIUS
+        );
+    }
+
+    // Whatever got created before a failure is leaked, the same as everywhere
+    // else during startup.
+    VkResult error;
+    const auto spheres_result = create_buffer(
+        p_allocator, p_device, p_upload_queue, buffer_type_t::STORAGE,
+        bounding_spheres.data(), bounding_spheres.size() * sizeof(glm::vec4)
+    );
+    if (spheres_result.is_error(error))
+    {
+        return result_t::error(error);
+    }
+    culling.bounding_spheres = spheres_result.unwrap();
+
+    culling.frames.reserve(p_frame_count);
+    for (uint32_t i = 0; i < p_frame_count; i++)
+    {
+        const auto instances_result = create_buffer(
+            p_allocator, p_device, p_upload_queue, buffer_type_t::STORAGE,
+            nullptr, p_objects.size() * sizeof(instance_t)
+        );
+        if (instances_result.is_error(error))
+        {
+            return result_t::error(error);
+        }
+
+        const auto draw_commands_result = create_buffer(
+            p_allocator, p_device, p_upload_queue, buffer_type_t::INDIRECT,
+            nullptr, p_submeshes.size() * sizeof(VkDrawIndexedIndirectCommand)
+        );
+        if (draw_commands_result.is_error(error))
+        {
+            return result_t::error(error);
+        }
+
+        culling.frames.push_back(gpu_culling_frame_t{
+            .instances = instances_result.unwrap(),
+            .draw_commands = draw_commands_result.unwrap(),
+            .descriptor_set = VK_NULL_HANDLE,
+        });
+    }
+
+    error = create_culling_descriptors(p_device, culling);
+    if (error != VK_SUCCESS)
+    {
+        return result_t::error(error);
+    }
+
+    const VkPushConstantRange push_constant_range{
+        .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+        .offset = 0,
+        .size = sizeof(culling_push_constants_t),
+    };
+
+    const auto layout_result = create_pipeline_layout(
+        p_device, std::array{culling.descriptor_set_layout},
+        std::array{push_constant_range}
+    );
+    if (layout_result.is_error(error))
+    {
+        return result_t::error(error);
+    }
+    culling.pipeline_layout = layout_result.unwrap();
+
+    const auto pipeline_result = create_compute_pipeline(
+        p_device, culling.pipeline_layout, p_compute_shader, p_cache
+    );
+    if (pipeline_result.is_error(error))
+    {
+        return result_t::error(error);
+    }
+    culling.pipeline = pipeline_result.unwrap();
+
+    return result_t::success(culling);
+}
+
+auto record_gpu_culling(
+    VkCommandBuffer p_command_buffer,
+    const gpu_culling_t& p_culling,
+    uint32_t p_frame_index,
+    const glm::mat4& p_model_view_projection
+) noexcept -> void
+{
+    const auto& frame = p_culling.frames[p_frame_index];
+
+    // The shader counts the visible objects up from zero, in the first
+    // command.
+    vkCmdUpdateBuffer(
+        p_command_buffer, frame.draw_commands.buffer, 0,
+        p_culling.draw_commands.size() * sizeof(VkDrawIndexedIndirectCommand),
+        p_culling.draw_commands.data()
+    );
+
+    const VkMemoryBarrier reset_barrier{
+        .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+        .pNext = nullptr,
+        .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+        .dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+    };
+
+    vkCmdPipelineBarrier(
+        p_command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &reset_barrier, 0, nullptr,
+        0, nullptr
+    );
+
+    vkCmdBindPipeline(
+        p_command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, p_culling.pipeline
+    );
+    vkCmdBindDescriptorSets(
+        p_command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE,
+        p_culling.pipeline_layout, 0, 1, &frame.descriptor_set, 0, nullptr
+    );
+
+    const culling_push_constants_t push_constants{
+        .model_view_projection = p_model_view_projection,
+        .object_count = p_culling.object_count,
+    };
+
+    vkCmdPushConstants(
+        p_command_buffer, p_culling.pipeline_layout,
+        VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(push_constants), &push_constants
+    );
+
+    vkCmdDispatch(
+        p_command_buffer,
+        (p_culling.object_count + GPU_CULLING_GROUP_SIZE - 1) /
+            GPU_CULLING_GROUP_SIZE,
+        1, 1
+    );
+
+    VkPipelineStageFlags source_stages = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+    VkAccessFlags source_access = VK_ACCESS_SHADER_WRITE_BIT;
+
+    // The other submeshes get drawn just as many times as the first.
+    if (p_culling.draw_commands.size() > 1)
+    {
+        const VkMemoryBarrier count_barrier{
+            .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+            .pNext = nullptr,
+            .srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT,
+            .dstAccessMask =
+                VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT,
+        };
+
+        vkCmdPipelineBarrier(
+            p_command_buffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+            VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 1, &count_barrier, 0, nullptr,
+            0, nullptr
+        );
+
+        constexpr auto instance_count_offset =
+            offsetof(VkDrawIndexedIndirectCommand, instanceCount);
+
+        for (size_t i = 1; i < p_culling.draw_commands.size(); i++)
+        {
+            const VkBufferCopy region{
+                .srcOffset = instance_count_offset,
+                .dstOffset = i * sizeof(VkDrawIndexedIndirectCommand) +
+                             instance_count_offset,
+                .size = sizeof(uint32_t),
+            };
+
+            vkCmdCopyBuffer(
+                p_command_buffer, frame.draw_commands.buffer,
+                frame.draw_commands.buffer, 1, &region
+            );
+        }
+
+        source_stages |= VK_PIPELINE_STAGE_TRANSFER_BIT;
+        source_access |= VK_ACCESS_TRANSFER_WRITE_BIT;
+    }
+
+    const VkMemoryBarrier cull_barrier{
+        .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+        .pNext = nullptr,
+        .srcAccessMask = source_access,
+        .dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT |
+                         VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT,
+    };
+
+    vkCmdPipelineBarrier(
+        p_command_buffer, source_stages,
+        VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT |
+            VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+        0, 1, &cull_barrier, 0, nullptr, 0, nullptr
+    );
+}
+
+auto destroy_gpu_culling(
+    VkDevice p_device,
+    memory_allocator_t& p_allocator,
+    const gpu_culling_t& p_culling
+) noexcept -> void
+{
+    vkDestroyPipeline(p_device, p_culling.pipeline, nullptr);
+    vkDestroyPipelineLayout(p_device, p_culling.pipeline_layout, nullptr);
+    vkDestroyDescriptorPool(p_device, p_culling.descriptor_pool, nullptr);
+    vkDestroyDescriptorSetLayout(
+        p_device, p_culling.descriptor_set_layout, nullptr
+    );
+
+    for (const auto& frame : p_culling.frames)
+    {
+        destroy_buffer(p_device, p_allocator, frame.draw_commands);
+        destroy_buffer(p_device, p_allocator, frame.instances);
+    }
+
+    destroy_buffer(p_device, p_allocator, p_culling.bounding_spheres);
+}
+
+} // namespace vulkan_scene
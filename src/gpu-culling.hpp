@@ -0,0 +1,82 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <glm/glm.hpp>
+
+#include "graphics.hpp"
+#include "mesh.hpp"
+#include "scene.hpp"
+
+namespace vulkan_scene
+{
+
+// Threads per workgroup of shaders/cull.comp.
+constexpr uint32_t GPU_CULLING_GROUP_SIZE = 64;
+
+// Radius of a sphere around the unit cube, which is what every object is.
+constexpr float OBJECT_BOUNDING_RADIUS = 0.8660254f;
+
+// What the culling shader writes for one frame in flight. The draw command is
+// rewritten before every dispatch, so the frames never share one.
+struct gpu_culling_frame_t
+{
+    // One instance_t per visible object, packed at the front.
+    buffer_t instances;
+
+    // A VkDrawIndexedIndirectCommand per submesh, each with the number of
+    // visible objects as its instance count.
+    buffer_t draw_commands;
+
+    VkDescriptorSet descriptor_set;
+};
+
+// Frustum-culls every object of a scene in a compute shader and turns the
+// survivors into an indirect draw, so that the CPU does the same amount of
+// work no matter how many objects there are.
+struct gpu_culling_t
+{
+    VkDescriptorSetLayout descriptor_set_layout;
+    VkDescriptorPool descriptor_pool;
+    VkPipelineLayout pipeline_layout;
+    VkPipeline pipeline;
+
+    // The bounding sphere of every object, as a center and a radius.
+    buffer_t bounding_spheres;
+    uint32_t object_count;
+
+    // What the draw commands get reset to before every dispatch.
+    std::vector<VkDrawIndexedIndirectCommand> draw_commands;
+
+    std::vector<gpu_culling_frame_t> frames;
+};
+
+// The bounding spheres only arrive once the upload queue has been flushed.
+auto create_gpu_culling(
+    memory_allocator_t& p_allocator,
+    VkDevice p_device,
+    upload_queue_t& p_upload_queue,
+    VkShaderModule p_compute_shader,
+    VkPipelineCache p_cache,
+    std::span<const scene_object_t> p_objects,
+    std::span<const submesh_t> p_submeshes,
+    uint32_t p_frame_count
+) noexcept -> kirho::result_t<gpu_culling_t, VkResult>;
+
+// Must be recorded outside of a render pass, before the indirect draw of the
+// same frame. Objects outside of the frustum that p_model_view_projection
+// describes are left out.
+auto record_gpu_culling(
+    VkCommandBuffer p_command_buffer,
+    const gpu_culling_t& p_culling,
+    uint32_t p_frame_index,
+    const glm::mat4& p_model_view_projection
+) noexcept -> void;
+
+auto destroy_gpu_culling(
+    VkDevice p_device,
+    memory_allocator_t& p_allocator,
+    const gpu_culling_t& p_culling
+) noexcept -> void;
+
+} // namespace vulkan_scene
@@ -0,0 +1,254 @@
+#include "common.hpp"
+
+#include "gpu-profiler.hpp"
+
+namespace vulkan_scene
+{
+
+auto create_gpu_profiler(
+    VkPhysicalDevice p_physical_device,
+    VkDevice p_device,
+    uint32_t p_queue_family,
+    uint32_t p_frame_count,
+    uint32_t p_window
+) noexcept -> kirho::result_t<gpu_profiler_t, VkResult>
+{
+    using result_t = kirho::result_t<gpu_profiler_t, VkResult>;
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(p_physical_device, &properties);
+
+    uint32_t queue_family_count;
+    vkGetPhysicalDeviceQueueFamilyProperties(
+        p_physical_device, &queue_family_count, nullptr
+    );
+    std::vector<VkQueueFamilyProperties> queue_families(queue_family_count);
+    vkGetPhysicalDeviceQueueFamilyProperties(
+        p_physical_device, &queue_family_count, queue_families.data()
+    );
+
+    const auto valid_bits =
+        queue_families.at(p_queue_family).timestampValidBits;
+
+    gpu_profiler_t profiler{
+        .query_pools = {},
+        .timestamp_period = properties.limits.timestampPeriod,
+        .timestamp_mask = valid_bits >= 64
+                              ? std::numeric_limits<uint64_t>::max()
+                              : (static_cast<uint64_t>(1) << valid_bits) - 1,
+        .scopes = {},
+        .window = std::max(p_window, 1u),
+        .pending = {},
+    };
+
+    if (valid_bits == 0)
+    {
+        std::cout << "[INFO]: The graphics queue doesn't support timestamps, "
+                     "so GPU times won't be measured.\n";
+        return result_t::success(profiler);
+    }
+
+    const VkQueryPoolCreateInfo query_pool_info{
+        .sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+        .pNext = nullptr,
+        .flags = 0,
+        .queryType = VK_QUERY_TYPE_TIMESTAMP,
+        .queryCount = MAX_GPU_SCOPES * 2,
+        .pipelineStatistics = 0,
+    };
+
+    for (uint32_t i = 0; i < p_frame_count; i++)
+    {
+        VkQueryPool query_pool;
+        const auto result = vkCreateQueryPool(
+            p_device, &query_pool_info, nullptr, &query_pool
+        );
+        if (result != VK_SUCCESS)
+        {
+            print_error(
+                "Failed to create a timestamp query pool. Vulkan error ",
+                result, '.'
+            );
+            destroy_gpu_profiler(p_device, profiler);
+            return result_t::error(result);
+        }
+
+        profiler.query_pools.push_back(query_pool);
+    }
+
+    profiler.pending.resize(p_frame_count);
+
+    return result_t::success(profiler);
+}
+
+auto add_gpu_scope(gpu_profiler_t& p_profiler, std::string_view p_name)
+    -> kirho::result_t<uint32_t, kirho::empty_t>
+{
+    using result_t = kirho::result_t<uint32_t, kirho::empty_t>;
+
+    // Every scope has two queries in each pool, and a pending flag per frame.
+    if (p_profiler.scopes.size() == MAX_GPU_SCOPES)
+    {
+        print_error(
+            "Can't add the GPU scope ", p_name, ". The profiler already has ",
+            MAX_GPU_SCOPES, " scopes."
+        );
+        return result_t::error(kirho::empty_t{});
+    }
+
+    p_profiler.scopes.push_back(gpu_scope_t{
+        .name = std::string{p_name},
+        .samples = {},
+        .next_sample = 0,
+    });
+
+    return result_t::success(
+        static_cast<uint32_t>(p_profiler.scopes.size() - 1)
+    );
+}
+
+auto begin_gpu_frame(
+    VkCommandBuffer p_command_buffer,
+    gpu_profiler_t& p_profiler,
+    uint32_t p_frame_index
+) noexcept -> void
+{
+    if (p_profiler.query_pools.empty())
+    {
+        return;
+    }
+
+    vkCmdResetQueryPool(
+        p_command_buffer, p_profiler.query_pools[p_frame_index], 0,
+        MAX_GPU_SCOPES * 2
+    );
+
+    p_profiler.pending[p_frame_index].fill(false);
+}
+
+auto begin_gpu_scope(
+    VkCommandBuffer p_command_buffer,
+    const gpu_profiler_t& p_profiler,
+    uint32_t p_frame_index,
+    uint32_t p_scope
+) noexcept -> void
+{
+    if (p_profiler.query_pools.empty())
+    {
+        return;
+    }
+
+    vkCmdWriteTimestamp(
+        p_command_buffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+        p_profiler.query_pools[p_frame_index], p_scope * 2
+    );
+}
+
+auto end_gpu_scope(
+    VkCommandBuffer p_command_buffer,
+    gpu_profiler_t& p_profiler,
+    uint32_t p_frame_index,
+    uint32_t p_scope
+) noexcept -> void
+{
+    if (p_profiler.query_pools.empty())
+    {
+        return;
+    }
+
+    // Only written once everything before it has completely finished.
+    vkCmdWriteTimestamp(
+        p_command_buffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+        p_profiler.query_pools[p_frame_index], p_scope * 2 + 1
+    );
+
+    p_profiler.pending[p_frame_index][p_scope] = true;
+}
+
+auto collect_gpu_timings(
+    VkDevice p_device, gpu_profiler_t& p_profiler, uint32_t p_frame_index
+) -> void
+{
+    if (p_profiler.query_pools.empty())
+    {
+        return;
+    }
+
+    auto& pending = p_profiler.pending[p_frame_index];
+
+    for (uint32_t i = 0; i < p_profiler.scopes.size(); i++)
+    {
+        if (!pending[i])
+        {
+            continue;
+        }
+
+        pending[i] = false;
+
+        std::array<uint64_t, 2> timestamps;
+        const auto result = vkGetQueryPoolResults(
+            p_device, p_profiler.query_pools[p_frame_index], i * 2, 2,
+            sizeof(timestamps), timestamps.data(), sizeof(uint64_t),
+            VK_QUERY_RESULT_64_BIT
+        );
+
+        // The frame's fence has been signaled, so this shouldn't happen. The
+        // frame just doesn't count if it does.
+        if (result != VK_SUCCESS)
+        {
+            continue;
+        }
+
+        const auto ticks =
+            (timestamps[1] - timestamps[0]) & p_profiler.timestamp_mask;
+        const auto milliseconds =
+            static_cast<double>(ticks) * p_profiler.timestamp_period / 1e6;
+
+        auto& scope = p_profiler.scopes[i];
+        if (scope.samples.size() < p_profiler.window)
+        {
+            scope.samples.push_back(milliseconds);
+        }
+        else
+        {
+            scope.samples[scope.next_sample] = milliseconds;
+        }
+
+        scope.next_sample = (scope.next_sample + 1) % p_profiler.window;
+    }
+}
+
+auto get_gpu_scope_stats(const gpu_profiler_t& p_profiler, uint32_t p_scope)
+    -> sample_stats_t
+{
+    return get_sample_stats(p_profiler.scopes.at(p_scope).samples);
+}
+
+auto print_gpu_timings(const gpu_profiler_t& p_profiler) -> void
+{
+    for (uint32_t i = 0; i < p_profiler.scopes.size(); i++)
+    {
+        const auto stats = get_gpu_scope_stats(p_profiler, i);
+        if (stats.count == 0)
+        {
+            continue;
+        }
+
+        std::cout << "[INFO]: GPU time of " << p_profiler.scopes[i].name
+                  << " (min/avg/p99 of the last " << stats.count
+                  << " frames): " << stats.min << '/' << stats.mean << '/'
+                  << stats.p99 << " ms.\n";
+    }
+}
+
+auto destroy_gpu_profiler(
+    VkDevice p_device, const gpu_profiler_t& p_profiler
+) noexcept -> void
+{
+    for (const auto query_pool : p_profiler.query_pools)
+    {
+        vkDestroyQueryPool(p_device, query_pool, nullptr);
+    }
+}
+
+} // namespace vulkan_scene
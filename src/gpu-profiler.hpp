@@ -0,0 +1,103 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+#include <vulkan/vulkan.h>
+
+#include "statistics.hpp"
+
+namespace vulkan_scene
+{
+
+// How many scopes a frame can have. Each one takes two timestamp queries.
+constexpr uint32_t MAX_GPU_SCOPES = 16;
+
+// How many of the most recent samples of each scope the statistics cover by
+// default.
+constexpr uint32_t GPU_PROFILER_WINDOW = 256;
+
+struct gpu_scope_t
+{
+    std::string name;
+
+    // Durations in milliseconds. Once the window is full, the oldest sample
+    // gets overwritten.
+    std::vector<double> samples;
+    size_t next_sample;
+};
+
+// Measures how long sections of a frame take on the GPU, using timestamps
+// written at the start and the end of each scope. Every frame in flight has
+// its own query pool, so the results of a frame are read once its fence has
+// been waited on and never stall the CPU.
+struct gpu_profiler_t
+{
+    // Empty if the graphics queue doesn't support timestamps, in which case
+    // all of the functions below do nothing.
+    std::vector<VkQueryPool> query_pools;
+
+    // Nanoseconds per timestamp tick.
+    double timestamp_period;
+    uint64_t timestamp_mask;
+
+    std::vector<gpu_scope_t> scopes;
+    uint32_t window;
+
+    // Which scopes have been ended in each frame, but not read yet.
+    std::vector<std::array<bool, MAX_GPU_SCOPES>> pending;
+};
+
+auto create_gpu_profiler(
+    VkPhysicalDevice p_physical_device,
+    VkDevice p_device,
+    uint32_t p_queue_family,
+    uint32_t p_frame_count,
+    uint32_t p_window = GPU_PROFILER_WINDOW
+) noexcept -> kirho::result_t<gpu_profiler_t, VkResult>;
+
+// Scopes have to be added before the first frame, and there can be at most
+// MAX_GPU_SCOPES of them. Returns the index to pass to begin_gpu_scope and
+// end_gpu_scope, or fails once the profiler is full.
+auto add_gpu_scope(gpu_profiler_t& p_profiler, std::string_view p_name)
+    -> kirho::result_t<uint32_t, kirho::empty_t>;
+
+// Resets the queries of the frame. Must be recorded outside of a render pass,
+// before any of the scopes.
+auto begin_gpu_frame(
+    VkCommandBuffer p_command_buffer,
+    gpu_profiler_t& p_profiler,
+    uint32_t p_frame_index
+) noexcept -> void;
+
+auto begin_gpu_scope(
+    VkCommandBuffer p_command_buffer,
+    const gpu_profiler_t& p_profiler,
+    uint32_t p_frame_index,
+    uint32_t p_scope
+) noexcept -> void;
+
+auto end_gpu_scope(
+    VkCommandBuffer p_command_buffer,
+    gpu_profiler_t& p_profiler,
+    uint32_t p_frame_index,
+    uint32_t p_scope
+) noexcept -> void;
+
+// Reads back the timings of the given frame. Only call this once the fence of
+// that frame has been waited on.
+auto collect_gpu_timings(
+    VkDevice p_device, gpu_profiler_t& p_profiler, uint32_t p_frame_index
+) -> void;
+
+// Statistics of the scope over the last frames in the window, in milliseconds.
+auto get_gpu_scope_stats(const gpu_profiler_t& p_profiler, uint32_t p_scope)
+    -> sample_stats_t;
+
+auto print_gpu_timings(const gpu_profiler_t& p_profiler) -> void;
+
+auto destroy_gpu_profiler(
+    VkDevice p_device, const gpu_profiler_t& p_profiler
+) noexcept -> void;
+
+} // namespace vulkan_scene
@@ -4,13 +4,14 @@
 #include <exception>
 #include <fstream>
 
-#include <stb_image.h>
 #include <vulkan/vulkan_core.h>
 
 #include "common.hpp"
 #include "device.hpp"
 
+#include "asset-loader.hpp"
 #include "graphics.hpp"
+#include "upload-queue.hpp"
 
 namespace
 {
@@ -18,120 +19,14 @@ namespace
 using vulkan_scene::buffer_t;
 using vulkan_scene::print_error;
 
-class temporary_command_buffer_t
-{
-  public:
-    temporary_command_buffer_t(
-        VkDevice device, VkQueue queue, VkCommandPool pool
-    )
-        : m_device(device), m_queue(queue), m_pool(pool),
-          m_buffer(vulkan_scene::create_command_buffer(device, pool).unwrap())
-    {
-        const VkCommandBufferBeginInfo begin_info{
-            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
-            .pNext = nullptr,
-            .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
-            .pInheritanceInfo = nullptr,
-        };
-
-        const auto result = vkBeginCommandBuffer(m_buffer, &begin_info);
-        if (result != VK_SUCCESS)
-        {
-            print_error(
-                "Failed to begin a single use command buffer. Vulkan error ",
-                result
-            );
-        }
-    }
-
-    temporary_command_buffer_t(const temporary_command_buffer_t&) = delete;
-    temporary_command_buffer_t& operator=(const temporary_command_buffer_t&) =
-        delete;
-
-    operator VkCommandBuffer()
-    {
-        return m_buffer;
-    }
-
-    ~temporary_command_buffer_t()
-    {
-        auto result = vkEndCommandBuffer(m_buffer);
-        if (result != VK_SUCCESS)
-        {
-            print_error(
-                "Failed to end a single use command buffer. Vulkan error ",
-                result
-            );
-            return;
-        }
-
-        const VkSubmitInfo submit_info{
-            .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
-            .pNext = nullptr,
-            .waitSemaphoreCount = 0,
-            .pWaitSemaphores = nullptr,
-            .pWaitDstStageMask = nullptr,
-            .commandBufferCount = 1,
-            .pCommandBuffers = &m_buffer,
-            .signalSemaphoreCount = 0,
-            .pSignalSemaphores = nullptr,
-        };
-
-        result = vkQueueSubmit(m_queue, 1, &submit_info, VK_NULL_HANDLE);
-        if (result != VK_SUCCESS)
-        {
-            print_error(
-                "Failed to submit a single use command buffer. Vulkan error ",
-                result
-            );
-            return;
-        }
-
-        vkQueueWaitIdle(m_queue);
-
-        vkFreeCommandBuffers(m_device, m_pool, 1, &m_buffer);
-    }
-
-  private:
-    VkDevice m_device;
-    VkQueue m_queue;
-    VkCommandPool m_pool;
-    VkCommandBuffer m_buffer;
-};
-
-auto find_buffer_memory_type(
-    VkPhysicalDevice p_device,
-    uint32_t p_type_filter,
-    VkMemoryPropertyFlags p_memory_properties
-) -> kirho::result_t<uint32_t, kirho::empty_t>
-{
-    using result_t = kirho::result_t<uint32_t, kirho::empty_t>;
-
-    VkPhysicalDeviceMemoryProperties memory_properties;
-    vkGetPhysicalDeviceMemoryProperties(p_device, &memory_properties);
-
-    for (uint32_t i = 0; i < memory_properties.memoryTypeCount; i++)
-    {
-        const auto follows_filter = (p_type_filter & (1 << i)) != 0;
-        const auto has_properties =
-            (memory_properties.memoryTypes[i].propertyFlags &
-             p_memory_properties) == p_memory_properties;
-
-        if (follows_filter && has_properties)
-        {
-            return result_t::success(i);
-        }
-    }
-
-    return result_t::error(kirho::empty_t{});
-}
-
 auto create_vulkan_buffer(
-    VkPhysicalDevice p_physical_device,
+    vulkan_scene::memory_allocator_t& p_allocator,
     VkDevice p_device,
     VkDeviceSize p_buffer_size,
     VkBufferUsageFlags p_usage,
-    VkMemoryPropertyFlags p_memory_properties
+    VkMemoryPropertyFlags p_memory_properties,
+    vulkan_scene::allocation_strategy_t p_strategy =
+        vulkan_scene::allocation_strategy_t::FREE_LIST
 ) noexcept -> kirho::result_t<buffer_t, VkResult>
 {
     using result_t = kirho::result_t<buffer_t, VkResult>;
@@ -162,106 +57,115 @@ auto create_vulkan_buffer(
         p_device, buffer.buffer, &memory_requirements
     );
 
-    const auto memory_type_result = find_buffer_memory_type(
-        p_physical_device, memory_requirements.memoryTypeBits,
-        p_memory_properties
+    const auto allocation_result = p_allocator.allocate(
+        memory_requirements, p_memory_properties,
+        vulkan_scene::resource_kind_t::LINEAR, p_strategy
     );
-    {
-        kirho::empty_t empty{};
-        if (memory_type_result.is_error(empty))
-        {
-            return result_t::error(VK_ERROR_UNKNOWN);
-        }
-    }
-    const auto memory_type = memory_type_result.unwrap();
 
-    const VkMemoryAllocateInfo alloc_info{
-        .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
-        .pNext = nullptr,
-        .allocationSize = memory_requirements.size,
-        .memoryTypeIndex = memory_type,
-    };
-
-    const auto result2 =
-        vkAllocateMemory(p_device, &alloc_info, nullptr, &buffer.memory);
-    if (result2 != VK_SUCCESS)
+    VkResult result2;
+    if (allocation_result.is_error(result2))
     {
         print_error(
             "Failed to allocate memory for a buffer. Vulkan error ", result2,
             '.'
         );
+        vkDestroyBuffer(p_device, buffer.buffer, nullptr);
         return result_t::error(result2);
     }
 
-    vkBindBufferMemory(p_device, buffer.buffer, buffer.memory, 0);
+    buffer.allocation = allocation_result.unwrap();
+
+    vkBindBufferMemory(
+        p_device, buffer.buffer, buffer.allocation.memory,
+        buffer.allocation.offset
+    );
 
     return result_t::success(buffer);
 }
 
-auto transition_image_layout(
+auto create_vulkan_image(
+    vulkan_scene::memory_allocator_t& p_allocator,
     VkDevice p_device,
-    VkQueue p_queue,
-    VkCommandPool p_pool,
-    VkImage p_image,
+    VkExtent2D p_extent,
     VkFormat p_format,
-    VkImageLayout p_old_layout,
-    VkImageLayout p_new_layout
-) -> kirho::result_t<kirho::empty_t, std::string_view>
+    VkImageUsageFlags p_usage,
+    uint32_t p_mip_levels = 1
+) noexcept -> kirho::result_t<vulkan_scene::image_t, VkResult>
 {
-    using result_t = kirho::result_t<kirho::empty_t, std::string_view>;
+    using result_t = kirho::result_t<vulkan_scene::image_t, VkResult>;
 
-    temporary_command_buffer_t command_buffer(p_device, p_queue, p_pool);
-
-    VkImageMemoryBarrier barrier{
-        .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+    const VkImageCreateInfo image_info{
+        .sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
         .pNext = nullptr,
-        .srcAccessMask = 0,
-        .dstAccessMask = 0,
-        .oldLayout = p_old_layout,
-        .newLayout = p_new_layout,
-        .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-        .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-        .image = p_image,
-        .subresourceRange =
-            VkImageSubresourceRange{
-                .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
-                .baseMipLevel = 0,
-                .levelCount = 1,
-                .baseArrayLayer = 0,
-                .layerCount = 1,
+        .flags = 0,
+        .imageType = VK_IMAGE_TYPE_2D,
+        .format = p_format,
+        .extent =
+            VkExtent3D{
+                .width = p_extent.width,
+                .height = p_extent.height,
+                .depth = 1,
             },
+        .mipLevels = p_mip_levels,
+        .arrayLayers = 1,
+        .samples = VK_SAMPLE_COUNT_1_BIT,
+        .tiling = VK_IMAGE_TILING_OPTIMAL,
+        .usage = p_usage,
+        .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+        .queueFamilyIndexCount = 0,
+        .pQueueFamilyIndices = nullptr,
+        .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
     };
 
-    VkPipelineStageFlags sourceStage, destinationStage;
+    vulkan_scene::image_t image{};
 
-    if (p_old_layout == VK_IMAGE_LAYOUT_UNDEFINED &&
-        p_new_layout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL)
+    auto result = vkCreateImage(p_device, &image_info, nullptr, &image.image);
+    if (result != VK_SUCCESS)
     {
-        barrier.srcAccessMask = 0;
-        barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-
-        sourceStage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
-        destinationStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
+        print_error("Failed to create an image. Vulkan error ", result);
+        return result_t::error(result);
     }
-    else if (p_old_layout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL && p_new_layout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL)
-    {
-        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
 
-        sourceStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
-        destinationStage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
-    }
-    else
+    VkMemoryRequirements memory_requirements;
+    vkGetImageMemoryRequirements(p_device, image.image, &memory_requirements);
+
+    const auto allocation_result = p_allocator.allocate(
+        memory_requirements, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+        vulkan_scene::resource_kind_t::OPTIMAL
+    );
+    if (allocation_result.is_error(result))
     {
-        return result_t::error("Unsupported layout transition");
+        print_error(
+            "Failed to allocate memory for an image. Vulkan error ", result
+        );
+        vkDestroyImage(p_device, image.image, nullptr);
+        return result_t::error(result);
     }
 
-    vkCmdPipelineBarrier(
-        command_buffer, sourceStage, destinationStage, 0, 0, nullptr, 0,
-        nullptr, 1, &barrier
+    image.allocation = allocation_result.unwrap();
+
+    vkBindImageMemory(
+        p_device, image.image, image.allocation.memory, image.allocation.offset
     );
 
-    return result_t::success();
+    return result_t::success(image);
+}
+
+auto get_format_aspect(VkFormat p_format) noexcept -> VkImageAspectFlags
+{
+    switch (p_format)
+    {
+    case VK_FORMAT_D16_UNORM:
+    case VK_FORMAT_X8_D24_UNORM_PACK32:
+    case VK_FORMAT_D32_SFLOAT:
+        return VK_IMAGE_ASPECT_DEPTH_BIT;
+    case VK_FORMAT_D16_UNORM_S8_UINT:
+    case VK_FORMAT_D24_UNORM_S8_UINT:
+    case VK_FORMAT_D32_SFLOAT_S8_UINT:
+        return VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT;
+    default:
+        return VK_IMAGE_ASPECT_COLOR_BIT;
+    }
 }
 
 } // namespace
@@ -271,19 +175,70 @@ namespace vulkan_scene
 
 using kirho::result_t;
 
-auto create_render_pass(VkDevice p_device, VkFormat p_swapchain_format) noexcept
-    -> result_t<VkRenderPass, VkResult>
+auto find_depth_format(VkPhysicalDevice p_physical_device) noexcept
+    -> result_t<VkFormat, kirho::empty_t>
 {
-    const VkAttachmentDescription attachment{
-        .flags = 0,
-        .format = p_swapchain_format,
-        .samples = VK_SAMPLE_COUNT_1_BIT,
-        .loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
-        .storeOp = VK_ATTACHMENT_STORE_OP_STORE,
-        .stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE,
-        .stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE,
-        .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
-        .finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
+    using result_tt = result_t<VkFormat, kirho::empty_t>;
+
+    // D16 is the only one that is guaranteed, but it's also the least precise.
+    constexpr std::array candidates{
+        VK_FORMAT_D32_SFLOAT,
+        VK_FORMAT_X8_D24_UNORM_PACK32,
+        VK_FORMAT_D24_UNORM_S8_UINT,
+        VK_FORMAT_D32_SFLOAT_S8_UINT,
+        VK_FORMAT_D16_UNORM,
+    };
+
+    for (const auto format : candidates)
+    {
+        VkFormatProperties format_properties;
+        vkGetPhysicalDeviceFormatProperties(
+            p_physical_device, format, &format_properties
+        );
+
+        if (format_properties.optimalTilingFeatures &
+            VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT)
+        {
+            return result_tt::success(format);
+        }
+    }
+
+    vulkan_scene::print_error("None of the depth formats are supported.");
+    return result_tt::error(kirho::empty_t{});
+}
+
+auto create_render_pass(
+    VkDevice p_device,
+    VkFormat p_color_format,
+    VkFormat p_depth_format,
+    VkImageLayout p_final_layout
+) noexcept -> result_t<VkRenderPass, VkResult>
+{
+    const std::array attachments{
+        VkAttachmentDescription{
+            .flags = 0,
+            .format = p_color_format,
+            .samples = VK_SAMPLE_COUNT_1_BIT,
+            .loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
+            .storeOp = VK_ATTACHMENT_STORE_OP_STORE,
+            .stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE,
+            .stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE,
+            .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+            .finalLayout = p_final_layout,
+        },
+        // Nothing reads the depth after the pass, so tilers never have to
+        // write it out.
+        VkAttachmentDescription{
+            .flags = 0,
+            .format = p_depth_format,
+            .samples = VK_SAMPLE_COUNT_1_BIT,
+            .loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
+            .storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE,
+            .stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE,
+            .stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE,
+            .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+            .finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+        },
     };
 
     const VkAttachmentReference attachment_ref{
@@ -291,6 +246,11 @@ auto create_render_pass(VkDevice p_device, VkFormat p_swapchain_format) noexcept
         .layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
     };
 
+    const VkAttachmentReference depth_attachment_ref{
+        .attachment = 1,
+        .layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+    };
+
     const VkSubpassDescription subpass{
         .flags = 0,
         .pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS,
@@ -299,18 +259,23 @@ auto create_render_pass(VkDevice p_device, VkFormat p_swapchain_format) noexcept
         .colorAttachmentCount = 1,
         .pColorAttachments = &attachment_ref,
         .pResolveAttachments = nullptr,
-        .pDepthStencilAttachment = nullptr,
+        .pDepthStencilAttachment = &depth_attachment_ref,
         .preserveAttachmentCount = 0,
         .pPreserveAttachments = nullptr,
     };
 
+    // There is only one depth buffer for all of the frames in flight, so the
+    // depth tests of a frame have to wait for the ones of the frame before.
     const VkSubpassDependency subpass_dependency{
         .srcSubpass = VK_SUBPASS_EXTERNAL,
         .dstSubpass = 0,
-        .srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
-        .dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
-        .srcAccessMask = 0,
-        .dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+        .srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT |
+                        VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+        .dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT |
+                        VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT,
+        .srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+        .dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT |
+                         VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
         .dependencyFlags = 0,
     };
 
@@ -318,8 +283,8 @@ auto create_render_pass(VkDevice p_device, VkFormat p_swapchain_format) noexcept
         .sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO,
         .pNext = nullptr,
         .flags = 0,
-        .attachmentCount = 1,
-        .pAttachments = &attachment,
+        .attachmentCount = static_cast<uint32_t>(attachments.size()),
+        .pAttachments = attachments.data(),
         .subpassCount = 1,
         .pSubpasses = &subpass,
         .dependencyCount = 1,
@@ -429,7 +394,10 @@ auto create_graphics_pipeline(
     VkRenderPass p_render_pass,
     VkPipelineLayout p_layout,
     VkShaderModule p_vertex_shader,
-    VkShaderModule p_fragment_shader
+    VkShaderModule p_fragment_shader,
+    VkPipelineCache p_cache,
+    vertex_layout_t p_vertex_layout,
+    vertex_format_t p_vertex_format
 ) noexcept -> result_t<VkPipeline, VkResult>
 {
     using result_tt = result_t<VkPipeline, VkResult>;
@@ -470,42 +438,89 @@ auto create_graphics_pipeline(
         .pDynamicStates = dynamic_states.data(),
     };
 
-    const VkVertexInputBindingDescription vertex_binding_description{
-        .binding = 0,
-        .stride = sizeof(vertex_t),
-        .inputRate = VK_VERTEX_INPUT_RATE_VERTEX,
+    const auto packed = p_vertex_format == vertex_format_t::PACKED;
+
+    const std::array vertex_binding_descriptions{
+        VkVertexInputBindingDescription{
+            .binding = 0,
+            .stride = packed ? sizeof(packed_vertex_t) : sizeof(vertex_t),
+            .inputRate = VK_VERTEX_INPUT_RATE_VERTEX,
+        },
+        VkVertexInputBindingDescription{
+            .binding = 1,
+            .stride = sizeof(instance_t),
+            .inputRate = VK_VERTEX_INPUT_RATE_INSTANCE,
+        },
     };
 
-    const std::array<VkVertexInputAttributeDescription, 3>
+    // A matrix attribute takes up one location per column.
+    const std::array<VkVertexInputAttributeDescription, 7>
         vertex_attribute_descriptions{
             VkVertexInputAttributeDescription{
                 .location = 0,
                 .binding = 0,
-                .format = VK_FORMAT_R32G32B32_SFLOAT,
-                .offset = static_cast<uint32_t>(offsetof(vertex_t, position)),
+                .format = packed ? VK_FORMAT_R16G16B16A16_UNORM
+                                 : VK_FORMAT_R32G32B32_SFLOAT,
+                .offset = static_cast<uint32_t>(
+                    packed ? offsetof(packed_vertex_t, position)
+                           : offsetof(vertex_t, position)
+                ),
             },
             VkVertexInputAttributeDescription{
                 .location = 1,
                 .binding = 0,
-                .format = VK_FORMAT_R32G32_SFLOAT,
-                .offset = static_cast<uint32_t>(offsetof(vertex_t, uv)),
+                .format = packed ? VK_FORMAT_R16G16_SFLOAT
+                                 : VK_FORMAT_R32G32_SFLOAT,
+                .offset = static_cast<uint32_t>(
+                    packed ? offsetof(packed_vertex_t, uv)
+                           : offsetof(vertex_t, uv)
+                ),
             },
             VkVertexInputAttributeDescription{
                 .location = 2,
                 .binding = 0,
-                .format = VK_FORMAT_R32G32B32_SFLOAT,
-                .offset = static_cast<uint32_t>(offsetof(vertex_t, normal)),
+                .format = packed ? VK_FORMAT_R16G16_SNORM
+                                 : VK_FORMAT_R32G32B32_SFLOAT,
+                .offset = static_cast<uint32_t>(
+                    packed ? offsetof(packed_vertex_t, normal)
+                           : offsetof(vertex_t, normal)
+                ),
+            },
+            VkVertexInputAttributeDescription{
+                .location = 3,
+                .binding = 1,
+                .format = VK_FORMAT_R32G32B32A32_SFLOAT,
+                .offset = 0,
+            },
+            VkVertexInputAttributeDescription{
+                .location = 4,
+                .binding = 1,
+                .format = VK_FORMAT_R32G32B32A32_SFLOAT,
+                .offset = sizeof(glm::vec4),
+            },
+            VkVertexInputAttributeDescription{
+                .location = 5,
+                .binding = 1,
+                .format = VK_FORMAT_R32G32B32A32_SFLOAT,
+                .offset = sizeof(glm::vec4) * 2,
+            },
+            VkVertexInputAttributeDescription{
+                .location = 6,
+                .binding = 1,
+                .format = VK_FORMAT_R32G32B32A32_SFLOAT,
+                .offset = sizeof(glm::vec4) * 3,
             },
         };
 
+    const auto instanced = p_vertex_layout == vertex_layout_t::INSTANCED_MESH;
+
     const VkPipelineVertexInputStateCreateInfo vertex_input_state = {
         .sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
         .pNext = nullptr,
         .flags = 0,
-        .vertexBindingDescriptionCount = 1,
-        .pVertexBindingDescriptions = &vertex_binding_description,
-        .vertexAttributeDescriptionCount =
-            static_cast<uint32_t>(vertex_attribute_descriptions.size()),
+        .vertexBindingDescriptionCount = instanced ? 2u : 1u,
+        .pVertexBindingDescriptions = vertex_binding_descriptions.data(),
+        .vertexAttributeDescriptionCount = instanced ? 7u : 3u,
         .pVertexAttributeDescriptions = vertex_attribute_descriptions.data(),
     };
 
@@ -554,6 +569,23 @@ auto create_graphics_pipeline(
         .alphaToOneEnable = VK_FALSE,
     };
 
+    // Opaque geometry gets drawn front to back, so that most hidden fragments
+    // are rejected before their fragment shader runs.
+    const VkPipelineDepthStencilStateCreateInfo depth_stencil_state = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO,
+        .pNext = nullptr,
+        .flags = 0,
+        .depthTestEnable = VK_TRUE,
+        .depthWriteEnable = VK_TRUE,
+        .depthCompareOp = VK_COMPARE_OP_LESS,
+        .depthBoundsTestEnable = VK_FALSE,
+        .stencilTestEnable = VK_FALSE,
+        .front = {},
+        .back = {},
+        .minDepthBounds = 0.0f,
+        .maxDepthBounds = 1.0f,
+    };
+
     const VkPipelineColorBlendAttachmentState color_blend_attachment = {
         .blendEnable = VK_FALSE,
         .srcColorBlendFactor = VK_BLEND_FACTOR_ONE,
@@ -589,7 +621,7 @@ auto create_graphics_pipeline(
         .pViewportState = &viewport_state,
         .pRasterizationState = &rasterization_state,
         .pMultisampleState = &multisample_state,
-        .pDepthStencilState = nullptr,
+        .pDepthStencilState = &depth_stencil_state,
         .pColorBlendState = &color_blend_state,
         .pDynamicState = &dynamic_state,
         .layout = p_layout,
@@ -601,7 +633,7 @@ auto create_graphics_pipeline(
 
     VkPipeline pipeline;
     const auto result = vkCreateGraphicsPipelines(
-        p_device, VK_NULL_HANDLE, 1, &pipeline_info, nullptr, &pipeline
+        p_device, p_cache, 1, &pipeline_info, nullptr, &pipeline
     );
     if (result != VK_SUCCESS)
     {
@@ -614,11 +646,51 @@ auto create_graphics_pipeline(
     return result_tt::success(pipeline);
 }
 
+auto create_compute_pipeline(
+    VkDevice p_device,
+    VkPipelineLayout p_layout,
+    VkShaderModule p_compute_shader,
+    VkPipelineCache p_cache
+) noexcept -> result_t<VkPipeline, VkResult>
+{
+    const VkComputePipelineCreateInfo pipeline_info{
+        .sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+        .pNext = nullptr,
+        .flags = 0,
+        .stage =
+            VkPipelineShaderStageCreateInfo{
+                .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+                .pNext = nullptr,
+                .flags = 0,
+                .stage = VK_SHADER_STAGE_COMPUTE_BIT,
+                .module = p_compute_shader,
+                .pName = "main",
+                .pSpecializationInfo = nullptr,
+            },
+        .layout = p_layout,
+        .basePipelineHandle = VK_NULL_HANDLE,
+        .basePipelineIndex = -1,
+    };
+
+    VkPipeline pipeline;
+    const auto result = vkCreateComputePipelines(
+        p_device, p_cache, 1, &pipeline_info, nullptr, &pipeline
+    );
+    if (result != VK_SUCCESS)
+    {
+        vulkan_scene::print_error(
+            "Failed to create the compute pipeline. Vulkan error ", result, '.'
+        );
+        return result_tt::error(result);
+    }
+
+    return result_tt::success(pipeline);
+}
+
 auto create_buffer(
-    VkPhysicalDevice p_physical_device,
+    memory_allocator_t& p_allocator,
     VkDevice p_device,
-    VkQueue p_graphics_queue,
-    VkCommandPool p_command_pool,
+    upload_queue_t& p_upload_queue,
     buffer_type_t p_type,
     const void* p_data,
     VkDeviceSize p_data_size
@@ -626,29 +698,6 @@ auto create_buffer(
 {
     using result_t = kirho::result_t<buffer_t, VkResult>;
 
-    const auto staging_buffer_result = create_vulkan_buffer(
-        p_physical_device, p_device, p_data_size,
-        VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
-            VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
-    );
-    {
-        VkResult error;
-        if (staging_buffer_result.is_error(error))
-        {
-            return result_t::error(error);
-        }
-    }
-    const auto staging_buffer = staging_buffer_result.unwrap();
-
-    void* staging_buffer_pointer = nullptr;
-    vkMapMemory(
-        p_device, staging_buffer.memory, 0, p_data_size, 0,
-        &staging_buffer_pointer
-    );
-    std::memcpy(staging_buffer_pointer, p_data, p_data_size);
-    vkUnmapMemory(p_device, staging_buffer.memory);
-
     VkBufferUsageFlags usage_flags = VK_BUFFER_USAGE_TRANSFER_DST_BIT;
 
     switch (p_type)
@@ -659,49 +708,85 @@ auto create_buffer(
     case buffer_type_t::INDEX:
         usage_flags |= VK_BUFFER_USAGE_INDEX_BUFFER_BIT;
         break;
+    case buffer_type_t::STORAGE:
+        usage_flags |= VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+                       VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
+        break;
+    case buffer_type_t::INDIRECT:
+        // The instance count of the first command gets copied into the rest.
+        usage_flags |= VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+                       VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT |
+                       VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+        break;
     default:
         print_error("Invalid buffer type.");
         return result_t::error(VK_ERROR_UNKNOWN);
     };
 
     const auto buffer_result = create_vulkan_buffer(
-        p_physical_device, p_device, p_data_size, usage_flags,
+        p_allocator, p_device, p_data_size, usage_flags,
         VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
     );
+
+    VkResult error;
+    if (buffer_result.is_error(error))
     {
-        VkResult error;
-        if (buffer_result.is_error(error))
-        {
-            return result_t::error(error);
-        }
+        return result_t::error(error);
     }
+
     auto buffer = buffer_result.unwrap();
     buffer.type = p_type;
 
+    if (p_data == nullptr)
     {
-        temporary_command_buffer_t command_buffer(
-            p_device, p_graphics_queue, p_command_pool
-        );
+        return result_t::success(buffer);
+    }
 
-        const VkBufferCopy copy_region{
-            .srcOffset = 0,
-            .dstOffset = 0,
-            .size = p_data_size,
-        };
+    const auto upload_result =
+        upload_buffer(p_upload_queue, buffer, 0, p_data, p_data_size);
+    if (upload_result.is_error(error))
+    {
+        destroy_buffer(p_device, p_allocator, buffer);
+        return result_t::error(error);
+    }
 
-        vkCmdCopyBuffer(
-            command_buffer, staging_buffer.buffer, buffer.buffer, 1,
-            &copy_region
-        );
+    return result_t::success(buffer);
+}
+
+auto create_index_buffer(
+    memory_allocator_t& p_allocator,
+    VkDevice p_device,
+    upload_queue_t& p_upload_queue,
+    VkIndexType p_index_type,
+    const void* p_indices,
+    uint32_t p_index_count
+) noexcept -> kirho::result_t<buffer_t, VkResult>
+{
+    using result_t = kirho::result_t<buffer_t, VkResult>;
+
+    const auto index_size = p_index_type == VK_INDEX_TYPE_UINT16
+                                ? sizeof(uint16_t)
+                                : sizeof(uint32_t);
+
+    const auto buffer_result = create_buffer(
+        p_allocator, p_device, p_upload_queue, buffer_type_t::INDEX, p_indices,
+        index_size * p_index_count
+    );
+
+    VkResult error;
+    if (buffer_result.is_error(error))
+    {
+        return result_t::error(error);
     }
 
-    destroy_buffer(p_device, staging_buffer);
+    auto buffer = buffer_result.unwrap();
+    buffer.index_type = p_index_type;
 
     return result_t::success(buffer);
 }
 
 auto create_uniform_buffer(
-    VkPhysicalDevice p_physical_device,
+    memory_allocator_t& p_allocator,
     VkDevice p_device,
     void* p_data,
     VkDeviceSize p_data_size
@@ -710,8 +795,7 @@ auto create_uniform_buffer(
     using result_t = kirho::result_t<buffer_t, VkResult>;
 
     const auto buffer_result = create_vulkan_buffer(
-        p_physical_device, p_device, p_data_size,
-        VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+        p_allocator, p_device, p_data_size, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
         VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
             VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
     );
@@ -729,184 +813,155 @@ auto create_uniform_buffer(
     return result_t::success(buffer);
 }
 
-auto create_image(
-    VkPhysicalDevice p_physical_device,
+auto create_readback_buffer(
+    memory_allocator_t& p_allocator,
     VkDevice p_device,
-    VkQueue p_queue,
-    VkCommandPool p_command_pool,
-    std::string_view p_file_path
-) -> kirho::result_t<image_t, VkResult>
+    VkDeviceSize p_data_size
+) noexcept -> kirho::result_t<buffer_t, VkResult>
 {
-    using result_t = kirho::result_t<image_t, VkResult>;
-
-    constexpr auto fixed_channels = 4;
+    using result_t = kirho::result_t<buffer_t, VkResult>;
 
-    int width, height, channels;
-    const auto image_data = stbi_load(
-        p_file_path.data(), &width, &height, &channels, fixed_channels
+    const auto buffer_result = create_vulkan_buffer(
+        p_allocator, p_device, p_data_size, VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+            VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
     );
-
-    if (image_data == nullptr)
     {
-        print_error("Failed to load ", p_file_path, '.');
-        return result_t::error(VK_ERROR_UNKNOWN);
+        VkResult error;
+        if (buffer_result.is_error(error))
+        {
+            return result_t::error(error);
+        }
     }
 
-    const VkDeviceSize buffer_size =
-        width * height * fixed_channels * sizeof(*image_data);
-
-    const auto staging_buffer = create_vulkan_buffer(
-                                    p_physical_device, p_device, buffer_size,
-                                    VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-                                    VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
-                                        VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
-    )
-                                    .unwrap();
-
-    void* staging_buffer_pointer;
-    vkMapMemory(
-        p_device, staging_buffer.memory, 0, buffer_size, 0,
-        &staging_buffer_pointer
-    );
-    std::memcpy(staging_buffer_pointer, image_data, buffer_size);
-    vkUnmapMemory(p_device, staging_buffer.memory);
+    auto buffer = buffer_result.unwrap();
+    buffer.type = buffer_type_t::READBACK;
 
-    stbi_image_free(image_data);
+    return result_t::success(buffer);
+}
 
-    const VkImageCreateInfo image_info{
-        .sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
-        .pNext = nullptr,
-        .flags = 0,
-        .imageType = VK_IMAGE_TYPE_2D,
-        .format = VK_FORMAT_R8G8B8A8_SRGB,
-        .extent =
-            VkExtent3D{
-                .width = static_cast<uint32_t>(width),
-                .height = static_cast<uint32_t>(height),
-                .depth = 1,
-            },
-        .mipLevels = 1,
-        .arrayLayers = 1,
-        .samples = VK_SAMPLE_COUNT_1_BIT,
-        .tiling = VK_IMAGE_TILING_OPTIMAL,
-        .usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
-        .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
-        .queueFamilyIndexCount = 0,
-        .pQueueFamilyIndices = nullptr,
-        .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
-    };
+auto create_staging_buffer(
+    memory_allocator_t& p_allocator,
+    VkDevice p_device,
+    VkDeviceSize p_data_size,
+    allocation_strategy_t p_strategy
+) noexcept -> kirho::result_t<buffer_t, VkResult>
+{
+    using result_t = kirho::result_t<buffer_t, VkResult>;
 
-    VkImage image;
-    auto result = vkCreateImage(p_device, &image_info, nullptr, &image);
-    if (result != VK_SUCCESS)
+    const auto buffer_result = create_vulkan_buffer(
+        p_allocator, p_device, p_data_size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+            VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+        p_strategy
+    );
     {
-        print_error("Failed to create an image. Vulkan error ", result);
-        return result_t::error(result);
+        VkResult error;
+        if (buffer_result.is_error(error))
+        {
+            return result_t::error(error);
+        }
     }
 
-    VkMemoryRequirements memory_requirements;
-    vkGetImageMemoryRequirements(p_device, image, &memory_requirements);
+    auto buffer = buffer_result.unwrap();
+    buffer.type = buffer_type_t::STAGING;
 
-    const VkMemoryAllocateInfo alloc_info{
-        .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
-        .pNext = nullptr,
-        .allocationSize = memory_requirements.size,
-        .memoryTypeIndex =
-            find_buffer_memory_type(
-                p_physical_device, memory_requirements.memoryTypeBits,
-                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
-            )
-                .unwrap(),
-    };
+    return result_t::success(buffer);
+}
 
-    VkDeviceMemory memory;
-    result = vkAllocateMemory(p_device, &alloc_info, nullptr, &memory);
-    if (result != VK_SUCCESS)
+auto create_attachment_image(
+    memory_allocator_t& p_allocator,
+    VkDevice p_device,
+    VkExtent2D p_extent,
+    VkFormat p_format,
+    VkImageUsageFlags p_usage
+) noexcept -> kirho::result_t<image_t, VkResult>
+{
+    using result_t = kirho::result_t<image_t, VkResult>;
+
+    const auto image_result =
+        create_vulkan_image(p_allocator, p_device, p_extent, p_format, p_usage);
+
+    VkResult result;
+    if (image_result.is_error(result))
     {
-        print_error(
-            "Failed to allocate memory for an image. Vulkan error ", result
-        );
         return result_t::error(result);
     }
 
-    vkBindImageMemory(p_device, image, memory, 0);
+    auto image = image_result.unwrap();
 
-    std::string_view error;
-    if (transition_image_layout(
-            p_device, p_queue, p_command_pool, image, VK_FORMAT_R8G8B8A8_SRGB,
-            VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL
-        )
-            .is_error(error))
+    const auto view_result = create_image_view(p_device, image.image, p_format);
+    if (view_result.is_error(result))
     {
-        print_error(error);
-        return result_t::error(VK_ERROR_UNKNOWN);
+        vkDestroyImage(p_device, image.image, nullptr);
+        p_allocator.free(image.allocation);
+        return result_t::error(result);
     }
 
-    {
-        temporary_command_buffer_t command_buffer{
-            p_device, p_queue, p_command_pool};
-
-        const VkBufferImageCopy region{
-            .bufferOffset = 0,
-            .bufferRowLength = 0,
-            .bufferImageHeight = 0,
-            .imageSubresource =
-                VkImageSubresourceLayers{
-                    .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
-                    .mipLevel = 0,
-                    .baseArrayLayer = 0,
-                    .layerCount = 1,
-                },
-            .imageOffset =
-                VkOffset3D{
-                    .x = 0,
-                    .y = 0,
-                    .z = 0,
-                },
-            .imageExtent =
-                VkExtent3D{
-                    .width = static_cast<uint32_t>(width),
-                    .height = static_cast<uint32_t>(height),
-                    .depth = 1,
-                },
-        };
+    image.view = view_result.unwrap();
 
-        vkCmdCopyBufferToImage(
-            command_buffer, staging_buffer.buffer, image,
-            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region
-        );
-    }
+    return result_t::success(image);
+}
 
-    destroy_buffer(p_device, staging_buffer);
+auto create_image(
+    memory_allocator_t& p_allocator,
+    VkDevice p_device,
+    upload_queue_t& p_upload_queue,
+    const decoded_image_t& p_decoded
+) -> kirho::result_t<image_t, VkResult>
+{
+    using result_t = kirho::result_t<image_t, VkResult>;
+
+    // The levels that didn't come with the image get blitted from the ones
+    // before them.
+    const auto needs_blits = p_decoded.levels.size() < p_decoded.level_count;
 
-    if (transition_image_layout(
-            p_device, p_queue, p_command_pool, image, VK_FORMAT_R8G8B8A8_SRGB,
-            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-            VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
-        )
-            .is_error(error))
+    const auto image_result = create_vulkan_image(
+        p_allocator, p_device, p_decoded.extent, p_decoded.format,
+        VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT |
+            (needs_blits ? VK_IMAGE_USAGE_TRANSFER_SRC_BIT : 0),
+        p_decoded.level_count
+    );
+
+    VkResult result;
+    if (image_result.is_error(result))
     {
-        print_error(error);
-        return result_t::error(VK_ERROR_UNKNOWN);
+        return result_t::error(result);
     }
 
-    const auto image_view_result = create_image_view(p_device, image);
+    auto image = image_result.unwrap();
+
+    const auto image_view_result = create_image_view(
+        p_device, image.image, p_decoded.format, p_decoded.level_count
+    );
     if (image_view_result.is_error(result))
     {
+        vkDestroyImage(p_device, image.image, nullptr);
+        p_allocator.free(image.allocation);
         return result_t::error(result);
     }
 
-    const auto image_view = image_view_result.unwrap();
+    image.view = image_view_result.unwrap();
 
-    return result_t::success(image_t{
-        .image = image,
-        .memory = memory,
-        .view = image_view,
-    });
+    // The pixels get copied into staging memory right away, so the decoded
+    // image can go away before the upload is even submitted.
+    const auto upload_result = upload_image(
+        p_upload_queue, image.image, p_decoded.extent, p_decoded.level_count,
+        p_decoded.levels, p_decoded.data.data(), p_decoded.data.size()
+    );
+
+    if (upload_result.is_error(result))
+    {
+        destroy_image(p_device, p_allocator, image);
+        return result_t::error(result);
+    }
+
+    return result_t::success(image);
 }
 
-auto create_image_view(VkDevice p_device, VkImage p_image, VkFormat p_format)
-    -> kirho::result_t<VkImageView, VkResult>
+auto create_image_view(
+    VkDevice p_device, VkImage p_image, VkFormat p_format, uint32_t p_mip_levels
+) -> kirho::result_t<VkImageView, VkResult>
 {
     using result_t = kirho::result_t<VkImageView, VkResult>;
 
@@ -926,9 +981,9 @@ auto create_image_view(VkDevice p_device, VkImage p_image, VkFormat p_format)
             },
         .subresourceRange =
             VkImageSubresourceRange{
-                .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                .aspectMask = get_format_aspect(p_format),
                 .baseMipLevel = 0,
-                .levelCount = 1,
+                .levelCount = p_mip_levels,
                 .baseArrayLayer = 0,
                 .layerCount = 1,
             },
@@ -972,7 +1027,7 @@ auto create_sampler(
         .compareEnable = VK_FALSE,
         .compareOp = VK_COMPARE_OP_ALWAYS,
         .minLod = 0.0f,
-        .maxLod = 0.0f,
+        .maxLod = VK_LOD_CLAMP_NONE,
         .borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK,
         .unnormalizedCoordinates = VK_FALSE,
     };
@@ -989,17 +1044,23 @@ auto create_sampler(
     return result_t::success(sampler);
 }
 
-auto destroy_buffer(VkDevice p_device, const buffer_t& p_buffer) -> void
+auto destroy_buffer(
+    VkDevice p_device,
+    memory_allocator_t& p_allocator,
+    const buffer_t& p_buffer
+) -> void
 {
     vkDestroyBuffer(p_device, p_buffer.buffer, nullptr);
-    vkFreeMemory(p_device, p_buffer.memory, nullptr);
+    p_allocator.free(p_buffer.allocation);
 }
 
-auto destroy_image(VkDevice p_device, const image_t& p_image) -> void
+auto destroy_image(
+    VkDevice p_device, memory_allocator_t& p_allocator, const image_t& p_image
+) -> void
 {
-    vkDestroyImage(p_device, p_image.image, nullptr);
-    vkFreeMemory(p_device, p_image.memory, nullptr);
     vkDestroyImageView(p_device, p_image.view, nullptr);
+    vkDestroyImage(p_device, p_image.image, nullptr);
+    p_allocator.free(p_image.allocation);
 }
 
 } // namespace vulkan_scene
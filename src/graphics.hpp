@@ -1,28 +1,44 @@
+#pragma once
+
 #include <glm/glm.hpp>
 #include <vulkan/vulkan.h>
 #include <vulkan/vulkan_core.h>
 
+#include "allocator.hpp"
+
 namespace vulkan_scene
 {
 
+struct decoded_image_t;
+struct upload_queue_t;
+
 enum class buffer_type_t
 {
     VERTEX,
     INDEX,
     UNIFORM,
+    READBACK,
+    STAGING,
+    // Written by compute shaders, and read back as per-instance vertex data.
+    STORAGE,
+    // Draw commands that compute shaders fill in.
+    INDIRECT,
 };
 
 struct buffer_t
 {
     VkBuffer buffer;
-    VkDeviceMemory memory;
+    allocation_t allocation;
     buffer_type_t type;
+
+    // What index buffers get bound with. Other buffers leave it alone.
+    VkIndexType index_type;
 };
 
 struct image_t
 {
     VkImage image;
-    VkDeviceMemory memory;
+    allocation_t allocation;
     VkImageView view;
 };
 
@@ -33,15 +49,76 @@ struct vertex_t
     glm::vec3 normal;
 };
 
-auto create_render_pass(VkDevice p_device, VkFormat p_swapchain_format) noexcept
-    -> kirho::result_t<VkRenderPass, VkResult>;
+// vertex_t in half the space, for meshes where vertex fetching is the
+// bottleneck. See pack_vertex in mesh.hpp for how each attribute is encoded.
+struct packed_vertex_t
+{
+    // Where the vertex is between the corners of the mesh's bounds, as UNORM.
+    // The fourth component is unused, since three-component formats aren't
+    // guaranteed to work as vertex attributes.
+    std::array<uint16_t, 4> position;
+
+    // The unit normal in octahedral encoding, as SNORM.
+    std::array<int16_t, 2> normal;
+
+    // Half floats.
+    std::array<uint16_t, 2> uv;
+};
+
+static_assert(sizeof(packed_vertex_t) == 16);
+
+// Per-instance data of instanced draws, which comes from a second vertex
+// buffer that advances once per instance.
+struct instance_t
+{
+    glm::mat4 model;
+};
+
+enum class vertex_layout_t
+{
+    // Just vertex_t in binding 0.
+    MESH,
+    // vertex_t in binding 0 and instance_t in binding 1, with the model matrix
+    // taking up locations 3 to 6.
+    INSTANCED_MESH,
+};
+
+// Which of the vertex structs binding 0 has.
+enum class vertex_format_t
+{
+    FULL,
+    PACKED,
+};
+
+// Picks the most precise depth format that can be used as a depth attachment.
+auto find_depth_format(VkPhysicalDevice p_physical_device) noexcept
+    -> kirho::result_t<VkFormat, kirho::empty_t>;
+
+// A single subpass with a color and a depth attachment. The depth contents are
+// cleared at the start and thrown away at the end.
+auto create_render_pass(
+    VkDevice p_device,
+    VkFormat p_color_format,
+    VkFormat p_depth_format,
+    VkImageLayout p_final_layout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR
+) noexcept -> kirho::result_t<VkRenderPass, VkResult>;
 
 auto create_graphics_pipeline(
     VkDevice p_device,
     VkRenderPass p_render_pass,
     VkPipelineLayout p_layout,
     VkShaderModule p_vertex_shader,
-    VkShaderModule p_fragment_shader
+    VkShaderModule p_fragment_shader,
+    VkPipelineCache p_cache = VK_NULL_HANDLE,
+    vertex_layout_t p_vertex_layout = vertex_layout_t::MESH,
+    vertex_format_t p_vertex_format = vertex_format_t::FULL
+) noexcept -> kirho::result_t<VkPipeline, VkResult>;
+
+auto create_compute_pipeline(
+    VkDevice p_device,
+    VkPipelineLayout p_layout,
+    VkShaderModule p_compute_shader,
+    VkPipelineCache p_cache = VK_NULL_HANDLE
 ) noexcept -> kirho::result_t<VkPipeline, VkResult>;
 
 auto create_pipeline_layout(
@@ -54,33 +131,73 @@ auto create_shader_module(
     VkDevice p_device, std::string_view p_file_path
 ) noexcept -> kirho::result_t<VkShaderModule, kirho::empty_t>;
 
+// The contents only arrive once the upload queue has been flushed. Without
+// p_data, the buffer is left uninitialized and nothing gets uploaded.
 auto create_buffer(
-    VkPhysicalDevice physical_device,
+    memory_allocator_t& allocator,
     VkDevice device,
-    VkQueue graphics_queue,
-    VkCommandPool command_pool,
+    upload_queue_t& upload_queue,
     buffer_type_t type,
     const void* data,
     VkDeviceSize data_size
 ) noexcept -> kirho::result_t<buffer_t, VkResult>;
 
+// Same as create_buffer, for p_index_count indices of p_index_type.
+auto create_index_buffer(
+    memory_allocator_t& p_allocator,
+    VkDevice p_device,
+    upload_queue_t& p_upload_queue,
+    VkIndexType p_index_type,
+    const void* p_indices,
+    uint32_t p_index_count
+) noexcept -> kirho::result_t<buffer_t, VkResult>;
+
 auto create_uniform_buffer(
-    VkPhysicalDevice p_physical_device,
+    memory_allocator_t& p_allocator,
     VkDevice p_device,
     void* p_data,
     VkDeviceSize p_data_size
 ) noexcept -> kirho::result_t<buffer_t, VkResult>;
 
+// A host-visible buffer that the GPU copies rendered images into.
+auto create_readback_buffer(
+    memory_allocator_t& p_allocator,
+    VkDevice p_device,
+    VkDeviceSize p_data_size
+) noexcept -> kirho::result_t<buffer_t, VkResult>;
+
+// A host-visible buffer that the GPU copies uploads out of.
+auto create_staging_buffer(
+    memory_allocator_t& p_allocator,
+    VkDevice p_device,
+    VkDeviceSize p_data_size,
+    allocation_strategy_t p_strategy = allocation_strategy_t::FREE_LIST
+) noexcept -> kirho::result_t<buffer_t, VkResult>;
+
+// An empty, device-local image (with a view) that can be rendered into.
+auto create_attachment_image(
+    memory_allocator_t& p_allocator,
+    VkDevice p_device,
+    VkExtent2D p_extent,
+    VkFormat p_format,
+    VkImageUsageFlags p_usage
+) noexcept -> kirho::result_t<image_t, VkResult>;
+
+// Same as create_buffer, the pixels only arrive once the upload queue has been
+// flushed. The image gets p_decoded.level_count mip levels, and any that
+// weren't decoded get blitted.
 auto create_image(
-    VkPhysicalDevice p_physical_device,
+    memory_allocator_t& p_allocator,
     VkDevice p_device,
-    VkQueue p_queue,
-    VkCommandPool p_command_pool,
-    std::string_view p_file_path
+    upload_queue_t& p_upload_queue,
+    const decoded_image_t& p_decoded
 ) -> kirho::result_t<image_t, VkResult>;
 
 auto create_image_view(
-    VkDevice device, VkImage image, VkFormat format = VK_FORMAT_R8G8B8A8_SRGB
+    VkDevice device,
+    VkImage image,
+    VkFormat format = VK_FORMAT_R8G8B8A8_SRGB,
+    uint32_t mip_levels = 1
 ) -> kirho::result_t<VkImageView, VkResult>;
 
 auto create_sampler(
@@ -90,8 +207,12 @@ auto create_sampler(
     bool enable_anisothropy
 ) -> kirho::result_t<VkSampler, VkResult>;
 
-auto destroy_image(VkDevice device, const image_t& image) -> void;
+auto destroy_image(
+    VkDevice device, memory_allocator_t& allocator, const image_t& image
+) -> void;
 
-auto destroy_buffer(VkDevice device, const buffer_t& buffer) -> void;
+auto destroy_buffer(
+    VkDevice device, memory_allocator_t& allocator, const buffer_t& buffer
+) -> void;
 
 } // namespace vulkan_scene
@@ -0,0 +1,414 @@
+#include <charconv>
+
+#include "json.hpp"
+
+namespace
+{
+
+using vulkan_scene::json_type_t;
+using vulkan_scene::json_value_t;
+
+// Deep enough for any reasonable document, and shallow enough that the
+// recursion can't run out of stack.
+constexpr uint32_t MAX_JSON_DEPTH = 128;
+
+class json_parser_t
+{
+  public:
+    explicit json_parser_t(std::string_view p_text) noexcept
+        : m_text(p_text), m_position(0)
+    {
+    }
+
+    auto parse() -> std::optional<json_value_t>
+    {
+        auto value = parse_value(0);
+
+        // Nothing but whitespace is allowed after the value.
+        skip_whitespace();
+        if (!value.has_value() || m_position != m_text.size())
+        {
+            return std::nullopt;
+        }
+
+        return value;
+    }
+
+  private:
+    auto skip_whitespace() noexcept -> void
+    {
+        while (m_position < m_text.size() &&
+               (m_text[m_position] == ' ' || m_text[m_position] == '\t' ||
+                m_text[m_position] == '\n' || m_text[m_position] == '\r'))
+        {
+            m_position++;
+        }
+    }
+
+    // Skips the character if it's next.
+    auto consume(char p_character) noexcept -> bool
+    {
+        if (m_position < m_text.size() && m_text[m_position] == p_character)
+        {
+            m_position++;
+            return true;
+        }
+
+        return false;
+    }
+
+    auto consume(std::string_view p_word) noexcept -> bool
+    {
+        if (m_text.substr(m_position, p_word.size()) == p_word)
+        {
+            m_position += p_word.size();
+            return true;
+        }
+
+        return false;
+    }
+
+    auto parse_value(uint32_t p_depth) -> std::optional<json_value_t>
+    {
+        if (p_depth > MAX_JSON_DEPTH)
+        {
+            return std::nullopt;
+        }
+
+        skip_whitespace();
+        if (m_position == m_text.size())
+        {
+            return std::nullopt;
+        }
+
+        json_value_t value{
+            .type = json_type_t::NULL_VALUE,
+            .boolean = false,
+            .number = 0.0,
+            .string = {},
+            .elements = {},
+            .keys = {},
+        };
+
+        auto parsed = false;
+
+        switch (m_text[m_position])
+        {
+        case '{':
+            m_position++;
+            value.type = json_type_t::OBJECT;
+            parsed = parse_object(value, p_depth);
+            break;
+        case '[':
+            m_position++;
+            value.type = json_type_t::ARRAY;
+            parsed = parse_array(value, p_depth);
+            break;
+        case '"':
+            m_position++;
+            value.type = json_type_t::STRING;
+            parsed = parse_string(value.string);
+            break;
+        case 't':
+            value.type = json_type_t::BOOLEAN;
+            value.boolean = true;
+            parsed = consume("true");
+            break;
+        case 'f':
+            value.type = json_type_t::BOOLEAN;
+            parsed = consume("false");
+            break;
+        case 'n':
+            parsed = consume("null");
+            break;
+        default:
+            value.type = json_type_t::NUMBER;
+            parsed = parse_number(value.number);
+            break;
+        }
+
+        if (!parsed)
+        {
+            return std::nullopt;
+        }
+
+        return value;
+    }
+
+    auto parse_object(json_value_t& p_object, uint32_t p_depth) -> bool
+    {
+        skip_whitespace();
+        if (consume('}'))
+        {
+            return true;
+        }
+
+        do
+        {
+            skip_whitespace();
+
+            std::string key;
+            if (!consume('"') || !parse_string(key))
+            {
+                return false;
+            }
+
+            skip_whitespace();
+            if (!consume(':'))
+            {
+                return false;
+            }
+
+            auto value = parse_value(p_depth + 1);
+            if (!value.has_value())
+            {
+                return false;
+            }
+
+            p_object.keys.push_back(std::move(key));
+            p_object.elements.push_back(std::move(*value));
+
+            skip_whitespace();
+        } while (consume(','));
+
+        return consume('}');
+    }
+
+    auto parse_array(json_value_t& p_array, uint32_t p_depth) -> bool
+    {
+        skip_whitespace();
+        if (consume(']'))
+        {
+            return true;
+        }
+
+        do
+        {
+            auto element = parse_value(p_depth + 1);
+            if (!element.has_value())
+            {
+                return false;
+            }
+
+            p_array.elements.push_back(std::move(*element));
+
+            skip_whitespace();
+        } while (consume(','));
+
+        return consume(']');
+    }
+
+    // Reads four hex digits of a \u escape.
+    auto parse_code_unit(uint32_t& p_code_unit) noexcept -> bool
+    {
+        if (m_text.size() - m_position < 4)
+        {
+            return false;
+        }
+
+        const auto first = m_text.data() + m_position;
+        const auto [end, error] =
+            std::from_chars(first, first + 4, p_code_unit, 16);
+        if (error != std::errc{} || end != first + 4)
+        {
+            return false;
+        }
+
+        m_position += 4;
+        return true;
+    }
+
+    // The opening quote has been consumed already.
+    auto parse_string(std::string& p_string) -> bool
+    {
+        while (m_position < m_text.size())
+        {
+            const auto character = m_text[m_position++];
+
+            if (character == '"')
+            {
+                return true;
+            }
+
+            if (static_cast<unsigned char>(character) < 0x20)
+            {
+                return false;
+            }
+
+            if (character != '\\')
+            {
+                p_string.push_back(character);
+                continue;
+            }
+
+            if (m_position == m_text.size())
+            {
+                return false;
+            }
+
+            switch (m_text[m_position++])
+            {
+            case '"':
+                p_string.push_back('"');
+                break;
+            case '\\':
+                p_string.push_back('\\');
+                break;
+            case '/':
+                p_string.push_back('/');
+                break;
+            case 'b':
+                p_string.push_back('\b');
+                break;
+            case 'f':
+                p_string.push_back('\f');
+                break;
+            case 'n':
+                p_string.push_back('\n');
+                break;
+            case 'r':
+                p_string.push_back('\r');
+                break;
+            case 't':
+                p_string.push_back('\t');
+                break;
+            case 'u':
+                if (!parse_escaped_code_point(p_string))
+                {
+                    return false;
+                }
+                break;
+            default:
+                return false;
+            }
+        }
+
+        return false;
+    }
+
+    // Appends the code point of a \u escape as UTF-8, including the second
+    // half of a surrogate pair.
+    auto parse_escaped_code_point(std::string& p_string) -> bool
+    {
+        uint32_t code_point;
+        if (!parse_code_unit(code_point))
+        {
+            return false;
+        }
+
+        if (code_point >= 0xD800 && code_point < 0xDC00)
+        {
+            uint32_t low;
+            if (!consume("\\u") || !parse_code_unit(low) || low < 0xDC00 ||
+                low >= 0xE000)
+            {
+                return false;
+            }
+
+            code_point = 0x10000 + ((code_point - 0xD800) << 10) +
+                         (low - 0xDC00);
+        }
+        else if (code_point >= 0xDC00 && code_point < 0xE000)
+        {
+            return false;
+        }
+
+        if (code_point < 0x80)
+        {
+            p_string.push_back(static_cast<char>(code_point));
+        }
+        else if (code_point < 0x800)
+        {
+            p_string.push_back(static_cast<char>(0xC0 | (code_point >> 6)));
+            p_string.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+        }
+        else if (code_point < 0x10000)
+        {
+            p_string.push_back(static_cast<char>(0xE0 | (code_point >> 12)));
+            p_string.push_back(
+                static_cast<char>(0x80 | ((code_point >> 6) & 0x3F))
+            );
+            p_string.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+        }
+        else
+        {
+            p_string.push_back(static_cast<char>(0xF0 | (code_point >> 18)));
+            p_string.push_back(
+                static_cast<char>(0x80 | ((code_point >> 12) & 0x3F))
+            );
+            p_string.push_back(
+                static_cast<char>(0x80 | ((code_point >> 6) & 0x3F))
+            );
+            p_string.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+        }
+
+        return true;
+    }
+
+    auto parse_number(double& p_number) noexcept -> bool
+    {
+        // from_chars doesn't take a leading plus, which JSON doesn't allow
+        // either, or hex and infinities, which it does take.
+        const auto first = m_text.data() + m_position;
+        const auto last = m_text.data() + m_text.size();
+
+        const auto digits = first != last && *first == '-' ? first + 1 : first;
+        if (digits == last || *digits < '0' || *digits > '9')
+        {
+            return false;
+        }
+
+        const auto [end, error] = std::from_chars(
+            first, last, p_number, std::chars_format::general
+        );
+        if (error != std::errc{})
+        {
+            return false;
+        }
+
+        m_position += static_cast<size_t>(end - first);
+        return true;
+    }
+
+    std::string_view m_text;
+    size_t m_position;
+};
+
+} // namespace
+
+namespace vulkan_scene
+{
+
+auto parse_json(std::string_view p_text) noexcept
+    -> std::optional<json_value_t>
+{
+    try
+    {
+        return json_parser_t{p_text}.parse();
+    }
+    catch (const std::bad_alloc&)
+    {
+        return std::nullopt;
+    }
+}
+
+auto find_json_member(const json_value_t& p_object, std::string_view p_key)
+    -> const json_value_t*
+{
+    if (p_object.type != json_type_t::OBJECT)
+    {
+        return nullptr;
+    }
+
+    for (size_t i = 0; i < p_object.keys.size(); i++)
+    {
+        if (p_object.keys[i] == p_key)
+        {
+            return &p_object.elements[i];
+        }
+    }
+
+    return nullptr;
+}
+
+} // namespace vulkan_scene
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+namespace vulkan_scene
+{
+
+enum class json_type_t
+{
+    NULL_VALUE,
+    BOOLEAN,
+    NUMBER,
+    STRING,
+    ARRAY,
+    OBJECT,
+};
+
+// A parsed JSON document, which is small enough for the files we read (glTF
+// headers) to just copy around.
+struct json_value_t
+{
+    json_type_t type;
+
+    bool boolean;
+    double number;
+    std::string string;
+
+    // The elements of an array, or the values of an object.
+    std::vector<json_value_t> elements;
+
+    // The keys of an object, in the same order as their values.
+    std::vector<std::string> keys;
+};
+
+// Returns nothing if the text isn't valid JSON, or nests deeper than the
+// parser is willing to go.
+auto parse_json(std::string_view p_text) noexcept
+    -> std::optional<json_value_t>;
+
+// The value of a member of an object. Returns null if the value isn't an
+// object or doesn't have the member.
+auto find_json_member(const json_value_t& p_object, std::string_view p_key)
+    -> const json_value_t*;
+
+} // namespace vulkan_scene
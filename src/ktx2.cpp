@@ -0,0 +1,436 @@
+#include <cstring>
+
+#include <fstream>
+#include <numeric>
+
+#include "common.hpp"
+
+#include "ktx2.hpp"
+
+namespace
+{
+
+using vulkan_scene::align_up;
+using vulkan_scene::format_block_t;
+using vulkan_scene::print_error;
+
+constexpr std::array<uint8_t, 12> KTX2_IDENTIFIER{
+    0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A,
+};
+
+struct ktx2_header_t
+{
+    uint8_t identifier[12];
+    uint32_t vk_format;
+    uint32_t type_size;
+    uint32_t pixel_width;
+    uint32_t pixel_height;
+    uint32_t pixel_depth;
+    uint32_t layer_count;
+    uint32_t face_count;
+    uint32_t level_count;
+    uint32_t supercompression_scheme;
+
+    uint32_t dfd_byte_offset;
+    uint32_t dfd_byte_length;
+    uint32_t kvd_byte_offset;
+    uint32_t kvd_byte_length;
+    uint64_t sgd_byte_offset;
+    uint64_t sgd_byte_length;
+};
+
+static_assert(sizeof(ktx2_header_t) == 80);
+
+struct ktx2_level_index_t
+{
+    uint64_t byte_offset;
+    uint64_t byte_length;
+    uint64_t uncompressed_byte_length;
+};
+
+// Values from the Khronos Data Format Specification.
+constexpr uint32_t DFD_VERSION_1_3 = 2;
+constexpr uint32_t DFD_MODEL_RGBSDA = 1;
+constexpr uint32_t DFD_MODEL_BC1A = 128;
+constexpr uint32_t DFD_MODEL_BC7 = 134;
+constexpr uint32_t DFD_MODEL_ASTC = 162;
+constexpr uint32_t DFD_PRIMARIES_BT709 = 1;
+constexpr uint32_t DFD_TRANSFER_LINEAR = 1;
+constexpr uint32_t DFD_TRANSFER_SRGB = 2;
+constexpr uint32_t DFD_CHANNEL_ALPHA = 15;
+constexpr uint32_t DFD_SAMPLE_LINEAR = 0x40;
+
+auto is_srgb(VkFormat p_format) noexcept -> bool
+{
+    switch (p_format)
+    {
+    case VK_FORMAT_R8G8B8A8_SRGB:
+    case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+    case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+    case VK_FORMAT_BC7_SRGB_BLOCK:
+    case VK_FORMAT_ASTC_4x4_SRGB_BLOCK:
+        return true;
+    default:
+        return false;
+    }
+}
+
+auto make_dfd_sample(
+    uint32_t p_bit_offset,
+    uint32_t p_bit_length,
+    uint32_t p_channel,
+    uint32_t p_upper
+) noexcept -> std::array<uint32_t, 4>
+{
+    return {
+        p_bit_offset | ((p_bit_length - 1) << 16) | (p_channel << 24),
+        0,
+        0,
+        p_upper,
+    };
+}
+
+// Builds the basic data format descriptor that KTX2 requires, including the
+// leading total size.
+auto make_data_format_descriptor(
+    VkFormat p_format, const format_block_t& p_block
+) noexcept -> std::vector<uint32_t>
+{
+    const auto srgb = is_srgb(p_format);
+
+    uint32_t model;
+    std::vector<std::array<uint32_t, 4>> samples;
+
+    switch (p_format)
+    {
+    case VK_FORMAT_R8G8B8A8_UNORM:
+    case VK_FORMAT_R8G8B8A8_SRGB:
+        model = DFD_MODEL_RGBSDA;
+        samples = {
+            make_dfd_sample(0, 8, 0, 255),
+            make_dfd_sample(8, 8, 1, 255),
+            make_dfd_sample(16, 8, 2, 255),
+            // Alpha never goes through the transfer function.
+            make_dfd_sample(
+                24, 8, DFD_CHANNEL_ALPHA | (srgb ? DFD_SAMPLE_LINEAR : 0), 255
+            ),
+        };
+        break;
+    case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+    case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+        model = DFD_MODEL_BC1A;
+        samples = {make_dfd_sample(0, 64, 1, UINT32_MAX)};
+        break;
+    case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+    case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+        model = DFD_MODEL_BC1A;
+        samples = {make_dfd_sample(0, 64, 0, UINT32_MAX)};
+        break;
+    case VK_FORMAT_BC7_UNORM_BLOCK:
+    case VK_FORMAT_BC7_SRGB_BLOCK:
+        model = DFD_MODEL_BC7;
+        samples = {make_dfd_sample(0, 128, 0, UINT32_MAX)};
+        break;
+    default:
+        model = DFD_MODEL_ASTC;
+        samples = {make_dfd_sample(0, 128, 0, UINT32_MAX)};
+        break;
+    }
+
+    const auto block_size =
+        static_cast<uint32_t>(24 + samples.size() * 4 * sizeof(uint32_t));
+
+    std::vector<uint32_t> descriptor{
+        static_cast<uint32_t>(sizeof(uint32_t) + block_size),
+        // Khronos is vendor 0 and the basic descriptor is type 0.
+        0,
+        DFD_VERSION_1_3 | (block_size << 16),
+        model | (DFD_PRIMARIES_BT709 << 8) |
+            ((srgb ? DFD_TRANSFER_SRGB : DFD_TRANSFER_LINEAR) << 16),
+        (p_block.width - 1) | ((p_block.height - 1) << 8),
+        p_block.size,
+        0,
+    };
+
+    for (const auto& sample : samples)
+    {
+        descriptor.insert(descriptor.end(), sample.begin(), sample.end());
+    }
+
+    return descriptor;
+}
+
+auto read_file(std::string_view p_file_path) noexcept
+    -> std::optional<std::vector<uint8_t>>
+{
+    std::ifstream file_stream{
+        p_file_path.data(), std::ios::binary | std::ios::ate
+    };
+    if (!file_stream)
+    {
+        return std::nullopt;
+    }
+
+    std::vector<uint8_t> contents(static_cast<size_t>(file_stream.tellg()));
+    file_stream.seekg(0);
+    file_stream.read(reinterpret_cast<char*>(contents.data()), contents.size());
+
+    if (!file_stream)
+    {
+        return std::nullopt;
+    }
+
+    return contents;
+}
+
+} // namespace
+
+namespace vulkan_scene
+{
+
+auto get_format_block(VkFormat p_format) noexcept
+    -> std::optional<format_block_t>
+{
+    switch (p_format)
+    {
+    case VK_FORMAT_R8G8B8A8_UNORM:
+    case VK_FORMAT_R8G8B8A8_SRGB:
+        return format_block_t{.width = 1, .height = 1, .size = 4};
+    case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+    case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+    case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+    case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+        return format_block_t{.width = 4, .height = 4, .size = 8};
+    case VK_FORMAT_BC7_UNORM_BLOCK:
+    case VK_FORMAT_BC7_SRGB_BLOCK:
+    case VK_FORMAT_ASTC_4x4_UNORM_BLOCK:
+    case VK_FORMAT_ASTC_4x4_SRGB_BLOCK:
+        return format_block_t{.width = 4, .height = 4, .size = 16};
+    default:
+        return std::nullopt;
+    }
+}
+
+auto get_level_size(
+    const format_block_t& p_block, uint32_t p_width, uint32_t p_height
+) noexcept -> size_t
+{
+    // Partial blocks at the edges still take up a whole block.
+    const auto blocks_x = (p_width + p_block.width - 1) / p_block.width;
+    const auto blocks_y = (p_height + p_block.height - 1) / p_block.height;
+
+    return static_cast<size_t>(blocks_x) * blocks_y * p_block.size;
+}
+
+auto read_ktx2(std::string_view p_file_path) noexcept
+    -> kirho::result_t<ktx2_texture_t, kirho::empty_t>
+{
+    using result_t = kirho::result_t<ktx2_texture_t, kirho::empty_t>;
+
+    const auto contents = read_file(p_file_path);
+    if (!contents.has_value())
+    {
+        print_error("Failed to read ", p_file_path, '.');
+        return result_t::error(kirho::empty_t{});
+    }
+
+    ktx2_header_t header;
+    if (contents->size() < sizeof(header))
+    {
+        print_error(p_file_path, " is not a KTX2 file.");
+        return result_t::error(kirho::empty_t{});
+    }
+
+    std::memcpy(&header, contents->data(), sizeof(header));
+
+    if (!std::equal(
+            KTX2_IDENTIFIER.begin(), KTX2_IDENTIFIER.end(), header.identifier
+        ))
+    {
+        print_error(p_file_path, " is not a KTX2 file.");
+        return result_t::error(kirho::empty_t{});
+    }
+
+    const auto format = static_cast<VkFormat>(header.vk_format);
+    const auto block = get_format_block(format);
+    if (!block.has_value())
+    {
+        print_error(
+            p_file_path, " uses an unsupported format (", header.vk_format, ")."
+        );
+        return result_t::error(kirho::empty_t{});
+    }
+
+    if (header.supercompression_scheme != 0)
+    {
+        print_error(p_file_path, " is supercompressed, which isn't supported.");
+        return result_t::error(kirho::empty_t{});
+    }
+
+    if (header.pixel_width == 0 || header.pixel_height == 0 ||
+        header.pixel_depth > 1 || header.layer_count > 1 ||
+        header.face_count != 1)
+    {
+        print_error(p_file_path, " is not a plain 2D texture.");
+        return result_t::error(kirho::empty_t{});
+    }
+
+    // A level count of zero asks the loader to generate the mips, but the
+    // base level is still there.
+    const auto level_count = std::max(header.level_count, 1u);
+    if (level_count > mip_level_count(header.pixel_width, header.pixel_height))
+    {
+        print_error(p_file_path, " has too many mip levels.");
+        return result_t::error(kirho::empty_t{});
+    }
+
+    const auto level_index_size = level_count * sizeof(ktx2_level_index_t);
+    if (contents->size() < sizeof(header) + level_index_size)
+    {
+        print_error(p_file_path, " is truncated.");
+        return result_t::error(kirho::empty_t{});
+    }
+
+    std::vector<ktx2_level_index_t> level_index(level_count);
+    std::memcpy(
+        level_index.data(), contents->data() + sizeof(header), level_index_size
+    );
+
+    ktx2_texture_t texture{
+        .format = format,
+        .width = header.pixel_width,
+        .height = header.pixel_height,
+        .levels = {},
+        .data = {},
+    };
+
+    texture.levels.reserve(level_count);
+
+    size_t offset = 0;
+    for (uint32_t i = 0; i < level_count; i++)
+    {
+        const auto width = std::max(header.pixel_width >> i, 1u);
+        const auto height = std::max(header.pixel_height >> i, 1u);
+        const auto size = get_level_size(*block, width, height);
+
+        const auto& entry = level_index[i];
+        if (entry.byte_length < size || entry.byte_offset > contents->size() ||
+            contents->size() - entry.byte_offset < size)
+        {
+            print_error(p_file_path, " is truncated.");
+            return result_t::error(kirho::empty_t{});
+        }
+
+        offset = align_up(offset, KTX2_LEVEL_ALIGNMENT);
+        texture.levels.push_back(mip_level_t{
+            .width = width,
+            .height = height,
+            .offset = offset,
+            .size = size,
+        });
+        offset += size;
+    }
+
+    texture.data.resize(offset);
+    for (uint32_t i = 0; i < level_count; i++)
+    {
+        std::memcpy(
+            texture.data.data() + texture.levels[i].offset,
+            contents->data() + level_index[i].byte_offset,
+            texture.levels[i].size
+        );
+    }
+
+    return result_t::success(std::move(texture));
+}
+
+auto write_ktx2(
+    std::string_view p_file_path, const ktx2_texture_t& p_texture
+) noexcept -> kirho::result_t<kirho::empty_t, kirho::empty_t>
+{
+    using result_t = kirho::result_t<kirho::empty_t, kirho::empty_t>;
+
+    const auto block = get_format_block(p_texture.format);
+    if (!block.has_value() || p_texture.levels.empty())
+    {
+        print_error("Can't write ", p_file_path, " in this format.");
+        return result_t::error(kirho::empty_t{});
+    }
+
+    const auto descriptor =
+        make_data_format_descriptor(p_texture.format, *block);
+    const auto level_count = static_cast<uint32_t>(p_texture.levels.size());
+
+    const auto dfd_offset =
+        sizeof(ktx2_header_t) + level_count * sizeof(ktx2_level_index_t);
+    const auto dfd_size = descriptor.size() * sizeof(uint32_t);
+
+    const ktx2_header_t header{
+        .identifier = {},
+        .vk_format = static_cast<uint32_t>(p_texture.format),
+        .type_size = 1,
+        .pixel_width = p_texture.width,
+        .pixel_height = p_texture.height,
+        .pixel_depth = 0,
+        .layer_count = 0,
+        .face_count = 1,
+        .level_count = level_count,
+        .supercompression_scheme = 0,
+        .dfd_byte_offset = static_cast<uint32_t>(dfd_offset),
+        .dfd_byte_length = static_cast<uint32_t>(dfd_size),
+        .kvd_byte_offset = 0,
+        .kvd_byte_length = 0,
+        .sgd_byte_offset = 0,
+        .sgd_byte_length = 0,
+    };
+
+    std::vector<uint8_t> contents(dfd_offset + dfd_size);
+    std::memcpy(contents.data(), &header, sizeof(header));
+    std::memcpy(
+        contents.data(), KTX2_IDENTIFIER.data(), KTX2_IDENTIFIER.size()
+    );
+    std::memcpy(contents.data() + dfd_offset, descriptor.data(), dfd_size);
+
+    // The smallest level comes first in the file, and each one is aligned to
+    // both the block size and 4 bytes.
+    const auto level_alignment =
+        std::lcm(static_cast<size_t>(block->size), static_cast<size_t>(4));
+
+    for (auto i = level_count; i-- > 0;)
+    {
+        const auto& level = p_texture.levels[i];
+
+        const auto offset = align_up(contents.size(), level_alignment);
+        contents.resize(offset + level.size);
+        std::memcpy(
+            contents.data() + offset, p_texture.data.data() + level.offset,
+            level.size
+        );
+
+        const ktx2_level_index_t entry{
+            .byte_offset = offset,
+            .byte_length = level.size,
+            .uncompressed_byte_length = level.size,
+        };
+        std::memcpy(
+            contents.data() + sizeof(header) + i * sizeof(entry), &entry,
+            sizeof(entry)
+        );
+    }
+
+    std::ofstream file_stream{p_file_path.data(), std::ios::binary};
+    file_stream.write(
+        reinterpret_cast<const char*>(contents.data()), contents.size()
+    );
+    file_stream.close();
+
+    if (!file_stream)
+    {
+        print_error("Failed to write ", p_file_path, '.');
+        return result_t::error(kirho::empty_t{});
+    }
+
+    return result_t::success();
+}
+
+} // namespace vulkan_scene
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <string_view>
+
+#include <vulkan/vulkan.h>
+
+#include "mipmap.hpp"
+
+namespace vulkan_scene
+{
+
+// Everything within a KTX2 file that the renderer cares about. Only 2D
+// textures without supercompression are supported.
+struct ktx2_texture_t
+{
+    VkFormat format;
+    uint32_t width;
+    uint32_t height;
+
+    // Largest level first. The offsets point into data, and every level starts
+    // on a multiple of KTX2_LEVEL_ALIGNMENT so that it can be copied straight
+    // out of a staging buffer.
+    std::vector<mip_level_t> levels;
+    std::vector<uint8_t> data;
+};
+
+constexpr size_t KTX2_LEVEL_ALIGNMENT = 16;
+
+// The size of a block of texels in one of the formats that can be stored in a
+// KTX2 file. Uncompressed formats have 1x1 blocks.
+struct format_block_t
+{
+    uint32_t width;
+    uint32_t height;
+    uint32_t size;
+};
+
+// Returns nothing for formats that this module doesn't know about.
+auto get_format_block(VkFormat p_format) noexcept
+    -> std::optional<format_block_t>;
+
+// The number of bytes that a p_width by p_height level takes up in a format
+// with the given block size.
+auto get_level_size(
+    const format_block_t& p_block, uint32_t p_width, uint32_t p_height
+) noexcept -> size_t;
+
+auto read_ktx2(std::string_view p_file_path) noexcept
+    -> kirho::result_t<ktx2_texture_t, kirho::empty_t>;
+
+auto write_ktx2(
+    std::string_view p_file_path, const ktx2_texture_t& p_texture
+) noexcept -> kirho::result_t<kirho::empty_t, kirho::empty_t>;
+
+} // namespace vulkan_scene
@@ -1,7 +1,9 @@
+#include <cstddef>
 #include <cstdlib>
 #include <cstring>
 
 #include <algorithm>
+#include <chrono>
 #include <limits>
 #include <span>
 #include <string_view>
@@ -11,10 +13,28 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <vulkan/vulkan_core.h>
 
+#include "asset-loader.hpp"
+#include "benchmark.hpp"
 #include "common.hpp"
+#include "cpu-trace.hpp"
 #include "device.hpp"
+#include "draw-recorder.hpp"
+#include "frame.hpp"
+#include "geometry-arena.hpp"
+#include "gpu-culling.hpp"
+#include "gpu-profiler.hpp"
 #include "graphics.hpp"
+#include "mesh-loader.hpp"
+#include "mesh.hpp"
+#include "offscreen.hpp"
+#include "pipeline-cache.hpp"
+#include "pipeline-statistics.hpp"
+#include "scene.hpp"
 #include "swapchain.hpp"
+#include "texture-table.hpp"
+#include "thread-pool.hpp"
+#include "uniform-ring.hpp"
+#include "upload-queue.hpp"
 #include "window.hpp"
 
 namespace
@@ -29,11 +49,42 @@ struct uniform_buffer_t
 struct push_constants_t
 {
     glm::mat4 model;
+
+    // Only the shaders for packed vertices use these.
+    glm::vec4 position_offset;
+    glm::vec4 position_scale;
+
+    // Which slot of the texture table the fragment shader samples.
+    uint32_t texture_index;
 };
 
+// Where shaders/basic.frag expects it.
+static_assert(offsetof(push_constants_t, texture_index) == 96);
+
+// The fragment shader only reads the texture index, but every push overlaps
+// it, so every push has to name both stages.
+constexpr VkShaderStageFlags PUSH_CONSTANT_STAGES =
+    VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+
 constexpr uint16_t WINDOW_WIDTH = 1280;
 constexpr uint16_t WINDOW_HEIGHT = 720;
 
+constexpr uint32_t MAX_FRAMES_IN_FLIGHT = 8;
+
+// How many frames a headless run renders if --max-frames isn't given.
+constexpr uint64_t DEFAULT_HEADLESS_FRAMES = 300;
+
+// How much uniform data each frame can push into the uniform ring.
+constexpr VkDeviceSize UNIFORM_RING_FRAME_SIZE = 64 * 1024;
+
+// How often the rolling GPU timings get printed while the renderer runs.
+constexpr auto GPU_TIMING_REPORT_INTERVAL = std::chrono::seconds{1};
+
+constexpr const char* DEFAULT_TEXTURE_PATH = "textures/can-pooper.png";
+
+// How far the camera is from the closest point of a scene with a single cube.
+constexpr float CAMERA_MARGIN = 1.134f;
+
 auto create_set_layout(
     VkDevice p_device,
     std::span<const VkDescriptorSetLayoutBinding> p_layout_bindings,
@@ -135,10 +186,12 @@ struct device_t
     VkPhysicalDevice physical_device;
     uint32_t graphics_queue_family;
     uint32_t present_queue_family;
+    uint32_t transfer_queue_family;
 
     VkDevice device;
     VkQueue graphics_queue;
     VkQueue present_queue;
+    VkQueue transfer_queue;
 
     device_t(
         VkInstance p_instance,
@@ -147,22 +200,30 @@ struct device_t
         VkPhysicalDevice p_physical_device,
         uint32_t p_graphics_queue_family,
         uint32_t p_present_queue_family,
+        uint32_t p_transfer_queue_family,
         VkDevice p_device,
         VkQueue p_graphics_queue,
-        VkQueue p_present_queue
+        VkQueue p_present_queue,
+        VkQueue p_transfer_queue
     )
         : instance(p_instance), debug_messenger(p_debug_messenger),
           surface(p_surface), physical_device(p_physical_device),
           graphics_queue_family(p_graphics_queue_family),
-          present_queue_family(p_present_queue_family), device(p_device),
-          graphics_queue(p_graphics_queue), present_queue(p_present_queue)
+          present_queue_family(p_present_queue_family),
+          transfer_queue_family(p_transfer_queue_family), device(p_device),
+          graphics_queue(p_graphics_queue), present_queue(p_present_queue),
+          transfer_queue(p_transfer_queue)
     {
     }
 
+    // Pass a null window to create a device for headless rendering.
     static auto create(GLFWwindow* window, bool enable_validation) -> device_t
     {
+        const auto headless = window == nullptr;
+
         const auto instance =
-            vulkan_scene::create_vulkan_instance(enable_validation).unwrap();
+            vulkan_scene::create_vulkan_instance(enable_validation, !headless)
+                .unwrap();
 
         const auto debug_messenger =
             enable_validation
@@ -170,23 +231,34 @@ struct device_t
                 : VK_NULL_HANDLE;
 
         const auto surface =
-            vulkan_scene::create_surface(instance, window).unwrap();
+            headless ? VK_NULL_HANDLE
+                     : vulkan_scene::create_surface(instance, window).unwrap();
 
         const auto
-            [physical_device, graphics_queue_family, present_queue_family] =
+            [physical_device, graphics_queue_family, present_queue_family,
+             transfer_queue_family] =
                 vulkan_scene::choose_physical_device(instance, surface)
                     .unwrap();
 
-        const auto [device, graphics_queue, present_queue] =
+        const auto [device, graphics_queue, present_queue, transfer_queue] =
             vulkan_scene::create_logical_device(
-                physical_device, graphics_queue_family, present_queue_family
+                physical_device, graphics_queue_family, present_queue_family,
+                transfer_queue_family, !headless, true
             )
                 .unwrap();
 
         return device_t{
-            instance,        debug_messenger,       surface,
-            physical_device, graphics_queue_family, present_queue_family,
-            device,          graphics_queue,        present_queue,
+            instance,
+            debug_messenger,
+            surface,
+            physical_device,
+            graphics_queue_family,
+            present_queue_family,
+            transfer_queue_family,
+            device,
+            graphics_queue,
+            present_queue,
+            transfer_queue,
         };
     }
 
@@ -201,7 +273,11 @@ struct device_t
     ~device_t()
     {
         vkDestroyDevice(device, nullptr);
-        vkDestroySurfaceKHR(instance, surface, nullptr);
+
+        if (surface != VK_NULL_HANDLE)
+        {
+            vkDestroySurfaceKHR(instance, surface, nullptr);
+        }
 
         if (debug_messenger != VK_NULL_HANDLE)
         {
@@ -224,7 +300,7 @@ auto append_cube_face_to_mesh(
     bool p_negate,
     bool p_backface,
     std::vector<vulkan_scene::vertex_t>& p_vertices,
-    std::vector<uint16_t>& p_indices
+    std::vector<uint32_t>& p_indices
 ) -> void
 {
     const float values[][2]{
@@ -247,7 +323,7 @@ auto append_cube_face_to_mesh(
         {0.0f, 0.0f},
     };
 
-    const auto pivot_index = static_cast<uint16_t>(p_vertices.size());
+    const auto pivot_index = static_cast<uint32_t>(p_vertices.size());
 
     for (int i = 0; i < 4; i++)
     {
@@ -295,123 +371,400 @@ auto append_cube_face_to_mesh(
 auto main(int argc, char** argv) noexcept -> int
 {
     auto enable_validation = false;
+    auto headless = false;
+    auto frames_in_flight = vulkan_scene::DEFAULT_FRAMES_IN_FLIGHT;
+    auto max_frames = std::optional<uint64_t>();
+    auto output_path = std::optional<std::string_view>();
+    auto pipeline_cache_path = vulkan_scene::DEFAULT_PIPELINE_CACHE_PATH;
+    auto texture_paths = std::vector<std::string_view>();
+    auto generate_mips = true;
+    auto allow_compressed_textures = true;
+    auto trace_path = std::optional<std::string_view>();
+    auto benchmark = false;
+    auto benchmark_frames = static_cast<uint32_t>(0);
+    auto benchmark_report_path = vulkan_scene::DEFAULT_BENCHMARK_REPORT_PATH;
+    auto object_count = static_cast<uint32_t>(1);
+    auto draw_order = vulkan_scene::draw_order_t::FRONT_TO_BACK;
+    auto instanced = false;
+    auto gpu_culling = false;
+    auto record_threads = static_cast<uint32_t>(0);
+    auto mesh_path = std::optional<std::string_view>();
+    auto packed_vertices = false;
 
     for (const char* const* arg = argv; arg < argv + argc; arg++)
     {
+        const auto has_value = arg + 1 < argv + argc;
+
         if (std::strcmp(*arg, "--enable-validation") == 0)
         {
             enable_validation = true;
         }
+        else if (std::strcmp(*arg, "--frames-in-flight") == 0 && has_value)
+        {
+            arg++;
+            frames_in_flight = std::clamp(
+                static_cast<uint32_t>(std::strtoul(*arg, nullptr, 10)),
+                static_cast<uint32_t>(1), MAX_FRAMES_IN_FLIGHT
+            );
+        }
+        else if (std::strcmp(*arg, "--max-frames") == 0 && has_value)
+        {
+            arg++;
+            max_frames = std::strtoull(*arg, nullptr, 10);
+        }
+        else if (std::strcmp(*arg, "--headless") == 0)
+        {
+            headless = true;
+        }
+        else if (std::strcmp(*arg, "--output") == 0 && has_value)
+        {
+            arg++;
+            output_path = *arg;
+        }
+        else if (std::strcmp(*arg, "--pipeline-cache") == 0 && has_value)
+        {
+            arg++;
+            pipeline_cache_path = *arg;
+        }
+        else if (std::strcmp(*arg, "--texture") == 0 && has_value)
+        {
+            arg++;
+            texture_paths.push_back(*arg);
+        }
+        else if (std::strcmp(*arg, "--mesh") == 0 && has_value)
+        {
+            arg++;
+            mesh_path = *arg;
+        }
+        else if (std::strcmp(*arg, "--packed-vertices") == 0)
+        {
+            packed_vertices = true;
+        }
+        else if (std::strcmp(*arg, "--no-mipmaps") == 0)
+        {
+            generate_mips = false;
+        }
+        else if (std::strcmp(*arg, "--uncompressed-textures") == 0)
+        {
+            allow_compressed_textures = false;
+        }
+        else if (std::strcmp(*arg, "--benchmark") == 0 && has_value)
+        {
+            arg++;
+            benchmark = true;
+            benchmark_frames = std::max(
+                static_cast<uint32_t>(std::strtoul(*arg, nullptr, 10)), 1u
+            );
+            max_frames = benchmark_frames;
+        }
+        else if (std::strcmp(*arg, "--benchmark-report") == 0 && has_value)
+        {
+            arg++;
+            benchmark_report_path = *arg;
+        }
+        else if (std::strcmp(*arg, "--trace") == 0 && has_value)
+        {
+            arg++;
+            trace_path = *arg;
+        }
+        else if (std::strcmp(*arg, "--object-count") == 0 && has_value)
+        {
+            arg++;
+            object_count = std::max(
+                static_cast<uint32_t>(std::strtoul(*arg, nullptr, 10)), 1u
+            );
+        }
+        else if (std::strcmp(*arg, "--instanced") == 0)
+        {
+            instanced = true;
+        }
+        else if (std::strcmp(*arg, "--gpu-culling") == 0)
+        {
+            // The culled objects get drawn as instances.
+            gpu_culling = true;
+            instanced = true;
+        }
+        else if (std::strcmp(*arg, "--record-threads") == 0 && has_value)
+        {
+            arg++;
+            record_threads =
+                static_cast<uint32_t>(std::strtoul(*arg, nullptr, 10));
+        }
+        else if (std::strcmp(*arg, "--draw-order") == 0 && has_value)
+        {
+            arg++;
+
+            const auto order = vulkan_scene::parse_draw_order(*arg);
+            if (!order.has_value())
+            {
+                vulkan_scene::print_error("Unknown draw order ", *arg, '.');
+                return EXIT_FAILURE;
+            }
+
+            draw_order = *order;
+        }
+    }
+
+    if (headless && !max_frames.has_value())
+    {
+        max_frames = DEFAULT_HEADLESS_FRAMES;
+    }
+
+    if (trace_path.has_value())
+    {
+        vulkan_scene::enable_cpu_trace(true);
+        vulkan_scene::set_cpu_trace_thread_name("main");
     }
 
     const auto window =
-        vulkan_scene::create_window("Vulkan Scene", WINDOW_WIDTH, WINDOW_HEIGHT)
-            .unwrap();
+        headless ? nullptr
+                 : vulkan_scene::create_window(
+                       "Vulkan Scene", WINDOW_WIDTH, WINDOW_HEIGHT
+                   )
+                       .unwrap();
 
     const auto device = device_t::create(window, enable_validation);
 
-    const auto command_pool =
-        vulkan_scene::create_command_pool(device, device.graphics_queue_family)
-            .unwrap();
+    // Textures get decoded in the background while the rest of the setup,
+    // pipeline creation in particular, happens on this thread.
+    auto thread_pool = vulkan_scene::thread_pool_t{};
+    auto asset_loader = vulkan_scene::asset_loader_t{thread_pool};
+
+    if (texture_paths.empty())
+    {
+        texture_paths.push_back(DEFAULT_TEXTURE_PATH);
+    }
 
-    const auto main_command_buffer =
-        vulkan_scene::create_command_buffer(device, command_pool).unwrap();
+    const auto decode_options = vulkan_scene::get_image_decode_options(
+        device.physical_device, generate_mips, allow_compressed_textures
+    );
 
-    const auto fence = vulkan_scene::create_fence(device).unwrap();
+    for (const auto texture_path : texture_paths)
+    {
+        asset_loader.load_image(std::string{texture_path}, decode_options);
+    }
 
-    const auto image_available_semaphore =
-        vulkan_scene::create_semaphore(device).unwrap();
+    auto allocator =
+        vulkan_scene::memory_allocator_t{device.physical_device, device};
 
-    const auto render_done_semaphore =
-        vulkan_scene::create_semaphore(device).unwrap();
+    auto upload_queue =
+        vulkan_scene::create_upload_queue(
+            allocator, device, device.transfer_queue,
+            device.transfer_queue_family, device.graphics_queue,
+            device.graphics_queue_family
+        )
+            .unwrap();
 
-    auto swapchain =
-        vulkan_scene::create_swapchain(
-            device, device.physical_device, device.graphics_queue_family,
-            device.present_queue_family, window, device.surface
+    const auto frames =
+        vulkan_scene::create_frames(
+            device, device.graphics_queue_family, frames_in_flight
         )
             .unwrap();
 
+    // An instanced scene is a single draw, which isn't worth splitting up.
+    auto draw_recorder = std::optional<vulkan_scene::draw_recorder_t>();
+    if (record_threads > 0 && !instanced)
+    {
+        draw_recorder = vulkan_scene::create_draw_recorder(
+                            device, device.graphics_queue_family,
+                            record_threads, frames_in_flight
+        )
+                            .unwrap();
+    }
+
+    // In headless mode, there is no swapchain. We render into one offscreen
+    // target per frame in flight instead.
+    auto swapchain = vulkan_scene::swapchain_t{
+        .swapchain = VK_NULL_HANDLE,
+        .images = {},
+        .format = vulkan_scene::OFFSCREEN_FORMAT,
+        .extent = VkExtent2D{WINDOW_WIDTH, WINDOW_HEIGHT},
+    };
+
+    if (!headless)
+    {
+        swapchain = vulkan_scene::create_swapchain(
+                        device, device.physical_device,
+                        device.graphics_queue_family,
+                        device.present_queue_family, window, device.surface
+        )
+                        .unwrap();
+    }
+
     auto swapchain_image_views = vulkan_scene::create_image_views(
                                      device, swapchain.images, swapchain.format
     )
                                      .unwrap();
 
+    // Empty in headless mode, where nothing gets presented.
+    auto render_done_semaphores =
+        vulkan_scene::create_render_done_semaphores(
+            device, static_cast<uint32_t>(swapchain.images.size())
+        )
+            .unwrap();
+
+    const auto depth_format =
+        vulkan_scene::find_depth_format(device.physical_device).unwrap();
+
+    // The render pass makes each frame wait for the depth tests of the one
+    // before it, so one depth image is enough for all of the frames in flight.
+    auto depth_image = vulkan_scene::create_attachment_image(
+                           allocator, device, swapchain.extent, depth_format,
+                           VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT
+    )
+                           .unwrap();
+
     const auto render_pass =
-        vulkan_scene::create_render_pass(device, swapchain.format).unwrap();
+        vulkan_scene::create_render_pass(
+            device, swapchain.format, depth_format,
+            headless ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL
+                     : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR
+        )
+            .unwrap();
+
+    auto framebuffers = vulkan_scene::create_framebuffers(
+                            device, swapchain_image_views, depth_image.view,
+                            swapchain.extent, render_pass
+    )
+                            .unwrap();
+
+    const auto offscreen_targets =
+        headless ? vulkan_scene::create_offscreen_targets(
+                       allocator, device, swapchain.extent, render_pass,
+                       depth_image.view, frames_in_flight
+                   )
+                       .unwrap()
+                 : std::vector<vulkan_scene::offscreen_target_t>{};
+
+    auto pipeline_statistics =
+        vulkan_scene::create_pipeline_statistics(
+            device.physical_device, device, frames_in_flight,
+            draw_recorder.has_value()
+        )
+            .unwrap();
 
-    auto framebuffers =
-        vulkan_scene::create_framebuffers(
-            device, swapchain_image_views, swapchain.extent, render_pass
+    // Benchmarks report on every frame, not just the most recent ones.
+    auto gpu_profiler =
+        vulkan_scene::create_gpu_profiler(
+            device.physical_device, device, device.graphics_queue_family,
+            frames_in_flight,
+            benchmark ? benchmark_frames : vulkan_scene::GPU_PROFILER_WINDOW
         )
             .unwrap();
 
+    const auto frame_scope =
+        vulkan_scene::add_gpu_scope(gpu_profiler, "frame").unwrap();
+    const auto main_pass_scope =
+        vulkan_scene::add_gpu_scope(gpu_profiler, "main pass").unwrap();
+    const auto readback_scope =
+        vulkan_scene::add_gpu_scope(gpu_profiler, "readback").unwrap();
+    const auto culling_scope =
+        vulkan_scene::add_gpu_scope(gpu_profiler, "culling").unwrap();
+
+    const auto vertex_shader_path =
+        instanced ? (packed_vertices ? "shaders/instanced-packed.vert.spv"
+                                     : "shaders/instanced.vert.spv")
+                  : (packed_vertices ? "shaders/basic-packed.vert.spv"
+                                     : "shaders/basic.vert.spv");
+
     const auto vertex_shader_module =
-        vulkan_scene::create_shader_module(device, "shaders/basic.vert.spv")
+        vulkan_scene::create_shader_module(device, vertex_shader_path)
             .unwrap();
 
     const auto fragment_shader_module =
         vulkan_scene::create_shader_module(device, "shaders/basic.frag.spv")
             .unwrap();
 
+    const auto culling_shader_module =
+        gpu_culling ? vulkan_scene::create_shader_module(
+                          device, "shaders/cull.comp.spv"
+                      )
+                          .unwrap()
+                    : VK_NULL_HANDLE;
+
     const auto descriptor_set_layout =
         create_set_layout(
             device,
             std::array{
                 VkDescriptorSetLayoutBinding{
                     .binding = 0,
-                    .descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+                    .descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC,
                     .descriptorCount = 1,
                     .stageFlags = VK_SHADER_STAGE_VERTEX_BIT,
                     .pImmutableSamplers = nullptr,
                 },
-                VkDescriptorSetLayoutBinding{
-                    .binding = 1,
-                    .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
-                    .descriptorCount = 1,
-                    .stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT,
-                    .pImmutableSamplers = nullptr,
-                },
             },
             VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_SHADER_STAGE_VERTEX_BIT
         )
             .unwrap();
 
+    // Bindless, so that the draws pick their textures with an index instead
+    // of binding sets of their own.
+    auto texture_table =
+        vulkan_scene::create_texture_table(device.physical_device, device)
+            .unwrap();
+
     const auto push_constant_range = VkPushConstantRange{
-        .stageFlags = VK_SHADER_STAGE_VERTEX_BIT,
+        .stageFlags = PUSH_CONSTANT_STAGES,
         .offset = 0,
         .size = sizeof(push_constants_t),
     };
 
     const auto pipeline_layout = vulkan_scene::create_pipeline_layout(
-                                     device, std::array{descriptor_set_layout},
+                                     device,
+                                     std::array{
+                                         descriptor_set_layout,
+                                         texture_table.set_layout,
+                                     },
                                      std::array{push_constant_range}
     )
                                      .unwrap();
 
+    const auto pipeline_cache =
+        vulkan_scene::create_pipeline_cache(
+            device.physical_device, device, pipeline_cache_path
+        )
+            .unwrap();
+
+    const auto pipeline_creation_start = std::chrono::steady_clock::now();
+    vulkan_scene::cpu_trace_scope_t pipeline_trace{"create pipelines"};
+
     const auto graphics_pipeline =
         vulkan_scene::create_graphics_pipeline(
             device, render_pass, pipeline_layout, vertex_shader_module,
-            fragment_shader_module
+            fragment_shader_module, pipeline_cache.cache,
+            instanced ? vulkan_scene::vertex_layout_t::INSTANCED_MESH
+                      : vulkan_scene::vertex_layout_t::MESH,
+            packed_vertices ? vulkan_scene::vertex_format_t::PACKED
+                            : vulkan_scene::vertex_format_t::FULL
         )
             .unwrap();
 
+    pipeline_trace.end();
+
+    {
+        const auto pipeline_creation_time =
+            std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - pipeline_creation_start
+            )
+                .count();
+
+        std::cout << "[INFO]: Creating the pipelines took "
+                  << pipeline_creation_time << " ms ("
+                  << (pipeline_cache.loaded ? "warm" : "cold") << " cache).\n";
+    }
+
     uniform_buffer_t uniform_buffer_data{};
 
-    const auto uniform_buffer =
-        vulkan_scene::create_uniform_buffer(
-            device.physical_device, device, &uniform_buffer_data,
-            sizeof(uniform_buffer_data)
+    auto uniform_ring =
+        vulkan_scene::create_uniform_ring(
+            allocator, device, UNIFORM_RING_FRAME_SIZE, frames_in_flight
         )
             .unwrap();
 
     constexpr std::array descriptor_pool_sizes{
         VkDescriptorPoolSize{
-            .type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
-            .descriptorCount = 1,
-        },
-        VkDescriptorPoolSize{
-            .type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+            .type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC,
             .descriptorCount = 1,
         },
     };
@@ -470,39 +823,188 @@ auto main(int argc, char** argv) noexcept -> int
         },
     };
 #else
-    std::vector<vulkan_scene::vertex_t> vertices;
-    std::vector<uint16_t> indices;
-
-    append_cube_face_to_mesh(axis_t::Z, false, false, vertices, indices);
-    append_cube_face_to_mesh(axis_t::Z, true, true, vertices, indices);
-    append_cube_face_to_mesh(axis_t::X, true, false, vertices, indices);
-    append_cube_face_to_mesh(axis_t::X, false, true, vertices, indices);
-    append_cube_face_to_mesh(axis_t::Y, true, false, vertices, indices);
-    append_cube_face_to_mesh(axis_t::Y, false, true, vertices, indices);
+    vulkan_scene::mesh_t cube;
+    std::vector<uint8_t> cube_indices;
+
+    // Either points into the cache of the mesh file, or at the cube.
+    auto cached_mesh = std::optional<vulkan_scene::cached_mesh_t>();
+    std::span<const vulkan_scene::vertex_t> vertices;
+    auto index_type = VK_INDEX_TYPE_UINT16;
+    uint32_t index_count = 0;
+    const void* indices = nullptr;
+    std::vector<vulkan_scene::submesh_t> submeshes;
+
+    if (mesh_path.has_value())
+    {
+        const auto mesh_result = vulkan_scene::load_mesh(*mesh_path);
+        kirho::empty_t error;
+        if (mesh_result.is_error(error))
+        {
+            return EXIT_FAILURE;
+        }
+
+        cached_mesh = mesh_result.unwrap();
+
+        vertices = cached_mesh->vertices;
+        index_type = cached_mesh->index_type;
+        index_count = cached_mesh->index_count;
+        indices = cached_mesh->indices;
+        submeshes.assign(
+            cached_mesh->submeshes.begin(), cached_mesh->submeshes.end()
+        );
+    }
+    else
+    {
+        append_cube_face_to_mesh(
+            axis_t::Z, false, false, cube.vertices, cube.indices
+        );
+        append_cube_face_to_mesh(
+            axis_t::Z, true, true, cube.vertices, cube.indices
+        );
+        append_cube_face_to_mesh(
+            axis_t::X, true, false, cube.vertices, cube.indices
+        );
+        append_cube_face_to_mesh(
+            axis_t::X, false, true, cube.vertices, cube.indices
+        );
+        append_cube_face_to_mesh(
+            axis_t::Y, true, false, cube.vertices, cube.indices
+        );
+        append_cube_face_to_mesh(
+            axis_t::Y, false, true, cube.vertices, cube.indices
+        );
+
+        vulkan_scene::print_mesh_optimization_stats(
+            "the cube", vulkan_scene::optimize_mesh(cube)
+        );
+
+        submeshes = vulkan_scene::split_mesh(cube);
+        index_type = vulkan_scene::choose_index_type(cube.indices);
+        cube_indices = vulkan_scene::pack_indices(cube.indices, index_type);
+
+        vertices = cube.vertices;
+        index_count = static_cast<uint32_t>(cube.indices.size());
+        indices = cube_indices.data();
+    }
 #endif
 
-    const auto vertex_buffer =
-        vulkan_scene::create_buffer(
-            device.physical_device, device, device.graphics_queue, command_pool,
-            vulkan_scene::buffer_type_t::VERTEX, vertices.data(),
-            vertices.size() * sizeof(vulkan_scene::vertex_t)
+    // The cache keeps the full vertices, so the packing happens here.
+    auto quantization = vulkan_scene::vertex_quantization_t{
+        .offset = glm::vec3{0.0f},
+        .scale = glm::vec3{1.0f},
+    };
+    std::vector<vulkan_scene::packed_vertex_t> packed_vertex_data;
+
+    const void* vertex_data = vertices.data();
+    auto vertex_size = static_cast<uint32_t>(sizeof(vulkan_scene::vertex_t));
+
+    if (packed_vertices)
+    {
+        quantization = vulkan_scene::get_vertex_quantization(vertices);
+        packed_vertex_data =
+            vulkan_scene::pack_vertices(vertices, quantization);
+
+        vertex_data = packed_vertex_data.data();
+        vertex_size = sizeof(vulkan_scene::packed_vertex_t);
+    }
+
+    const auto vertex_count = static_cast<uint32_t>(vertices.size());
+
+    // Every mesh gets sub-allocated from the arena, so the draws never have to
+    // rebind the vertex or index buffer. With only the one mesh, the arena may
+    // as well use its index type.
+    auto geometry_arena =
+        vulkan_scene::create_geometry_arena(
+            allocator, device, upload_queue, vertex_size, index_type,
+            std::max(
+                vertex_count,
+                vulkan_scene::DEFAULT_GEOMETRY_ARENA_VERTEX_CAPACITY
+            ),
+            std::max(
+                index_count, vulkan_scene::DEFAULT_GEOMETRY_ARENA_INDEX_CAPACITY
+            )
         )
             .unwrap();
 
-    const auto index_buffer =
-        vulkan_scene::create_buffer(
-            device.physical_device, device, device.graphics_queue, command_pool,
-            vulkan_scene::buffer_type_t::INDEX, indices.data(),
-            sizeof(uint16_t) * indices.size()
+    const auto geometry =
+        vulkan_scene::add_geometry(
+            geometry_arena, upload_queue, vertex_data, vertex_count,
+            index_type, indices, index_count, submeshes
         )
             .unwrap();
 
-    const auto image =
-        vulkan_scene::create_image(
-            device.physical_device, device, device.graphics_queue, command_pool,
-            "textures/can-pooper.png"
+    // The mesh has been copied into the staging ring, so the cache can be
+    // unmapped already.
+    if (cached_mesh.has_value())
+    {
+        vulkan_scene::unload_mesh(*cached_mesh);
+    }
+
+    const auto scene = vulkan_scene::create_lattice_scene(object_count);
+
+    // With GPU culling, a compute shader writes the instances of the visible
+    // objects every frame, along with the draw command that draws them.
+    auto culling = std::optional<vulkan_scene::gpu_culling_t>();
+    if (gpu_culling)
+    {
+        culling = vulkan_scene::create_gpu_culling(
+                      allocator, device, upload_queue, culling_shader_module,
+                      pipeline_cache.cache, scene.objects,
+                      geometry.submeshes, frames_in_flight
         )
-            .unwrap();
+                      .unwrap();
+    }
+
+    // With instancing alone, the per-object transforms never change. The
+    // rotation of the whole scene is still pushed as a constant.
+    auto instance_buffer = std::optional<vulkan_scene::buffer_t>();
+    if (instanced && !gpu_culling)
+    {
+        std::vector<vulkan_scene::instance_t> instances;
+        instances.reserve(scene.objects.size());
+        for (const auto& object : scene.objects)
+        {
+            instances.push_back(vulkan_scene::instance_t{
+                .model = glm::translate(glm::mat4(1.0f), object.position),
+            });
+        }
+
+        instance_buffer =
+            vulkan_scene::create_buffer(
+                allocator, device, upload_queue,
+                vulkan_scene::buffer_type_t::VERTEX, instances.data(),
+                instances.size() * sizeof(vulkan_scene::instance_t)
+            )
+                .unwrap();
+    }
+
+    // Each image gets recorded into the upload queue as soon as it has been
+    // decoded, while the others may still be decoding.
+    std::vector<vulkan_scene::image_t> images(texture_paths.size());
+    vulkan_scene::cpu_trace_scope_t texture_trace{"upload textures"};
+    while (const auto loaded = asset_loader.next_image())
+    {
+        if (!loaded->image.has_value())
+        {
+            return EXIT_FAILURE;
+        }
+
+        images[loaded->index] =
+            vulkan_scene::create_image(
+                allocator, device, upload_queue, *loaded->image
+            )
+                .unwrap();
+    }
+
+    // All of the uploads above went into as few submissions as possible. They
+    // have to be done before the first frame uses them, though.
+    const auto upload_ticket =
+        vulkan_scene::flush_uploads(upload_queue).unwrap();
+    vulkan_scene::wait_for_upload(upload_queue, upload_ticket).unwrap();
+    texture_trace.end();
+
+    // By now every long-lived resource has been created.
+    allocator.print_stats();
 
     const auto sampler = vulkan_scene::create_sampler(
                              device, VK_FILTER_LINEAR, VK_FILTER_LINEAR, false
@@ -510,18 +1012,13 @@ auto main(int argc, char** argv) noexcept -> int
                              .unwrap();
 
     {
+        // The offset into the ring is supplied when the set gets bound.
         const VkDescriptorBufferInfo uniform_buffer_info{
-            .buffer = uniform_buffer.buffer,
+            .buffer = uniform_ring.buffer.buffer,
             .offset = 0,
             .range = sizeof(uniform_buffer_data),
         };
 
-        const VkDescriptorImageInfo image_info{
-            .sampler = sampler,
-            .imageView = image.view,
-            .imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-        };
-
         const VkWriteDescriptorSet set_write{
             .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
             .pNext = nullptr,
@@ -529,49 +1026,156 @@ auto main(int argc, char** argv) noexcept -> int
             .dstBinding = 0,
             .dstArrayElement = 0,
             .descriptorCount = 1,
-            .descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
-            .pImageInfo = &image_info,
+            .descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC,
+            .pImageInfo = nullptr,
             .pBufferInfo = &uniform_buffer_info,
             .pTexelBufferView = nullptr,
         };
 
-        const VkWriteDescriptorSet set_write_2{
-            .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-            .pNext = nullptr,
-            .dstSet = descriptor_set,
-            .dstBinding = 1,
-            .dstArrayElement = 0,
-            .descriptorCount = 1,
-            .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
-            .pImageInfo = &image_info,
-            .pBufferInfo = nullptr,
-            .pTexelBufferView = nullptr,
-        };
-
-        const std::array set_writes{set_write, set_write_2};
+        vkUpdateDescriptorSets(device, 1, &set_write, 0, nullptr);
+    }
 
-        vkUpdateDescriptorSets(
-            device, set_writes.size(), set_writes.data(), 0, nullptr
+    // Every texture gets a slot of the table. The objects take turns using
+    // them, so that consecutive draws sample different textures.
+    std::vector<uint32_t> texture_indices;
+    texture_indices.reserve(images.size());
+    for (const auto& image : images)
+    {
+        texture_indices.push_back(
+            vulkan_scene::add_texture(
+                device, texture_table, image.view, sampler
+            )
+                .unwrap()
         );
     }
 
     using vulkan_scene::print_error;
 
-    double delta_time = 0.0;
+    const auto recreate_swapchain = [&]() -> bool
+    {
+        const auto result = vkDeviceWaitIdle(device);
+        if (result != VK_SUCCESS)
+        {
+            print_error(
+                "Failed to wait for the device to complete all operations. "
+                "Vulkan error ",
+                result
+            );
+            return false;
+        }
+
+        std::for_each(
+            framebuffers.cbegin(), framebuffers.cend(),
+            [&device](VkFramebuffer fb)
+            { vkDestroyFramebuffer(device, fb, nullptr); }
+        );
+
+        std::for_each(
+            swapchain_image_views.cbegin(), swapchain_image_views.cend(),
+            [&device](VkImageView view)
+            { vkDestroyImageView(device, view, nullptr); }
+        );
 
-    push_constants_t push_constants{};
+        vulkan_scene::destroy_render_done_semaphores(
+            device, render_done_semaphores
+        );
+
+        vkDestroySwapchainKHR(device, swapchain.swapchain, nullptr);
+
+        vulkan_scene::destroy_image(device, allocator, depth_image);
+
+        swapchain = vulkan_scene::create_swapchain(
+                        device, device.physical_device,
+                        device.graphics_queue_family,
+                        device.present_queue_family, window, device.surface
+        )
+                        .unwrap();
+
+        swapchain_image_views = vulkan_scene::create_image_views(
+                                    device, swapchain.images, swapchain.format
+        )
+                                    .unwrap();
 
-    double old_cursor_x, old_cursor_y;
+        render_done_semaphores =
+            vulkan_scene::create_render_done_semaphores(
+                device, static_cast<uint32_t>(swapchain.images.size())
+            )
+                .unwrap();
+
+        depth_image = vulkan_scene::create_attachment_image(
+                          allocator, device, swapchain.extent, depth_format,
+                          VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT
+        )
+                          .unwrap();
+
+        framebuffers = vulkan_scene::create_framebuffers(
+                           device, swapchain_image_views, depth_image.view,
+                           swapchain.extent, render_pass
+        )
+                           .unwrap();
+
+        return true;
+    };
+
+    using clock = std::chrono::steady_clock;
+
+    double delta_time = 0.0;
+    double total_frame_time = 0.0;
+    double min_frame_time = std::numeric_limits<double>::max();
+    double max_frame_time = 0.0;
+
+    // Only benchmarks report every frame, and they stop after a fixed number
+    // of them. Otherwise, this would keep growing for as long as the scene
+    // runs.
+    std::vector<double> frame_times;
+    if (benchmark)
+    {
+        frame_times.reserve(benchmark_frames);
+    }
+    auto last_gpu_timing_report = clock::now();
+    double total_record_time = 0.0;
+    uint64_t frame_count = 0;
+    uint32_t frame_index = 0;
+
+    // Every push sends the quantization along with the model, so that the
+    // draws don't depend on what was pushed before them.
+    // Instanced draws use the first texture for every instance.
+    push_constants_t push_constants{
+        .model = glm::mat4{1.0f},
+        .position_offset = glm::vec4{quantization.offset, 0.0f},
+        .position_scale = glm::vec4{quantization.scale, 0.0f},
+        .texture_index = texture_indices.front(),
+    };
+
+    double old_cursor_x = 0.0, old_cursor_y = 0.0;
     bool first_frame = true;
 
     float total_x_rotation = 0.0f, total_y_rotation = 0.0f;
 
-    while (!glfwWindowShouldClose(window))
+    // F12 writes the trace while the renderer is running.
+    auto trace_key_was_pressed = false;
+
+    std::vector<vulkan_scene::draw_t> draws;
+
+    // Far enough away that the whole scene is in view.
+    const auto camera_distance = scene.radius + CAMERA_MARGIN;
+
+    while ((headless || !glfwWindowShouldClose(window)) &&
+           frame_count < max_frames.value_or(
+                             std::numeric_limits<uint64_t>::max()
+                         ))
     {
-        const double start_time = glfwGetTime();
+        const auto start_time = clock::now();
+        vulkan_scene::cpu_trace_scope_t frame_trace{"frame"};
+
+        const auto& frame = frames[frame_index];
+        const auto command_buffer = frame.command_buffer;
 
-        double cursor_x, cursor_y;
-        glfwGetCursorPos(window, &cursor_x, &cursor_y);
+        double cursor_x = 0.0, cursor_y = 0.0;
+        if (!headless)
+        {
+            glfwGetCursorPos(window, &cursor_x, &cursor_y);
+        }
 
         if (first_frame)
         {
@@ -583,79 +1187,58 @@ auto main(int argc, char** argv) noexcept -> int
 
         VkResult result;
 
-        uint32_t image_index;
-        result = vkAcquireNextImageKHR(
-            device, swapchain.swapchain, std::numeric_limits<uint64_t>::max(),
-            image_available_semaphore, VK_NULL_HANDLE, &image_index
+        // Only wait for the frame that last used this slot, the others can
+        // still be in flight.
+        vulkan_scene::cpu_trace_scope_t fence_trace{"wait for fence"};
+        vkWaitForFences(
+            device, 1, &frame.fence, VK_TRUE,
+            std::numeric_limits<uint64_t>::max()
+        );
+        fence_trace.end();
+
+        vulkan_scene::collect_pipeline_statistics(
+            device, pipeline_statistics, frame_index
         );
+        vulkan_scene::collect_gpu_timings(device, gpu_profiler, frame_index);
+
+        uint32_t image_index = 0;
+        vulkan_scene::cpu_trace_scope_t acquire_trace{"acquire image"};
+        result = headless ? VK_SUCCESS
+                          : vkAcquireNextImageKHR(
+                                device, swapchain.swapchain,
+                                std::numeric_limits<uint64_t>::max(),
+                                frame.image_available_semaphore,
+                                VK_NULL_HANDLE, &image_index
+                            );
+        acquire_trace.end();
 
         if (result == VK_ERROR_OUT_OF_DATE_KHR)
         {
-            const auto result = vkDeviceWaitIdle(device);
-            if (result != VK_SUCCESS)
+            if (!recreate_swapchain())
             {
-                print_error(
-                    "Failed to wait for the device to complete all "
-                    "operations. "
-                    "Vulkan error ",
-                    result
-                );
                 return EXIT_FAILURE;
             }
 
-            std::for_each(
-                framebuffers.cbegin(), framebuffers.cend(),
-                [&device](VkFramebuffer fb)
-                { vkDestroyFramebuffer(device, fb, nullptr); }
-            );
-
-            std::for_each(
-                swapchain_image_views.cbegin(), swapchain_image_views.cend(),
-                [&device](VkImageView view)
-                { vkDestroyImageView(device, view, nullptr); }
-            );
-
-            vkDestroySwapchainKHR(device, swapchain.swapchain, nullptr);
-
-            swapchain = vulkan_scene::create_swapchain(
-                            device, device.physical_device,
-                            device.graphics_queue_family,
-                            device.present_queue_family, window, device.surface
-            )
-                            .unwrap();
-
-            swapchain_image_views =
-                vulkan_scene::create_image_views(
-                    device, swapchain.images, swapchain.format
-                )
-                    .unwrap();
-
-            framebuffers =
-                vulkan_scene::create_framebuffers(
-                    device, swapchain_image_views, swapchain.extent, render_pass
-                )
-                    .unwrap();
-
             continue;
         }
 
-        vkWaitForFences(
-            device, 1, &fence, VK_TRUE, std::numeric_limits<uint64_t>::max()
-        );
-        vkResetFences(device, 1, &fence);
+        // The fence must only be reset once we know that we're actually going
+        // to submit work that signals it.
+        vkResetFences(device, 1, &frame.fence);
 
-        vkResetCommandBuffer(main_command_buffer, 0);
+        vulkan_scene::cpu_trace_scope_t record_trace{"record commands"};
+        const auto record_start_time = clock::now();
+        // The fence was waited on above, so nothing in the pool is in use.
+        vkResetCommandPool(device, frame.command_pool, 0);
 
         const VkCommandBufferBeginInfo command_buffer_begin_info{
             .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
             .pNext = nullptr,
-            .flags = 0,
+            .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
             .pInheritanceInfo = nullptr,
         };
 
-        result = vkBeginCommandBuffer(
-            main_command_buffer, &command_buffer_begin_info
-        );
+        result = vkBeginCommandBuffer(command_buffer, &command_buffer_begin_info);
         if (result != VK_SUCCESS)
         {
             print_error(
@@ -666,24 +1249,131 @@ auto main(int argc, char** argv) noexcept -> int
             return EXIT_FAILURE;
         }
 
-        const VkClearValue clear_value{
-            .color =
-                VkClearColorValue{
-                    .float32 =
-                        {
-                            0.0f,
-                            0.0f,
-                            0.0f,
-                            1.0f,
-                        },
-                },
+        vulkan_scene::begin_gpu_frame(
+            command_buffer, gpu_profiler, frame_index
+        );
+        vulkan_scene::begin_gpu_scope(
+            command_buffer, gpu_profiler, frame_index, frame_scope
+        );
+
+        vulkan_scene::cpu_trace_scope_t uniform_trace{"update uniforms"};
+
+        const auto aspect = static_cast<float>(swapchain.extent.width) /
+                            static_cast<float>(swapchain.extent.height);
+
+        // Benchmarks follow a script instead of the mouse, one fixed step per
+        // frame.
+        const auto benchmark_pose =
+            vulkan_scene::get_benchmark_pose(frame_count);
+
+        const auto distance =
+            benchmark ? camera_distance * benchmark_pose.distance_scale
+                      : camera_distance;
+
+        uniform_buffer_data.view = glm::mat4(1.0f);
+        uniform_buffer_data.view = glm::translate(
+            uniform_buffer_data.view, glm::vec3(0.0f, 0.0f, -distance)
+        );
+
+        uniform_buffer_data.projection = glm::perspective(
+            45.0f, aspect, 0.1f, std::max(100.0f, distance + scene.radius)
+        );
+
+        vulkan_scene::begin_uniform_frame(uniform_ring, frame_index);
+
+        const auto uniform_offset_result =
+            vulkan_scene::push_uniform(uniform_ring, uniform_buffer_data);
+        {
+            kirho::empty_t error;
+            if (uniform_offset_result.is_error(error))
+            {
+                return EXIT_FAILURE;
+            }
+        }
+        const auto uniform_offset = uniform_offset_result.unwrap();
+        uniform_trace.end();
+
+        // push_constants.color_shift = sin(glfwGetTime() * 2.0) / 2.0 +
+        // 0.5;
+        // push_constants.model = glm::rotate(
+        //     push_constants.model,
+        //     50.0f * static_cast<float>(glm::radians(glfwGetTime())),
+        //     glm::vec3(0.5f, 1.0f, 0.0f)
+        // );
+        auto rotation = glm::mat4(1.0);
+
+        if (!headless && !benchmark &&
+            glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_LEFT) == GLFW_PRESS)
+        {
+            const double delta_cursor_x = cursor_x - old_cursor_x;
+            const double delta_cursor_y = old_cursor_y - cursor_y;
+
+            total_x_rotation +=
+                static_cast<float>(glm::radians(delta_cursor_x * 2.0));
+            total_y_rotation +=
+                static_cast<float>(glm::radians(delta_cursor_y * 2.0));
+        }
+
+        rotation = glm::rotate(
+            rotation,
+            benchmark ? benchmark_pose.yaw
+                      : static_cast<float>(glm::radians(total_x_rotation)),
+            glm::vec3(0.0f, 1.0f, 0.0f)
+        );
+
+        rotation = glm::rotate(
+            rotation,
+            benchmark ? benchmark_pose.pitch
+                      : static_cast<float>(glm::radians(total_y_rotation)),
+            glm::vec3(1.0f, 0.0f, 0.0f)
+        );
+
+        if (culling.has_value())
+        {
+            vulkan_scene::begin_gpu_scope(
+                command_buffer, gpu_profiler, frame_index, culling_scope
+            );
+
+            vulkan_scene::record_gpu_culling(
+                command_buffer, *culling, frame_index,
+                uniform_buffer_data.projection * uniform_buffer_data.view *
+                    rotation
+            );
+
+            vulkan_scene::end_gpu_scope(
+                command_buffer, gpu_profiler, frame_index, culling_scope
+            );
+        }
+
+        const std::array clear_values{
+            VkClearValue{
+                .color =
+                    VkClearColorValue{
+                        .float32 =
+                            {
+                                0.0f,
+                                0.0f,
+                                0.0f,
+                                1.0f,
+                            },
+                    },
+            },
+            VkClearValue{
+                .depthStencil =
+                    VkClearDepthStencilValue{
+                        .depth = 1.0f,
+                        .stencil = 0,
+                    },
+            },
         };
 
         const VkRenderPassBeginInfo render_pass_begin_info{
             .sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO,
             .pNext = nullptr,
             .renderPass = render_pass,
-            .framebuffer = framebuffers.at(image_index),
+            .framebuffer = headless
+                               ? offscreen_targets.at(frame_index).framebuffer
+                               : framebuffers.at(image_index),
             .renderArea =
                 VkRect2D{
                     .offset =
@@ -693,122 +1383,245 @@ auto main(int argc, char** argv) noexcept -> int
                         },
                     .extent = swapchain.extent,
                 },
-            .clearValueCount = 1,
-            .pClearValues = &clear_value, // TODO
+            .clearValueCount = static_cast<uint32_t>(clear_values.size()),
+            .pClearValues = clear_values.data(),
         };
 
-        vkCmdBeginRenderPass(
-            main_command_buffer, &render_pass_begin_info,
-            VK_SUBPASS_CONTENTS_INLINE
+        vulkan_scene::begin_pipeline_statistics(
+            command_buffer, pipeline_statistics, frame_index
         );
-
-        vkCmdBindPipeline(
-            main_command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
-            graphics_pipeline
+        vulkan_scene::begin_gpu_scope(
+            command_buffer, gpu_profiler, frame_index, main_pass_scope
         );
 
-        const VkViewport viewport{
-            .x = 0.0f,
-            .y = 0.0f,
-            .width = static_cast<float>(swapchain.extent.width),
-            .height = static_cast<float>(swapchain.extent.height),
-            .minDepth = 0.0f,
-            .maxDepth = 1.0f,
-        };
+        // Secondary command buffers inherit nothing but the render pass, so
+        // each of them binds all of this again.
+        const auto bind_state = [&](VkCommandBuffer p_command_buffer)
+        {
+            vkCmdBindPipeline(
+                p_command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
+                graphics_pipeline
+            );
 
-        vkCmdSetViewport(main_command_buffer, 0, 1, &viewport);
+            const VkViewport viewport{
+                .x = 0.0f,
+                .y = 0.0f,
+                .width = static_cast<float>(swapchain.extent.width),
+                .height = static_cast<float>(swapchain.extent.height),
+                .minDepth = 0.0f,
+                .maxDepth = 1.0f,
+            };
 
-        const VkRect2D scissor{
-            .offset = VkOffset2D{.x = 0, .y = 0},
-            .extent = swapchain.extent,
-        };
+            vkCmdSetViewport(p_command_buffer, 0, 1, &viewport);
 
-        vkCmdSetScissor(main_command_buffer, 0, 1, &scissor);
+            const VkRect2D scissor{
+                .offset = VkOffset2D{.x = 0, .y = 0},
+                .extent = swapchain.extent,
+            };
 
-        const VkDeviceSize offset = 0;
-        vkCmdBindVertexBuffers(
-            main_command_buffer, 0, 1, &vertex_buffer.buffer, &offset
-        );
+            vkCmdSetScissor(p_command_buffer, 0, 1, &scissor);
 
-        vkCmdBindIndexBuffer(
-            main_command_buffer, index_buffer.buffer, 0, VK_INDEX_TYPE_UINT16
-        );
+            vulkan_scene::bind_geometry_arena(p_command_buffer, geometry_arena);
 
-        // vkCmdDraw(
-        //     main_command_buffer, static_cast<uint32_t>(vertices.size()),
-        //     1, 0, 0
-        // );
+            const std::array descriptor_sets{
+                descriptor_set, texture_table.descriptor_set
+            };
 
-        int screen_width, screen_height;
-        glfwGetFramebufferSize(window, &screen_width, &screen_height);
-        const auto aspect = static_cast<float>(screen_width) /
-                            static_cast<float>(screen_height);
+            vkCmdBindDescriptorSets(
+                p_command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
+                pipeline_layout, 0,
+                static_cast<uint32_t>(descriptor_sets.size()),
+                descriptor_sets.data(), 1, &uniform_offset
+            );
+        };
 
-        uniform_buffer_data.view = glm::mat4(1.0f);
-        uniform_buffer_data.view = glm::translate(
-            uniform_buffer_data.view, glm::vec3(0.0f, 0.0f, -2.0f)
-        );
+        // May run on several threads at once, each with its own range.
+        const auto record_object_draws = [&](VkCommandBuffer p_command_buffer,
+                                             uint32_t p_first_draw,
+                                             uint32_t p_draw_count)
+        {
+            auto draw_constants = push_constants;
 
-        uniform_buffer_data.projection =
-            glm::perspective(45.0f, aspect, 0.1f, 100.0f);
+            for (uint32_t i = p_first_draw; i < p_first_draw + p_draw_count;
+                 i++)
+            {
+                const auto object_index = draws[i].object_index;
 
-        uniform_buffer_t* uniform_buffer_ptr;
-        vkMapMemory(
-            device, uniform_buffer.memory, 0, sizeof(uniform_buffer_t), 0,
-            reinterpret_cast<void**>(&uniform_buffer_ptr)
-        );
+                draw_constants.model = glm::translate(
+                    rotation, scene.objects[object_index].position
+                );
+                draw_constants.texture_index =
+                    texture_indices[object_index % texture_indices.size()];
 
-        *uniform_buffer_ptr = uniform_buffer_data;
+                vkCmdPushConstants(
+                    p_command_buffer, pipeline_layout, PUSH_CONSTANT_STAGES, 0,
+                    sizeof(draw_constants), &draw_constants
+                );
 
-        vkUnmapMemory(device, uniform_buffer.memory);
+                for (const auto& submesh : geometry.submeshes)
+                {
+                    vkCmdDrawIndexed(
+                        p_command_buffer, submesh.index_count, 1,
+                        submesh.first_index, submesh.vertex_offset, 0
+                    );
+                }
+            }
+        };
 
-        vkCmdBindDescriptorSets(
-            main_command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
-            pipeline_layout, 0, 1, &descriptor_set, 0, nullptr
+        if (!instanced)
+        {
+            // The whole scene turns around the origin, so the draws have to be
+            // sorted again every frame.
+            vulkan_scene::sort_draws(
+                scene.objects, uniform_buffer_data.view * rotation, draw_order,
+                draws
+            );
+        }
+
+        vkCmdBeginRenderPass(
+            command_buffer, &render_pass_begin_info,
+            draw_recorder.has_value()
+                ? VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS
+                : VK_SUBPASS_CONTENTS_INLINE
         );
 
-        // push_constants.color_shift = sin(glfwGetTime() * 2.0) / 2.0 +
-        // 0.5;
-        // push_constants.model = glm::rotate(
-        //     push_constants.model,
-        //     50.0f * static_cast<float>(glm::radians(glfwGetTime())),
-        //     glm::vec3(0.5f, 1.0f, 0.0f)
-        // );
-        push_constants.model = glm::mat4(1.0);
+        if (draw_recorder.has_value())
+        {
+            // The fragment invocations of the secondaries still have to be
+            // counted by the query that the primary began. There is no query
+            // if the device can't inherit it, and then the flags are zero.
+            const VkCommandBufferInheritanceInfo inheritance_info{
+                .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO,
+                .pNext = nullptr,
+                .renderPass = render_pass,
+                .subpass = 0,
+                .framebuffer = render_pass_begin_info.framebuffer,
+                .occlusionQueryEnable = VK_FALSE,
+                .queryFlags = 0,
+                .pipelineStatistics =
+                    vulkan_scene::get_pipeline_statistic_flags(
+                        pipeline_statistics
+                    ),
+            };
+
+            const auto secondary_result = vulkan_scene::record_draws(
+                device, *draw_recorder, thread_pool, frame_index,
+                inheritance_info, static_cast<uint32_t>(draws.size()),
+                [&](VkCommandBuffer p_command_buffer,
+                    uint32_t p_first_draw,
+                    uint32_t p_draw_count)
+                {
+                    bind_state(p_command_buffer);
+                    record_object_draws(
+                        p_command_buffer, p_first_draw, p_draw_count
+                    );
+                }
+            );
+            {
+                VkResult error;
+                if (secondary_result.is_error(error))
+                {
+                    return EXIT_FAILURE;
+                }
+            }
 
-        if (glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_LEFT) == GLFW_PRESS)
+            const auto secondary_command_buffers = secondary_result.unwrap();
+            vkCmdExecuteCommands(
+                command_buffer,
+                static_cast<uint32_t>(secondary_command_buffers.size()),
+                secondary_command_buffers.data()
+            );
+        }
+        else if (instanced)
         {
-            const double delta_cursor_x = cursor_x - old_cursor_x;
-            const double delta_cursor_y = old_cursor_y - cursor_y;
+            bind_state(command_buffer);
 
-            total_x_rotation +=
-                static_cast<float>(glm::radians(delta_cursor_x * 2.0));
-            total_y_rotation +=
-                static_cast<float>(glm::radians(delta_cursor_y * 2.0));
+            // The instances stay in lattice order, since sorting them would
+            // mean rewriting the instance buffer every frame.
+            push_constants.model = rotation;
+
+            vkCmdPushConstants(
+                command_buffer, pipeline_layout, PUSH_CONSTANT_STAGES, 0,
+                sizeof(push_constants), &push_constants
+            );
+
+            const VkDeviceSize offset = 0;
+
+            if (culling.has_value())
+            {
+                // Only the culling shader knows how many instances there are.
+                const auto& culling_frame = culling->frames[frame_index];
+
+                vkCmdBindVertexBuffers(
+                    command_buffer, 1, 1, &culling_frame.instances.buffer,
+                    &offset
+                );
+
+                // One at a time, since drawing several at once needs the
+                // multiDrawIndirect feature.
+                for (size_t i = 0; i < geometry.submeshes.size(); i++)
+                {
+                    vkCmdDrawIndexedIndirect(
+                        command_buffer, culling_frame.draw_commands.buffer,
+                        i * sizeof(VkDrawIndexedIndirectCommand), 1,
+                        sizeof(VkDrawIndexedIndirectCommand)
+                    );
+                }
+            }
+            else
+            {
+                vkCmdBindVertexBuffers(
+                    command_buffer, 1, 1, &instance_buffer->buffer, &offset
+                );
+
+                for (const auto& submesh : geometry.submeshes)
+                {
+                    vkCmdDrawIndexed(
+                        command_buffer, submesh.index_count,
+                        static_cast<uint32_t>(scene.objects.size()),
+                        submesh.first_index, submesh.vertex_offset, 0
+                    );
+                }
+            }
+        }
+        else
+        {
+            bind_state(command_buffer);
+            record_object_draws(
+                command_buffer, 0, static_cast<uint32_t>(draws.size())
+            );
         }
 
-        push_constants.model = glm::rotate(
-            push_constants.model,
-            static_cast<float>(glm::radians(total_x_rotation)),
-            glm::vec3(0.0f, 1.0f, 0.0f)
-        );
+        vkCmdEndRenderPass(command_buffer);
 
-        push_constants.model = glm::rotate(
-            push_constants.model,
-            static_cast<float>(glm::radians(total_y_rotation)),
-            glm::vec3(1.0f, 0.0f, 0.0f)
+        vulkan_scene::end_gpu_scope(
+            command_buffer, gpu_profiler, frame_index, main_pass_scope
         );
-
-        vkCmdPushConstants(
-            main_command_buffer, pipeline_layout, VK_SHADER_STAGE_VERTEX_BIT, 0,
-            sizeof(push_constants), &push_constants
+        vulkan_scene::end_pipeline_statistics(
+            command_buffer, pipeline_statistics, frame_index
         );
 
-        vkCmdDrawIndexed(main_command_buffer, indices.size(), 1, 0, 0, 0);
+        if (headless)
+        {
+            vulkan_scene::begin_gpu_scope(
+                command_buffer, gpu_profiler, frame_index, readback_scope
+            );
+
+            vulkan_scene::record_readback(
+                command_buffer, offscreen_targets.at(frame_index),
+                swapchain.extent
+            );
+
+            vulkan_scene::end_gpu_scope(
+                command_buffer, gpu_profiler, frame_index, readback_scope
+            );
+        }
 
-        vkCmdEndRenderPass(main_command_buffer);
+        vulkan_scene::end_gpu_scope(
+            command_buffer, gpu_profiler, frame_index, frame_scope
+        );
 
-        result = vkEndCommandBuffer(main_command_buffer);
+        result = vkEndCommandBuffer(command_buffer);
         if (result != VK_SUCCESS)
         {
             print_error(
@@ -819,22 +1632,33 @@ auto main(int argc, char** argv) noexcept -> int
             return EXIT_FAILURE;
         }
 
+        record_trace.end();
+        total_record_time +=
+            std::chrono::duration<double>(clock::now() - record_start_time)
+                .count();
+
         VkPipelineStageFlags wait_stage =
             VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
 
+        const auto render_done_semaphore =
+            headless ? VK_NULL_HANDLE : render_done_semaphores.at(image_index);
+
         const VkSubmitInfo submit_info{
             .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
             .pNext = nullptr,
-            .waitSemaphoreCount = 1,
-            .pWaitSemaphores = &image_available_semaphore,
+            .waitSemaphoreCount = headless ? 0u : 1u,
+            .pWaitSemaphores = &frame.image_available_semaphore,
             .pWaitDstStageMask = &wait_stage,
             .commandBufferCount = 1,
-            .pCommandBuffers = &main_command_buffer,
-            .signalSemaphoreCount = 1,
+            .pCommandBuffers = &command_buffer,
+            .signalSemaphoreCount = headless ? 0u : 1u,
             .pSignalSemaphores = &render_done_semaphore,
         };
 
-        result = vkQueueSubmit(device.graphics_queue, 1, &submit_info, fence);
+        vulkan_scene::cpu_trace_scope_t submit_trace{"submit"};
+        result =
+            vkQueueSubmit(device.graphics_queue, 1, &submit_info, frame.fence);
+        submit_trace.end();
         if (result != VK_SUCCESS)
         {
             print_error(
@@ -857,53 +1681,17 @@ auto main(int argc, char** argv) noexcept -> int
             .pResults = nullptr,
         };
 
-        result = vkQueuePresentKHR(device.present_queue, &present_info);
+        vulkan_scene::cpu_trace_scope_t present_trace{"present"};
+        result = headless
+                     ? VK_SUCCESS
+                     : vkQueuePresentKHR(device.present_queue, &present_info);
+        present_trace.end();
         if (result == VK_ERROR_OUT_OF_DATE_KHR)
         {
-            const auto result = vkDeviceWaitIdle(device);
-            if (result != VK_SUCCESS)
+            if (!recreate_swapchain())
             {
-                print_error(
-                    "Failed to wait for the device to complete all "
-                    "operations. "
-                    "Vulkan error ",
-                    result
-                );
                 return EXIT_FAILURE;
             }
-
-            std::for_each(
-                framebuffers.cbegin(), framebuffers.cend(),
-                [&device](VkFramebuffer fb)
-                { vkDestroyFramebuffer(device, fb, nullptr); }
-            );
-
-            std::for_each(
-                swapchain_image_views.cbegin(), swapchain_image_views.cend(),
-                [&device](VkImageView view)
-                { vkDestroyImageView(device, view, nullptr); }
-            );
-
-            vkDestroySwapchainKHR(device, swapchain.swapchain, nullptr);
-
-            swapchain = vulkan_scene::create_swapchain(
-                            device, device.physical_device,
-                            device.graphics_queue_family,
-                            device.present_queue_family, window, device.surface
-            )
-                            .unwrap();
-
-            swapchain_image_views =
-                vulkan_scene::create_image_views(
-                    device, swapchain.images, swapchain.format
-                )
-                    .unwrap();
-
-            framebuffers =
-                vulkan_scene::create_framebuffers(
-                    device, swapchain_image_views, swapchain.extent, render_pass
-                )
-                    .unwrap();
         }
         else if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR)
         {
@@ -914,44 +1702,177 @@ auto main(int argc, char** argv) noexcept -> int
             return EXIT_FAILURE;
         }
 
-        glfwPollEvents();
+        if (!headless)
+        {
+            vulkan_scene::cpu_trace_scope_t events_trace{"poll events"};
+            glfwPollEvents();
+            events_trace.end();
+
+            const auto trace_key_pressed =
+                glfwGetKey(window, GLFW_KEY_F12) == GLFW_PRESS;
+            if (trace_key_pressed && !trace_key_was_pressed &&
+                trace_path.has_value())
+            {
+                vulkan_scene::write_cpu_trace(trace_path.value());
+            }
+            trace_key_was_pressed = trace_key_pressed;
+        }
 
         old_cursor_x = cursor_x;
         old_cursor_y = cursor_y;
 
-        const double end_time = glfwGetTime();
-        delta_time = end_time - start_time;
+        frame_index = (frame_index + 1) % frames_in_flight;
+
+        const auto end_time = clock::now();
+        delta_time =
+            std::chrono::duration<double>(end_time - start_time).count();
         const double framerate = 1.0 / delta_time;
 
+        total_frame_time += delta_time;
+        min_frame_time = std::min(min_frame_time, delta_time);
+        max_frame_time = std::max(max_frame_time, delta_time);
+        if (benchmark)
+        {
+            frame_times.push_back(delta_time);
+        }
+        frame_count++;
+
         std::cout << "[INFO]: Framerate: " << framerate << "\r";
+
+        if (end_time - last_gpu_timing_report >= GPU_TIMING_REPORT_INTERVAL)
+        {
+            std::cout << '\n';
+            vulkan_scene::print_gpu_timings(gpu_profiler);
+            last_gpu_timing_report = end_time;
+        }
     }
 
     vkDeviceWaitIdle(device);
 
+    for (uint32_t i = 0; i < frames_in_flight; i++)
+    {
+        vulkan_scene::collect_pipeline_statistics(
+            device, pipeline_statistics, i
+        );
+        vulkan_scene::collect_gpu_timings(device, gpu_profiler, i);
+    }
+
+    if (frame_count > 0)
+    {
+        std::cout << "\n[INFO]: Rendered " << frame_count << " frames with "
+                  << frames_in_flight << " frame(s) in flight. Frame time "
+                  << "(min/avg/max): " << min_frame_time * 1000.0 << '/'
+                  << total_frame_time * 1000.0 / frame_count << '/'
+                  << max_frame_time * 1000.0 << " ms.\n";
+
+        std::cout << "[INFO]: Recording the commands took "
+                  << total_record_time * 1000.0 / frame_count
+                  << " ms per frame on average ("
+                  << (draw_recorder.has_value() ? record_threads : 1)
+                  << " thread(s)).\n";
+
+        vulkan_scene::print_pipeline_statistics(
+            pipeline_statistics, swapchain.extent
+        );
+        vulkan_scene::print_gpu_timings(gpu_profiler);
+    }
+
+    if (benchmark && frame_count > 0)
+    {
+        VkPhysicalDeviceProperties properties;
+        vkGetPhysicalDeviceProperties(device.physical_device, &properties);
+
+        std::vector<double> frame_times_ms;
+        frame_times_ms.reserve(frame_times.size());
+        for (const auto time : frame_times)
+        {
+            frame_times_ms.push_back(time * 1000.0);
+        }
+
+        vulkan_scene::write_benchmark_report(
+            benchmark_report_path,
+            vulkan_scene::benchmark_info_t{
+                .device_name = properties.deviceName,
+                .extent = swapchain.extent,
+                .frames_in_flight = frames_in_flight,
+                .object_count = object_count,
+            },
+            frame_times_ms, gpu_profiler
+        );
+    }
+
+    if (headless && output_path.has_value() && frame_count > 0)
+    {
+        // The frame before frame_index is the last one that was rendered.
+        const auto last_frame_index =
+            (frame_index + frames_in_flight - 1) % frames_in_flight;
+
+        vulkan_scene::write_readback_to_file(
+            offscreen_targets.at(last_frame_index), swapchain.extent,
+            output_path.value()
+        );
+    }
+
+    if (trace_path.has_value())
+    {
+        vulkan_scene::write_cpu_trace(trace_path.value());
+    }
+
     vkDestroySampler(device, sampler, nullptr);
-    vulkan_scene::destroy_image(device, image);
-    vulkan_scene::destroy_buffer(device, index_buffer);
-    vulkan_scene::destroy_buffer(device, vertex_buffer);
+    for (const auto& texture : images)
+    {
+        vulkan_scene::destroy_image(device, allocator, texture);
+    }
+    if (instance_buffer.has_value())
+    {
+        vulkan_scene::destroy_buffer(device, allocator, *instance_buffer);
+    }
+    if (culling.has_value())
+    {
+        vulkan_scene::destroy_gpu_culling(device, allocator, *culling);
+    }
+    vulkan_scene::destroy_geometry_arena(device, allocator, geometry_arena);
     vkDestroyDescriptorPool(device, descriptor_pool, nullptr);
-    vulkan_scene::destroy_buffer(device, uniform_buffer);
+    vulkan_scene::destroy_texture_table(device, texture_table);
+    vulkan_scene::destroy_uniform_ring(device, allocator, uniform_ring);
     vkDestroyPipeline(device, graphics_pipeline, nullptr);
+    vulkan_scene::save_pipeline_cache(
+        device.physical_device, device, pipeline_cache.cache,
+        pipeline_cache_path
+    );
+    vkDestroyPipelineCache(device, pipeline_cache.cache, nullptr);
     vkDestroyPipelineLayout(device, pipeline_layout, nullptr);
     vkDestroyDescriptorSetLayout(device, descriptor_set_layout, nullptr);
+    vkDestroyShaderModule(device, culling_shader_module, nullptr);
     vkDestroyShaderModule(device, fragment_shader_module, nullptr);
     vkDestroyShaderModule(device, vertex_shader_module, nullptr);
     for (const auto buffer : framebuffers)
         vkDestroyFramebuffer(device, buffer, nullptr);
     vkDestroyRenderPass(device, render_pass, nullptr);
+    vulkan_scene::destroy_gpu_profiler(device, gpu_profiler);
+    vulkan_scene::destroy_pipeline_statistics(device, pipeline_statistics);
+    vulkan_scene::destroy_offscreen_targets(
+        device, allocator, offscreen_targets
+    );
+    vulkan_scene::destroy_image(device, allocator, depth_image);
     for (const auto view : swapchain_image_views)
         vkDestroyImageView(device, view, nullptr);
-    vkDestroySwapchainKHR(device, swapchain.swapchain, nullptr);
-    vkDestroySemaphore(device, render_done_semaphore, nullptr);
-    vkDestroySemaphore(device, image_available_semaphore, nullptr);
-    vkDestroyFence(device, fence, nullptr);
-    vkFreeCommandBuffers(device, command_pool, 1, &main_command_buffer);
-    vkDestroyCommandPool(device, command_pool, nullptr);
-
-    vulkan_scene::destroy_window(window);
+    vulkan_scene::destroy_render_done_semaphores(
+        device, render_done_semaphores
+    );
+    if (swapchain.swapchain != VK_NULL_HANDLE)
+        vkDestroySwapchainKHR(device, swapchain.swapchain, nullptr);
+    if (draw_recorder.has_value())
+    {
+        vulkan_scene::destroy_draw_recorder(device, *draw_recorder);
+    }
+    vulkan_scene::destroy_frames(device, frames);
+    vulkan_scene::destroy_upload_queue(upload_queue);
+
+    if (window != nullptr)
+    {
+        vulkan_scene::destroy_window(window);
+    }
 
     return 0;
 }
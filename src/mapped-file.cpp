@@ -0,0 +1,152 @@
+#include <string>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "common.hpp"
+
+#include "mapped-file.hpp"
+
+namespace vulkan_scene
+{
+
+#ifdef _WIN32
+
+auto map_file(std::string_view p_file_path) noexcept
+    -> kirho::result_t<mapped_file_t, kirho::empty_t>
+{
+    using result_t = kirho::result_t<mapped_file_t, kirho::empty_t>;
+
+    const std::string file_path{p_file_path};
+
+    const auto file = CreateFileA(
+        file_path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+        OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr
+    );
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        print_error("Failed to open ", p_file_path, '.');
+        return result_t::error(kirho::empty_t{});
+    }
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size))
+    {
+        print_error("Failed to get the size of ", p_file_path, '.');
+        CloseHandle(file);
+        return result_t::error(kirho::empty_t{});
+    }
+
+    // Empty files can't be mapped.
+    if (size.QuadPart == 0)
+    {
+        CloseHandle(file);
+        return result_t::success(mapped_file_t{.data = nullptr, .size = 0});
+    }
+
+    // The view keeps the file and the mapping alive on its own.
+    const auto mapping =
+        CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+
+    if (mapping == nullptr)
+    {
+        print_error("Failed to map ", p_file_path, '.');
+        return result_t::error(kirho::empty_t{});
+    }
+
+    const auto data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+
+    if (data == nullptr)
+    {
+        print_error("Failed to map ", p_file_path, '.');
+        return result_t::error(kirho::empty_t{});
+    }
+
+    return result_t::success(mapped_file_t{
+        .data = static_cast<const uint8_t*>(data),
+        .size = static_cast<size_t>(size.QuadPart),
+    });
+}
+
+auto unmap_file(const mapped_file_t& p_file) noexcept -> void
+{
+    if (p_file.data != nullptr)
+    {
+        UnmapViewOfFile(p_file.data);
+    }
+}
+
+#else
+
+auto map_file(std::string_view p_file_path) noexcept
+    -> kirho::result_t<mapped_file_t, kirho::empty_t>
+{
+    using result_t = kirho::result_t<mapped_file_t, kirho::empty_t>;
+
+    const std::string file_path{p_file_path};
+
+    const auto file = open(file_path.c_str(), O_RDONLY);
+    if (file < 0)
+    {
+        print_error("Failed to open ", p_file_path, '.');
+        return result_t::error(kirho::empty_t{});
+    }
+
+    struct stat status;
+    if (fstat(file, &status) != 0)
+    {
+        print_error("Failed to get the size of ", p_file_path, '.');
+        close(file);
+        return result_t::error(kirho::empty_t{});
+    }
+
+    const auto size = static_cast<size_t>(status.st_size);
+
+    // Empty files can't be mapped.
+    if (size == 0)
+    {
+        close(file);
+        return result_t::success(mapped_file_t{.data = nullptr, .size = 0});
+    }
+
+    // The mapping keeps the file alive on its own.
+    const auto data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file, 0);
+    close(file);
+
+    if (data == MAP_FAILED)
+    {
+        print_error("Failed to map ", p_file_path, '.');
+        return result_t::error(kirho::empty_t{});
+    }
+
+    // Files get mapped to be copied out from start to end, so the kernel can
+    // read ahead aggressively.
+    posix_madvise(data, size, POSIX_MADV_SEQUENTIAL);
+
+    return result_t::success(mapped_file_t{
+        .data = static_cast<const uint8_t*>(data),
+        .size = size,
+    });
+}
+
+auto unmap_file(const mapped_file_t& p_file) noexcept -> void
+{
+    if (p_file.data != nullptr)
+    {
+        munmap(const_cast<uint8_t*>(p_file.data), p_file.size);
+    }
+}
+
+#endif
+
+} // namespace vulkan_scene
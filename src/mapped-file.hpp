@@ -0,0 +1,22 @@
+#pragma once
+
+#include <string_view>
+
+namespace vulkan_scene
+{
+
+// A read-only view of a whole file. The OS only reads pages in once they are
+// touched, and nothing gets copied into a buffer of our own along the way.
+struct mapped_file_t
+{
+    // Null for empty files.
+    const uint8_t* data;
+    size_t size;
+};
+
+auto map_file(std::string_view p_file_path) noexcept
+    -> kirho::result_t<mapped_file_t, kirho::empty_t>;
+
+auto unmap_file(const mapped_file_t& p_file) noexcept -> void;
+
+} // namespace vulkan_scene
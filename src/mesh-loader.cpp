@@ -0,0 +1,1529 @@
+#include <cctype>
+#include <cmath>
+#include <cstring>
+
+#include <charconv>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include "common.hpp"
+#include "json.hpp"
+
+#include "mesh-loader.hpp"
+
+namespace
+{
+
+using vulkan_scene::find_json_member;
+using vulkan_scene::json_type_t;
+using vulkan_scene::json_value_t;
+using vulkan_scene::mapped_file_t;
+using vulkan_scene::mesh_t;
+using vulkan_scene::print_error;
+using vulkan_scene::vertex_t;
+
+// Splits the next token off the front of the line.
+auto next_token(std::string_view& p_line) noexcept -> std::string_view
+{
+    const auto start = p_line.find_first_not_of(" \t\r");
+    if (start == std::string_view::npos)
+    {
+        p_line = {};
+        return {};
+    }
+
+    p_line.remove_prefix(start);
+
+    const auto token = p_line.substr(0, p_line.find_first_of(" \t\r"));
+    p_line.remove_prefix(token.size());
+
+    return token;
+}
+
+auto parse_float(std::string_view p_token, float& p_value) noexcept -> bool
+{
+    // from_chars doesn't take a leading plus, which some exporters write.
+    if (!p_token.empty() && p_token.front() == '+')
+    {
+        p_token.remove_prefix(1);
+    }
+
+    const auto last = p_token.data() + p_token.size();
+    const auto [end, error] = std::from_chars(p_token.data(), last, p_value);
+
+    return !p_token.empty() && error == std::errc{} && end == last;
+}
+
+auto parse_floats(std::string_view& p_line, std::span<float> p_values) noexcept
+    -> bool
+{
+    for (auto& value : p_values)
+    {
+        if (!parse_float(next_token(p_line), value))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// OBJ indices start at one, and negative ones count back from the last element
+// so far.
+auto parse_obj_index(
+    std::string_view p_token, size_t p_count, uint32_t& p_index
+) noexcept -> bool
+{
+    int64_t index;
+    const auto last = p_token.data() + p_token.size();
+    const auto [end, error] = std::from_chars(p_token.data(), last, index);
+    if (p_token.empty() || error != std::errc{} || end != last)
+    {
+        return false;
+    }
+
+    const auto count = static_cast<int64_t>(p_count);
+    if (index > 0 && index <= count)
+    {
+        p_index = static_cast<uint32_t>(index - 1);
+        return true;
+    }
+
+    if (index < 0 && -index <= count)
+    {
+        p_index = static_cast<uint32_t>(count + index);
+        return true;
+    }
+
+    return false;
+}
+
+constexpr uint32_t GLB_MAGIC = 0x46546C67;
+constexpr uint32_t GLB_VERSION = 2;
+constexpr uint32_t GLB_CHUNK_JSON = 0x4E4F534A;
+constexpr uint32_t GLB_CHUNK_BIN = 0x004E4942;
+
+constexpr uint64_t GLTF_UNSIGNED_BYTE = 5121;
+constexpr uint64_t GLTF_UNSIGNED_SHORT = 5123;
+constexpr uint64_t GLTF_UNSIGNED_INT = 5125;
+constexpr uint64_t GLTF_FLOAT = 5126;
+
+constexpr uint64_t GLTF_MODE_TRIANGLES = 4;
+
+// Deep enough for any real scene, and it stops cycles in the node hierarchy.
+constexpr uint32_t MAX_GLTF_NODE_DEPTH = 64;
+
+// Marks members of a glTF object that don't have a default.
+constexpr auto REQUIRED = std::numeric_limits<uint64_t>::max();
+
+// Returns nothing if the member isn't a whole number of at least zero, or if
+// it's missing and there's no default.
+auto get_uint_member(
+    const json_value_t& p_object,
+    std::string_view p_key,
+    uint64_t p_default = REQUIRED
+) -> std::optional<uint64_t>
+{
+    const auto member = find_json_member(p_object, p_key);
+    if (member == nullptr)
+    {
+        return p_default == REQUIRED ? std::nullopt : std::optional{p_default};
+    }
+
+    // Doubles hold whole numbers exactly up to 2^53.
+    if (member->type != json_type_t::NUMBER || member->number < 0.0 ||
+        member->number > 9007199254740992.0 ||
+        member->number != std::floor(member->number))
+    {
+        return std::nullopt;
+    }
+
+    return static_cast<uint64_t>(member->number);
+}
+
+// Reads an array of exactly as many numbers as there are values.
+auto get_floats(const json_value_t& p_array, std::span<float> p_values) -> bool
+{
+    if (p_array.type != json_type_t::ARRAY ||
+        p_array.elements.size() != p_values.size())
+    {
+        return false;
+    }
+
+    for (size_t i = 0; i < p_values.size(); i++)
+    {
+        if (p_array.elements[i].type != json_type_t::NUMBER)
+        {
+            return false;
+        }
+
+        p_values[i] = static_cast<float>(p_array.elements[i].number);
+    }
+
+    return true;
+}
+
+// The object at p_root[p_key][p_index], or null if there is none.
+auto get_indexed_object(
+    const json_value_t& p_root, std::string_view p_key, uint64_t p_index
+) -> const json_value_t*
+{
+    const auto array = find_json_member(p_root, p_key);
+    if (array == nullptr || array->type != json_type_t::ARRAY ||
+        p_index >= array->elements.size() ||
+        array->elements[p_index].type != json_type_t::OBJECT)
+    {
+        return nullptr;
+    }
+
+    return &array->elements[p_index];
+}
+
+auto decode_base64(std::string_view p_text)
+    -> std::optional<std::vector<uint8_t>>
+{
+    std::vector<uint8_t> bytes;
+    bytes.reserve(p_text.size() / 4 * 3);
+
+    uint32_t bits = 0;
+    uint32_t bit_count = 0;
+
+    for (const auto character : p_text)
+    {
+        uint32_t value;
+        if (character >= 'A' && character <= 'Z')
+        {
+            value = static_cast<uint32_t>(character - 'A');
+        }
+        else if (character >= 'a' && character <= 'z')
+        {
+            value = static_cast<uint32_t>(character - 'a') + 26;
+        }
+        else if (character >= '0' && character <= '9')
+        {
+            value = static_cast<uint32_t>(character - '0') + 52;
+        }
+        else if (character == '+')
+        {
+            value = 62;
+        }
+        else if (character == '/')
+        {
+            value = 63;
+        }
+        else if (character == '=')
+        {
+            break;
+        }
+        else
+        {
+            return std::nullopt;
+        }
+
+        bits = (bits << 6) | value;
+        bit_count += 6;
+
+        if (bit_count >= 8)
+        {
+            bit_count -= 8;
+            bytes.push_back(static_cast<uint8_t>(bits >> bit_count));
+        }
+    }
+
+    return bytes;
+}
+
+// Undoes the percent-encoding of relative URIs, such as %20 for spaces.
+auto decode_uri(std::string_view p_uri) -> std::string
+{
+    std::string decoded;
+    decoded.reserve(p_uri.size());
+
+    for (size_t i = 0; i < p_uri.size(); i++)
+    {
+        uint8_t byte;
+        const auto digits = p_uri.data() + i + 1;
+
+        if (p_uri[i] == '%' && i + 2 < p_uri.size() &&
+            std::from_chars(digits, digits + 2, byte, 16).ptr == digits + 2)
+        {
+            decoded.push_back(static_cast<char>(byte));
+            i += 2;
+        }
+        else
+        {
+            decoded.push_back(p_uri[i]);
+        }
+    }
+
+    return decoded;
+}
+
+// Where an accessor's elements are, after following it to its buffer.
+struct gltf_accessor_t
+{
+    const uint8_t* data;
+    size_t stride;
+    size_t count;
+    uint64_t component_type;
+    bool normalized;
+};
+
+class gltf_reader_t
+{
+  public:
+    explicit gltf_reader_t(std::string_view p_file_path) noexcept
+        : m_file_path(p_file_path), m_json(), m_files(), m_decoded_buffers(),
+          m_buffers(), m_binary_chunk()
+    {
+    }
+
+    gltf_reader_t(const gltf_reader_t&) = delete;
+    gltf_reader_t& operator=(const gltf_reader_t&) = delete;
+
+    // The buffers point into the mapped files until the end.
+    ~gltf_reader_t()
+    {
+        for (const auto& file : m_files)
+        {
+            vulkan_scene::unmap_file(file);
+        }
+    }
+
+    // Prints what went wrong and returns nothing if reading fails.
+    auto read() -> std::optional<mesh_t>
+    {
+        const auto file_result = vulkan_scene::map_file(m_file_path);
+        kirho::empty_t error;
+        if (file_result.is_error(error))
+        {
+            return std::nullopt;
+        }
+
+        const auto file = file_result.unwrap();
+        m_files.push_back(file);
+
+        if (!parse_json({file.data, file.size}) || !load_buffers())
+        {
+            return std::nullopt;
+        }
+
+        mesh_t mesh;
+
+        const auto scene_index = get_uint_member(m_json, "scene", 0);
+        const auto scene =
+            scene_index.has_value()
+                ? get_indexed_object(m_json, "scenes", *scene_index)
+                : nullptr;
+
+        if (scene != nullptr)
+        {
+            const auto nodes = find_json_member(*scene, "nodes");
+            if (nodes != nullptr && nodes->type == json_type_t::ARRAY)
+            {
+                for (const auto& node : nodes->elements)
+                {
+                    if (node.type != json_type_t::NUMBER ||
+                        !add_node(
+                            static_cast<uint64_t>(node.number),
+                            glm::mat4{1.0f}, 0, mesh
+                        ))
+                    {
+                        fail("has a scene with an invalid node.");
+                        return std::nullopt;
+                    }
+                }
+            }
+        }
+        else
+        {
+            // Without a scene, there are no transforms either, so every mesh
+            // gets added as it is.
+            const auto meshes = find_json_member(m_json, "meshes");
+            const auto mesh_count =
+                meshes != nullptr ? meshes->elements.size() : 0;
+
+            for (size_t i = 0; i < mesh_count; i++)
+            {
+                if (!add_mesh(i, glm::mat4{1.0f}, mesh))
+                {
+                    return std::nullopt;
+                }
+            }
+        }
+
+        return mesh;
+    }
+
+  private:
+    auto fail(std::string_view p_reason) const -> bool
+    {
+        print_error(m_file_path, ' ', p_reason);
+        return false;
+    }
+
+    // Takes both .gltf files, which are JSON all the way through, and .glb
+    // files, which have the JSON in a chunk that may be followed by a chunk of
+    // binary data.
+    auto parse_json(std::span<const uint8_t> p_contents) -> bool
+    {
+        auto text = std::string_view{
+            reinterpret_cast<const char*>(p_contents.data()), p_contents.size()
+        };
+
+        uint32_t header[3]{};
+        if (p_contents.size() >= sizeof(header))
+        {
+            std::memcpy(header, p_contents.data(), sizeof(header));
+        }
+
+        if (p_contents.size() >= sizeof(header) && header[0] == GLB_MAGIC)
+        {
+            if (header[1] != GLB_VERSION)
+            {
+                return fail("is not a glTF 2.0 binary.");
+            }
+
+            text = {};
+
+            auto offset = sizeof(header);
+            while (p_contents.size() - offset >= 2 * sizeof(uint32_t))
+            {
+                uint32_t chunk_header[2];
+                std::memcpy(
+                    chunk_header, p_contents.data() + offset,
+                    sizeof(chunk_header)
+                );
+                offset += sizeof(chunk_header);
+
+                const auto chunk_size = static_cast<size_t>(chunk_header[0]);
+                if (p_contents.size() - offset < chunk_size)
+                {
+                    return fail("is truncated.");
+                }
+
+                const auto chunk = p_contents.subspan(offset, chunk_size);
+
+                // The JSON chunk has to come first.
+                if (text.empty() && chunk_header[1] == GLB_CHUNK_JSON)
+                {
+                    text = {
+                        reinterpret_cast<const char*>(chunk.data()),
+                        chunk.size()
+                    };
+                }
+                else if (!text.empty() && chunk_header[1] == GLB_CHUNK_BIN &&
+                         m_binary_chunk.empty())
+                {
+                    m_binary_chunk = chunk;
+                }
+
+                // Chunks are padded to four bytes.
+                offset += std::min(
+                    vulkan_scene::align_up(chunk_size, size_t{4}),
+                    p_contents.size() - offset
+                );
+            }
+        }
+
+        auto json = vulkan_scene::parse_json(text);
+        if (!json.has_value() || json->type != json_type_t::OBJECT)
+        {
+            return fail("doesn't contain valid JSON.");
+        }
+
+        m_json = std::move(*json);
+
+        const auto asset = find_json_member(m_json, "asset");
+        const auto version =
+            asset != nullptr ? find_json_member(*asset, "version")
+                             : nullptr;
+        if (version == nullptr || version->type != json_type_t::STRING ||
+            !version->string.starts_with("2."))
+        {
+            return fail("is not a glTF 2.0 file.");
+        }
+
+        return true;
+    }
+
+    auto load_buffers() -> bool
+    {
+        const auto buffers = find_json_member(m_json, "buffers");
+        if (buffers == nullptr)
+        {
+            return true;
+        }
+
+        const auto directory =
+            std::filesystem::path{m_file_path}.parent_path();
+
+        for (size_t i = 0; i < buffers->elements.size(); i++)
+        {
+            const auto& buffer = buffers->elements[i];
+            const auto size = get_uint_member(buffer, "byteLength");
+            if (!size.has_value())
+            {
+                return fail("has a buffer without a size.");
+            }
+
+            const auto uri = find_json_member(buffer, "uri");
+            std::span<const uint8_t> data;
+
+            if (uri == nullptr)
+            {
+                // Only the first buffer of a .glb can be the binary chunk.
+                if (i != 0)
+                {
+                    return fail("has a buffer without any data.");
+                }
+
+                data = m_binary_chunk;
+            }
+            else if (uri->type != json_type_t::STRING)
+            {
+                return fail("has a buffer with an invalid URI.");
+            }
+            else if (uri->string.starts_with("data:"))
+            {
+                constexpr std::string_view BASE64_MARKER = ";base64,";
+
+                const auto marker = uri->string.find(BASE64_MARKER);
+                auto decoded =
+                    marker != std::string::npos
+                        ? decode_base64(std::string_view{uri->string}.substr(
+                              marker + BASE64_MARKER.size()
+                          ))
+                        : std::nullopt;
+                if (!decoded.has_value())
+                {
+                    return fail("has a buffer with an invalid data URI.");
+                }
+
+                m_decoded_buffers.push_back(std::move(*decoded));
+                data = m_decoded_buffers.back();
+            }
+            else
+            {
+                const auto path =
+                    (directory / decode_uri(uri->string)).string();
+
+                const auto file_result = vulkan_scene::map_file(path);
+                kirho::empty_t error;
+                if (file_result.is_error(error))
+                {
+                    return false;
+                }
+
+                const auto file = file_result.unwrap();
+                m_files.push_back(file);
+                data = {file.data, file.size};
+            }
+
+            if (data.size() < *size)
+            {
+                return fail("has a buffer that is shorter than it claims.");
+            }
+
+            m_buffers.push_back(data.first(*size));
+        }
+
+        return true;
+    }
+
+    // Finds the elements of an accessor and makes sure that they are all in
+    // bounds.
+    auto get_accessor(uint64_t p_index, uint32_t p_component_count)
+        -> std::optional<gltf_accessor_t>
+    {
+        const auto accessor = get_indexed_object(m_json, "accessors", p_index);
+        if (accessor == nullptr)
+        {
+            fail("refers to an accessor that doesn't exist.");
+            return std::nullopt;
+        }
+
+        if (find_json_member(*accessor, "sparse") != nullptr)
+        {
+            fail("has a sparse accessor, which isn't supported.");
+            return std::nullopt;
+        }
+
+        const auto type = find_json_member(*accessor, "type");
+        const uint32_t component_count =
+            type == nullptr || type->type != json_type_t::STRING ? 0
+            : type->string == "SCALAR"                           ? 1
+            : type->string == "VEC2"                             ? 2
+            : type->string == "VEC3"                             ? 3
+            : type->string == "VEC4"                             ? 4
+                                                                 : 0;
+        if (component_count != p_component_count)
+        {
+            fail("has an accessor of the wrong type.");
+            return std::nullopt;
+        }
+
+        const auto component_type =
+            get_uint_member(*accessor, "componentType");
+        const auto component_size =
+            component_type == GLTF_UNSIGNED_BYTE    ? 1
+            : component_type == GLTF_UNSIGNED_SHORT ? 2
+            : component_type == GLTF_UNSIGNED_INT ||
+                    component_type == GLTF_FLOAT
+                ? 4
+                : 0;
+        if (component_size == 0)
+        {
+            fail("has an accessor with an unsupported component type.");
+            return std::nullopt;
+        }
+
+        const auto view_index = get_uint_member(*accessor, "bufferView");
+        const auto view =
+            view_index.has_value()
+                ? get_indexed_object(m_json, "bufferViews", *view_index)
+                : nullptr;
+        if (view == nullptr)
+        {
+            fail("has an accessor without a buffer view, which isn't "
+                 "supported.");
+            return std::nullopt;
+        }
+
+        const auto element_size =
+            static_cast<uint64_t>(component_size * component_count);
+
+        const auto buffer_index = get_uint_member(*view, "buffer");
+        const auto view_offset = get_uint_member(*view, "byteOffset", 0);
+        const auto view_size = get_uint_member(*view, "byteLength");
+        const auto stride = get_uint_member(*view, "byteStride", element_size);
+        const auto offset = get_uint_member(*accessor, "byteOffset", 0);
+        const auto count = get_uint_member(*accessor, "count");
+
+        if (!buffer_index.has_value() || *buffer_index >= m_buffers.size() ||
+            !view_offset.has_value() || !view_size.has_value() ||
+            !stride.has_value() || !offset.has_value() || !count.has_value() ||
+            *stride < element_size)
+        {
+            fail("has an invalid accessor or buffer view.");
+            return std::nullopt;
+        }
+
+        const auto buffer = m_buffers[*buffer_index];
+        if (*view_offset > buffer.size() ||
+            buffer.size() - *view_offset < *view_size ||
+            (*count > 0 &&
+             (*offset > *view_size || *view_size - *offset < element_size ||
+              (*view_size - *offset - element_size) / *stride < *count - 1)))
+        {
+            fail("has an accessor that is out of bounds.");
+            return std::nullopt;
+        }
+
+        const auto normalized =
+            find_json_member(*accessor, "normalized");
+
+        return gltf_accessor_t{
+            .data = buffer.data() + *view_offset + *offset,
+            .stride = static_cast<size_t>(*stride),
+            .count = static_cast<size_t>(*count),
+            .component_type = *component_type,
+            .normalized = normalized != nullptr && normalized->boolean,
+        };
+    }
+
+    // Reads floats, or normalized integers which get turned into floats.
+    auto read_floats(
+        uint64_t p_accessor,
+        uint32_t p_component_count,
+        std::vector<float>& p_values
+    ) -> bool
+    {
+        const auto accessor = get_accessor(p_accessor, p_component_count);
+        if (!accessor.has_value())
+        {
+            return false;
+        }
+
+        if (accessor->component_type != GLTF_FLOAT && !accessor->normalized)
+        {
+            return fail("has an attribute with an unsupported type.");
+        }
+
+        p_values.resize(accessor->count * p_component_count);
+
+        for (size_t i = 0; i < accessor->count; i++)
+        {
+            const auto element = accessor->data + i * accessor->stride;
+            const auto values = p_values.data() + i * p_component_count;
+
+            for (uint32_t j = 0; j < p_component_count; j++)
+            {
+                if (accessor->component_type == GLTF_FLOAT)
+                {
+                    std::memcpy(&values[j], element + j * 4, sizeof(float));
+                }
+                else if (accessor->component_type == GLTF_UNSIGNED_SHORT)
+                {
+                    uint16_t value;
+                    std::memcpy(&value, element + j * 2, sizeof(value));
+                    values[j] = static_cast<float>(value) / 65535.0f;
+                }
+                else if (accessor->component_type == GLTF_UNSIGNED_BYTE)
+                {
+                    values[j] = static_cast<float>(element[j]) / 255.0f;
+                }
+                else
+                {
+                    return fail("has an attribute with an unsupported type.");
+                }
+            }
+        }
+
+        return true;
+    }
+
+    auto read_indices(uint64_t p_accessor, std::vector<uint32_t>& p_indices)
+        -> bool
+    {
+        const auto accessor = get_accessor(p_accessor, 1);
+        if (!accessor.has_value())
+        {
+            return false;
+        }
+
+        if (accessor->component_type == GLTF_FLOAT)
+        {
+            return fail("has indices that aren't integers.");
+        }
+
+        p_indices.resize(accessor->count);
+
+        for (size_t i = 0; i < accessor->count; i++)
+        {
+            const auto element = accessor->data + i * accessor->stride;
+
+            if (accessor->component_type == GLTF_UNSIGNED_INT)
+            {
+                std::memcpy(&p_indices[i], element, sizeof(uint32_t));
+            }
+            else if (accessor->component_type == GLTF_UNSIGNED_SHORT)
+            {
+                uint16_t index;
+                std::memcpy(&index, element, sizeof(index));
+                p_indices[i] = index;
+            }
+            else
+            {
+                p_indices[i] = *element;
+            }
+        }
+
+        return true;
+    }
+
+    auto add_node(
+        uint64_t p_index,
+        const glm::mat4& p_parent_transform,
+        uint32_t p_depth,
+        mesh_t& p_mesh
+    ) -> bool
+    {
+        if (p_depth > MAX_GLTF_NODE_DEPTH)
+        {
+            return fail("has nodes that nest too deeply.");
+        }
+
+        const auto node = get_indexed_object(m_json, "nodes", p_index);
+        if (node == nullptr)
+        {
+            return fail("refers to a node that doesn't exist.");
+        }
+
+        glm::mat4 transform;
+
+        if (const auto matrix = find_json_member(*node, "matrix"))
+        {
+            std::array<float, 16> values;
+            if (!get_floats(*matrix, values))
+            {
+                return fail("has a node with an invalid matrix.");
+            }
+
+            // Column-major in both glTF and GLM.
+            transform = glm::make_mat4(values.data());
+        }
+        else
+        {
+            std::array<float, 3> translation{0.0f, 0.0f, 0.0f};
+            std::array<float, 4> rotation{0.0f, 0.0f, 0.0f, 1.0f};
+            std::array<float, 3> scale{1.0f, 1.0f, 1.0f};
+
+            const auto translation_member =
+                find_json_member(*node, "translation");
+            const auto rotation_member =
+                find_json_member(*node, "rotation");
+            const auto scale_member =
+                find_json_member(*node, "scale");
+
+            if ((translation_member != nullptr &&
+                 !get_floats(*translation_member, translation)) ||
+                (rotation_member != nullptr &&
+                 !get_floats(*rotation_member, rotation)) ||
+                (scale_member != nullptr && !get_floats(*scale_member, scale)))
+            {
+                return fail("has a node with an invalid transform.");
+            }
+
+            // glTF stores quaternions as x, y, z, w, while GLM takes w first.
+            transform =
+                glm::translate(
+                    glm::mat4{1.0f},
+                    glm::vec3{translation[0], translation[1], translation[2]}
+                ) *
+                glm::mat4_cast(glm::quat{
+                    rotation[3], rotation[0], rotation[1], rotation[2]
+                }) *
+                glm::scale(
+                    glm::mat4{1.0f}, glm::vec3{scale[0], scale[1], scale[2]}
+                );
+        }
+
+        transform = p_parent_transform * transform;
+
+        if (find_json_member(*node, "mesh") != nullptr)
+        {
+            const auto mesh_index = get_uint_member(*node, "mesh");
+            if (!mesh_index.has_value() ||
+                !add_mesh(*mesh_index, transform, p_mesh))
+            {
+                return false;
+            }
+        }
+
+        const auto children = find_json_member(*node, "children");
+        if (children == nullptr)
+        {
+            return true;
+        }
+
+        for (const auto& child : children->elements)
+        {
+            if (child.type != json_type_t::NUMBER ||
+                !add_node(
+                    static_cast<uint64_t>(child.number), transform, p_depth + 1,
+                    p_mesh
+                ))
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    auto add_mesh(
+        uint64_t p_index, const glm::mat4& p_transform, mesh_t& p_mesh
+    ) -> bool
+    {
+        const auto mesh = get_indexed_object(m_json, "meshes", p_index);
+        const auto primitives =
+            mesh != nullptr ? find_json_member(*mesh, "primitives")
+                            : nullptr;
+        if (primitives == nullptr || primitives->type != json_type_t::ARRAY)
+        {
+            return fail("refers to a mesh that doesn't exist.");
+        }
+
+        for (const auto& primitive : primitives->elements)
+        {
+            if (!add_primitive(primitive, p_transform, p_mesh))
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    auto add_primitive(
+        const json_value_t& p_primitive,
+        const glm::mat4& p_transform,
+        mesh_t& p_mesh
+    ) -> bool
+    {
+        // Points and lines have nothing to fill.
+        if (get_uint_member(p_primitive, "mode", GLTF_MODE_TRIANGLES) !=
+            GLTF_MODE_TRIANGLES)
+        {
+            return true;
+        }
+
+        const auto attributes =
+            find_json_member(p_primitive, "attributes");
+        const auto position = attributes != nullptr
+                                  ? get_uint_member(*attributes, "POSITION")
+                                  : std::nullopt;
+        if (!position.has_value())
+        {
+            return fail("has a primitive without positions.");
+        }
+
+        std::vector<float> positions;
+        std::vector<float> normals;
+        std::vector<float> uvs;
+
+        if (!read_floats(*position, 3, positions))
+        {
+            return false;
+        }
+
+        const auto vertex_count = positions.size() / 3;
+
+        const auto normal = get_uint_member(*attributes, "NORMAL");
+        const auto uv = get_uint_member(*attributes, "TEXCOORD_0");
+
+        if ((normal.has_value() && !read_floats(*normal, 3, normals)) ||
+            (uv.has_value() && !read_floats(*uv, 2, uvs)))
+        {
+            return false;
+        }
+
+        if ((normal.has_value() && normals.size() != vertex_count * 3) ||
+            (uv.has_value() && uvs.size() != vertex_count * 2))
+        {
+            return fail("has a primitive with mismatched attributes.");
+        }
+
+        mesh_t primitive;
+        primitive.vertices.reserve(vertex_count);
+
+        for (size_t i = 0; i < vertex_count; i++)
+        {
+            primitive.vertices.push_back(vertex_t{
+                .position =
+                    {positions[i * 3], positions[i * 3 + 1],
+                     positions[i * 3 + 2]},
+                .uv = uv.has_value() ? glm::vec2{uvs[i * 2], uvs[i * 2 + 1]}
+                                     : glm::vec2{0.0f, 0.0f},
+                .normal = normal.has_value()
+                              ? glm::vec3{normals[i * 3], normals[i * 3 + 1],
+                                          normals[i * 3 + 2]}
+                              : glm::vec3{0.0f, 0.0f, 0.0f},
+            });
+        }
+
+        if (find_json_member(p_primitive, "indices") != nullptr)
+        {
+            const auto indices = get_uint_member(p_primitive, "indices");
+            if (!indices.has_value() ||
+                !read_indices(*indices, primitive.indices))
+            {
+                return fail("has a primitive with invalid indices.");
+            }
+        }
+        else
+        {
+            primitive.indices.resize(vertex_count);
+            for (size_t i = 0; i < vertex_count; i++)
+            {
+                primitive.indices[i] = static_cast<uint32_t>(i);
+            }
+        }
+
+        if (primitive.indices.size() % 3 != 0 ||
+            std::any_of(
+                primitive.indices.begin(), primitive.indices.end(),
+                [vertex_count](uint32_t p_index)
+                { return p_index >= vertex_count; }
+            ))
+        {
+            return fail("has a primitive with invalid indices.");
+        }
+
+        if (p_mesh.vertices.size() + vertex_count >
+            std::numeric_limits<uint32_t>::max())
+        {
+            return fail("has too many vertices.");
+        }
+
+        if (!normal.has_value())
+        {
+            vulkan_scene::generate_normals(primitive);
+        }
+
+        const auto normal_matrix =
+            glm::transpose(glm::inverse(glm::mat3{p_transform}));
+
+        for (auto& vertex : primitive.vertices)
+        {
+            vertex.position =
+                glm::vec3{p_transform * glm::vec4{vertex.position, 1.0f}};
+
+            const auto transformed_normal = normal_matrix * vertex.normal;
+            const auto length = glm::length(transformed_normal);
+            vertex.normal = length > 0.0f ? transformed_normal / length
+                                          : transformed_normal;
+        }
+
+        // A mirroring transform turns the triangles inside out.
+        const auto mirrored = glm::determinant(glm::mat3{p_transform}) < 0.0f;
+
+        const auto first_vertex = static_cast<uint32_t>(p_mesh.vertices.size());
+        p_mesh.vertices.insert(
+            p_mesh.vertices.end(), primitive.vertices.begin(),
+            primitive.vertices.end()
+        );
+
+        for (size_t i = 0; i < primitive.indices.size(); i += 3)
+        {
+            const size_t second = mirrored ? 2 : 1;
+            p_mesh.indices.push_back(first_vertex + primitive.indices[i]);
+            p_mesh.indices.push_back(
+                first_vertex + primitive.indices[i + second]
+            );
+            p_mesh.indices.push_back(
+                first_vertex + primitive.indices[i + 3 - second]
+            );
+        }
+
+        return true;
+    }
+
+    std::string_view m_file_path;
+    json_value_t m_json;
+
+    std::vector<mapped_file_t> m_files;
+    std::vector<std::vector<uint8_t>> m_decoded_buffers;
+    std::vector<std::span<const uint8_t>> m_buffers;
+
+    // The second chunk of a .glb file, if there is one.
+    std::span<const uint8_t> m_binary_chunk;
+};
+
+constexpr std::array<uint8_t, 8> MESH_CACHE_IDENTIFIER{
+    'V', 'S', 'M', 'E', 'S', 'H', '\r', '\n',
+};
+
+struct mesh_cache_header_t
+{
+    uint8_t identifier[8];
+    uint32_t version;
+    uint32_t vertex_size;
+
+    // The size and modification time of the mesh file that the cache was
+    // written for. The cache is stale if either of them differs.
+    uint64_t source_size;
+    int64_t source_write_time;
+
+    uint32_t vertex_count;
+    uint32_t index_count;
+    uint32_t index_size;
+    uint32_t submesh_count;
+    uint64_t vertex_offset;
+    uint64_t index_offset;
+    uint64_t submesh_offset;
+    uint64_t reserved;
+};
+
+static_assert(sizeof(mesh_cache_header_t) == 80);
+
+struct mesh_source_t
+{
+    uint64_t size;
+    int64_t write_time;
+};
+
+auto get_mesh_source(std::string_view p_file_path)
+    -> std::optional<mesh_source_t>
+{
+    const std::filesystem::path path{p_file_path};
+    std::error_code error;
+
+    const auto size = std::filesystem::file_size(path, error);
+    if (error)
+    {
+        return std::nullopt;
+    }
+
+    const auto write_time = std::filesystem::last_write_time(path, error);
+    if (error)
+    {
+        return std::nullopt;
+    }
+
+    return mesh_source_t{
+        .size = static_cast<uint64_t>(size),
+        .write_time =
+            static_cast<int64_t>(write_time.time_since_epoch().count()),
+    };
+}
+
+// Returns nothing if the cache is stale or isn't a mesh cache at all.
+auto get_cached_mesh(
+    const mapped_file_t& p_file, const mesh_source_t& p_source
+) noexcept -> std::optional<vulkan_scene::cached_mesh_t>
+{
+    using vulkan_scene::MESH_CACHE_ALIGNMENT;
+    using vulkan_scene::submesh_t;
+
+    mesh_cache_header_t header;
+    if (p_file.size < sizeof(header))
+    {
+        return std::nullopt;
+    }
+
+    std::memcpy(&header, p_file.data, sizeof(header));
+
+    // Checks that a section of the file is aligned and in bounds.
+    const auto has_section = [&p_file](uint64_t p_offset, uint64_t p_size)
+    {
+        return p_offset % MESH_CACHE_ALIGNMENT == 0 &&
+               p_offset <= p_file.size && p_file.size - p_offset >= p_size;
+    };
+
+    if (!std::equal(
+            MESH_CACHE_IDENTIFIER.begin(), MESH_CACHE_IDENTIFIER.end(),
+            header.identifier
+        ) ||
+        header.version != vulkan_scene::MESH_CACHE_VERSION ||
+        header.vertex_size != sizeof(vertex_t) ||
+        header.source_size != p_source.size ||
+        header.source_write_time != p_source.write_time ||
+        (header.index_size != sizeof(uint16_t) &&
+         header.index_size != sizeof(uint32_t)) ||
+        !has_section(
+            header.vertex_offset,
+            static_cast<uint64_t>(header.vertex_count) * sizeof(vertex_t)
+        ) ||
+        !has_section(
+            header.index_offset,
+            static_cast<uint64_t>(header.index_count) * header.index_size
+        ) ||
+        !has_section(
+            header.submesh_offset,
+            static_cast<uint64_t>(header.submesh_count) * sizeof(submesh_t)
+        ))
+    {
+        return std::nullopt;
+    }
+
+    // The mapping starts on a page boundary, so the data is aligned too.
+    const auto submeshes = std::span{
+        reinterpret_cast<const submesh_t*>(p_file.data + header.submesh_offset),
+        header.submesh_count
+    };
+
+    // The indices themselves are trusted, since reading through all of them
+    // would take away much of the point of mapping the cache.
+    for (const auto& submesh : submeshes)
+    {
+        if (submesh.first_index > header.index_count ||
+            header.index_count - submesh.first_index < submesh.index_count ||
+            submesh.vertex_offset < 0 ||
+            static_cast<uint32_t>(submesh.vertex_offset) >= header.vertex_count)
+        {
+            return std::nullopt;
+        }
+    }
+
+    return vulkan_scene::cached_mesh_t{
+        .file = p_file,
+        .vertices =
+            {reinterpret_cast<const vertex_t*>(
+                 p_file.data + header.vertex_offset
+             ),
+             header.vertex_count},
+        .index_type = header.index_size == sizeof(uint16_t)
+                          ? VK_INDEX_TYPE_UINT16
+                          : VK_INDEX_TYPE_UINT32,
+        .index_count = header.index_count,
+        .indices = p_file.data + header.index_offset,
+        .submeshes = submeshes,
+    };
+}
+
+auto write_mesh_cache(
+    const std::string& p_cache_path,
+    const mesh_t& p_mesh,
+    std::span<const vulkan_scene::submesh_t> p_submeshes,
+    const mesh_source_t& p_source
+) -> bool
+{
+    using vulkan_scene::align_up;
+    using vulkan_scene::MESH_CACHE_ALIGNMENT;
+
+    const auto index_type = vulkan_scene::choose_index_type(p_mesh.indices);
+    const auto indices = vulkan_scene::pack_indices(p_mesh.indices, index_type);
+
+    const auto vertex_offset =
+        align_up(sizeof(mesh_cache_header_t), MESH_CACHE_ALIGNMENT);
+    const auto index_offset = align_up(
+        vertex_offset + p_mesh.vertices.size() * sizeof(vertex_t),
+        MESH_CACHE_ALIGNMENT
+    );
+    const auto submesh_offset =
+        align_up(index_offset + indices.size(), MESH_CACHE_ALIGNMENT);
+
+    const mesh_cache_header_t header{
+        .identifier = {},
+        .version = vulkan_scene::MESH_CACHE_VERSION,
+        .vertex_size = sizeof(vertex_t),
+        .source_size = p_source.size,
+        .source_write_time = p_source.write_time,
+        .vertex_count = static_cast<uint32_t>(p_mesh.vertices.size()),
+        .index_count = static_cast<uint32_t>(p_mesh.indices.size()),
+        .index_size = vulkan_scene::get_index_size(index_type),
+        .submesh_count = static_cast<uint32_t>(p_submeshes.size()),
+        .vertex_offset = vertex_offset,
+        .index_offset = index_offset,
+        .submesh_offset = submesh_offset,
+        .reserved = 0,
+    };
+
+    std::vector<uint8_t> contents(submesh_offset + p_submeshes.size_bytes());
+    std::memcpy(contents.data(), &header, sizeof(header));
+    std::memcpy(
+        contents.data(), MESH_CACHE_IDENTIFIER.data(),
+        MESH_CACHE_IDENTIFIER.size()
+    );
+    std::memcpy(
+        contents.data() + vertex_offset, p_mesh.vertices.data(),
+        p_mesh.vertices.size() * sizeof(vertex_t)
+    );
+    std::memcpy(contents.data() + index_offset, indices.data(), indices.size());
+    std::memcpy(
+        contents.data() + submesh_offset, p_submeshes.data(),
+        p_submeshes.size_bytes()
+    );
+
+    // Written next to the cache and then moved over it, so that a run that
+    // gets interrupted can't leave half a cache behind.
+    const auto temporary_path = p_cache_path + ".tmp";
+    {
+        std::ofstream file_stream{temporary_path, std::ios::binary};
+        file_stream.write(
+            reinterpret_cast<const char*>(contents.data()),
+            static_cast<std::streamsize>(contents.size())
+        );
+
+        if (!file_stream)
+        {
+            print_error("Failed to write ", temporary_path, '.');
+            return false;
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::rename(temporary_path, p_cache_path, error);
+    if (error)
+    {
+        print_error("Failed to write ", p_cache_path, ": ", error.message());
+        std::filesystem::remove(temporary_path, error);
+        return false;
+    }
+
+    return true;
+}
+
+} // namespace
+
+namespace vulkan_scene
+{
+
+auto read_obj(std::string_view p_file_path) noexcept
+    -> kirho::result_t<mesh_t, kirho::empty_t>
+{
+    using result_t = kirho::result_t<mesh_t, kirho::empty_t>;
+
+    const auto file_result = map_file(p_file_path);
+    kirho::empty_t error;
+    if (file_result.is_error(error))
+    {
+        return result_t::error(error);
+    }
+
+    const auto file = file_result.unwrap();
+    const auto text =
+        std::string_view{reinterpret_cast<const char*>(file.data), file.size};
+
+    std::vector<glm::vec3> positions;
+    std::vector<glm::vec2> uvs;
+    std::vector<glm::vec3> normals;
+
+    mesh_t mesh;
+    auto missing_normals = false;
+
+    // The corners of the face that is being read, before it gets split into
+    // triangles.
+    std::vector<vertex_t> face;
+
+    size_t line_start = 0;
+    size_t line_number = 0;
+    auto valid = true;
+
+    while (valid && line_start < text.size())
+    {
+        const auto line_end =
+            std::min(text.find('\n', line_start), text.size());
+        auto line = text.substr(line_start, line_end - line_start);
+        line_start = line_end + 1;
+        line_number++;
+
+        line = line.substr(0, line.find('#'));
+        const auto keyword = next_token(line);
+
+        if (keyword == "v")
+        {
+            std::array<float, 3> values;
+            valid = parse_floats(line, values);
+            positions.push_back({values[0], values[1], values[2]});
+        }
+        else if (keyword == "vt")
+        {
+            // OBJ puts the origin of the texture at the bottom, Vulkan at the
+            // top.
+            std::array<float, 2> values;
+            valid = parse_floats(line, values);
+            uvs.push_back({values[0], 1.0f - values[1]});
+        }
+        else if (keyword == "vn")
+        {
+            std::array<float, 3> values;
+            valid = parse_floats(line, values);
+            normals.push_back({values[0], values[1], values[2]});
+        }
+        else if (keyword == "f")
+        {
+            face.clear();
+
+            // Each corner is v, v/vt, v//vn or v/vt/vn.
+            for (auto corner = next_token(line); valid && !corner.empty();
+                 corner = next_token(line))
+            {
+                const auto first_slash = corner.find('/');
+                const auto second_slash = corner.find('/', first_slash + 1);
+
+                const auto position_token = corner.substr(0, first_slash);
+                const auto uv_token =
+                    first_slash == std::string_view::npos
+                        ? std::string_view{}
+                        : corner.substr(
+                              first_slash + 1, second_slash - first_slash - 1
+                          );
+                const auto normal_token =
+                    second_slash == std::string_view::npos
+                        ? std::string_view{}
+                        : corner.substr(second_slash + 1);
+
+                vertex_t vertex{
+                    .position = {0.0f, 0.0f, 0.0f},
+                    .uv = {0.0f, 0.0f},
+                    .normal = {0.0f, 0.0f, 0.0f},
+                };
+
+                uint32_t index;
+
+                valid =
+                    parse_obj_index(position_token, positions.size(), index);
+                if (valid)
+                {
+                    vertex.position = positions[index];
+                }
+
+                if (valid && !uv_token.empty())
+                {
+                    valid = parse_obj_index(uv_token, uvs.size(), index);
+                    if (valid)
+                    {
+                        vertex.uv = uvs[index];
+                    }
+                }
+
+                if (valid && !normal_token.empty())
+                {
+                    valid = parse_obj_index(
+                        normal_token, normals.size(), index
+                    );
+                    if (valid)
+                    {
+                        vertex.normal = normals[index];
+                    }
+                }
+                else
+                {
+                    missing_normals = true;
+                }
+
+                face.push_back(vertex);
+            }
+
+            valid = valid && face.size() >= 3;
+
+            // Every corner gets a vertex of its own for now, and the ones that
+            // turn out to be the same get welded later.
+            for (size_t i = 1; valid && i + 1 < face.size(); i++)
+            {
+                for (const auto& corner : {face[0], face[i], face[i + 1]})
+                {
+                    mesh.indices.push_back(
+                        static_cast<uint32_t>(mesh.vertices.size())
+                    );
+                    mesh.vertices.push_back(corner);
+                }
+            }
+        }
+    }
+
+    unmap_file(file);
+
+    if (!valid)
+    {
+        print_error(p_file_path, ':', line_number, " is not valid OBJ.");
+        return result_t::error(kirho::empty_t{});
+    }
+
+    if (missing_normals)
+    {
+        generate_normals(mesh);
+    }
+
+    return result_t::success(std::move(mesh));
+}
+
+auto read_gltf(std::string_view p_file_path) noexcept
+    -> kirho::result_t<mesh_t, kirho::empty_t>
+{
+    using result_t = kirho::result_t<mesh_t, kirho::empty_t>;
+
+    gltf_reader_t reader{p_file_path};
+    auto mesh = reader.read();
+    if (!mesh.has_value())
+    {
+        return result_t::error(kirho::empty_t{});
+    }
+
+    return result_t::success(std::move(*mesh));
+}
+
+auto import_mesh(std::string_view p_file_path) noexcept
+    -> kirho::result_t<mesh_t, kirho::empty_t>
+{
+    using result_t = kirho::result_t<mesh_t, kirho::empty_t>;
+
+    auto extension = std::filesystem::path{p_file_path}.extension().string();
+    std::transform(
+        extension.begin(), extension.end(), extension.begin(),
+        [](unsigned char p_character)
+        { return static_cast<char>(std::tolower(p_character)); }
+    );
+
+    if (extension == ".obj")
+    {
+        return read_obj(p_file_path);
+    }
+
+    if (extension == ".gltf" || extension == ".glb")
+    {
+        return read_gltf(p_file_path);
+    }
+
+    print_error(p_file_path, " is neither an OBJ nor a glTF file.");
+    return result_t::error(kirho::empty_t{});
+}
+
+auto load_mesh(std::string_view p_file_path) noexcept
+    -> kirho::result_t<cached_mesh_t, kirho::empty_t>
+{
+    using result_t = kirho::result_t<cached_mesh_t, kirho::empty_t>;
+
+    const auto source = get_mesh_source(p_file_path);
+    if (!source.has_value())
+    {
+        print_error("Failed to read ", p_file_path, '.');
+        return result_t::error(kirho::empty_t{});
+    }
+
+    auto cache_path = std::string{p_file_path};
+    cache_path += MESH_CACHE_EXTENSION;
+
+    kirho::empty_t error;
+
+    // A stale cache isn't an error, it just gets written again.
+    std::error_code exists_error;
+    if (std::filesystem::exists(cache_path, exists_error))
+    {
+        const auto file_result = map_file(cache_path);
+        if (!file_result.is_error(error))
+        {
+            const auto file = file_result.unwrap();
+            if (const auto mesh = get_cached_mesh(file, *source))
+            {
+                return result_t::success(*mesh);
+            }
+
+            unmap_file(file);
+        }
+    }
+
+    const auto import_result = import_mesh(p_file_path);
+    if (import_result.is_error(error))
+    {
+        return result_t::error(error);
+    }
+
+    auto mesh = import_result.unwrap();
+    if (mesh.indices.empty())
+    {
+        print_error(p_file_path, " doesn't have any triangles.");
+        return result_t::error(kirho::empty_t{});
+    }
+
+    fit_mesh_to_unit_cube(mesh);
+    print_mesh_optimization_stats(p_file_path, optimize_mesh(mesh));
+
+    const auto submeshes = split_mesh(mesh);
+    if (submeshes.size() > 1)
+    {
+        std::cout << "[INFO]: Split " << p_file_path << " into "
+                  << submeshes.size() << " submeshes.\n";
+    }
+
+    if (!write_mesh_cache(cache_path, mesh, submeshes, *source))
+    {
+        return result_t::error(kirho::empty_t{});
+    }
+
+    std::cout << "[INFO]: Wrote the mesh cache to " << cache_path << ".\n";
+
+    // Going through the cache even on the first run keeps the two paths the
+    // same, and the pages are still in memory from writing them anyway.
+    const auto file_result = map_file(cache_path);
+    if (file_result.is_error(error))
+    {
+        return result_t::error(error);
+    }
+
+    const auto file = file_result.unwrap();
+    const auto cached_mesh = get_cached_mesh(file, *source);
+    if (!cached_mesh.has_value())
+    {
+        print_error("The mesh cache at ", cache_path, " doesn't read back.");
+        unmap_file(file);
+        return result_t::error(kirho::empty_t{});
+    }
+
+    return result_t::success(*cached_mesh);
+}
+
+auto unload_mesh(const cached_mesh_t& p_mesh) noexcept -> void
+{
+    unmap_file(p_mesh.file);
+}
+
+} // namespace vulkan_scene
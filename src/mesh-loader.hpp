@@ -0,0 +1,65 @@
+#pragma once
+
+#include <string_view>
+
+#include "mapped-file.hpp"
+#include "mesh.hpp"
+
+namespace vulkan_scene
+{
+
+// Bumped whenever the layout of the cache files or the processing that goes
+// into them changes, so that old caches get rewritten.
+constexpr uint32_t MESH_CACHE_VERSION = 2;
+
+// Appended to the path of a mesh to get the path of its cache.
+constexpr std::string_view MESH_CACHE_EXTENSION = ".cache";
+
+// The vertices, the indices and the submeshes all start on a multiple of this
+// in a cache.
+constexpr size_t MESH_CACHE_ALIGNMENT = 16;
+
+// Reads a Wavefront OBJ file. Faces with more than three corners get split
+// into fans, and materials are ignored. If any face is missing its normals,
+// flat ones get generated for the whole mesh.
+auto read_obj(std::string_view p_file_path) noexcept
+    -> kirho::result_t<mesh_t, kirho::empty_t>;
+
+// Reads a glTF 2.0 file, either a .glb or a .gltf with its buffers in data URIs
+// or in files next to it. Every triangle primitive in the default scene gets
+// merged into one mesh, with the transforms of the nodes applied. Materials,
+// skins, morph targets and sparse accessors aren't supported.
+auto read_gltf(std::string_view p_file_path) noexcept
+    -> kirho::result_t<mesh_t, kirho::empty_t>;
+
+// Picks read_obj or read_gltf by the extension of the file.
+auto import_mesh(std::string_view p_file_path) noexcept
+    -> kirho::result_t<mesh_t, kirho::empty_t>;
+
+// A mesh in its cache file, which is laid out the way the buffers are. The
+// vertices and the indices point into the mapped file, so they get copied
+// straight into the staging ring without going through a buffer of our own.
+struct cached_mesh_t
+{
+    mapped_file_t file;
+
+    std::span<const vertex_t> vertices;
+
+    // 16-bit indices get used whenever every vertex can be reached with them.
+    VkIndexType index_type;
+    uint32_t index_count;
+    const void* indices;
+
+    // Only meshes too big to draw in one go have more than one.
+    std::span<const submesh_t> submeshes;
+};
+
+// Maps the cache of a mesh file. If there is no cache yet, or the mesh file has
+// changed since it was written, the mesh gets imported, fit into the unit
+// cube, optimized, split into submeshes and written to the cache first.
+auto load_mesh(std::string_view p_file_path) noexcept
+    -> kirho::result_t<cached_mesh_t, kirho::empty_t>;
+
+auto unload_mesh(const cached_mesh_t& p_mesh) noexcept -> void;
+
+} // namespace vulkan_scene
@@ -0,0 +1,883 @@
+#include <cmath>
+#include <cstring>
+
+#include <unordered_set>
+
+#include <glm/gtc/packing.hpp>
+
+#include "mesh.hpp"
+
+namespace vulkan_scene
+{
+
+namespace
+{
+
+constexpr auto NO_INDEX = std::numeric_limits<uint32_t>::max();
+
+// Forsyth's optimization simulates an LRU cache that is larger than the one
+// the statistics assume, which only affects how far the scores reach.
+constexpr uint32_t FORSYTH_CACHE_SIZE = 32;
+constexpr float FORSYTH_CACHE_DECAY_POWER = 1.5f;
+constexpr float FORSYTH_LAST_TRIANGLE_SCORE = 0.75f;
+constexpr float FORSYTH_VALENCE_BOOST_SCALE = 2.0f;
+constexpr float FORSYTH_VALENCE_BOOST_POWER = 0.5f;
+
+// Hashes the bytes of the vertex, which has no padding that could differ
+// between otherwise identical vertices.
+static_assert(sizeof(vertex_t) == 8 * sizeof(float));
+
+auto hash_vertex(const vertex_t& p_vertex) noexcept -> size_t
+{
+    // FNV-1a.
+    uint64_t hash = 14695981039346656037ull;
+
+    const auto bytes = reinterpret_cast<const unsigned char*>(&p_vertex);
+    for (size_t i = 0; i < sizeof(vertex_t); i++)
+    {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+
+    return static_cast<size_t>(hash);
+}
+
+auto get_vertex_score(
+    uint32_t p_cache_position, uint32_t p_remaining_triangle_count
+) noexcept -> float
+{
+    // Nothing left to draw with this vertex, so it shouldn't attract anything.
+    if (p_remaining_triangle_count == 0)
+    {
+        return -1.0f;
+    }
+
+    auto score = 0.0f;
+
+    // The vertices of the last triangle get a fixed score, since they were
+    // added to the cache in no particular order.
+    if (p_cache_position < 3)
+    {
+        score = FORSYTH_LAST_TRIANGLE_SCORE;
+    }
+    else if (p_cache_position < FORSYTH_CACHE_SIZE)
+    {
+        const auto scale = 1.0f / static_cast<float>(FORSYTH_CACHE_SIZE - 3);
+        score = std::pow(
+            1.0f - static_cast<float>(p_cache_position - 3) * scale,
+            FORSYTH_CACHE_DECAY_POWER
+        );
+    }
+
+    // Vertices with few triangles left get finished off first, instead of
+    // being left behind to get transformed again later.
+    score += FORSYTH_VALENCE_BOOST_SCALE *
+             std::pow(
+                 static_cast<float>(p_remaining_triangle_count),
+                 -FORSYTH_VALENCE_BOOST_POWER
+             );
+
+    return score;
+}
+
+// Simulates a FIFO cache with timestamps, so that flushing it is just a matter
+// of moving time forward.
+class fifo_cache_t
+{
+  public:
+    explicit fifo_cache_t(uint32_t p_vertex_count, uint32_t p_cache_size)
+        : m_timestamps(p_vertex_count, 0), m_time(p_cache_size + 1),
+          m_cache_size(p_cache_size)
+    {
+    }
+
+    // Returns how many of the triangle's vertices missed the cache.
+    auto add_triangle(const uint32_t* p_triangle) noexcept -> uint32_t
+    {
+        uint32_t miss_count = 0;
+        for (uint32_t i = 0; i < 3; i++)
+        {
+            auto& timestamp = m_timestamps[p_triangle[i]];
+            if (m_time - timestamp > m_cache_size)
+            {
+                timestamp = m_time++;
+                miss_count++;
+            }
+        }
+
+        return miss_count;
+    }
+
+    auto flush() noexcept -> void
+    {
+        m_time += m_cache_size + 1;
+    }
+
+  private:
+    std::vector<uint32_t> m_timestamps;
+    uint32_t m_time;
+    uint32_t m_cache_size;
+};
+
+// -1 for negative numbers and 1 for everything else, so that normals on the
+// axes still fold over properly.
+auto sign_not_zero(glm::vec2 p_value) noexcept -> glm::vec2
+{
+    return {
+        p_value.x < 0.0f ? -1.0f : 1.0f, p_value.y < 0.0f ? -1.0f : 1.0f
+    };
+}
+
+// Projects the unit sphere onto an octahedron, and folds the lower half of
+// that over the upper one to get a square (Cigolle et al., "A Survey of
+// Efficient Representations for Independent Unit Vectors").
+auto encode_octahedral(glm::vec3 p_normal) noexcept -> glm::vec2
+{
+    p_normal /= std::abs(p_normal.x) + std::abs(p_normal.y) +
+                std::abs(p_normal.z);
+
+    auto encoded = glm::vec2{p_normal.x, p_normal.y};
+    if (p_normal.z < 0.0f)
+    {
+        encoded = (1.0f - glm::abs(glm::vec2{encoded.y, encoded.x})) *
+                  sign_not_zero(encoded);
+    }
+
+    return encoded;
+}
+
+// The same as decode_octahedral in the vertex shaders.
+auto decode_octahedral(glm::vec2 p_encoded) noexcept -> glm::vec3
+{
+    auto normal = glm::vec3{
+        p_encoded.x,
+        p_encoded.y,
+        1.0f - std::abs(p_encoded.x) - std::abs(p_encoded.y),
+    };
+
+    const auto fold = std::max(-normal.z, 0.0f);
+    normal.x += normal.x >= 0.0f ? -fold : fold;
+    normal.y += normal.y >= 0.0f ? -fold : fold;
+
+    return glm::normalize(normal);
+}
+
+auto to_unorm16(float p_value) noexcept -> uint16_t
+{
+    return static_cast<uint16_t>(
+        std::round(std::clamp(p_value, 0.0f, 1.0f) * 65535.0f)
+    );
+}
+
+auto to_snorm16(float p_value) noexcept -> int16_t
+{
+    return static_cast<int16_t>(
+        std::round(std::clamp(p_value, -1.0f, 1.0f) * 32767.0f)
+    );
+}
+
+} // namespace
+
+auto get_vertex_cache_stats(
+    std::span<const uint32_t> p_indices,
+    uint32_t p_vertex_count,
+    uint32_t p_cache_size
+) -> vertex_cache_stats_t
+{
+    const auto triangle_count = p_indices.size() / 3;
+    if (triangle_count == 0 || p_vertex_count == 0)
+    {
+        return vertex_cache_stats_t{.acmr = 0.0f, .atvr = 0.0f};
+    }
+
+    fifo_cache_t cache{p_vertex_count, p_cache_size};
+
+    uint64_t miss_count = 0;
+    for (size_t i = 0; i < triangle_count; i++)
+    {
+        miss_count += cache.add_triangle(&p_indices[i * 3]);
+    }
+
+    return vertex_cache_stats_t{
+        .acmr = static_cast<float>(miss_count) /
+                static_cast<float>(triangle_count),
+        .atvr = static_cast<float>(miss_count) /
+                static_cast<float>(p_vertex_count),
+    };
+}
+
+auto weld_vertices(mesh_t& p_mesh) -> void
+{
+    const auto& vertices = p_mesh.vertices;
+
+    // The set holds indices into the vertices, so it doesn't copy any of them.
+    const auto hash = [&vertices](uint32_t p_index)
+    { return hash_vertex(vertices[p_index]); };
+    const auto equal = [&vertices](uint32_t p_first, uint32_t p_second)
+    {
+        return std::memcmp(
+                   &vertices[p_first], &vertices[p_second], sizeof(vertex_t)
+               ) == 0;
+    };
+
+    std::unordered_set<uint32_t, decltype(hash), decltype(equal)> unique{
+        vertices.size(), hash, equal
+    };
+
+    std::vector<uint32_t> remap(vertices.size());
+    std::vector<vertex_t> welded;
+    welded.reserve(vertices.size());
+
+    for (uint32_t i = 0; i < vertices.size(); i++)
+    {
+        const auto [existing, inserted] = unique.insert(i);
+        if (inserted)
+        {
+            remap[i] = static_cast<uint32_t>(welded.size());
+            welded.push_back(vertices[i]);
+        }
+        else
+        {
+            remap[i] = remap[*existing];
+        }
+    }
+
+    for (auto& index : p_mesh.indices)
+    {
+        index = remap[index];
+    }
+
+    p_mesh.vertices = std::move(welded);
+}
+
+auto optimize_vertex_cache(
+    std::span<uint32_t> p_indices, uint32_t p_vertex_count
+) -> void
+{
+    const auto triangle_count = static_cast<uint32_t>(p_indices.size() / 3);
+    if (triangle_count == 0)
+    {
+        return;
+    }
+
+    // The triangles that use each vertex and aren't drawn yet, as one range
+    // of the adjacency per vertex. Drawn triangles get swapped to the end of
+    // the range, past the remaining count.
+    std::vector<uint32_t> remaining_counts(p_vertex_count, 0);
+    for (const auto index : p_indices)
+    {
+        remaining_counts[index]++;
+    }
+
+    std::vector<uint32_t> adjacency_offsets(p_vertex_count);
+    uint32_t offset = 0;
+    for (uint32_t i = 0; i < p_vertex_count; i++)
+    {
+        adjacency_offsets[i] = offset;
+        offset += remaining_counts[i];
+    }
+
+    std::vector<uint32_t> adjacency(p_indices.size());
+    {
+        std::vector<uint32_t> filled(p_vertex_count, 0);
+        for (uint32_t i = 0; i < p_indices.size(); i++)
+        {
+            const auto vertex = p_indices[i];
+            adjacency[adjacency_offsets[vertex] + filled[vertex]++] = i / 3;
+        }
+    }
+
+    std::vector<uint32_t> cache_positions(p_vertex_count, NO_INDEX);
+
+    std::vector<float> vertex_scores(p_vertex_count);
+    for (uint32_t i = 0; i < p_vertex_count; i++)
+    {
+        vertex_scores[i] = get_vertex_score(NO_INDEX, remaining_counts[i]);
+    }
+
+    const auto get_triangle_score = [&](uint32_t p_triangle)
+    {
+        return vertex_scores[p_indices[p_triangle * 3]] +
+               vertex_scores[p_indices[p_triangle * 3 + 1]] +
+               vertex_scores[p_indices[p_triangle * 3 + 2]];
+    };
+
+    std::vector<float> triangle_scores(triangle_count);
+    std::vector<bool> drawn(triangle_count, false);
+
+    auto best_triangle = static_cast<uint32_t>(0);
+    for (uint32_t i = 0; i < triangle_count; i++)
+    {
+        triangle_scores[i] = get_triangle_score(i);
+        if (triangle_scores[i] > triangle_scores[best_triangle])
+        {
+            best_triangle = i;
+        }
+    }
+
+    // Three more than the cache holds, for the vertices that fall out of it.
+    std::array<uint32_t, FORSYTH_CACHE_SIZE + 3> cache;
+    std::array<uint32_t, FORSYTH_CACHE_SIZE + 3> new_cache;
+    uint32_t cache_size = 0;
+
+    std::vector<uint32_t> output;
+    output.reserve(p_indices.size());
+
+    // Where to look for a triangle once nothing in the cache has any left.
+    uint32_t next_undrawn = 0;
+
+    while (output.size() < p_indices.size())
+    {
+        if (best_triangle == NO_INDEX)
+        {
+            while (drawn[next_undrawn])
+            {
+                next_undrawn++;
+            }
+
+            best_triangle = next_undrawn;
+        }
+
+        const auto triangle = &p_indices[best_triangle * 3];
+        drawn[best_triangle] = true;
+
+        uint32_t new_cache_size = 0;
+        for (uint32_t i = 0; i < 3; i++)
+        {
+            const auto vertex = triangle[i];
+            output.push_back(vertex);
+
+            const auto first = adjacency.begin() + adjacency_offsets[vertex];
+            const auto last = first + remaining_counts[vertex];
+            std::iter_swap(std::find(first, last, best_triangle), last - 1);
+            remaining_counts[vertex]--;
+
+            // A degenerate triangle can use the same vertex twice.
+            const auto new_cache_end = new_cache.begin() + new_cache_size;
+            if (std::find(new_cache.begin(), new_cache_end, vertex) ==
+                new_cache_end)
+            {
+                new_cache[new_cache_size++] = vertex;
+            }
+        }
+
+        for (uint32_t i = 0; i < cache_size; i++)
+        {
+            const auto vertex = cache[i];
+            if (vertex != triangle[0] && vertex != triangle[1] &&
+                vertex != triangle[2])
+            {
+                new_cache[new_cache_size++] = vertex;
+            }
+        }
+
+        // The ones past the end of the cache just got evicted, but their
+        // scores still need to drop.
+        for (uint32_t i = 0; i < new_cache_size; i++)
+        {
+            const auto vertex = new_cache[i];
+            cache_positions[vertex] = i < FORSYTH_CACHE_SIZE ? i : NO_INDEX;
+            vertex_scores[vertex] = get_vertex_score(
+                cache_positions[vertex], remaining_counts[vertex]
+            );
+        }
+
+        // Only the triangles around the cache changed their scores, and the
+        // next triangle comes from those if there are any.
+        best_triangle = NO_INDEX;
+        auto best_score = 0.0f;
+
+        for (uint32_t i = 0; i < new_cache_size; i++)
+        {
+            const auto vertex = new_cache[i];
+            const auto first = adjacency_offsets[vertex];
+
+            for (uint32_t j = first; j < first + remaining_counts[vertex];
+                 j++)
+            {
+                const auto adjacent = adjacency[j];
+                triangle_scores[adjacent] = get_triangle_score(adjacent);
+
+                if (best_triangle == NO_INDEX ||
+                    triangle_scores[adjacent] > best_score)
+                {
+                    best_triangle = adjacent;
+                    best_score = triangle_scores[adjacent];
+                }
+            }
+        }
+
+        cache_size = std::min(new_cache_size, FORSYTH_CACHE_SIZE);
+        std::copy_n(new_cache.begin(), cache_size, cache.begin());
+    }
+
+    std::copy(output.begin(), output.end(), p_indices.begin());
+}
+
+auto optimize_overdraw(
+    std::span<uint32_t> p_indices,
+    std::span<const vertex_t> p_vertices,
+    float p_threshold
+) -> void
+{
+    const auto triangle_count = static_cast<uint32_t>(p_indices.size() / 3);
+    if (triangle_count == 0)
+    {
+        return;
+    }
+
+    const auto vertex_count = static_cast<uint32_t>(p_vertices.size());
+    fifo_cache_t cache{vertex_count, VERTEX_CACHE_SIZE};
+
+    // The cache optimization starts over wherever it runs out of neighbouring
+    // triangles, which shows as a triangle that misses with all of its
+    // vertices. Those are the hard boundaries between clusters.
+    std::vector<uint32_t> hard_starts;
+    for (uint32_t i = 0; i < triangle_count; i++)
+    {
+        if (cache.add_triangle(&p_indices[i * 3]) == 3 || i == 0)
+        {
+            hard_starts.push_back(i);
+        }
+    }
+    hard_starts.push_back(triangle_count);
+
+    // The hard clusters get split further, wherever the ACMR since the last
+    // split is within the threshold of the whole cluster's. Every cluster is
+    // counted as if it started with an empty cache, since it could end up
+    // anywhere.
+    std::vector<uint32_t> cluster_starts;
+    for (size_t i = 0; i + 1 < hard_starts.size(); i++)
+    {
+        const auto start = hard_starts[i];
+        const auto end = hard_starts[i + 1];
+
+        cache.flush();
+        uint32_t cluster_miss_count = 0;
+        for (auto j = start; j < end; j++)
+        {
+            cluster_miss_count += cache.add_triangle(&p_indices[j * 3]);
+        }
+
+        const auto target_acmr = p_threshold *
+                                 static_cast<float>(cluster_miss_count) /
+                                 static_cast<float>(end - start);
+
+        cache.flush();
+        cluster_starts.push_back(start);
+
+        auto soft_start = start;
+        uint32_t miss_count = 0;
+        for (auto j = start; j + 1 < end; j++)
+        {
+            miss_count += cache.add_triangle(&p_indices[j * 3]);
+
+            const auto acmr = static_cast<float>(miss_count) /
+                              static_cast<float>(j + 1 - soft_start);
+            if (acmr <= target_acmr)
+            {
+                cache.flush();
+                cluster_starts.push_back(j + 1);
+                soft_start = j + 1;
+                miss_count = 0;
+            }
+        }
+    }
+    cluster_starts.push_back(triangle_count);
+
+    const auto get_position = [&](uint32_t p_index)
+    { return p_vertices[p_indices[p_index]].position; };
+
+    auto mesh_center = glm::vec3{0.0f};
+    for (uint32_t i = 0; i < p_indices.size(); i++)
+    {
+        mesh_center += get_position(i);
+    }
+    mesh_center /= static_cast<float>(p_indices.size());
+
+    const auto cluster_count = static_cast<uint32_t>(cluster_starts.size() - 1);
+
+    // How far each cluster faces away from the middle of the mesh.
+    std::vector<float> cluster_keys(cluster_count);
+    for (uint32_t i = 0; i < cluster_count; i++)
+    {
+        auto center = glm::vec3{0.0f};
+        auto normal = glm::vec3{0.0f};
+
+        for (auto j = cluster_starts[i]; j < cluster_starts[i + 1]; j++)
+        {
+            const auto a = get_position(j * 3);
+            const auto b = get_position(j * 3 + 1);
+            const auto c = get_position(j * 3 + 2);
+
+            center += a + b + c;
+
+            // Weighed by the area of the triangle.
+            normal += glm::cross(b - a, c - a);
+        }
+
+        const auto cluster_size =
+            static_cast<float>(cluster_starts[i + 1] - cluster_starts[i]);
+        center /= cluster_size * 3;
+
+        const auto normal_length = glm::length(normal);
+        cluster_keys[i] =
+            normal_length > 0.0f
+                ? glm::dot(center - mesh_center, normal / normal_length)
+                : 0.0f;
+    }
+
+    std::vector<uint32_t> cluster_order(cluster_count);
+    for (uint32_t i = 0; i < cluster_count; i++)
+    {
+        cluster_order[i] = i;
+    }
+
+    std::stable_sort(
+        cluster_order.begin(), cluster_order.end(),
+        [&cluster_keys](uint32_t p_first, uint32_t p_second)
+        { return cluster_keys[p_first] > cluster_keys[p_second]; }
+    );
+
+    std::vector<uint32_t> output;
+    output.reserve(p_indices.size());
+    for (const auto cluster : cluster_order)
+    {
+        output.insert(
+            output.end(), p_indices.begin() + cluster_starts[cluster] * 3,
+            p_indices.begin() + cluster_starts[cluster + 1] * 3
+        );
+    }
+
+    std::copy(output.begin(), output.end(), p_indices.begin());
+}
+
+auto optimize_vertex_fetch(mesh_t& p_mesh) -> void
+{
+    std::vector<uint32_t> remap(p_mesh.vertices.size(), NO_INDEX);
+    std::vector<vertex_t> vertices;
+    vertices.reserve(p_mesh.vertices.size());
+
+    for (auto& index : p_mesh.indices)
+    {
+        if (remap[index] == NO_INDEX)
+        {
+            remap[index] = static_cast<uint32_t>(vertices.size());
+            vertices.push_back(p_mesh.vertices[index]);
+        }
+
+        index = remap[index];
+    }
+
+    p_mesh.vertices = std::move(vertices);
+}
+
+auto optimize_mesh(mesh_t& p_mesh) -> mesh_optimization_stats_t
+{
+    const auto original_vertex_count =
+        static_cast<uint32_t>(p_mesh.vertices.size());
+    const auto original_cache_stats =
+        get_vertex_cache_stats(p_mesh.indices, original_vertex_count);
+
+    weld_vertices(p_mesh);
+    optimize_vertex_cache(
+        p_mesh.indices, static_cast<uint32_t>(p_mesh.vertices.size())
+    );
+    optimize_overdraw(p_mesh.indices, p_mesh.vertices);
+    optimize_vertex_fetch(p_mesh);
+
+    const auto vertex_count = static_cast<uint32_t>(p_mesh.vertices.size());
+
+    return mesh_optimization_stats_t{
+        .original_vertex_count = original_vertex_count,
+        .vertex_count = vertex_count,
+        .original_cache_stats = original_cache_stats,
+        .cache_stats = get_vertex_cache_stats(p_mesh.indices, vertex_count),
+    };
+}
+
+auto print_mesh_optimization_stats(
+    std::string_view p_name, const mesh_optimization_stats_t& p_stats
+) -> void
+{
+    std::cout << "[INFO]: Optimized " << p_name << " from "
+              << p_stats.original_vertex_count << " to " << p_stats.vertex_count
+              << " vertices. ACMR went from "
+              << p_stats.original_cache_stats.acmr << " to "
+              << p_stats.cache_stats.acmr << ", ATVR from "
+              << p_stats.original_cache_stats.atvr << " to "
+              << p_stats.cache_stats.atvr << ".\n";
+}
+
+auto split_mesh(mesh_t& p_mesh, uint32_t p_max_index_value)
+    -> std::vector<submesh_t>
+{
+    if (p_mesh.vertices.size() <= size_t{p_max_index_value} + 1)
+    {
+        return {submesh_t{
+            .first_index = 0,
+            .index_count = static_cast<uint32_t>(p_mesh.indices.size()),
+            .vertex_offset = 0,
+        }};
+    }
+
+    std::vector<submesh_t> submeshes;
+    submesh_t submesh{.first_index = 0, .index_count = 0, .vertex_offset = 0};
+
+    std::vector<vertex_t> vertices;
+    vertices.reserve(p_mesh.vertices.size());
+
+    // Where each of the original vertices is in the current submesh, if it's
+    // in there yet.
+    std::vector<uint32_t> remap(p_mesh.vertices.size(), NO_INDEX);
+    std::vector<uint32_t> submesh_vertices;
+
+    for (size_t i = 0; i + 2 < p_mesh.indices.size(); i += 3)
+    {
+        const auto triangle = std::span{p_mesh.indices}.subspan(i, 3);
+
+        uint32_t new_vertex_count = 0;
+        for (size_t j = 0; j < 3; j++)
+        {
+            const auto index = triangle[j];
+            const auto repeated = std::find(
+                                      triangle.begin(), triangle.begin() + j,
+                                      index
+                                  ) != triangle.begin() + j;
+            if (remap[index] == NO_INDEX && !repeated)
+            {
+                new_vertex_count++;
+            }
+        }
+
+        const auto submesh_vertex_count = submesh_vertices.size();
+        if (submesh_vertex_count + new_vertex_count >
+            size_t{p_max_index_value} + 1)
+        {
+            submeshes.push_back(submesh);
+
+            for (const auto index : submesh_vertices)
+            {
+                remap[index] = NO_INDEX;
+            }
+            submesh_vertices.clear();
+
+            submesh = submesh_t{
+                .first_index = static_cast<uint32_t>(i),
+                .index_count = 0,
+                .vertex_offset = static_cast<int32_t>(vertices.size()),
+            };
+        }
+
+        for (auto& index : triangle)
+        {
+            if (remap[index] == NO_INDEX)
+            {
+                remap[index] = static_cast<uint32_t>(submesh_vertices.size());
+                submesh_vertices.push_back(index);
+                vertices.push_back(p_mesh.vertices[index]);
+            }
+
+            index = remap[index];
+        }
+
+        submesh.index_count += 3;
+    }
+
+    submeshes.push_back(submesh);
+    p_mesh.vertices = std::move(vertices);
+
+    return submeshes;
+}
+
+auto choose_index_type(std::span<const uint32_t> p_indices) -> VkIndexType
+{
+    const auto fits = std::all_of(
+        p_indices.begin(), p_indices.end(),
+        [](uint32_t p_index)
+        { return p_index <= std::numeric_limits<uint16_t>::max(); }
+    );
+
+    return fits ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32;
+}
+
+auto get_index_size(VkIndexType p_index_type) -> uint32_t
+{
+    return p_index_type == VK_INDEX_TYPE_UINT16 ? sizeof(uint16_t)
+                                                : sizeof(uint32_t);
+}
+
+auto pack_indices(std::span<const uint32_t> p_indices, VkIndexType p_index_type)
+    -> std::vector<uint8_t>
+{
+    std::vector<uint8_t> bytes(p_indices.size() * get_index_size(p_index_type));
+
+    if (p_index_type == VK_INDEX_TYPE_UINT32)
+    {
+        std::memcpy(bytes.data(), p_indices.data(), bytes.size());
+        return bytes;
+    }
+
+    for (size_t i = 0; i < p_indices.size(); i++)
+    {
+        const auto index = static_cast<uint16_t>(p_indices[i]);
+        std::memcpy(bytes.data() + i * sizeof(index), &index, sizeof(index));
+    }
+
+    return bytes;
+}
+
+auto get_vertex_quantization(std::span<const vertex_t> p_vertices)
+    -> vertex_quantization_t
+{
+    if (p_vertices.empty())
+    {
+        return {.offset = glm::vec3{0.0f}, .scale = glm::vec3{1.0f}};
+    }
+
+    auto min = p_vertices.front().position;
+    auto max = min;
+    for (const auto& vertex : p_vertices)
+    {
+        min = glm::min(min, vertex.position);
+        max = glm::max(max, vertex.position);
+    }
+
+    auto scale = max - min;
+    for (int i = 0; i < 3; i++)
+    {
+        if (scale[i] <= 0.0f)
+        {
+            scale[i] = 1.0f;
+        }
+    }
+
+    return {.offset = min, .scale = scale};
+}
+
+auto pack_vertex(
+    const vertex_t& p_vertex, const vertex_quantization_t& p_quantization
+) -> packed_vertex_t
+{
+    const auto position =
+        (p_vertex.position - p_quantization.offset) / p_quantization.scale;
+    const auto normal = encode_octahedral(p_vertex.normal);
+
+    return packed_vertex_t{
+        .position =
+            {to_unorm16(position.x),
+             to_unorm16(position.y),
+             to_unorm16(position.z),
+             0},
+        .normal = {to_snorm16(normal.x), to_snorm16(normal.y)},
+        .uv =
+            {glm::packHalf1x16(p_vertex.uv.x),
+             glm::packHalf1x16(p_vertex.uv.y)},
+    };
+}
+
+auto unpack_vertex(
+    const packed_vertex_t& p_vertex, const vertex_quantization_t& p_quantization
+) -> vertex_t
+{
+    const auto position = glm::vec3{
+        static_cast<float>(p_vertex.position[0]),
+        static_cast<float>(p_vertex.position[1]),
+        static_cast<float>(p_vertex.position[2]),
+    };
+
+    // SNORM has two ways of writing -1, which both mean the same.
+    const auto normal = glm::max(
+        glm::vec2{
+            static_cast<float>(p_vertex.normal[0]),
+            static_cast<float>(p_vertex.normal[1]),
+        } / 32767.0f,
+        glm::vec2{-1.0f}
+    );
+
+    return vertex_t{
+        .position =
+            p_quantization.offset + p_quantization.scale * position / 65535.0f,
+        .uv =
+            {glm::unpackHalf1x16(p_vertex.uv[0]),
+             glm::unpackHalf1x16(p_vertex.uv[1])},
+        .normal = decode_octahedral(normal),
+    };
+}
+
+auto pack_vertices(
+    std::span<const vertex_t> p_vertices,
+    const vertex_quantization_t& p_quantization
+) -> std::vector<packed_vertex_t>
+{
+    std::vector<packed_vertex_t> packed_vertices;
+    packed_vertices.reserve(p_vertices.size());
+
+    for (const auto& vertex : p_vertices)
+    {
+        packed_vertices.push_back(pack_vertex(vertex, p_quantization));
+    }
+
+    return packed_vertices;
+}
+
+auto generate_normals(mesh_t& p_mesh) -> void
+{
+    for (auto& vertex : p_mesh.vertices)
+    {
+        vertex.normal = glm::vec3{0.0f};
+    }
+
+    for (size_t i = 0; i + 2 < p_mesh.indices.size(); i += 3)
+    {
+        auto& a = p_mesh.vertices[p_mesh.indices[i]];
+        auto& b = p_mesh.vertices[p_mesh.indices[i + 1]];
+        auto& c = p_mesh.vertices[p_mesh.indices[i + 2]];
+
+        // Twice the area of the triangle long.
+        const auto normal =
+            glm::cross(b.position - a.position, c.position - a.position);
+
+        a.normal += normal;
+        b.normal += normal;
+        c.normal += normal;
+    }
+
+    for (auto& vertex : p_mesh.vertices)
+    {
+        const auto length = glm::length(vertex.normal);
+        if (length > 0.0f)
+        {
+            vertex.normal /= length;
+        }
+    }
+}
+
+auto fit_mesh_to_unit_cube(mesh_t& p_mesh) -> void
+{
+    if (p_mesh.vertices.empty())
+    {
+        return;
+    }
+
+    auto min = p_mesh.vertices.front().position;
+    auto max = min;
+    for (const auto& vertex : p_mesh.vertices)
+    {
+        min = glm::min(min, vertex.position);
+        max = glm::max(max, vertex.position);
+    }
+
+    const auto center = (min + max) * 0.5f;
+    const auto extent = max - min;
+    const auto largest_extent = std::max({extent.x, extent.y, extent.z});
+    const auto scale = largest_extent > 0.0f ? 1.0f / largest_extent : 1.0f;
+
+    // The scale is the same on every axis, so the normals stay as they are.
+    for (auto& vertex : p_mesh.vertices)
+    {
+        vertex.position = (vertex.position - center) * scale;
+    }
+}
+
+} // namespace vulkan_scene
@@ -0,0 +1,152 @@
+#pragma once
+
+#include <string_view>
+
+#include "graphics.hpp"
+
+namespace vulkan_scene
+{
+
+// The size of the FIFO post-transform vertex cache that the statistics
+// simulate. Hardware doesn't quite work like that, but meshes that do well on
+// it do well on hardware too.
+constexpr uint32_t VERTEX_CACHE_SIZE = 16;
+
+// An indexed triangle list. The indices are 32-bit while the mesh gets
+// processed, whatever width they end up uploaded with.
+struct mesh_t
+{
+    std::vector<vertex_t> vertices;
+    std::vector<uint32_t> indices;
+};
+
+struct vertex_cache_stats_t
+{
+    // Average cache miss ratio, which is how many vertices get transformed per
+    // triangle. Goes from 3 down to about 0.5 for a regular grid.
+    float acmr;
+
+    // Average transform to vertex ratio, which is how many times each vertex
+    // gets transformed. 1 is the best there is.
+    float atvr;
+};
+
+// All zeroes if there are no triangles.
+auto get_vertex_cache_stats(
+    std::span<const uint32_t> p_indices,
+    uint32_t p_vertex_count,
+    uint32_t p_cache_size = VERTEX_CACHE_SIZE
+) -> vertex_cache_stats_t;
+
+// Merges the vertices that are bitwise identical, keeping the first of each.
+// Vertices that are only nearly identical stay apart.
+auto weld_vertices(mesh_t& p_mesh) -> void;
+
+// Reorders the triangles so that neighbouring triangles share as many vertices
+// as possible, using Tom Forsyth's linear-speed vertex cache optimization. The
+// winding of each triangle is kept.
+auto optimize_vertex_cache(
+    std::span<uint32_t> p_indices, uint32_t p_vertex_count
+) -> void;
+
+// Splits the triangles into clusters and puts the ones that face outwards from
+// the middle of the mesh first, so that they are more likely to occlude the
+// rest (Sander et al., "Fast Triangle Reordering for Vertex Locality and
+// Reduced Overdraw"). Run this after optimize_vertex_cache, whose order it
+// keeps inside of the clusters. The clusters get smaller the higher the
+// threshold is, and the ACMR is allowed to get that much worse. 1.05 is 5%.
+auto optimize_overdraw(
+    std::span<uint32_t> p_indices,
+    std::span<const vertex_t> p_vertices,
+    float p_threshold = 1.05f
+) -> void;
+
+// Reorders the vertices into the order in which the indices first refer to
+// them, so that vertex fetches walk through memory mostly forwards. Vertices
+// that nothing refers to get dropped.
+auto optimize_vertex_fetch(mesh_t& p_mesh) -> void;
+
+// What optimize_mesh did to a mesh.
+struct mesh_optimization_stats_t
+{
+    uint32_t original_vertex_count;
+    uint32_t vertex_count;
+    vertex_cache_stats_t original_cache_stats;
+    vertex_cache_stats_t cache_stats;
+};
+
+// Everything above, in the order they have to run in.
+auto optimize_mesh(mesh_t& p_mesh) -> mesh_optimization_stats_t;
+
+auto print_mesh_optimization_stats(
+    std::string_view p_name, const mesh_optimization_stats_t& p_stats
+) -> void;
+
+// Without the fullDrawIndexUint32 feature, which we don't enable, indexed
+// draws can only reach this far past their vertex offset.
+constexpr uint32_t MAX_DRAW_INDEX_VALUE = (1u << 24) - 1;
+
+// A run of a mesh's triangles that gets drawn on its own, with indices that
+// are relative to its vertex offset.
+struct submesh_t
+{
+    uint32_t first_index;
+    uint32_t index_count;
+    int32_t vertex_offset;
+};
+
+// Splits the triangles, in their current order, into runs that use no more
+// than p_max_index_value + 1 vertices each. Each run gets a range of vertices
+// of its own, which its indices are relative to, so vertices that runs share
+// get copied. Meshes that fit stay as they are, in a single submesh.
+auto split_mesh(
+    mesh_t& p_mesh, uint32_t p_max_index_value = MAX_DRAW_INDEX_VALUE
+) -> std::vector<submesh_t>;
+
+// 16-bit indices if every index fits into them, 32-bit ones otherwise.
+auto choose_index_type(std::span<const uint32_t> p_indices) -> VkIndexType;
+
+auto get_index_size(VkIndexType p_index_type) -> uint32_t;
+
+// The indices at the width of p_index_type, ready to be uploaded.
+auto pack_indices(std::span<const uint32_t> p_indices, VkIndexType p_index_type)
+    -> std::vector<uint8_t>;
+
+// What the positions of packed vertices get scaled by and then moved by to
+// get back to where they were, which the vertex shader does.
+struct vertex_quantization_t
+{
+    glm::vec3 offset;
+    glm::vec3 scale;
+};
+
+// Maps the bounds of the vertices onto the range of the packed positions.
+// Along axes on which the vertices are flat, the scale is 1.
+auto get_vertex_quantization(std::span<const vertex_t> p_vertices)
+    -> vertex_quantization_t;
+
+// The normal gets normalized first, so it may be of any length other than 0.
+auto pack_vertex(
+    const vertex_t& p_vertex, const vertex_quantization_t& p_quantization
+) -> packed_vertex_t;
+
+// What the vertex shader makes of a packed vertex. The normal comes out normal.
+auto unpack_vertex(
+    const packed_vertex_t& p_vertex, const vertex_quantization_t& p_quantization
+) -> vertex_t;
+
+auto pack_vertices(
+    std::span<const vertex_t> p_vertices,
+    const vertex_quantization_t& p_quantization
+) -> std::vector<packed_vertex_t>;
+
+// Sets the normal of each vertex to the average of the triangles around it,
+// weighed by their areas. Vertices that only belong to one triangle end up
+// with that triangle's normal, so meshes without shared vertices look flat.
+auto generate_normals(mesh_t& p_mesh) -> void;
+
+// Centers the mesh on the origin and scales it so that it just fits into the
+// unit cube, which is what the scenes are laid out for.
+auto fit_mesh_to_unit_cube(mesh_t& p_mesh) -> void;
+
+} // namespace vulkan_scene
@@ -0,0 +1,155 @@
+#include <cmath>
+#include <cstring>
+
+#include "mipmap.hpp"
+
+namespace
+{
+
+constexpr uint32_t CHANNEL_COUNT = 4;
+
+auto srgb_to_linear(float p_value) noexcept -> float
+{
+    return p_value <= 0.04045f ? p_value / 12.92f
+                               : std::pow((p_value + 0.055f) / 1.055f, 2.4f);
+}
+
+auto linear_to_srgb(float p_value) noexcept -> float
+{
+    return p_value <= 0.0031308f
+               ? p_value * 12.92f
+               : 1.055f * std::pow(p_value, 1.0f / 2.4f) - 0.055f;
+}
+
+auto to_byte(float p_value) noexcept -> uint8_t
+{
+    return static_cast<uint8_t>(
+        std::clamp(p_value * 255.0f + 0.5f, 0.0f, 255.0f)
+    );
+}
+
+} // namespace
+
+namespace vulkan_scene
+{
+
+auto mip_level_count(uint32_t p_width, uint32_t p_height) noexcept -> uint32_t
+{
+    auto size = std::max(p_width, p_height);
+    auto count = static_cast<uint32_t>(1);
+
+    while (size > 1)
+    {
+        size /= 2;
+        count++;
+    }
+
+    return count;
+}
+
+auto mip_chain_layout(
+    uint32_t p_width, uint32_t p_height, uint32_t p_level_count
+) noexcept -> std::vector<mip_level_t>
+{
+    std::vector<mip_level_t> levels;
+    levels.reserve(p_level_count);
+
+    size_t offset = 0;
+    auto width = p_width;
+    auto height = p_height;
+
+    for (uint32_t i = 0; i < p_level_count; i++)
+    {
+        const auto size = static_cast<size_t>(width) * height * CHANNEL_COUNT;
+
+        levels.push_back(mip_level_t{
+            .width = width,
+            .height = height,
+            .offset = offset,
+            .size = size,
+        });
+
+        offset += size;
+        width = std::max(width / 2, static_cast<uint32_t>(1));
+        height = std::max(height / 2, static_cast<uint32_t>(1));
+    }
+
+    return levels;
+}
+
+auto generate_mip_chain(
+    const uint8_t* p_pixels,
+    uint32_t p_width,
+    uint32_t p_height,
+    uint32_t p_level_count,
+    bool p_srgb
+) noexcept -> std::vector<uint8_t>
+{
+    const auto levels = mip_chain_layout(p_width, p_height, p_level_count);
+
+    std::vector<uint8_t> chain(levels.back().offset + levels.back().size);
+    std::memcpy(chain.data(), p_pixels, levels.front().size);
+
+    // Decoding sRGB is by far the most expensive part, and there are only 256
+    // possible inputs.
+    std::array<float, 256> to_linear;
+    for (size_t i = 0; i < to_linear.size(); i++)
+    {
+        const auto value = static_cast<float>(i) / 255.0f;
+        to_linear[i] = p_srgb ? srgb_to_linear(value) : value;
+    }
+
+    for (size_t i = 1; i < levels.size(); i++)
+    {
+        const auto& source = levels[i - 1];
+        const auto& destination = levels[i];
+
+        const auto source_pixels = chain.data() + source.offset;
+        const auto destination_pixels = chain.data() + destination.offset;
+
+        for (uint32_t y = 0; y < destination.height; y++)
+        {
+            // Odd sizes lose their last row or column, and 1 pixel wide levels
+            // just sample the same one twice.
+            const auto y0 = std::min(y * 2, source.height - 1);
+            const auto y1 = std::min(y * 2 + 1, source.height - 1);
+
+            for (uint32_t x = 0; x < destination.width; x++)
+            {
+                const auto x0 = std::min(x * 2, source.width - 1);
+                const auto x1 = std::min(x * 2 + 1, source.width - 1);
+
+                const std::array<const uint8_t*, 4> samples{
+                    source_pixels + (y0 * source.width + x0) * CHANNEL_COUNT,
+                    source_pixels + (y0 * source.width + x1) * CHANNEL_COUNT,
+                    source_pixels + (y1 * source.width + x0) * CHANNEL_COUNT,
+                    source_pixels + (y1 * source.width + x1) * CHANNEL_COUNT,
+                };
+
+                const auto output = destination_pixels +
+                                    (y * destination.width + x) * CHANNEL_COUNT;
+
+                for (uint32_t channel = 0; channel < CHANNEL_COUNT; channel++)
+                {
+                    // Alpha is always linear.
+                    const auto is_color = p_srgb && channel != 3;
+
+                    auto sum = 0.0f;
+                    for (const auto sample : samples)
+                    {
+                        sum += is_color ? to_linear[sample[channel]]
+                                        : sample[channel] / 255.0f;
+                    }
+
+                    const auto average = sum / samples.size();
+                    output[channel] =
+                        to_byte(is_color ? linear_to_srgb(average) : average);
+                }
+            }
+        }
+    }
+
+    return chain;
+}
+
+} // namespace vulkan_scene
@@ -0,0 +1,37 @@
+#pragma once
+
+namespace vulkan_scene
+{
+
+struct mip_level_t
+{
+    uint32_t width;
+    uint32_t height;
+
+    // Where the level starts within the whole chain.
+    size_t offset;
+    size_t size;
+};
+
+// The number of levels in a full mip chain, down to 1x1.
+auto mip_level_count(uint32_t p_width, uint32_t p_height) noexcept -> uint32_t;
+
+// Describes how a chain of tightly packed RGBA8 levels is laid out.
+auto mip_chain_layout(
+    uint32_t p_width, uint32_t p_height, uint32_t p_level_count
+) noexcept -> std::vector<mip_level_t>;
+
+// Builds a mip chain from tightly packed RGBA8 pixels with a 2x2 box filter.
+// This is the fallback for formats that can't be blitted with linear
+// filtering. The result starts with a copy of the base level, and its levels
+// are laid out as described by mip_chain_layout. If p_srgb is set, the colour
+// channels are averaged in linear space.
+auto generate_mip_chain(
+    const uint8_t* p_pixels,
+    uint32_t p_width,
+    uint32_t p_height,
+    uint32_t p_level_count,
+    bool p_srgb
+) noexcept -> std::vector<uint8_t>;
+
+} // namespace vulkan_scene
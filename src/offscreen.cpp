@@ -0,0 +1,233 @@
+#include <fstream>
+
+#include "common.hpp"
+
+#include "offscreen.hpp"
+
+namespace vulkan_scene
+{
+
+auto create_offscreen_targets(
+    memory_allocator_t& p_allocator,
+    VkDevice p_device,
+    VkExtent2D p_extent,
+    VkRenderPass p_render_pass,
+    VkImageView p_depth_view,
+    uint32_t p_count
+) noexcept -> kirho::result_t<std::vector<offscreen_target_t>, VkResult>
+{
+    using result_t = kirho::result_t<std::vector<offscreen_target_t>, VkResult>;
+
+    const VkDeviceSize readback_size =
+        static_cast<VkDeviceSize>(p_extent.width) * p_extent.height * 4;
+
+    std::vector<offscreen_target_t> targets;
+    targets.reserve(p_count);
+
+    for (uint32_t i = 0; i < p_count; i++)
+    {
+        VkResult result;
+
+        const auto color_result = create_attachment_image(
+            p_allocator, p_device, p_extent, OFFSCREEN_FORMAT,
+            VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT |
+                VK_IMAGE_USAGE_TRANSFER_SRC_BIT
+        );
+        if (color_result.is_error(result))
+        {
+            destroy_offscreen_targets(p_device, p_allocator, targets);
+            return result_t::error(result);
+        }
+
+        const auto color = color_result.unwrap();
+
+        const auto readback_result =
+            create_readback_buffer(p_allocator, p_device, readback_size);
+        if (readback_result.is_error(result))
+        {
+            destroy_image(p_device, p_allocator, color);
+            destroy_offscreen_targets(p_device, p_allocator, targets);
+            return result_t::error(result);
+        }
+
+        const auto readback = readback_result.unwrap();
+
+        const std::array attachments{color.view, p_depth_view};
+
+        const VkFramebufferCreateInfo framebuffer_info{
+            .sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = 0,
+            .renderPass = p_render_pass,
+            .attachmentCount = static_cast<uint32_t>(attachments.size()),
+            .pAttachments = attachments.data(),
+            .width = p_extent.width,
+            .height = p_extent.height,
+            .layers = 1,
+        };
+
+        VkFramebuffer framebuffer;
+        result = vkCreateFramebuffer(
+            p_device, &framebuffer_info, nullptr, &framebuffer
+        );
+        if (result != VK_SUCCESS)
+        {
+            print_error(
+                "Failed to create an offscreen framebuffer. Vulkan error ",
+                result, '.'
+            );
+            destroy_buffer(p_device, p_allocator, readback);
+            destroy_image(p_device, p_allocator, color);
+            destroy_offscreen_targets(p_device, p_allocator, targets);
+            return result_t::error(result);
+        }
+
+        // The readback buffers are host visible, so the allocator has already
+        // mapped them for us.
+        targets.push_back(offscreen_target_t{
+            .color = color,
+            .framebuffer = framebuffer,
+            .readback = readback,
+            .readback_data = readback.allocation.mapped,
+        });
+    }
+
+    return result_t::success(targets);
+}
+
+auto record_readback(
+    VkCommandBuffer p_command_buffer,
+    const offscreen_target_t& p_target,
+    VkExtent2D p_extent
+) noexcept -> void
+{
+    // The render pass already transitioned the image, but its writes still
+    // have to be made visible to the transfer.
+    const VkImageMemoryBarrier image_barrier{
+        .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+        .pNext = nullptr,
+        .srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+        .dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT,
+        .oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+        .newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+        .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .image = p_target.color.image,
+        .subresourceRange =
+            VkImageSubresourceRange{
+                .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                .baseMipLevel = 0,
+                .levelCount = 1,
+                .baseArrayLayer = 0,
+                .layerCount = 1,
+            },
+    };
+
+    vkCmdPipelineBarrier(
+        p_command_buffer, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+        VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1,
+        &image_barrier
+    );
+
+    const VkBufferImageCopy region{
+        .bufferOffset = 0,
+        .bufferRowLength = 0,
+        .bufferImageHeight = 0,
+        .imageSubresource =
+            VkImageSubresourceLayers{
+                .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                .mipLevel = 0,
+                .baseArrayLayer = 0,
+                .layerCount = 1,
+            },
+        .imageOffset =
+            VkOffset3D{
+                .x = 0,
+                .y = 0,
+                .z = 0,
+            },
+        .imageExtent =
+            VkExtent3D{
+                .width = p_extent.width,
+                .height = p_extent.height,
+                .depth = 1,
+            },
+    };
+
+    vkCmdCopyImageToBuffer(
+        p_command_buffer, p_target.color.image,
+        VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, p_target.readback.buffer, 1,
+        &region
+    );
+
+    const VkBufferMemoryBarrier buffer_barrier{
+        .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+        .pNext = nullptr,
+        .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+        .dstAccessMask = VK_ACCESS_HOST_READ_BIT,
+        .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .buffer = p_target.readback.buffer,
+        .offset = 0,
+        .size = VK_WHOLE_SIZE,
+    };
+
+    vkCmdPipelineBarrier(
+        p_command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT,
+        VK_PIPELINE_STAGE_HOST_BIT, 0, 0, nullptr, 1, &buffer_barrier, 0,
+        nullptr
+    );
+}
+
+auto write_readback_to_file(
+    const offscreen_target_t& p_target,
+    VkExtent2D p_extent,
+    std::string_view p_file_path
+) noexcept -> kirho::result_t<kirho::empty_t, kirho::empty_t>
+{
+    using result_t = kirho::result_t<kirho::empty_t, kirho::empty_t>;
+
+    std::ofstream file_stream{p_file_path.data(), std::ios::binary};
+    if (!file_stream)
+    {
+        print_error("Failed to open ", p_file_path, " for writing.");
+        return result_t::error(kirho::empty_t{});
+    }
+
+    file_stream << "P6\n"
+                << p_extent.width << ' ' << p_extent.height << "\n255\n";
+
+    // PPM has no alpha channel, so it gets dropped.
+    const auto pixels = static_cast<const uint8_t*>(p_target.readback_data);
+    const auto pixel_count =
+        static_cast<size_t>(p_extent.width) * p_extent.height;
+
+    for (size_t i = 0; i < pixel_count; i++)
+    {
+        file_stream.write(reinterpret_cast<const char*>(pixels + i * 4), 3);
+    }
+
+    if (!file_stream)
+    {
+        print_error("Failed to write to ", p_file_path, '.');
+        return result_t::error(kirho::empty_t{});
+    }
+
+    return result_t::success(kirho::empty_t{});
+}
+
+auto destroy_offscreen_targets(
+    VkDevice p_device,
+    memory_allocator_t& p_allocator,
+    const std::vector<offscreen_target_t>& p_targets
+) noexcept -> void
+{
+    for (const auto& target : p_targets)
+    {
+        vkDestroyFramebuffer(p_device, target.framebuffer, nullptr);
+        destroy_buffer(p_device, p_allocator, target.readback);
+        destroy_image(p_device, p_allocator, target.color);
+    }
+}
+
+} // namespace vulkan_scene
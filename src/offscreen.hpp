@@ -0,0 +1,56 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include "graphics.hpp"
+
+namespace vulkan_scene
+{
+
+constexpr VkFormat OFFSCREEN_FORMAT = VK_FORMAT_R8G8B8A8_SRGB;
+
+// A color image that we render into instead of a swapchain image, along with a
+// host-visible buffer that the result gets copied back into.
+struct offscreen_target_t
+{
+    image_t color;
+    VkFramebuffer framebuffer;
+    buffer_t readback;
+    const void* readback_data;
+};
+
+// Creates one target per frame in flight, so that a frame can be read back
+// while the next one is rendering. The render pass must leave its color
+// attachment in VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL. The depth attachment is
+// shared between all of the targets.
+auto create_offscreen_targets(
+    memory_allocator_t& p_allocator,
+    VkDevice p_device,
+    VkExtent2D p_extent,
+    VkRenderPass p_render_pass,
+    VkImageView p_depth_view,
+    uint32_t p_count
+) noexcept -> kirho::result_t<std::vector<offscreen_target_t>, VkResult>;
+
+// Records the copy of the color image into the readback buffer. Must be
+// recorded after the render pass has ended.
+auto record_readback(
+    VkCommandBuffer p_command_buffer,
+    const offscreen_target_t& p_target,
+    VkExtent2D p_extent
+) noexcept -> void;
+
+// Writes the contents of the readback buffer as a binary PPM image.
+auto write_readback_to_file(
+    const offscreen_target_t& p_target,
+    VkExtent2D p_extent,
+    std::string_view p_file_path
+) noexcept -> kirho::result_t<kirho::empty_t, kirho::empty_t>;
+
+auto destroy_offscreen_targets(
+    VkDevice p_device,
+    memory_allocator_t& p_allocator,
+    const std::vector<offscreen_target_t>& p_targets
+) noexcept -> void;
+
+} // namespace vulkan_scene
@@ -0,0 +1,284 @@
+#include <cstring>
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include "common.hpp"
+
+#include "pipeline-cache.hpp"
+
+namespace
+{
+
+using vulkan_scene::print_error;
+
+// "VSPC" in little endian.
+constexpr uint32_t PIPELINE_CACHE_MAGIC = 0x43505356;
+constexpr uint32_t PIPELINE_CACHE_FILE_VERSION = 1;
+
+// Comes before the cache data in the file. The data has a header of its own,
+// but that one doesn't include the driver version, and drivers aren't always
+// good at rejecting data from older versions of themselves.
+struct pipeline_cache_file_header_t
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t vendor_id;
+    uint32_t device_id;
+    uint32_t driver_version;
+    uint8_t cache_uuid[VK_UUID_SIZE];
+    uint64_t data_size;
+    uint64_t data_hash;
+};
+
+// FNV-1a. Only meant to catch truncated or otherwise mangled files.
+auto hash_data(std::span<const uint8_t> p_data) noexcept -> uint64_t
+{
+    auto hash = static_cast<uint64_t>(0xcbf29ce484222325);
+
+    for (const auto byte : p_data)
+    {
+        hash ^= byte;
+        hash *= 0x100000001b3;
+    }
+
+    return hash;
+}
+
+auto make_file_header(
+    const VkPhysicalDeviceProperties& p_properties,
+    std::span<const uint8_t> p_data
+) noexcept -> pipeline_cache_file_header_t
+{
+    pipeline_cache_file_header_t header{
+        .magic = PIPELINE_CACHE_MAGIC,
+        .version = PIPELINE_CACHE_FILE_VERSION,
+        .vendor_id = p_properties.vendorID,
+        .device_id = p_properties.deviceID,
+        .driver_version = p_properties.driverVersion,
+        .cache_uuid = {},
+        .data_size = p_data.size(),
+        .data_hash = hash_data(p_data),
+    };
+
+    std::memcpy(
+        header.cache_uuid, p_properties.pipelineCacheUUID, VK_UUID_SIZE
+    );
+
+    return header;
+}
+
+// Checks the header that Vulkan puts in front of the cache data itself.
+auto is_data_header_valid(
+    const VkPhysicalDeviceProperties& p_properties,
+    std::span<const uint8_t> p_data
+) noexcept -> bool
+{
+    VkPipelineCacheHeaderVersionOne header;
+    if (p_data.size() < sizeof(header))
+    {
+        return false;
+    }
+
+    std::memcpy(&header, p_data.data(), sizeof(header));
+
+    return header.headerSize >= sizeof(header) &&
+           header.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+           header.vendorID == p_properties.vendorID &&
+           header.deviceID == p_properties.deviceID &&
+           std::memcmp(
+               header.pipelineCacheUUID, p_properties.pipelineCacheUUID,
+               VK_UUID_SIZE
+           ) == 0;
+}
+
+// Returns nothing if the file doesn't exist or can't be used on this device.
+auto read_cache_file(
+    const VkPhysicalDeviceProperties& p_properties,
+    std::string_view p_file_path
+) noexcept -> std::vector<uint8_t>
+{
+    std::ifstream file_stream{
+        p_file_path.data(), std::ios::binary | std::ios::ate
+    };
+    if (!file_stream)
+    {
+        return {};
+    }
+
+    const auto file_size = static_cast<uint64_t>(file_stream.tellg());
+    file_stream.seekg(0);
+
+    pipeline_cache_file_header_t header;
+    file_stream.read(reinterpret_cast<char*>(&header), sizeof(header));
+
+    const auto expected_header = make_file_header(p_properties, {});
+
+    if (!file_stream || header.magic != expected_header.magic ||
+        header.version != expected_header.version)
+    {
+        print_error(p_file_path, " is not a pipeline cache. Ignoring it.");
+        return {};
+    }
+
+    if (header.vendor_id != expected_header.vendor_id ||
+        header.device_id != expected_header.device_id ||
+        header.driver_version != expected_header.driver_version ||
+        std::memcmp(
+            header.cache_uuid, expected_header.cache_uuid, VK_UUID_SIZE
+        ) != 0)
+    {
+        std::cout << "[INFO]: The pipeline cache in " << p_file_path
+                  << " was written by a different device or driver. Starting "
+                     "with an empty one.\n";
+        return {};
+    }
+
+    // The size comes from the file, so it has to be checked before anything
+    // gets allocated with it.
+    if (header.data_size > file_size - sizeof(header))
+    {
+        print_error(
+            "The pipeline cache in ", p_file_path, " is corrupt. Ignoring it."
+        );
+        return {};
+    }
+
+    std::vector<uint8_t> data(header.data_size);
+    file_stream.read(reinterpret_cast<char*>(data.data()), data.size());
+
+    if (!file_stream || hash_data(data) != header.data_hash ||
+        !is_data_header_valid(p_properties, data))
+    {
+        print_error(
+            "The pipeline cache in ", p_file_path, " is corrupt. Ignoring it."
+        );
+        return {};
+    }
+
+    return data;
+}
+
+} // namespace
+
+namespace vulkan_scene
+{
+
+auto create_pipeline_cache(
+    VkPhysicalDevice p_physical_device,
+    VkDevice p_device,
+    std::string_view p_file_path
+) noexcept -> kirho::result_t<pipeline_cache_t, VkResult>
+{
+    using result_t = kirho::result_t<pipeline_cache_t, VkResult>;
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(p_physical_device, &properties);
+
+    const auto data = read_cache_file(properties, p_file_path);
+
+    const VkPipelineCacheCreateInfo cache_info{
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,
+        .pNext = nullptr,
+        .flags = 0,
+        .initialDataSize = data.size(),
+        .pInitialData = data.empty() ? nullptr : data.data(),
+    };
+
+    VkPipelineCache cache;
+    const auto result =
+        vkCreatePipelineCache(p_device, &cache_info, nullptr, &cache);
+    if (result != VK_SUCCESS)
+    {
+        print_error(
+            "Failed to create the pipeline cache. Vulkan error ", result, '.'
+        );
+        return result_t::error(result);
+    }
+
+    if (!data.empty())
+    {
+        std::cout << "[INFO]: Loaded " << data.size()
+                  << " bytes of pipeline cache from " << p_file_path << ".\n";
+    }
+
+    return result_t::success(pipeline_cache_t{
+        .cache = cache,
+        .loaded = !data.empty(),
+    });
+}
+
+auto save_pipeline_cache(
+    VkPhysicalDevice p_physical_device,
+    VkDevice p_device,
+    VkPipelineCache p_cache,
+    std::string_view p_file_path
+) noexcept -> kirho::result_t<kirho::empty_t, kirho::empty_t>
+{
+    using result_t = kirho::result_t<kirho::empty_t, kirho::empty_t>;
+
+    size_t data_size;
+    auto result = vkGetPipelineCacheData(p_device, p_cache, &data_size, nullptr);
+    if (result != VK_SUCCESS)
+    {
+        print_error(
+            "Failed to get the size of the pipeline cache. Vulkan error ",
+            result, '.'
+        );
+        return result_t::error(kirho::empty_t{});
+    }
+
+    std::vector<uint8_t> data(data_size);
+    result = vkGetPipelineCacheData(p_device, p_cache, &data_size, data.data());
+    if (result != VK_SUCCESS)
+    {
+        print_error(
+            "Failed to get the pipeline cache data. Vulkan error ", result, '.'
+        );
+        return result_t::error(kirho::empty_t{});
+    }
+    data.resize(data_size);
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(p_physical_device, &properties);
+
+    const auto header = make_file_header(properties, data);
+
+    const auto temporary_path = std::string{p_file_path} + ".tmp";
+
+    {
+        std::ofstream file_stream{temporary_path, std::ios::binary};
+        file_stream.write(
+            reinterpret_cast<const char*>(&header), sizeof(header)
+        );
+        file_stream.write(
+            reinterpret_cast<const char*>(data.data()), data.size()
+        );
+        file_stream.close();
+
+        if (!file_stream)
+        {
+            print_error("Failed to write ", temporary_path, '.');
+            std::error_code error;
+            std::filesystem::remove(temporary_path, error);
+            return result_t::error(kirho::empty_t{});
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::rename(temporary_path, p_file_path, error);
+    if (error)
+    {
+        print_error(
+            "Failed to move the pipeline cache into ", p_file_path, ": ",
+            error.message(), '.'
+        );
+        std::filesystem::remove(temporary_path, error);
+        return result_t::error(kirho::empty_t{});
+    }
+
+    return result_t::success();
+}
+
+} // namespace vulkan_scene
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <string_view>
+
+#include <vulkan/vulkan.h>
+
+namespace vulkan_scene
+{
+
+constexpr std::string_view DEFAULT_PIPELINE_CACHE_PATH = "pipeline-cache.bin";
+
+struct pipeline_cache_t
+{
+    VkPipelineCache cache;
+
+    // Whether anything was loaded from disk, i.e. whether pipeline creation is
+    // going to be warm or cold.
+    bool loaded;
+};
+
+// Creates a pipeline cache, seeded with the contents of p_file_path if that
+// file was written by the same device and driver. A missing, stale or corrupt
+// file just results in an empty cache.
+auto create_pipeline_cache(
+    VkPhysicalDevice p_physical_device,
+    VkDevice p_device,
+    std::string_view p_file_path
+) noexcept -> kirho::result_t<pipeline_cache_t, VkResult>;
+
+// Writes the cache to a temporary file next to p_file_path and renames it into
+// place, so that a crash halfway through never leaves a truncated cache behind.
+auto save_pipeline_cache(
+    VkPhysicalDevice p_physical_device,
+    VkDevice p_device,
+    VkPipelineCache p_cache,
+    std::string_view p_file_path
+) noexcept -> kirho::result_t<kirho::empty_t, kirho::empty_t>;
+
+} // namespace vulkan_scene
@@ -0,0 +1,170 @@
+#include "common.hpp"
+
+#include "pipeline-statistics.hpp"
+
+namespace vulkan_scene
+{
+
+auto create_pipeline_statistics(
+    VkPhysicalDevice p_physical_device,
+    VkDevice p_device,
+    uint32_t p_frame_count,
+    bool p_secondary_command_buffers
+) noexcept -> kirho::result_t<pipeline_statistics_t, VkResult>
+{
+    using result_t = kirho::result_t<pipeline_statistics_t, VkResult>;
+
+    pipeline_statistics_t statistics{
+        .query_pool = VK_NULL_HANDLE,
+        .pending = std::vector<bool>(p_frame_count, false),
+        .fragment_invocations = 0,
+        .frame_count = 0,
+    };
+
+    // create_logical_device enables the features whenever they're there.
+    VkPhysicalDeviceFeatures features;
+    vkGetPhysicalDeviceFeatures(p_physical_device, &features);
+    if (!features.pipelineStatisticsQuery)
+    {
+        std::cout << "[INFO]: Pipeline statistics aren't supported, so the "
+                     "overdraw won't be measured.\n";
+        return result_t::success(statistics);
+    }
+
+    if (p_secondary_command_buffers && !features.inheritedQueries)
+    {
+        std::cout << "[INFO]: Secondary command buffers can't inherit queries, "
+                     "so the overdraw won't be measured.\n";
+        return result_t::success(statistics);
+    }
+
+    const VkQueryPoolCreateInfo query_pool_info{
+        .sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+        .pNext = nullptr,
+        .flags = 0,
+        .queryType = VK_QUERY_TYPE_PIPELINE_STATISTICS,
+        .queryCount = p_frame_count,
+        .pipelineStatistics =
+            VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT,
+    };
+
+    const auto result = vkCreateQueryPool(
+        p_device, &query_pool_info, nullptr, &statistics.query_pool
+    );
+    if (result != VK_SUCCESS)
+    {
+        print_error(
+            "Failed to create a query pool. Vulkan error ", result, '.'
+        );
+        return result_t::error(result);
+    }
+
+    return result_t::success(statistics);
+}
+
+auto get_pipeline_statistic_flags(const pipeline_statistics_t& p_statistics
+) noexcept -> VkQueryPipelineStatisticFlags
+{
+    return p_statistics.query_pool == VK_NULL_HANDLE
+               ? 0
+               : VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT;
+}
+
+auto begin_pipeline_statistics(
+    VkCommandBuffer p_command_buffer,
+    const pipeline_statistics_t& p_statistics,
+    uint32_t p_frame_index
+) noexcept -> void
+{
+    if (p_statistics.query_pool == VK_NULL_HANDLE)
+    {
+        return;
+    }
+
+    vkCmdResetQueryPool(
+        p_command_buffer, p_statistics.query_pool, p_frame_index, 1
+    );
+    vkCmdBeginQuery(
+        p_command_buffer, p_statistics.query_pool, p_frame_index, 0
+    );
+}
+
+auto end_pipeline_statistics(
+    VkCommandBuffer p_command_buffer,
+    pipeline_statistics_t& p_statistics,
+    uint32_t p_frame_index
+) noexcept -> void
+{
+    if (p_statistics.query_pool == VK_NULL_HANDLE)
+    {
+        return;
+    }
+
+    vkCmdEndQuery(p_command_buffer, p_statistics.query_pool, p_frame_index);
+    p_statistics.pending[p_frame_index] = true;
+}
+
+auto collect_pipeline_statistics(
+    VkDevice p_device,
+    pipeline_statistics_t& p_statistics,
+    uint32_t p_frame_index
+) noexcept -> void
+{
+    if (p_statistics.query_pool == VK_NULL_HANDLE ||
+        !p_statistics.pending[p_frame_index])
+    {
+        return;
+    }
+
+    uint64_t fragment_invocations;
+    const auto result = vkGetQueryPoolResults(
+        p_device, p_statistics.query_pool, p_frame_index, 1,
+        sizeof(fragment_invocations), &fragment_invocations,
+        sizeof(fragment_invocations), VK_QUERY_RESULT_64_BIT
+    );
+
+    p_statistics.pending[p_frame_index] = false;
+
+    // The frame's fence has already been signaled, so the results should
+    // always be there. If not, the frame just doesn't count.
+    if (result != VK_SUCCESS)
+    {
+        return;
+    }
+
+    p_statistics.fragment_invocations += fragment_invocations;
+    p_statistics.frame_count++;
+}
+
+auto print_pipeline_statistics(
+    const pipeline_statistics_t& p_statistics, VkExtent2D p_extent
+) noexcept -> void
+{
+    if (p_statistics.frame_count == 0)
+    {
+        return;
+    }
+
+    const auto fragments_per_frame =
+        static_cast<double>(p_statistics.fragment_invocations) /
+        static_cast<double>(p_statistics.frame_count);
+
+    const auto pixel_count =
+        static_cast<double>(p_extent.width) * p_extent.height;
+
+    std::cout << "[INFO]: Fragment shader invocations: " << fragments_per_frame
+              << " per frame, " << fragments_per_frame / pixel_count
+              << " per pixel.\n";
+}
+
+auto destroy_pipeline_statistics(
+    VkDevice p_device, const pipeline_statistics_t& p_statistics
+) noexcept -> void
+{
+    if (p_statistics.query_pool != VK_NULL_HANDLE)
+    {
+        vkDestroyQueryPool(p_device, p_statistics.query_pool, nullptr);
+    }
+}
+
+} // namespace vulkan_scene
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+namespace vulkan_scene
+{
+
+// Counts the fragment shader invocations of every frame, which is how much
+// overdraw there is once it's compared to the number of pixels. There is one
+// query per frame in flight, so reading the results never stalls on a frame
+// that is still being rendered.
+struct pipeline_statistics_t
+{
+    // VK_NULL_HANDLE if the device doesn't support pipeline statistics, in
+    // which case all of the functions below do nothing.
+    VkQueryPool query_pool;
+
+    // Whether the query of each frame has been ended but not read yet.
+    std::vector<bool> pending;
+
+    uint64_t fragment_invocations;
+    uint64_t frame_count;
+};
+
+// If the draws are recorded into secondary command buffers, those have to
+// inherit the query, which needs the inheritedQueries feature. Without it, no
+// statistics get collected either.
+auto create_pipeline_statistics(
+    VkPhysicalDevice p_physical_device,
+    VkDevice p_device,
+    uint32_t p_frame_count,
+    bool p_secondary_command_buffers
+) noexcept -> kirho::result_t<pipeline_statistics_t, VkResult>;
+
+// The statistics that the query counts, or none without a query pool. Secondary
+// command buffers that run while the query is active must inherit these.
+auto get_pipeline_statistic_flags(const pipeline_statistics_t& p_statistics
+) noexcept -> VkQueryPipelineStatisticFlags;
+
+// Both must be recorded outside of a render pass, around the draws that are
+// supposed to be counted.
+auto begin_pipeline_statistics(
+    VkCommandBuffer p_command_buffer,
+    const pipeline_statistics_t& p_statistics,
+    uint32_t p_frame_index
+) noexcept -> void;
+
+auto end_pipeline_statistics(
+    VkCommandBuffer p_command_buffer,
+    pipeline_statistics_t& p_statistics,
+    uint32_t p_frame_index
+) noexcept -> void;
+
+// Adds the results of the given frame to the totals. Only call this once the
+// fence of that frame has been waited on.
+auto collect_pipeline_statistics(
+    VkDevice p_device,
+    pipeline_statistics_t& p_statistics,
+    uint32_t p_frame_index
+) noexcept -> void;
+
+// Prints the average number of fragment invocations per frame and per pixel.
+auto print_pipeline_statistics(
+    const pipeline_statistics_t& p_statistics, VkExtent2D p_extent
+) noexcept -> void;
+
+auto destroy_pipeline_statistics(
+    VkDevice p_device, const pipeline_statistics_t& p_statistics
+) noexcept -> void;
+
+} // namespace vulkan_scene
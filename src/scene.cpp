@@ -0,0 +1,101 @@
+#include <cmath>
+
+#include "scene.hpp"
+
+namespace vulkan_scene
+{
+
+auto create_lattice_scene(uint32_t p_object_count) -> scene_t
+{
+    auto side = static_cast<uint32_t>(std::cbrt(p_object_count));
+    while (side * side * side < p_object_count)
+    {
+        side++;
+    }
+
+    const auto half_extent = static_cast<float>(side - 1) * LATTICE_SPACING / 2;
+
+    scene_t scene{
+        .objects = {},
+        .radius = std::sqrt(3.0f) * (half_extent + 0.5f),
+    };
+    scene.objects.reserve(p_object_count);
+
+    for (uint32_t i = 0; i < p_object_count; i++)
+    {
+        const auto x = i % side;
+        const auto y = i / side % side;
+        const auto z = i / (side * side);
+
+        scene.objects.push_back(scene_object_t{
+            .position =
+                glm::vec3{
+                    static_cast<float>(x) * LATTICE_SPACING - half_extent,
+                    static_cast<float>(y) * LATTICE_SPACING - half_extent,
+                    static_cast<float>(z) * LATTICE_SPACING - half_extent,
+                },
+        });
+    }
+
+    return scene;
+}
+
+auto parse_draw_order(std::string_view p_name) noexcept
+    -> std::optional<draw_order_t>
+{
+    if (p_name == "unsorted")
+    {
+        return draw_order_t::UNSORTED;
+    }
+
+    if (p_name == "front-to-back")
+    {
+        return draw_order_t::FRONT_TO_BACK;
+    }
+
+    if (p_name == "back-to-front")
+    {
+        return draw_order_t::BACK_TO_FRONT;
+    }
+
+    return std::nullopt;
+}
+
+auto sort_draws(
+    std::span<const scene_object_t> p_objects,
+    const glm::mat4& p_model_view,
+    draw_order_t p_order,
+    std::vector<draw_t>& p_draws
+) -> void
+{
+    p_draws.clear();
+    p_draws.reserve(p_objects.size());
+
+    // Only the z row of the matrix matters, so the depths are computed once
+    // per object instead of on every comparison.
+    for (uint32_t i = 0; i < p_objects.size(); i++)
+    {
+        const auto& position = p_objects[i].position;
+
+        p_draws.push_back(draw_t{
+            .object_index = i,
+            .depth = p_model_view[0][2] * position.x +
+                     p_model_view[1][2] * position.y +
+                     p_model_view[2][2] * position.z + p_model_view[3][2],
+        });
+    }
+
+    switch (p_order)
+    {
+    case draw_order_t::UNSORTED:
+        break;
+    case draw_order_t::FRONT_TO_BACK:
+        std::ranges::sort(p_draws, std::ranges::greater{}, &draw_t::depth);
+        break;
+    case draw_order_t::BACK_TO_FRONT:
+        std::ranges::sort(p_draws, std::ranges::less{}, &draw_t::depth);
+        break;
+    }
+}
+
+} // namespace vulkan_scene
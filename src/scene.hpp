@@ -0,0 +1,61 @@
+#pragma once
+
+#include <string_view>
+
+#include <glm/glm.hpp>
+
+namespace vulkan_scene
+{
+
+// Spacing between the centers of neighbouring cubes in a lattice scene.
+constexpr float LATTICE_SPACING = 1.5f;
+
+struct scene_object_t
+{
+    glm::vec3 position;
+};
+
+struct scene_t
+{
+    std::vector<scene_object_t> objects;
+
+    // Radius of a sphere around the origin that contains every object.
+    float radius;
+};
+
+// Lays out unit cubes on a cube-shaped lattice centered on the origin. With a
+// count of one, that's a single cube at the origin.
+auto create_lattice_scene(uint32_t p_object_count) -> scene_t;
+
+enum class draw_order_t
+{
+    UNSORTED,
+    // Closest first, so that the depth test rejects hidden fragments before
+    // their fragment shader runs. This is the order for opaque geometry.
+    FRONT_TO_BACK,
+    // Farthest first, which is the worst case for overdraw.
+    BACK_TO_FRONT,
+};
+
+auto parse_draw_order(std::string_view p_name) noexcept
+    -> std::optional<draw_order_t>;
+
+struct draw_t
+{
+    uint32_t object_index;
+
+    // View-space z of the object's center. The camera looks down -z, so
+    // larger values are closer.
+    float depth;
+};
+
+// Fills p_draws with one draw per object, in the requested order. The vector
+// is only cleared, so reusing it across frames doesn't allocate.
+auto sort_draws(
+    std::span<const scene_object_t> p_objects,
+    const glm::mat4& p_model_view,
+    draw_order_t p_order,
+    std::vector<draw_t>& p_draws
+) -> void;
+
+} // namespace vulkan_scene
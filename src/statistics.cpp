@@ -0,0 +1,88 @@
+#include <cmath>
+
+#include "statistics.hpp"
+
+namespace vulkan_scene
+{
+
+auto get_sample_stats(std::span<const double> p_samples) -> sample_stats_t
+{
+    if (p_samples.empty())
+    {
+        return sample_stats_t{
+            .count = 0,
+            .min = 0.0,
+            .max = 0.0,
+            .mean = 0.0,
+            .median = 0.0,
+            .p95 = 0.0,
+            .p99 = 0.0,
+        };
+    }
+
+    std::vector<double> sorted{p_samples.begin(), p_samples.end()};
+    std::ranges::sort(sorted);
+
+    double total = 0.0;
+    for (const auto sample : sorted)
+    {
+        total += sample;
+    }
+
+    return sample_stats_t{
+        .count = sorted.size(),
+        .min = sorted.front(),
+        .max = sorted.back(),
+        .mean = total / static_cast<double>(sorted.size()),
+        .median = get_percentile(sorted, 50.0),
+        .p95 = get_percentile(sorted, 95.0),
+        .p99 = get_percentile(sorted, 99.0),
+    };
+}
+
+auto get_percentile(std::span<const double> p_sorted_samples, double p_percent)
+    -> double
+{
+    const auto rank = static_cast<size_t>(std::ceil(
+        p_percent / 100.0 * static_cast<double>(p_sorted_samples.size())
+    ));
+
+    return p_sorted_samples[std::clamp(
+        rank, static_cast<size_t>(1), p_sorted_samples.size()
+    ) - 1];
+}
+
+auto get_histogram(std::span<const double> p_samples, uint32_t p_bucket_count)
+    -> histogram_t
+{
+    histogram_t histogram{
+        .start = 0.0,
+        .bucket_width = 0.0,
+        .counts = std::vector<uint32_t>(p_bucket_count, 0),
+    };
+
+    if (p_samples.empty() || p_bucket_count == 0)
+    {
+        return histogram;
+    }
+
+    const auto [min, max] = std::ranges::minmax(p_samples);
+
+    histogram.start = min;
+    histogram.bucket_width = (max - min) / p_bucket_count;
+
+    for (const auto sample : p_samples)
+    {
+        // The largest sample would land just past the last bucket.
+        const auto bucket =
+            histogram.bucket_width > 0.0
+                ? static_cast<uint32_t>((sample - min) / histogram.bucket_width)
+                : 0;
+
+        histogram.counts[std::min(bucket, p_bucket_count - 1)]++;
+    }
+
+    return histogram;
+}
+
+} // namespace vulkan_scene
@@ -0,0 +1,36 @@
+#pragma once
+
+namespace vulkan_scene
+{
+
+struct sample_stats_t
+{
+    size_t count;
+    double min;
+    double max;
+    double mean;
+    double median;
+    double p95;
+    double p99;
+};
+
+// All zeroes if there are no samples.
+auto get_sample_stats(std::span<const double> p_samples) -> sample_stats_t;
+
+// Nearest-rank percentile, from 0 to 100. The samples must be sorted and not
+// empty.
+auto get_percentile(std::span<const double> p_sorted_samples, double p_percent)
+    -> double;
+
+// Equally sized buckets that go from the smallest sample to the largest.
+struct histogram_t
+{
+    double start;
+    double bucket_width;
+    std::vector<uint32_t> counts;
+};
+
+auto get_histogram(std::span<const double> p_samples, uint32_t p_bucket_count)
+    -> histogram_t;
+
+} // namespace vulkan_scene
@@ -0,0 +1,265 @@
+#include "common.hpp"
+
+#include "sub-allocator.hpp"
+
+namespace vulkan_scene
+{
+
+sub_allocator_t::sub_allocator_t(
+    uint64_t p_size, allocation_strategy_t p_strategy, uint64_t p_granularity
+) noexcept
+    : m_size(p_size), m_strategy(p_strategy),
+      m_granularity(std::max(p_granularity, static_cast<uint64_t>(1))),
+      m_used(0), m_allocation_count(0), m_linear_head(0)
+{
+    if (m_strategy == allocation_strategy_t::FREE_LIST)
+    {
+        m_ranges.emplace(
+            0, range_t{
+                   .size = m_size,
+                   .kind = resource_kind_t::LINEAR,
+                   .free = true,
+               }
+        );
+    }
+}
+
+auto sub_allocator_t::allocate(
+    uint64_t p_size, uint64_t p_alignment, resource_kind_t p_kind
+) noexcept -> kirho::result_t<uint64_t, kirho::empty_t>
+{
+    using result_t = kirho::result_t<uint64_t, kirho::empty_t>;
+
+    if (p_size == 0)
+    {
+        return result_t::error(kirho::empty_t{});
+    }
+
+    const auto alignment = std::max(p_alignment, static_cast<uint64_t>(1));
+
+    switch (m_strategy)
+    {
+    case allocation_strategy_t::LINEAR:
+        return allocate_linear(p_size, alignment, p_kind);
+    case allocation_strategy_t::FREE_LIST:
+        return allocate_free_list(p_size, alignment, p_kind);
+    }
+
+    return result_t::error(kirho::empty_t{});
+}
+
+auto sub_allocator_t::allocate_linear(
+    uint64_t p_size, uint64_t p_alignment, resource_kind_t p_kind
+) noexcept -> kirho::result_t<uint64_t, kirho::empty_t>
+{
+    using result_t = kirho::result_t<uint64_t, kirho::empty_t>;
+
+    auto offset = align_up(m_linear_head, p_alignment);
+
+    // In the linear strategy, only allocated ranges are tracked, so the last
+    // one is the one right before the head.
+    if (!m_ranges.empty())
+    {
+        const auto& [last_offset, last] = *m_ranges.rbegin();
+        if (last.kind != p_kind &&
+            on_same_page(last_offset + last.size - 1, offset))
+        {
+            offset = align_up(offset, m_granularity);
+        }
+    }
+
+    if (offset + p_size > m_size)
+    {
+        return result_t::error(kirho::empty_t{});
+    }
+
+    m_ranges.emplace(
+        offset, range_t{
+                    .size = p_size,
+                    .kind = p_kind,
+                    .free = false,
+                }
+    );
+
+    m_linear_head = offset + p_size;
+    m_used += p_size;
+    m_allocation_count++;
+
+    return result_t::success(offset);
+}
+
+auto sub_allocator_t::allocate_free_list(
+    uint64_t p_size, uint64_t p_alignment, resource_kind_t p_kind
+) noexcept -> kirho::result_t<uint64_t, kirho::empty_t>
+{
+    using result_t = kirho::result_t<uint64_t, kirho::empty_t>;
+
+    auto best = m_ranges.end();
+    uint64_t best_offset = 0;
+
+    for (auto it = m_ranges.begin(); it != m_ranges.end(); it++)
+    {
+        const auto& [range_offset, range] = *it;
+
+        if (!range.free || range.size < p_size)
+        {
+            continue;
+        }
+
+        // Free ranges are always merged, so the neighbours are allocated.
+        auto offset = align_up(range_offset, p_alignment);
+
+        if (it != m_ranges.begin())
+        {
+            const auto& [previous_offset, previous] = *std::prev(it);
+            if (previous.kind != p_kind &&
+                on_same_page(previous_offset + previous.size - 1, offset))
+            {
+                offset = align_up(offset, m_granularity);
+            }
+        }
+
+        const auto end = offset + p_size;
+        if (end > range_offset + range.size)
+        {
+            continue;
+        }
+
+        const auto next = std::next(it);
+        if (next != m_ranges.end() && next->second.kind != p_kind &&
+            on_same_page(end - 1, next->first))
+        {
+            continue;
+        }
+
+        // Best fit, which keeps large ranges around for large allocations.
+        if (best == m_ranges.end() || range.size < best->second.size)
+        {
+            best = it;
+            best_offset = offset;
+        }
+    }
+
+    if (best == m_ranges.end())
+    {
+        return result_t::error(kirho::empty_t{});
+    }
+
+    const auto range_offset = best->first;
+    const auto range_end = range_offset + best->second.size;
+    const auto end = best_offset + p_size;
+
+    m_ranges.erase(best);
+
+    if (best_offset > range_offset)
+    {
+        m_ranges.emplace(
+            range_offset, range_t{
+                              .size = best_offset - range_offset,
+                              .kind = resource_kind_t::LINEAR,
+                              .free = true,
+                          }
+        );
+    }
+
+    m_ranges.emplace(
+        best_offset, range_t{
+                         .size = p_size,
+                         .kind = p_kind,
+                         .free = false,
+                     }
+    );
+
+    if (end < range_end)
+    {
+        m_ranges.emplace(
+            end, range_t{
+                     .size = range_end - end,
+                     .kind = resource_kind_t::LINEAR,
+                     .free = true,
+                 }
+        );
+    }
+
+    m_used += p_size;
+    m_allocation_count++;
+
+    return result_t::success(best_offset);
+}
+
+auto sub_allocator_t::free(uint64_t p_offset) noexcept -> void
+{
+    auto it = m_ranges.find(p_offset);
+    if (it == m_ranges.end() || it->second.free)
+    {
+        print_error("Tried to free an unknown allocation at ", p_offset, '.');
+        return;
+    }
+
+    m_used -= it->second.size;
+    m_allocation_count--;
+
+    if (m_strategy == allocation_strategy_t::LINEAR)
+    {
+        m_ranges.erase(it);
+
+        // The head can move back to whatever is still allocated at the end.
+        m_linear_head = m_ranges.empty() ? 0
+                                         : m_ranges.rbegin()->first +
+                                               m_ranges.rbegin()->second.size;
+        return;
+    }
+
+    it->second.free = true;
+
+    const auto next = std::next(it);
+    if (next != m_ranges.end() && next->second.free)
+    {
+        it->second.size += next->second.size;
+        m_ranges.erase(next);
+    }
+
+    if (it != m_ranges.begin())
+    {
+        const auto previous = std::prev(it);
+        if (previous->second.free)
+        {
+            previous->second.size += it->second.size;
+            m_ranges.erase(it);
+        }
+    }
+}
+
+auto sub_allocator_t::stats() const noexcept -> sub_allocator_stats_t
+{
+    sub_allocator_stats_t stats{
+        .size = m_size,
+        .used = m_used,
+        .allocation_count = m_allocation_count,
+        .free_range_count = 0,
+        .largest_free_range = 0,
+    };
+
+    if (m_strategy == allocation_strategy_t::LINEAR)
+    {
+        // Only the space after the head can be handed out again.
+        const auto tail = m_size - m_linear_head;
+        stats.free_range_count = tail > 0 ? 1 : 0;
+        stats.largest_free_range = tail;
+        return stats;
+    }
+
+    for (const auto& [offset, range] : m_ranges)
+    {
+        if (range.free)
+        {
+            stats.free_range_count++;
+            stats.largest_free_range =
+                std::max(stats.largest_free_range, range.size);
+        }
+    }
+
+    return stats;
+}
+
+} // namespace vulkan_scene
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <map>
+
+namespace vulkan_scene
+{
+
+// How a sub-allocator hands out space inside of its block.
+enum class allocation_strategy_t
+{
+    // Bumps a pointer. Very cheap, but only the space at the end is ever
+    // reclaimed: freeing an allocation moves the pointer back to the end of
+    // the last one still in use, so a freed allocation is only reused once
+    // everything after it has been freed too. Meant for short-lived resources
+    // such as staging buffers.
+    LINEAR,
+
+    // Best-fit over an address-ordered list of free ranges that are merged
+    // back together when freed.
+    FREE_LIST,
+};
+
+// Buffers and linear images may not share a bufferImageGranularity-sized page
+// with optimal images, so the sub-allocator has to know which is which.
+enum class resource_kind_t
+{
+    LINEAR,
+    OPTIMAL,
+};
+
+struct sub_allocator_stats_t
+{
+    uint64_t size;
+    uint64_t used;
+    uint64_t allocation_count;
+    uint64_t free_range_count;
+    uint64_t largest_free_range;
+
+    // 0 when all of the free space is in one piece, approaching 1 the more
+    // it is scattered across small ranges.
+    auto fragmentation() const noexcept -> double
+    {
+        const auto free = size - used;
+        return free == 0 ? 0.0
+                         : 1.0 - static_cast<double>(largest_free_range) /
+                                     static_cast<double>(free);
+    }
+};
+
+// Manages the bookkeeping of a single block of memory. It never touches the
+// memory itself (or Vulkan, for that matter), so it can be tested without a
+// GPU.
+class sub_allocator_t
+{
+  public:
+    sub_allocator_t(
+        uint64_t p_size,
+        allocation_strategy_t p_strategy,
+        uint64_t p_granularity = 1
+    ) noexcept;
+
+    // Returns the offset of the new allocation.
+    auto allocate(
+        uint64_t p_size, uint64_t p_alignment, resource_kind_t p_kind
+    ) noexcept -> kirho::result_t<uint64_t, kirho::empty_t>;
+
+    auto free(uint64_t p_offset) noexcept -> void;
+
+    auto stats() const noexcept -> sub_allocator_stats_t;
+
+    auto empty() const noexcept -> bool
+    {
+        return m_allocation_count == 0;
+    }
+
+    auto size() const noexcept -> uint64_t
+    {
+        return m_size;
+    }
+
+    auto strategy() const noexcept -> allocation_strategy_t
+    {
+        return m_strategy;
+    }
+
+  private:
+    struct range_t
+    {
+        uint64_t size;
+        resource_kind_t kind;
+        bool free;
+    };
+
+    auto allocate_linear(
+        uint64_t p_size, uint64_t p_alignment, resource_kind_t p_kind
+    ) noexcept -> kirho::result_t<uint64_t, kirho::empty_t>;
+
+    auto allocate_free_list(
+        uint64_t p_size, uint64_t p_alignment, resource_kind_t p_kind
+    ) noexcept -> kirho::result_t<uint64_t, kirho::empty_t>;
+
+    // Whether the two byte offsets share a bufferImageGranularity page.
+    auto on_same_page(uint64_t p_a, uint64_t p_b) const noexcept -> bool
+    {
+        return p_a / m_granularity == p_b / m_granularity;
+    }
+
+    uint64_t m_size;
+    allocation_strategy_t m_strategy;
+    uint64_t m_granularity;
+
+    // Every range in the block, free or not, keyed by their offsets.
+    std::map<uint64_t, range_t> m_ranges;
+
+    uint64_t m_used;
+    uint64_t m_allocation_count;
+
+    // Only used by the linear strategy.
+    uint64_t m_linear_head;
+};
+
+} // namespace vulkan_scene
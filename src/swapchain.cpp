@@ -179,6 +179,7 @@ auto create_image_views(
 auto create_framebuffers(
     VkDevice p_device,
     const std::vector<VkImageView>& p_image_views,
+    VkImageView p_depth_view,
     const VkExtent2D& p_swapchain_extent,
     VkRenderPass p_render_pass
 ) noexcept -> result_t<std::vector<VkFramebuffer>, VkResult>
@@ -191,16 +192,18 @@ auto create_framebuffers(
 
     std::ranges::transform(
         p_image_views, std::back_inserter(framebuffers),
-        [p_device, p_render_pass, &p_swapchain_extent,
+        [p_device, p_depth_view, p_render_pass, &p_swapchain_extent,
          &latest_failure](VkImageView p_image_view) -> VkFramebuffer
         {
+            const std::array attachments{p_image_view, p_depth_view};
+
             const VkFramebufferCreateInfo framebuffer_info{
                 .sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO,
                 .pNext = nullptr,
                 .flags = 0,
                 .renderPass = p_render_pass,
-                .attachmentCount = 1,
-                .pAttachments = &p_image_view,
+                .attachmentCount = static_cast<uint32_t>(attachments.size()),
+                .pAttachments = attachments.data(),
                 .width = p_swapchain_extent.width,
                 .height = p_swapchain_extent.height,
                 .layers = 1,
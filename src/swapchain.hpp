@@ -26,9 +26,11 @@ auto create_image_views(
     VkDevice p_device, const std::vector<VkImage>& p_images, VkFormat p_format
 ) noexcept -> kirho::result_t<std::vector<VkImageView>, VkResult>;
 
+// Every framebuffer shares the same depth attachment.
 auto create_framebuffers(
     VkDevice p_device,
     const std::vector<VkImageView>& p_image_views,
+    VkImageView p_depth_view,
     const VkExtent2D& p_swapchain_extent,
     VkRenderPass p_render_pass
 ) noexcept -> kirho::result_t<std::vector<VkFramebuffer>, VkResult>;
@@ -0,0 +1,200 @@
+#include "common.hpp"
+
+#include "texture-table.hpp"
+
+namespace vulkan_scene
+{
+
+namespace
+{
+
+// Combined image samplers count against both the sampler and the sampled image
+// limits.
+auto get_max_texture_count(VkPhysicalDevice p_physical_device) noexcept
+    -> uint32_t
+{
+    VkPhysicalDeviceDescriptorIndexingProperties indexing_properties{
+        .sType =
+            VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES,
+        .pNext = nullptr,
+    };
+
+    VkPhysicalDeviceProperties2 properties{
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2,
+        .pNext = &indexing_properties,
+    };
+    vkGetPhysicalDeviceProperties2(p_physical_device, &properties);
+
+    return std::min({
+        indexing_properties.maxPerStageDescriptorUpdateAfterBindSamplers,
+        indexing_properties.maxPerStageDescriptorUpdateAfterBindSampledImages,
+        indexing_properties.maxDescriptorSetUpdateAfterBindSamplers,
+        indexing_properties.maxDescriptorSetUpdateAfterBindSampledImages,
+    });
+}
+
+} // namespace
+
+auto create_texture_table(
+    VkPhysicalDevice p_physical_device,
+    VkDevice p_device,
+    uint32_t p_capacity
+) noexcept -> kirho::result_t<texture_table_t, VkResult>
+{
+    using result_t = kirho::result_t<texture_table_t, VkResult>;
+
+    const auto capacity =
+        std::min(p_capacity, get_max_texture_count(p_physical_device));
+
+    const VkDescriptorBindingFlags binding_flags =
+        VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT |
+        VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT |
+        VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT;
+
+    const VkDescriptorSetLayoutBindingFlagsCreateInfo binding_flags_info{
+        .sType =
+            VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO,
+        .pNext = nullptr,
+        .bindingCount = 1,
+        .pBindingFlags = &binding_flags,
+    };
+
+    const VkDescriptorSetLayoutBinding binding{
+        .binding = 0,
+        .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+        .descriptorCount = capacity,
+        .stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT,
+        .pImmutableSamplers = nullptr,
+    };
+
+    const VkDescriptorSetLayoutCreateInfo set_layout_info{
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+        .pNext = &binding_flags_info,
+        .flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT,
+        .bindingCount = 1,
+        .pBindings = &binding,
+    };
+
+    VkDescriptorSetLayout set_layout;
+    auto result = vkCreateDescriptorSetLayout(
+        p_device, &set_layout_info, nullptr, &set_layout
+    );
+    if (result != VK_SUCCESS)
+    {
+        print_error(
+            "Failed to create the texture table's set layout. Vulkan error ",
+            result, '.'
+        );
+        return result_t::error(result);
+    }
+
+    const VkDescriptorPoolSize pool_size{
+        .type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+        .descriptorCount = capacity,
+    };
+
+    const VkDescriptorPoolCreateInfo pool_info{
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+        .pNext = nullptr,
+        .flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT,
+        .maxSets = 1,
+        .poolSizeCount = 1,
+        .pPoolSizes = &pool_size,
+    };
+
+    VkDescriptorPool pool;
+    result = vkCreateDescriptorPool(p_device, &pool_info, nullptr, &pool);
+    if (result != VK_SUCCESS)
+    {
+        print_error(
+            "Failed to create the texture table's descriptor pool. Vulkan "
+            "error ",
+            result, '.'
+        );
+        vkDestroyDescriptorSetLayout(p_device, set_layout, nullptr);
+        return result_t::error(result);
+    }
+
+    const VkDescriptorSetAllocateInfo set_info{
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+        .pNext = nullptr,
+        .descriptorPool = pool,
+        .descriptorSetCount = 1,
+        .pSetLayouts = &set_layout,
+    };
+
+    VkDescriptorSet set;
+    result = vkAllocateDescriptorSets(p_device, &set_info, &set);
+    if (result != VK_SUCCESS)
+    {
+        print_error(
+            "Failed to allocate the texture table's descriptor set. Vulkan "
+            "error ",
+            result, '.'
+        );
+        vkDestroyDescriptorPool(p_device, pool, nullptr);
+        vkDestroyDescriptorSetLayout(p_device, set_layout, nullptr);
+        return result_t::error(result);
+    }
+
+    return result_t::success(texture_table_t{
+        .set_layout = set_layout,
+        .descriptor_pool = pool,
+        .descriptor_set = set,
+        .capacity = capacity,
+        .texture_count = 0,
+    });
+}
+
+auto add_texture(
+    VkDevice p_device,
+    texture_table_t& p_table,
+    VkImageView p_view,
+    VkSampler p_sampler
+) noexcept -> kirho::result_t<uint32_t, kirho::empty_t>
+{
+    using result_t = kirho::result_t<uint32_t, kirho::empty_t>;
+
+    if (p_table.texture_count == p_table.capacity)
+    {
+        print_error(
+            "The texture table is full. It holds ", p_table.capacity,
+            " textures."
+        );
+        return result_t::error(kirho::empty_t{});
+    }
+
+    const VkDescriptorImageInfo image_info{
+        .sampler = p_sampler,
+        .imageView = p_view,
+        .imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+    };
+
+    const VkWriteDescriptorSet set_write{
+        .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+        .pNext = nullptr,
+        .dstSet = p_table.descriptor_set,
+        .dstBinding = 0,
+        .dstArrayElement = p_table.texture_count,
+        .descriptorCount = 1,
+        .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+        .pImageInfo = &image_info,
+        .pBufferInfo = nullptr,
+        .pTexelBufferView = nullptr,
+    };
+
+    vkUpdateDescriptorSets(p_device, 1, &set_write, 0, nullptr);
+
+    return result_t::success(p_table.texture_count++);
+}
+
+auto destroy_texture_table(
+    VkDevice p_device, const texture_table_t& p_table
+) noexcept -> void
+{
+    // Destroying the pool frees the set along with it.
+    vkDestroyDescriptorPool(p_device, p_table.descriptor_pool, nullptr);
+    vkDestroyDescriptorSetLayout(p_device, p_table.set_layout, nullptr);
+}
+
+} // namespace vulkan_scene
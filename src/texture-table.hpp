@@ -0,0 +1,50 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+namespace vulkan_scene
+{
+
+// How many textures a table can hold at most, unless the device allows fewer.
+constexpr uint32_t DEFAULT_TEXTURE_TABLE_CAPACITY = 4096;
+
+// Every texture in one descriptor set, as a runtime-sized array of combined
+// image samplers that the shaders index into. The set gets bound once and
+// stays bound, whatever textures the draws use.
+//
+// Slots that haven't been filled in yet may not be sampled, but they may be
+// filled in at any time, even while command buffers that use the set are
+// pending. The slots that those command buffers sample from must not change,
+// though.
+struct texture_table_t
+{
+    VkDescriptorSetLayout set_layout;
+    VkDescriptorPool descriptor_pool;
+    VkDescriptorSet descriptor_set;
+
+    uint32_t capacity;
+    uint32_t texture_count;
+};
+
+// The table's set layout has the array at binding 0, visible to fragment
+// shaders.
+auto create_texture_table(
+    VkPhysicalDevice p_physical_device,
+    VkDevice p_device,
+    uint32_t p_capacity = DEFAULT_TEXTURE_TABLE_CAPACITY
+) noexcept -> kirho::result_t<texture_table_t, VkResult>;
+
+// Writes the texture into the next free slot and returns its index, which is
+// what the shaders look it up with. Fails once the table is full.
+auto add_texture(
+    VkDevice p_device,
+    texture_table_t& p_table,
+    VkImageView p_view,
+    VkSampler p_sampler
+) noexcept -> kirho::result_t<uint32_t, kirho::empty_t>;
+
+auto destroy_texture_table(
+    VkDevice p_device, const texture_table_t& p_table
+) noexcept -> void;
+
+} // namespace vulkan_scene
@@ -0,0 +1,342 @@
+#include <string>
+
+#include "cpu-trace.hpp"
+
+#include "thread-pool.hpp"
+
+namespace vulkan_scene
+{
+
+struct task_node_t
+{
+    std::function<void()> function;
+
+    // The dependencies that aren't done yet, plus one until submit is done
+    // registering the task with all of them.
+    std::atomic<uint32_t> remaining_dependency_count;
+
+    std::atomic<bool> done;
+
+    // Guards continuations, and done against being set while a continuation
+    // gets added.
+    std::mutex mutex;
+
+    // The tasks that depend on this one.
+    std::vector<task_handle_t> continuations;
+};
+
+namespace
+{
+
+// Which pool the current thread works for, if any, and its index in there.
+thread_local const thread_pool_t* t_current_pool = nullptr;
+thread_local uint32_t t_worker_index = 0;
+
+} // namespace
+
+auto get_default_thread_count() noexcept -> uint32_t
+{
+    return std::max(std::thread::hardware_concurrency(), 1u);
+}
+
+thread_pool_t::thread_pool_t(uint32_t p_thread_count)
+    : m_queued_count(0), m_unfinished_count(0), m_sleeping_count(0),
+      m_waiting_count(0), m_next_worker(0), m_steal_count(0),
+      m_stopping(false)
+{
+    p_thread_count = std::max(p_thread_count, 1u);
+
+    m_workers.reserve(p_thread_count);
+    for (uint32_t i = 0; i < p_thread_count; i++)
+    {
+        m_workers.push_back(std::make_unique<worker_t>());
+    }
+
+    m_threads.reserve(p_thread_count);
+    for (uint32_t i = 0; i < p_thread_count; i++)
+    {
+        m_threads.emplace_back(
+            [this, i]
+            {
+                set_cpu_trace_thread_name("worker " + std::to_string(i));
+                run_worker(i);
+            }
+        );
+    }
+}
+
+thread_pool_t::~thread_pool_t()
+{
+    {
+        const std::lock_guard lock{m_mutex};
+        m_stopping = true;
+    }
+
+    m_wake.notify_all();
+
+    for (auto& thread : m_threads)
+    {
+        thread.join();
+    }
+}
+
+auto thread_pool_t::submit(
+    std::function<void()> p_task,
+    std::span<const task_handle_t> p_dependencies
+) -> task_handle_t
+{
+    auto task = std::make_shared<task_node_t>();
+    task->function = std::move(p_task);
+    task->remaining_dependency_count =
+        static_cast<uint32_t>(p_dependencies.size()) + 1;
+    task->done = false;
+
+    m_unfinished_count++;
+
+    for (const auto& dependency : p_dependencies)
+    {
+        if (dependency == nullptr)
+        {
+            task->remaining_dependency_count--;
+            continue;
+        }
+
+        const std::lock_guard lock{dependency->mutex};
+        if (dependency->done)
+        {
+            task->remaining_dependency_count--;
+        }
+        else
+        {
+            dependency->continuations.push_back(task);
+        }
+    }
+
+    // Whichever dependency finishes last enqueues the task otherwise.
+    if (--task->remaining_dependency_count == 0)
+    {
+        enqueue(task);
+    }
+
+    return task;
+}
+
+auto thread_pool_t::wait(const task_handle_t& p_task) -> void
+{
+    while (!p_task->done)
+    {
+        if (const auto task = find_task())
+        {
+            run_task(task);
+            continue;
+        }
+
+        std::unique_lock lock{m_mutex};
+        m_sleeping_count++;
+        m_waiting_count++;
+        m_wake.wait(
+            lock, [&] { return p_task->done || m_queued_count > 0; }
+        );
+        m_waiting_count--;
+        m_sleeping_count--;
+    }
+
+    // The task that was meant to wake a worker may have woken this thread
+    // instead, just as it was returning.
+    if (m_queued_count > 0 && m_sleeping_count > 0)
+    {
+        const std::lock_guard lock{m_mutex};
+        m_wake.notify_one();
+    }
+}
+
+auto thread_pool_t::parallel_for(
+    uint32_t p_begin,
+    uint32_t p_end,
+    uint32_t p_grain_size,
+    const std::function<void(uint32_t p_first, uint32_t p_last)>& p_body
+) -> void
+{
+    if (p_begin >= p_end)
+    {
+        return;
+    }
+
+    const auto grain_size = static_cast<uint64_t>(std::max(p_grain_size, 1u));
+    const auto get_last = [p_end, grain_size](uint64_t p_first)
+    {
+        return static_cast<uint32_t>(
+            std::min(p_first + grain_size, static_cast<uint64_t>(p_end))
+        );
+    };
+
+    // The first range is left for the calling thread.
+    std::vector<task_handle_t> tasks;
+    for (uint64_t first = p_begin + grain_size; first < p_end;
+         first += grain_size)
+    {
+        tasks.push_back(submit(
+            [&p_body, first = static_cast<uint32_t>(first),
+             last = get_last(first)] { p_body(first, last); }
+        ));
+    }
+
+    p_body(p_begin, get_last(p_begin));
+
+    for (const auto& task : tasks)
+    {
+        wait(task);
+    }
+}
+
+auto thread_pool_t::wait_idle() -> void
+{
+    std::unique_lock lock{m_mutex};
+    m_idle.wait(lock, [this] { return m_unfinished_count == 0; });
+}
+
+auto thread_pool_t::run_worker(uint32_t p_index) -> void
+{
+    t_current_pool = this;
+    t_worker_index = p_index;
+
+    while (true)
+    {
+        if (const auto task = find_task())
+        {
+            run_task(task);
+            continue;
+        }
+
+        std::unique_lock lock{m_mutex};
+        m_sleeping_count++;
+        m_wake.wait(
+            lock,
+            [this] {
+                return m_queued_count > 0 ||
+                       (m_stopping && m_unfinished_count == 0);
+            }
+        );
+        m_sleeping_count--;
+
+        // Tasks can still be waiting for their dependencies while stopping,
+        // and those get run before the workers go away.
+        if (m_stopping && m_unfinished_count == 0)
+        {
+            return;
+        }
+    }
+}
+
+auto thread_pool_t::enqueue(task_handle_t p_task) -> void
+{
+    const auto index =
+        t_current_pool == this
+            ? t_worker_index
+            : m_next_worker++ % static_cast<uint32_t>(m_workers.size());
+
+    m_queued_count++;
+
+    {
+        auto& worker = *m_workers[index];
+        const std::lock_guard lock{worker.mutex};
+        worker.tasks.push_back(std::move(p_task));
+    }
+
+    // Counting the sleepers keeps the common case, where every worker is busy,
+    // from touching m_mutex at all.
+    if (m_sleeping_count > 0)
+    {
+        const std::lock_guard lock{m_mutex};
+        m_wake.notify_one();
+    }
+}
+
+auto thread_pool_t::find_task() -> task_handle_t
+{
+    const auto worker_count = static_cast<uint32_t>(m_workers.size());
+    const auto is_worker = t_current_pool == this;
+
+    // The newest task on our own deque is the most likely to still be in the
+    // cache.
+    if (is_worker)
+    {
+        auto& worker = *m_workers[t_worker_index];
+        const std::lock_guard lock{worker.mutex};
+        if (!worker.tasks.empty())
+        {
+            auto task = std::move(worker.tasks.back());
+            worker.tasks.pop_back();
+            m_queued_count--;
+            return task;
+        }
+    }
+
+    // The oldest task on someone else's deque is the least likely to be
+    // wanted by its owner soon.
+    const auto first_victim = is_worker ? t_worker_index + 1 : 0;
+    for (uint32_t i = 0; i < worker_count; i++)
+    {
+        const auto victim_index = (first_victim + i) % worker_count;
+        if (is_worker && victim_index == t_worker_index)
+        {
+            continue;
+        }
+
+        auto& victim = *m_workers[victim_index];
+        const std::lock_guard lock{victim.mutex};
+        if (!victim.tasks.empty())
+        {
+            auto task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            m_queued_count--;
+
+            if (is_worker)
+            {
+                m_steal_count.fetch_add(1, std::memory_order_relaxed);
+            }
+
+            return task;
+        }
+    }
+
+    return nullptr;
+}
+
+auto thread_pool_t::run_task(const task_handle_t& p_task) -> void
+{
+    p_task->function();
+
+    // Whatever the function holds on to shouldn't live as long as the handle.
+    p_task->function = nullptr;
+
+    std::vector<task_handle_t> continuations;
+    {
+        const std::lock_guard lock{p_task->mutex};
+        p_task->done = true;
+        continuations.swap(p_task->continuations);
+    }
+
+    for (auto& continuation : continuations)
+    {
+        if (--continuation->remaining_dependency_count == 0)
+        {
+            enqueue(std::move(continuation));
+        }
+    }
+
+    if (m_waiting_count > 0)
+    {
+        const std::lock_guard lock{m_mutex};
+        m_wake.notify_all();
+    }
+
+    if (--m_unfinished_count == 0)
+    {
+        const std::lock_guard lock{m_mutex};
+        m_idle.notify_all();
+        m_wake.notify_all();
+    }
+}
+
+} // namespace vulkan_scene
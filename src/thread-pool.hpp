@@ -0,0 +1,120 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace vulkan_scene
+{
+
+// One thread per hardware thread, or one if the standard library can't tell.
+auto get_default_thread_count() noexcept -> uint32_t;
+
+struct task_node_t;
+
+// Refers to a submitted task, so that other tasks can depend on it or a
+// thread can wait for it.
+using task_handle_t = std::shared_ptr<task_node_t>;
+
+// A fixed set of worker threads, each with its own deque of tasks. A worker
+// runs the newest task of its own deque first, and steals the oldest task of
+// another worker's deque when its own runs dry. Tasks that are submitted from
+// outside of the pool get spread across the workers, so there is no order
+// between any of them. Tasks must not throw.
+class thread_pool_t
+{
+  public:
+    explicit thread_pool_t(
+        uint32_t p_thread_count = get_default_thread_count()
+    );
+
+    thread_pool_t(const thread_pool_t&) = delete;
+    thread_pool_t& operator=(const thread_pool_t&) = delete;
+
+    // Finishes every task that was already submitted before returning,
+    // including the ones that are still waiting for their dependencies.
+    ~thread_pool_t();
+
+    // The task only runs once all of its dependencies are done. Submitting
+    // from inside of a task puts the new task on the current worker's deque.
+    auto submit(
+        std::function<void()> p_task,
+        std::span<const task_handle_t> p_dependencies = {}
+    ) -> task_handle_t;
+
+    // Runs other tasks until the given one is done, so this can be called from
+    // inside of a task without tying up a worker.
+    auto wait(const task_handle_t& p_task) -> void;
+
+    // Calls p_body(first, last) on ranges of at most p_grain_size indices that
+    // cover [p_begin, p_end) together, and returns once all of them are done.
+    // The calling thread runs ranges as well, like wait does.
+    auto parallel_for(
+        uint32_t p_begin,
+        uint32_t p_end,
+        uint32_t p_grain_size,
+        const std::function<void(uint32_t p_first, uint32_t p_last)>& p_body
+    ) -> void;
+
+    // Blocks until every submitted task is done.
+    auto wait_idle() -> void;
+
+    auto thread_count() const noexcept -> uint32_t
+    {
+        return static_cast<uint32_t>(m_threads.size());
+    }
+
+    // How many tasks were taken from another worker's deque so far.
+    auto steal_count() const noexcept -> uint64_t
+    {
+        return m_steal_count.load(std::memory_order_relaxed);
+    }
+
+  private:
+    struct worker_t
+    {
+        std::mutex mutex;
+        std::deque<task_handle_t> tasks;
+    };
+
+    auto run_worker(uint32_t p_index) -> void;
+
+    // Puts a task whose dependencies are done on a deque.
+    auto enqueue(task_handle_t p_task) -> void;
+
+    // Takes a task off the current worker's deque, or steals one. Returns
+    // nothing if every deque is empty.
+    auto find_task() -> task_handle_t;
+
+    auto run_task(const task_handle_t& p_task) -> void;
+
+    std::vector<std::unique_ptr<worker_t>> m_workers;
+    std::vector<std::thread> m_threads;
+
+    // Only there to sleep on, the deques have their own mutexes.
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_idle;
+
+    // Never lower than the number of tasks on the deques. Counts up before a
+    // task is pushed and down after one is popped.
+    std::atomic<uint64_t> m_queued_count;
+
+    // Submitted but not done, whether they are queued or not.
+    std::atomic<uint64_t> m_unfinished_count;
+
+    // Threads that are sleeping on m_wake, including the ones in wait.
+    std::atomic<uint32_t> m_sleeping_count;
+
+    // Only the ones in wait, which also need to hear about finished tasks.
+    std::atomic<uint32_t> m_waiting_count;
+
+    std::atomic<uint32_t> m_next_worker;
+    std::atomic<uint64_t> m_steal_count;
+    bool m_stopping;
+};
+
+} // namespace vulkan_scene
@@ -0,0 +1,90 @@
+#include <cstring>
+
+#include "common.hpp"
+
+#include "uniform-ring.hpp"
+
+namespace vulkan_scene
+{
+
+auto create_uniform_ring(
+    memory_allocator_t& p_allocator,
+    VkDevice p_device,
+    VkDeviceSize p_frame_size,
+    uint32_t p_frame_count
+) noexcept -> kirho::result_t<uniform_ring_t, VkResult>
+{
+    using result_t = kirho::result_t<uniform_ring_t, VkResult>;
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(p_allocator.physical_device(), &properties);
+
+    const auto alignment = properties.limits.minUniformBufferOffsetAlignment;
+
+    // Every region has to start at an aligned offset as well.
+    const auto frame_size = align_up(p_frame_size, alignment);
+
+    const auto buffer_result = create_uniform_buffer(
+        p_allocator, p_device, nullptr, frame_size * p_frame_count
+    );
+
+    VkResult result;
+    if (buffer_result.is_error(result))
+    {
+        return result_t::error(result);
+    }
+
+    // Uniform buffers are host visible, so the allocator keeps them mapped.
+    const auto buffer = buffer_result.unwrap();
+
+    return result_t::success(uniform_ring_t{
+        .buffer = buffer,
+        .mapped = static_cast<uint8_t*>(buffer.allocation.mapped),
+        .alignment = alignment,
+        .frame_size = frame_size,
+        .frame_count = p_frame_count,
+        .frame_begin = 0,
+        .head = 0,
+    });
+}
+
+auto begin_uniform_frame(uniform_ring_t& p_ring, uint32_t p_frame_index) noexcept
+    -> void
+{
+    p_ring.frame_begin = p_ring.frame_size * (p_frame_index % p_ring.frame_count);
+    p_ring.head = 0;
+}
+
+auto push_uniform_data(
+    uniform_ring_t& p_ring, const void* p_data, VkDeviceSize p_size
+) noexcept -> kirho::result_t<uint32_t, kirho::empty_t>
+{
+    using result_t = kirho::result_t<uint32_t, kirho::empty_t>;
+
+    if (p_ring.head + p_size > p_ring.frame_size)
+    {
+        print_error(
+            "The uniform ring ran out of space for this frame (", p_ring.head,
+            " of ", p_ring.frame_size, " bytes used)."
+        );
+        return result_t::error(kirho::empty_t{});
+    }
+
+    const auto offset = p_ring.frame_begin + p_ring.head;
+    std::memcpy(p_ring.mapped + offset, p_data, p_size);
+
+    p_ring.head = align_up(p_ring.head + p_size, p_ring.alignment);
+
+    return result_t::success(static_cast<uint32_t>(offset));
+}
+
+auto destroy_uniform_ring(
+    VkDevice p_device,
+    memory_allocator_t& p_allocator,
+    const uniform_ring_t& p_ring
+) -> void
+{
+    destroy_buffer(p_device, p_allocator, p_ring.buffer);
+}
+
+} // namespace vulkan_scene
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include "graphics.hpp"
+
+namespace vulkan_scene
+{
+
+// A persistently mapped uniform buffer that is split into one region per frame
+// in flight. Every frame, uniform data gets appended to that frame's region and
+// is bound with a dynamic offset, so nothing is ever mapped or overwritten
+// while the GPU might still be reading it.
+struct uniform_ring_t
+{
+    buffer_t buffer;
+    uint8_t* mapped;
+
+    // minUniformBufferOffsetAlignment of the device.
+    VkDeviceSize alignment;
+    VkDeviceSize frame_size;
+    uint32_t frame_count;
+
+    VkDeviceSize frame_begin;
+    VkDeviceSize head;
+};
+
+auto create_uniform_ring(
+    memory_allocator_t& p_allocator,
+    VkDevice p_device,
+    VkDeviceSize p_frame_size,
+    uint32_t p_frame_count
+) noexcept -> kirho::result_t<uniform_ring_t, VkResult>;
+
+// Starts writing into the region of the given frame. Only call this once the
+// fence of that frame has been waited on.
+auto begin_uniform_frame(uniform_ring_t& p_ring, uint32_t p_frame_index) noexcept
+    -> void;
+
+// Copies the data into the current frame's region and returns the dynamic
+// offset to bind it with. Fails if the region is full.
+auto push_uniform_data(
+    uniform_ring_t& p_ring, const void* p_data, VkDeviceSize p_size
+) noexcept -> kirho::result_t<uint32_t, kirho::empty_t>;
+
+template <typename T>
+auto push_uniform(uniform_ring_t& p_ring, const T& p_data) noexcept
+    -> kirho::result_t<uint32_t, kirho::empty_t>
+{
+    return push_uniform_data(p_ring, &p_data, sizeof(T));
+}
+
+auto destroy_uniform_ring(
+    VkDevice p_device,
+    memory_allocator_t& p_allocator,
+    const uniform_ring_t& p_ring
+) -> void;
+
+} // namespace vulkan_scene
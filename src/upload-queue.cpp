@@ -0,0 +1,1044 @@
+#include <cstring>
+
+#include <utility>
+
+#include "common.hpp"
+#include "device.hpp"
+
+#include "mipmap.hpp"
+
+#include "upload-queue.hpp"
+
+namespace
+{
+
+using vulkan_scene::mip_generation_t;
+using vulkan_scene::print_error;
+using vulkan_scene::upload_batch_t;
+using vulkan_scene::upload_queue_t;
+
+// Enough for vkCmdCopyBufferToImage with any of the formats we use.
+constexpr VkDeviceSize STAGING_ALIGNMENT = 16;
+
+// Everything that might read an uploaded resource, including the culling
+// shader and the indirect draws that it writes the commands of.
+constexpr VkPipelineStageFlags CONSUMER_STAGES =
+    VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT |
+    VK_PIPELINE_STAGE_VERTEX_SHADER_BIT |
+    VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT |
+    VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+constexpr VkAccessFlags CONSUMER_ACCESS =
+    VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT |
+    VK_ACCESS_INDEX_READ_BIT | VK_ACCESS_UNIFORM_READ_BIT |
+    VK_ACCESS_SHADER_READ_BIT;
+
+auto transfers_ownership(const upload_queue_t& p_queue) noexcept -> bool
+{
+    return p_queue.queue_family != p_queue.destination_family;
+}
+
+// Blits every generated level from the one before it. All levels end up in
+// the shader layout.
+auto record_mip_generation(
+    VkCommandBuffer p_command_buffer, const mip_generation_t& p_generation
+) noexcept -> void
+{
+    VkImageMemoryBarrier barrier{
+        .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+        .pNext = nullptr,
+        .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+        .dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT,
+        .oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+        .newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+        .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .image = p_generation.image,
+        .subresourceRange =
+            VkImageSubresourceRange{
+                .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                .baseMipLevel = 0,
+                .levelCount = 1,
+                .baseArrayLayer = 0,
+                .layerCount = 1,
+            },
+    };
+
+    const auto level_extent = [&](uint32_t p_level)
+    {
+        return VkOffset3D{
+            .x = static_cast<int32_t>(
+                std::max(p_generation.extent.width >> p_level, 1u)
+            ),
+            .y = static_cast<int32_t>(
+                std::max(p_generation.extent.height >> p_level, 1u)
+            ),
+            .z = 1,
+        };
+    };
+
+    for (auto level = p_generation.first_level;
+         level < p_generation.level_count; level++)
+    {
+        barrier.subresourceRange.baseMipLevel = level - 1;
+
+        vkCmdPipelineBarrier(
+            p_command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT,
+            VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1,
+            &barrier
+        );
+
+        const VkImageBlit blit{
+            .srcSubresource =
+                VkImageSubresourceLayers{
+                    .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                    .mipLevel = level - 1,
+                    .baseArrayLayer = 0,
+                    .layerCount = 1,
+                },
+            .srcOffsets = {VkOffset3D{0, 0, 0}, level_extent(level - 1)},
+            .dstSubresource =
+                VkImageSubresourceLayers{
+                    .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                    .mipLevel = level,
+                    .baseArrayLayer = 0,
+                    .layerCount = 1,
+                },
+            .dstOffsets = {VkOffset3D{0, 0, 0}, level_extent(level)},
+        };
+
+        vkCmdBlitImage(
+            p_command_buffer, p_generation.image,
+            VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, p_generation.image,
+            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &blit, VK_FILTER_LINEAR
+        );
+    }
+
+    // The uploaded levels that weren't blitted from are still in the transfer
+    // destination layout, and so is the last level.
+    std::array<VkImageMemoryBarrier, 3> final_barriers;
+    uint32_t final_barrier_count = 0;
+
+    const auto add_final_barrier =
+        [&](VkImageLayout p_layout, uint32_t p_first_level, uint32_t p_count)
+    {
+        if (p_count == 0)
+        {
+            return;
+        }
+
+        auto final_barrier = barrier;
+        final_barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        final_barrier.oldLayout = p_layout;
+        final_barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        final_barrier.subresourceRange.baseMipLevel = p_first_level;
+        final_barrier.subresourceRange.levelCount = p_count;
+
+        final_barriers[final_barrier_count++] = final_barrier;
+    };
+
+    const auto first_source = p_generation.first_level - 1;
+    const auto last_level = p_generation.level_count - 1;
+
+    add_final_barrier(VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 0, first_source);
+    add_final_barrier(
+        VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, first_source,
+        last_level - first_source
+    );
+    add_final_barrier(VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, last_level, 1);
+
+    vkCmdPipelineBarrier(
+        p_command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT,
+        VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr,
+        final_barrier_count, final_barriers.data()
+    );
+}
+
+// Records the barriers that make the batch's uploads visible to the consumers.
+// With a separate transfer family, this is only the releasing half of the
+// ownership transfers, and the acquiring half goes into the other command
+// buffer, along with the mip generation (transfer queues can't blit).
+auto record_batch_barriers(
+    const upload_queue_t& p_queue, upload_batch_t& p_batch
+) noexcept -> kirho::result_t<kirho::empty_t, VkResult>
+{
+    using result_t = kirho::result_t<kirho::empty_t, VkResult>;
+
+    const auto source_family = transfers_ownership(p_queue)
+                                   ? p_queue.queue_family
+                                   : VK_QUEUE_FAMILY_IGNORED;
+    const auto destination_family = transfers_ownership(p_queue)
+                                        ? p_queue.destination_family
+                                        : VK_QUEUE_FAMILY_IGNORED;
+
+    for (auto& barrier : p_batch.buffer_barriers)
+    {
+        barrier.srcQueueFamilyIndex = source_family;
+        barrier.dstQueueFamilyIndex = destination_family;
+    }
+
+    for (auto& barrier : p_batch.image_barriers)
+    {
+        barrier.srcQueueFamilyIndex = source_family;
+        barrier.dstQueueFamilyIndex = destination_family;
+    }
+
+    // Images that still need their mip chains stay in the transfer layout
+    // while changing hands.
+    std::vector<VkImageMemoryBarrier> mip_ownership_barriers;
+    for (const auto& generation : p_batch.mip_generations)
+    {
+        mip_ownership_barriers.push_back(VkImageMemoryBarrier{
+            .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+            .pNext = nullptr,
+            .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+            .dstAccessMask = 0,
+            .oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            .newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            .srcQueueFamilyIndex = source_family,
+            .dstQueueFamilyIndex = destination_family,
+            .image = generation.image,
+            .subresourceRange =
+                VkImageSubresourceRange{
+                    .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                    .baseMipLevel = 0,
+                    .levelCount = generation.level_count,
+                    .baseArrayLayer = 0,
+                    .layerCount = 1,
+                },
+        });
+    }
+
+    const auto record = [&](VkCommandBuffer p_command_buffer,
+                            VkPipelineStageFlags p_source_stages,
+                            VkPipelineStageFlags p_destination_stages,
+                            VkAccessFlags p_source_access,
+                            VkAccessFlags p_destination_access)
+    {
+        for (auto& barrier : p_batch.buffer_barriers)
+        {
+            barrier.srcAccessMask = p_source_access;
+            barrier.dstAccessMask = p_destination_access;
+        }
+
+        for (auto& barrier : p_batch.image_barriers)
+        {
+            barrier.srcAccessMask = p_source_access;
+            barrier.dstAccessMask = p_destination_access;
+        }
+
+        vkCmdPipelineBarrier(
+            p_command_buffer, p_source_stages, p_destination_stages, 0, 0,
+            nullptr, static_cast<uint32_t>(p_batch.buffer_barriers.size()),
+            p_batch.buffer_barriers.data(),
+            static_cast<uint32_t>(p_batch.image_barriers.size()),
+            p_batch.image_barriers.data()
+        );
+    };
+
+    if (!transfers_ownership(p_queue))
+    {
+        record(
+            p_batch.command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT,
+            CONSUMER_STAGES, VK_ACCESS_TRANSFER_WRITE_BIT, CONSUMER_ACCESS
+        );
+
+        for (const auto& generation : p_batch.mip_generations)
+        {
+            record_mip_generation(p_batch.command_buffer, generation);
+        }
+
+        return result_t::success();
+    }
+
+    // The destination access mask of a release barrier is ignored, and so is
+    // the source access mask of an acquire barrier. The semaphore takes care
+    // of the execution dependency between the two.
+    record(
+        p_batch.command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT,
+        VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, VK_ACCESS_TRANSFER_WRITE_BIT, 0
+    );
+
+    if (!mip_ownership_barriers.empty())
+    {
+        vkCmdPipelineBarrier(
+            p_batch.command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT,
+            VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 0, nullptr,
+            static_cast<uint32_t>(mip_ownership_barriers.size()),
+            mip_ownership_barriers.data()
+        );
+    }
+
+    const VkCommandBufferBeginInfo begin_info{
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+        .pNext = nullptr,
+        .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+        .pInheritanceInfo = nullptr,
+    };
+
+    auto result =
+        vkBeginCommandBuffer(p_batch.acquire_command_buffer, &begin_info);
+    if (result != VK_SUCCESS)
+    {
+        print_error(
+            "Failed to begin an ownership acquire command buffer. Vulkan "
+            "error ",
+            result, '.'
+        );
+        return result_t::error(result);
+    }
+
+    record(
+        p_batch.acquire_command_buffer, CONSUMER_STAGES, CONSUMER_STAGES, 0,
+        CONSUMER_ACCESS
+    );
+
+    if (!mip_ownership_barriers.empty())
+    {
+        for (auto& barrier : mip_ownership_barriers)
+        {
+            barrier.srcAccessMask = 0;
+            barrier.dstAccessMask =
+                VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+        }
+
+        vkCmdPipelineBarrier(
+            p_batch.acquire_command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT,
+            VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr,
+            static_cast<uint32_t>(mip_ownership_barriers.size()),
+            mip_ownership_barriers.data()
+        );
+
+        for (const auto& generation : p_batch.mip_generations)
+        {
+            record_mip_generation(p_batch.acquire_command_buffer, generation);
+        }
+    }
+
+    result = vkEndCommandBuffer(p_batch.acquire_command_buffer);
+    if (result != VK_SUCCESS)
+    {
+        print_error(
+            "Failed to end an ownership acquire command buffer. Vulkan error ",
+            result, '.'
+        );
+        return result_t::error(result);
+    }
+
+    return result_t::success();
+}
+
+auto current_batch(upload_queue_t& p_queue) noexcept -> upload_batch_t&
+{
+    return p_queue.batches.at(p_queue.current);
+}
+
+// Waits for a submitted batch and gives its staging memory back.
+auto retire_batch(upload_queue_t& p_queue, upload_batch_t& p_batch) noexcept
+    -> kirho::result_t<kirho::empty_t, VkResult>
+{
+    using result_t = kirho::result_t<kirho::empty_t, VkResult>;
+
+    if (!p_batch.submitted)
+    {
+        return result_t::success();
+    }
+
+    const auto result =
+        vkWaitForFences(p_queue.device, 1, &p_batch.fence, VK_TRUE, UINT64_MAX);
+    if (result != VK_SUCCESS)
+    {
+        print_error(
+            "Failed to wait for an upload batch. Vulkan error ", result, '.'
+        );
+        return result_t::error(result);
+    }
+
+    for (const auto& staging : p_batch.dedicated_staging)
+    {
+        vulkan_scene::destroy_buffer(
+            p_queue.device, *p_queue.allocator, staging
+        );
+    }
+    p_batch.dedicated_staging.clear();
+
+    p_queue.used -= p_batch.staging_used;
+    p_batch.staging_used = 0;
+
+    // Nothing else records into the pools, so the command buffers can be
+    // reset all at once.
+    vkResetCommandPool(p_queue.device, p_batch.command_pool, 0);
+    if (p_batch.acquire_command_pool != VK_NULL_HANDLE)
+    {
+        vkResetCommandPool(p_queue.device, p_batch.acquire_command_pool, 0);
+    }
+
+    p_queue.completed = p_batch.ticket;
+    p_batch.submitted = false;
+
+    return result_t::success();
+}
+
+// Batches are submitted in order, so the oldest one that is still in flight is
+// the first submitted one after the current.
+auto oldest_submitted_batch(upload_queue_t& p_queue) noexcept
+    -> upload_batch_t*
+{
+    const auto batch_count = static_cast<uint32_t>(p_queue.batches.size());
+
+    for (uint32_t i = 1; i <= batch_count; i++)
+    {
+        auto& batch = p_queue.batches.at((p_queue.current + i) % batch_count);
+        if (batch.submitted)
+        {
+            return &batch;
+        }
+    }
+
+    return nullptr;
+}
+
+auto begin_recording(upload_queue_t& p_queue) noexcept
+    -> kirho::result_t<VkCommandBuffer, VkResult>
+{
+    using result_t = kirho::result_t<VkCommandBuffer, VkResult>;
+
+    auto& batch = current_batch(p_queue);
+
+    if (batch.copy_count == 0)
+    {
+        const VkCommandBufferBeginInfo begin_info{
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+            .pNext = nullptr,
+            .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+            .pInheritanceInfo = nullptr,
+        };
+
+        const auto result =
+            vkBeginCommandBuffer(batch.command_buffer, &begin_info);
+        if (result != VK_SUCCESS)
+        {
+            print_error(
+                "Failed to begin an upload command buffer. Vulkan error ",
+                result, '.'
+            );
+            return result_t::error(result);
+        }
+    }
+
+    batch.copy_count++;
+    p_queue.copy_count++;
+
+    return result_t::success(batch.command_buffer);
+}
+
+// Finds room for p_size bytes of staging data, either in the ring or in a
+// dedicated buffer for very large uploads. Returns the buffer and the offset
+// to copy from.
+auto reserve_staging(
+    upload_queue_t& p_queue, const void* p_data, VkDeviceSize p_size
+) noexcept -> kirho::result_t<std::pair<VkBuffer, VkDeviceSize>, VkResult>
+{
+    using result_t =
+        kirho::result_t<std::pair<VkBuffer, VkDeviceSize>, VkResult>;
+
+    VkResult result;
+
+    // Big uploads would otherwise keep the ring from holding anything else.
+    if (p_size > p_queue.staging_size / 4)
+    {
+        const auto staging_result = vulkan_scene::create_staging_buffer(
+            *p_queue.allocator, p_queue.device, p_size,
+            vulkan_scene::allocation_strategy_t::LINEAR
+        );
+        if (staging_result.is_error(result))
+        {
+            return result_t::error(result);
+        }
+
+        const auto staging = staging_result.unwrap();
+        std::memcpy(staging.allocation.mapped, p_data, p_size);
+
+        current_batch(p_queue).dedicated_staging.push_back(staging);
+
+        return result_t::success(std::make_pair(staging.buffer, 0));
+    }
+
+    while (true)
+    {
+        if (p_queue.used == 0)
+        {
+            p_queue.head = 0;
+        }
+
+        auto offset = vulkan_scene::align_up(p_queue.head, STAGING_ALIGNMENT);
+        auto needed = offset - p_queue.head + p_size;
+
+        // Data never wraps around the end of the ring. The rest of it gets
+        // skipped instead.
+        if (offset + p_size > p_queue.staging_size)
+        {
+            offset = 0;
+            needed = p_queue.staging_size - p_queue.head + p_size;
+        }
+
+        if (p_queue.used + needed <= p_queue.staging_size)
+        {
+            p_queue.head = offset + p_size;
+            p_queue.used += needed;
+            current_batch(p_queue).staging_used += needed;
+
+            std::memcpy(p_queue.mapped + offset, p_data, p_size);
+
+            return result_t::success(
+                std::make_pair(p_queue.staging.buffer, offset)
+            );
+        }
+
+        // The ring is full, so wait for the oldest batch to free some of it.
+        // If nothing is in flight, the current batch is what fills it up.
+        auto oldest = oldest_submitted_batch(p_queue);
+        if (oldest == nullptr)
+        {
+            if (current_batch(p_queue).copy_count == 0)
+            {
+                print_error(
+                    "An upload of ", p_size,
+                    " bytes does not fit into the staging ring."
+                );
+                return result_t::error(VK_ERROR_OUT_OF_HOST_MEMORY);
+            }
+
+            const auto flush_result = vulkan_scene::flush_uploads(p_queue);
+            if (flush_result.is_error(result))
+            {
+                return result_t::error(result);
+            }
+
+            continue;
+        }
+
+        if (retire_batch(p_queue, *oldest).is_error(result))
+        {
+            return result_t::error(result);
+        }
+    }
+}
+
+} // namespace
+
+namespace vulkan_scene
+{
+
+auto create_upload_queue(
+    memory_allocator_t& p_allocator,
+    VkDevice p_device,
+    VkQueue p_queue,
+    uint32_t p_queue_family,
+    VkQueue p_destination_queue,
+    uint32_t p_destination_family,
+    VkDeviceSize p_staging_size
+) noexcept -> kirho::result_t<upload_queue_t, VkResult>
+{
+    using result_t = kirho::result_t<upload_queue_t, VkResult>;
+
+    VkResult result;
+
+    const auto staging_result =
+        create_staging_buffer(p_allocator, p_device, p_staging_size);
+    if (staging_result.is_error(result))
+    {
+        return result_t::error(result);
+    }
+
+    const auto staging = staging_result.unwrap();
+
+    upload_queue_t queue{
+        .device = p_device,
+        .allocator = &p_allocator,
+        .queue = p_queue,
+        .queue_family = p_queue_family,
+        .destination_queue = p_destination_queue,
+        .destination_family = p_destination_family,
+        .staging = staging,
+        .mapped = static_cast<uint8_t*>(staging.allocation.mapped),
+        .staging_size = p_staging_size,
+        .head = 0,
+        .used = 0,
+        .batches = {},
+        .current = 0,
+        .next_ticket = 1,
+        .completed = 0,
+        .submit_count = 0,
+        .copy_count = 0,
+    };
+
+    for (uint32_t i = 0; i < UPLOAD_BATCH_COUNT; i++)
+    {
+        const auto command_pool_result =
+            create_command_pool(p_device, p_queue_family);
+        if (command_pool_result.is_error(result))
+        {
+            destroy_upload_queue(queue);
+            return result_t::error(result);
+        }
+
+        const auto command_pool = command_pool_result.unwrap();
+
+        // The command buffers get freed along with the pools.
+        const auto command_buffer_result =
+            create_command_buffer(p_device, command_pool);
+        const auto fence_result = create_fence(p_device);
+        if (command_buffer_result.is_error(result) ||
+            fence_result.is_error(result))
+        {
+            if (!fence_result.is_error(result))
+            {
+                vkDestroyFence(p_device, fence_result.unwrap(), nullptr);
+            }
+            vkDestroyCommandPool(p_device, command_pool, nullptr);
+            destroy_upload_queue(queue);
+            return result_t::error(result);
+        }
+
+        auto batch = upload_batch_t{
+            .command_pool = command_pool,
+            .command_buffer = command_buffer_result.unwrap(),
+            .fence = fence_result.unwrap(),
+            .ticket = 0,
+            .acquire_command_pool = VK_NULL_HANDLE,
+            .acquire_command_buffer = VK_NULL_HANDLE,
+            .semaphore = VK_NULL_HANDLE,
+            .buffer_barriers = {},
+            .image_barriers = {},
+            .mip_generations = {},
+            .staging_used = 0,
+            .dedicated_staging = {},
+            .copy_count = 0,
+            .submitted = false,
+        };
+
+        // From here on, destroy_upload_queue cleans the batch up.
+        queue.batches.push_back(batch);
+
+        if (transfers_ownership(queue))
+        {
+            auto& added_batch = queue.batches.back();
+
+            const auto acquire_pool_result =
+                create_command_pool(p_device, p_destination_family);
+            if (acquire_pool_result.is_error(result))
+            {
+                destroy_upload_queue(queue);
+                return result_t::error(result);
+            }
+
+            added_batch.acquire_command_pool = acquire_pool_result.unwrap();
+
+            const auto acquire_result = create_command_buffer(
+                p_device, added_batch.acquire_command_pool
+            );
+            const auto semaphore_result = create_semaphore(p_device);
+
+            if (acquire_result.is_error(result) ||
+                semaphore_result.is_error(result))
+            {
+                if (!semaphore_result.is_error(result))
+                {
+                    vkDestroySemaphore(
+                        p_device, semaphore_result.unwrap(), nullptr
+                    );
+                }
+                destroy_upload_queue(queue);
+                return result_t::error(result);
+            }
+
+            added_batch.acquire_command_buffer = acquire_result.unwrap();
+            added_batch.semaphore = semaphore_result.unwrap();
+        }
+    }
+
+    current_batch(queue).ticket = queue.next_ticket++;
+
+    return result_t::success(queue);
+}
+
+auto upload_buffer(
+    upload_queue_t& p_queue,
+    const buffer_t& p_buffer,
+    VkDeviceSize p_offset,
+    const void* p_data,
+    VkDeviceSize p_size
+) noexcept -> kirho::result_t<upload_ticket_t, VkResult>
+{
+    using result_t = kirho::result_t<upload_ticket_t, VkResult>;
+
+    VkResult result;
+
+    // This might flush the current batch, so it has to come first.
+    const auto staging_result = reserve_staging(p_queue, p_data, p_size);
+    if (staging_result.is_error(result))
+    {
+        return result_t::error(result);
+    }
+
+    const auto [staging_buffer, staging_offset] = staging_result.unwrap();
+
+    const auto command_buffer_result = begin_recording(p_queue);
+    if (command_buffer_result.is_error(result))
+    {
+        return result_t::error(result);
+    }
+
+    const VkBufferCopy copy_region{
+        .srcOffset = staging_offset,
+        .dstOffset = p_offset,
+        .size = p_size,
+    };
+
+    vkCmdCopyBuffer(
+        command_buffer_result.unwrap(), staging_buffer, p_buffer.buffer, 1,
+        &copy_region
+    );
+
+    current_batch(p_queue).buffer_barriers.push_back(VkBufferMemoryBarrier{
+        .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+        .pNext = nullptr,
+        .srcAccessMask = 0,
+        .dstAccessMask = 0,
+        .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .buffer = p_buffer.buffer,
+        .offset = p_offset,
+        .size = p_size,
+    });
+
+    return result_t::success(current_batch(p_queue).ticket);
+}
+
+auto upload_image(
+    upload_queue_t& p_queue,
+    VkImage p_image,
+    VkExtent2D p_extent,
+    uint32_t p_level_count,
+    std::span<const mip_level_t> p_levels,
+    const void* p_data,
+    VkDeviceSize p_size
+) noexcept -> kirho::result_t<upload_ticket_t, VkResult>
+{
+    using result_t = kirho::result_t<upload_ticket_t, VkResult>;
+
+    VkResult result;
+
+    const auto staging_result = reserve_staging(p_queue, p_data, p_size);
+    if (staging_result.is_error(result))
+    {
+        return result_t::error(result);
+    }
+
+    const auto [staging_buffer, staging_offset] = staging_result.unwrap();
+
+    const auto command_buffer_result = begin_recording(p_queue);
+    if (command_buffer_result.is_error(result))
+    {
+        return result_t::error(result);
+    }
+
+    const auto command_buffer = command_buffer_result.unwrap();
+
+    const VkImageSubresourceRange subresource_range{
+        .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+        .baseMipLevel = 0,
+        .levelCount = p_level_count,
+        .baseArrayLayer = 0,
+        .layerCount = 1,
+    };
+
+    VkImageMemoryBarrier barrier{
+        .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+        .pNext = nullptr,
+        .srcAccessMask = 0,
+        .dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+        .oldLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+        .newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+        .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .image = p_image,
+        .subresourceRange = subresource_range,
+    };
+
+    vkCmdPipelineBarrier(
+        command_buffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+        VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier
+    );
+
+    const auto provided_levels = static_cast<uint32_t>(p_levels.size());
+
+    std::vector<VkBufferImageCopy> regions;
+    regions.reserve(provided_levels);
+
+    for (uint32_t i = 0; i < provided_levels; i++)
+    {
+        regions.push_back(VkBufferImageCopy{
+            .bufferOffset = staging_offset + p_levels[i].offset,
+            .bufferRowLength = 0,
+            .bufferImageHeight = 0,
+            .imageSubresource =
+                VkImageSubresourceLayers{
+                    .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                    .mipLevel = i,
+                    .baseArrayLayer = 0,
+                    .layerCount = 1,
+                },
+            .imageOffset =
+                VkOffset3D{
+                    .x = 0,
+                    .y = 0,
+                    .z = 0,
+                },
+            .imageExtent =
+                VkExtent3D{
+                    .width = p_levels[i].width,
+                    .height = p_levels[i].height,
+                    .depth = 1,
+                },
+        });
+    }
+
+    vkCmdCopyBufferToImage(
+        command_buffer, staging_buffer, p_image,
+        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+        static_cast<uint32_t>(regions.size()), regions.data()
+    );
+
+    auto& batch = current_batch(p_queue);
+
+    // The rest of the chain gets blitted once the batch is flushed, on a queue
+    // that supports it.
+    if (provided_levels < p_level_count)
+    {
+        batch.mip_generations.push_back(mip_generation_t{
+            .image = p_image,
+            .extent = p_extent,
+            .level_count = p_level_count,
+            .first_level = provided_levels,
+        });
+
+        return result_t::success(batch.ticket);
+    }
+
+    // The transition to the shader layout happens along with the ownership
+    // transfer, when the batch gets flushed.
+    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    batch.image_barriers.push_back(barrier);
+
+    return result_t::success(batch.ticket);
+}
+
+auto flush_uploads(upload_queue_t& p_queue) noexcept
+    -> kirho::result_t<upload_ticket_t, VkResult>
+{
+    using result_t = kirho::result_t<upload_ticket_t, VkResult>;
+
+    auto& batch = current_batch(p_queue);
+
+    // Nothing was recorded, so the last submitted batch is the newest one.
+    if (batch.copy_count == 0)
+    {
+        return result_t::success(batch.ticket - 1);
+    }
+
+    VkResult result;
+    if (record_batch_barriers(p_queue, batch).is_error(result))
+    {
+        return result_t::error(result);
+    }
+
+    result = vkEndCommandBuffer(batch.command_buffer);
+    if (result != VK_SUCCESS)
+    {
+        print_error(
+            "Failed to end an upload command buffer. Vulkan error ", result, '.'
+        );
+        return result_t::error(result);
+    }
+
+    vkResetFences(p_queue.device, 1, &batch.fence);
+
+    // With an ownership transfer, the fence goes onto the acquiring submission
+    // instead, which can only run after the uploads anyways.
+    const auto signal_semaphore_count = transfers_ownership(p_queue) ? 1u : 0u;
+
+    const VkSubmitInfo submit_info{
+        .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+        .pNext = nullptr,
+        .waitSemaphoreCount = 0,
+        .pWaitSemaphores = nullptr,
+        .pWaitDstStageMask = nullptr,
+        .commandBufferCount = 1,
+        .pCommandBuffers = &batch.command_buffer,
+        .signalSemaphoreCount = signal_semaphore_count,
+        .pSignalSemaphores = &batch.semaphore,
+    };
+
+    result = vkQueueSubmit(
+        p_queue.queue, 1, &submit_info,
+        transfers_ownership(p_queue) ? VK_NULL_HANDLE : batch.fence
+    );
+    if (result != VK_SUCCESS)
+    {
+        print_error(
+            "Failed to submit an upload batch. Vulkan error ", result, '.'
+        );
+        return result_t::error(result);
+    }
+
+    if (transfers_ownership(p_queue))
+    {
+        // The mip generation starts with transfers.
+        const VkPipelineStageFlags wait_stage =
+            CONSUMER_STAGES | VK_PIPELINE_STAGE_TRANSFER_BIT;
+
+        const VkSubmitInfo acquire_submit_info{
+            .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+            .pNext = nullptr,
+            .waitSemaphoreCount = 1,
+            .pWaitSemaphores = &batch.semaphore,
+            .pWaitDstStageMask = &wait_stage,
+            .commandBufferCount = 1,
+            .pCommandBuffers = &batch.acquire_command_buffer,
+            .signalSemaphoreCount = 0,
+            .pSignalSemaphores = nullptr,
+        };
+
+        result = vkQueueSubmit(
+            p_queue.destination_queue, 1, &acquire_submit_info, batch.fence
+        );
+        if (result != VK_SUCCESS)
+        {
+            print_error(
+                "Failed to submit an ownership acquire batch. Vulkan error ",
+                result, '.'
+            );
+            return result_t::error(result);
+        }
+    }
+
+    batch.submitted = true;
+    p_queue.submit_count++;
+
+    const auto ticket = batch.ticket;
+
+    // Move on to the next batch, which might still be in flight from a while
+    // ago.
+    p_queue.current = (p_queue.current + 1) %
+                      static_cast<uint32_t>(p_queue.batches.size());
+
+    auto& next_batch = current_batch(p_queue);
+    if (retire_batch(p_queue, next_batch).is_error(result))
+    {
+        return result_t::error(result);
+    }
+
+    next_batch.ticket = p_queue.next_ticket++;
+    next_batch.copy_count = 0;
+    next_batch.buffer_barriers.clear();
+    next_batch.image_barriers.clear();
+    next_batch.mip_generations.clear();
+
+    return result_t::success(ticket);
+}
+
+auto wait_for_upload(upload_queue_t& p_queue, upload_ticket_t p_ticket) noexcept
+    -> kirho::result_t<kirho::empty_t, VkResult>
+{
+    using result_t = kirho::result_t<kirho::empty_t, VkResult>;
+
+    VkResult result;
+
+    if (p_ticket >= current_batch(p_queue).ticket)
+    {
+        if (flush_uploads(p_queue).is_error(result))
+        {
+            return result_t::error(result);
+        }
+    }
+
+    while (p_queue.completed < p_ticket)
+    {
+        auto oldest = oldest_submitted_batch(p_queue);
+        if (oldest == nullptr)
+        {
+            break;
+        }
+
+        if (retire_batch(p_queue, *oldest).is_error(result))
+        {
+            return result_t::error(result);
+        }
+    }
+
+    return result_t::success();
+}
+
+auto is_upload_complete(upload_queue_t& p_queue, upload_ticket_t p_ticket) noexcept
+    -> bool
+{
+    while (p_queue.completed < p_ticket)
+    {
+        auto oldest = oldest_submitted_batch(p_queue);
+        if (oldest == nullptr ||
+            vkGetFenceStatus(p_queue.device, oldest->fence) != VK_SUCCESS)
+        {
+            return false;
+        }
+
+        VkResult result;
+        if (retire_batch(p_queue, *oldest).is_error(result))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+auto destroy_upload_queue(upload_queue_t& p_queue) noexcept -> void
+{
+    for (auto& batch : p_queue.batches)
+    {
+        if (batch.submitted)
+        {
+            vkWaitForFences(
+                p_queue.device, 1, &batch.fence, VK_TRUE, UINT64_MAX
+            );
+        }
+
+        for (const auto& staging : batch.dedicated_staging)
+        {
+            destroy_buffer(p_queue.device, *p_queue.allocator, staging);
+        }
+
+        vkDestroySemaphore(p_queue.device, batch.semaphore, nullptr);
+        vkDestroyFence(p_queue.device, batch.fence, nullptr);
+
+        // Destroying the pools frees the command buffers as well.
+        vkDestroyCommandPool(p_queue.device, batch.command_pool, nullptr);
+        vkDestroyCommandPool(
+            p_queue.device, batch.acquire_command_pool, nullptr
+        );
+    }
+
+    if (p_queue.copy_count != 0)
+    {
+        std::cout << "[INFO]: Uploaded " << p_queue.copy_count
+                  << " resource(s) in " << p_queue.submit_count
+                  << " submission(s).\n";
+    }
+
+    destroy_buffer(p_queue.device, *p_queue.allocator, p_queue.staging);
+
+    p_queue.batches.clear();
+}
+
+} // namespace vulkan_scene
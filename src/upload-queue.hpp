@@ -0,0 +1,150 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include "graphics.hpp"
+#include "mipmap.hpp"
+
+namespace vulkan_scene
+{
+
+constexpr VkDeviceSize DEFAULT_STAGING_RING_SIZE = 16 * 1024 * 1024;
+constexpr uint32_t UPLOAD_BATCH_COUNT = 4;
+
+// Identifies the batch that an upload was recorded into. Tickets only ever
+// increase, so an upload is done once every ticket up to its own is.
+using upload_ticket_t = uint64_t;
+
+// An image whose mip levels from first_level onwards still need to be blitted.
+struct mip_generation_t
+{
+    VkImage image;
+    VkExtent2D extent;
+    uint32_t level_count;
+    uint32_t first_level;
+};
+
+// Every batch has command pools of its own, which get reset as a whole once
+// the batch is done, rather than resetting or reallocating the command
+// buffers one by one.
+struct upload_batch_t
+{
+    VkCommandPool command_pool;
+    VkCommandBuffer command_buffer;
+    VkFence fence;
+    upload_ticket_t ticket;
+
+    // Only used when uploading on a different queue family than the one that
+    // uses the resources afterwards. The acquiring half of the ownership
+    // transfers gets submitted there, after waiting on the semaphore.
+    VkCommandPool acquire_command_pool;
+    VkCommandBuffer acquire_command_buffer;
+    VkSemaphore semaphore;
+
+    // Recorded once the batch gets flushed, so that they can go into a single
+    // vkCmdPipelineBarrier call (or two, if ownership changes).
+    std::vector<VkBufferMemoryBarrier> buffer_barriers;
+    std::vector<VkImageMemoryBarrier> image_barriers;
+    std::vector<mip_generation_t> mip_generations;
+
+    // How many bytes of the staging ring (padding included) this batch uses.
+    // They are given back once its fence has been signaled.
+    VkDeviceSize staging_used;
+
+    // Uploads that don't fit into the ring get a staging buffer of their own,
+    // which lives until the batch is done.
+    std::vector<buffer_t> dedicated_staging;
+
+    uint32_t copy_count;
+    bool submitted;
+};
+
+// Records buffer and image uploads into a few reusable command buffers and
+// submits them in batches, instead of stalling the queue once per resource.
+// All the staging data goes through one persistently mapped ring buffer.
+//
+// Uploads can run on a dedicated transfer queue. Ownership of the resources is
+// then handed over to the destination queue family (the graphics one) when
+// each batch completes.
+struct upload_queue_t
+{
+    VkDevice device;
+    memory_allocator_t* allocator;
+
+    VkQueue queue;
+    uint32_t queue_family;
+
+    VkQueue destination_queue;
+    uint32_t destination_family;
+
+    buffer_t staging;
+    uint8_t* mapped;
+    VkDeviceSize staging_size;
+    VkDeviceSize head;
+    VkDeviceSize used;
+
+    std::vector<upload_batch_t> batches;
+    uint32_t current;
+
+    upload_ticket_t next_ticket;
+    upload_ticket_t completed;
+
+    uint64_t submit_count;
+    uint64_t copy_count;
+};
+
+auto create_upload_queue(
+    memory_allocator_t& p_allocator,
+    VkDevice p_device,
+    VkQueue p_queue,
+    uint32_t p_queue_family,
+    VkQueue p_destination_queue,
+    uint32_t p_destination_family,
+    VkDeviceSize p_staging_size = DEFAULT_STAGING_RING_SIZE
+) noexcept -> kirho::result_t<upload_queue_t, VkResult>;
+
+// Copies the data into the staging ring and records a copy into the given
+// buffer. Nothing reaches the GPU until the batch gets flushed, so the ticket
+// has to be waited on before the buffer is used.
+auto upload_buffer(
+    upload_queue_t& p_queue,
+    const buffer_t& p_buffer,
+    VkDeviceSize p_offset,
+    const void* p_data,
+    VkDeviceSize p_size
+) noexcept -> kirho::result_t<upload_ticket_t, VkResult>;
+
+// Same as upload_buffer, but for a freshly created image with p_level_count
+// mip levels. The data holds the first p_levels.size() of them, at the offsets
+// given in p_levels, which have to be multiples of the format's block size.
+// The remaining levels are blitted from the last provided one on the
+// destination queue, so the format has to support linear blits in that case.
+//
+// The image ends up in VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, owned by the
+// destination queue family.
+auto upload_image(
+    upload_queue_t& p_queue,
+    VkImage p_image,
+    VkExtent2D p_extent,
+    uint32_t p_level_count,
+    std::span<const mip_level_t> p_levels,
+    const void* p_data,
+    VkDeviceSize p_size
+) noexcept -> kirho::result_t<upload_ticket_t, VkResult>;
+
+// Submits everything recorded so far and returns the ticket of that batch.
+auto flush_uploads(upload_queue_t& p_queue) noexcept
+    -> kirho::result_t<upload_ticket_t, VkResult>;
+
+// Blocks until the uploads with the given ticket (and all before them) are
+// done, flushing them first if they haven't been submitted yet.
+auto wait_for_upload(upload_queue_t& p_queue, upload_ticket_t p_ticket) noexcept
+    -> kirho::result_t<kirho::empty_t, VkResult>;
+
+// Checks without blocking.
+auto is_upload_complete(upload_queue_t& p_queue, upload_ticket_t p_ticket) noexcept
+    -> bool;
+
+auto destroy_upload_queue(upload_queue_t& p_queue) noexcept -> void;
+
+} // namespace vulkan_scene
@@ -0,0 +1,156 @@
+#include <cassert>
+
+#include <sub-allocator.hpp>
+
+using vulkan_scene::allocation_strategy_t;
+using vulkan_scene::resource_kind_t;
+using vulkan_scene::sub_allocator_t;
+
+namespace
+{
+
+auto test_free_list() -> void
+{
+    sub_allocator_t allocator{1024, allocation_strategy_t::FREE_LIST};
+
+    const auto a = allocator.allocate(100, 16, resource_kind_t::LINEAR).unwrap();
+    const auto b = allocator.allocate(100, 256, resource_kind_t::LINEAR).unwrap();
+    const auto c = allocator.allocate(100, 16, resource_kind_t::LINEAR).unwrap();
+
+    assert(a == 0);
+    assert(b == 256);
+    assert(b % 256 == 0);
+    // The padding between a and b is the best fit for c.
+    assert(c == 112);
+    assert(allocator.stats().allocation_count == 3);
+    assert(allocator.stats().used == 300);
+
+    // Too big for any of the remaining ranges.
+    kirho::empty_t error;
+    assert(allocator.allocate(1024, 1, resource_kind_t::LINEAR).is_error(error)
+    );
+
+    // Freeing b merges it with the space on both sides of it, leaving only
+    // that range and the padding between a and c.
+    allocator.free(b);
+    const auto stats = allocator.stats();
+    assert(stats.allocation_count == 2);
+    assert(stats.free_range_count == 2);
+    assert(stats.largest_free_range == 1024 - 212);
+
+    allocator.free(a);
+    allocator.free(c);
+    assert(allocator.empty());
+    assert(allocator.stats().free_range_count == 1);
+    assert(allocator.stats().largest_free_range == 1024);
+    assert(allocator.stats().fragmentation() == 0.0);
+}
+
+auto test_fragmentation() -> void
+{
+    sub_allocator_t allocator{1000, allocation_strategy_t::FREE_LIST};
+
+    uint64_t offsets[10];
+    for (auto& offset : offsets)
+    {
+        offset = allocator.allocate(100, 1, resource_kind_t::LINEAR).unwrap();
+    }
+
+    assert(allocator.stats().largest_free_range == 0);
+
+    // Free every other allocation, which leaves five holes of 100 bytes.
+    for (int i = 0; i < 10; i += 2)
+    {
+        allocator.free(offsets[i]);
+    }
+
+    const auto stats = allocator.stats();
+    assert(stats.free_range_count == 5);
+    assert(stats.largest_free_range == 100);
+    assert(stats.fragmentation() > 0.7);
+
+    kirho::empty_t error;
+    assert(allocator.allocate(200, 1, resource_kind_t::LINEAR).is_error(error));
+    assert(allocator.allocate(100, 1, resource_kind_t::LINEAR).unwrap() == 0);
+}
+
+auto test_granularity() -> void
+{
+    sub_allocator_t allocator{4096, allocation_strategy_t::FREE_LIST, 1024};
+
+    const auto buffer =
+        allocator.allocate(100, 4, resource_kind_t::LINEAR).unwrap();
+    const auto image =
+        allocator.allocate(100, 4, resource_kind_t::OPTIMAL).unwrap();
+
+    assert(buffer == 0);
+    // The image may not share a page with the buffer before it.
+    assert(image == 1024);
+
+    // Buffers can still go between the two, as long as they stay off the
+    // image's page.
+    const auto small_buffer =
+        allocator.allocate(100, 4, resource_kind_t::LINEAR).unwrap();
+    assert(small_buffer == 100);
+
+    // Resources of the same kind can be packed tightly...
+    const auto another_image =
+        allocator.allocate(100, 4, resource_kind_t::OPTIMAL).unwrap();
+    assert(another_image == 1124);
+
+    // ...but a buffer that comes after an image has to skip to the next page.
+    const auto large_buffer =
+        allocator.allocate(900, 4, resource_kind_t::LINEAR).unwrap();
+    assert(large_buffer == 2048);
+
+    // Once the images are gone, the buffers can use their pages again.
+    allocator.free(image);
+    allocator.free(another_image);
+    const auto packed_buffer =
+        allocator.allocate(1500, 4, resource_kind_t::LINEAR).unwrap();
+    assert(packed_buffer == 200);
+}
+
+auto test_linear() -> void
+{
+    sub_allocator_t allocator{1024, allocation_strategy_t::LINEAR, 256};
+
+    const auto a = allocator.allocate(100, 16, resource_kind_t::LINEAR).unwrap();
+    const auto b = allocator.allocate(100, 16, resource_kind_t::LINEAR).unwrap();
+    const auto c =
+        allocator.allocate(100, 16, resource_kind_t::OPTIMAL).unwrap();
+
+    assert(a == 0);
+    assert(b == 112);
+    assert(c == 256);
+
+    kirho::empty_t error;
+    assert(allocator.allocate(800, 1, resource_kind_t::OPTIMAL).is_error(error)
+    );
+
+    // Freeing the last allocation moves the head back.
+    allocator.free(c);
+    assert(allocator.stats().largest_free_range == 1024 - 212);
+
+    // Freeing one in the middle doesn't give anything back until the block
+    // is empty.
+    allocator.free(a);
+    assert(allocator.stats().largest_free_range == 1024 - 212);
+
+    allocator.free(b);
+    assert(allocator.empty());
+    assert(allocator.stats().largest_free_range == 1024);
+    assert(allocator.allocate(1024, 1, resource_kind_t::LINEAR).unwrap() == 0);
+}
+
+} // namespace
+
+auto main() -> int
+{
+    test_free_list();
+    test_fragmentation();
+    test_granularity();
+    test_linear();
+
+    return 0;
+}
@@ -0,0 +1,127 @@
+#include <cassert>
+
+#include <atomic>
+#include <filesystem>
+#include <string>
+
+#include <asset-loader.hpp>
+#include <ktx2.hpp>
+#include <thread-pool.hpp>
+
+namespace
+{
+
+auto test_thread_pool() -> void
+{
+    std::atomic<uint32_t> counter = 0;
+
+    {
+        vulkan_scene::thread_pool_t thread_pool{4};
+        assert(thread_pool.thread_count() == 4);
+
+        for (uint32_t i = 0; i < 1000; i++)
+        {
+            thread_pool.submit([&counter] { counter++; });
+        }
+
+        thread_pool.wait_idle();
+        assert(counter == 1000);
+
+        // Whatever is still queued when the pool goes away gets run first.
+        for (uint32_t i = 0; i < 1000; i++)
+        {
+            thread_pool.submit([&counter] { counter++; });
+        }
+    }
+
+    assert(counter == 2000);
+}
+
+auto test_asset_loader() -> void
+{
+    constexpr uint32_t image_count = 16;
+
+    const auto directory = std::filesystem::temp_directory_path();
+
+    // KTX2 files don't need a device to decode, unlike checking whether the
+    // compressed variants of a PNG are usable.
+    std::vector<std::string> paths;
+    for (uint32_t i = 0; i < image_count; i++)
+    {
+        const auto size = 4 + i;
+        const auto name =
+            "vulkan-scene-loader-" + std::to_string(i) + ".ktx2";
+        const auto path = (directory / name).string();
+
+        vulkan_scene::ktx2_texture_t texture{
+            .format = VK_FORMAT_R8G8B8A8_SRGB,
+            .width = size,
+            .height = size,
+            .levels = vulkan_scene::mip_chain_layout(size, size, 1),
+            .data = std::vector<uint8_t>(
+                size * size * 4, static_cast<uint8_t>(i)
+            ),
+        };
+
+        kirho::empty_t error;
+        assert(!vulkan_scene::write_ktx2(path, texture).is_error(error));
+
+        paths.push_back(path);
+    }
+
+    const vulkan_scene::image_decode_options_t options{
+        .generate_mips = true,
+        .mips_on_cpu = false,
+        .use_compressed_variants = false,
+        .sampleable_formats = {},
+    };
+
+    vulkan_scene::thread_pool_t thread_pool{4};
+    vulkan_scene::asset_loader_t asset_loader{thread_pool};
+
+    for (uint32_t i = 0; i < image_count; i++)
+    {
+        assert(asset_loader.load_image(paths[i], options) == i);
+    }
+
+    const auto missing_index =
+        asset_loader.load_image((directory / "missing.png").string(), options);
+
+    std::vector<bool> seen(image_count + 1, false);
+    while (const auto loaded = asset_loader.next_image())
+    {
+        assert(!seen[loaded->index]);
+        seen[loaded->index] = true;
+
+        if (loaded->index == missing_index)
+        {
+            assert(!loaded->image.has_value());
+            continue;
+        }
+
+        const auto& image = loaded->image.value();
+        const auto size = static_cast<uint32_t>(4 + loaded->index);
+
+        assert(image.extent.width == size && image.extent.height == size);
+        assert(image.level_count == 1 && image.levels.size() == 1);
+        assert(image.data.size() == size * size * 4);
+        assert(image.data.front() == loaded->index);
+    }
+
+    assert(std::all_of(
+        seen.begin(), seen.end(), [](bool p_seen) { return p_seen; }
+    ));
+
+    for (const auto& path : paths)
+    {
+        std::filesystem::remove(path);
+    }
+}
+
+} // namespace
+
+auto main() -> int
+{
+    test_thread_pool();
+    test_asset_loader();
+}
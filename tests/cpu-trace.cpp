@@ -0,0 +1,92 @@
+#include <cassert>
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include <cpu-trace.hpp>
+
+namespace
+{
+
+auto count_occurrences(std::string_view p_string, std::string_view p_pattern)
+    -> size_t
+{
+    size_t count = 0;
+    for (auto position = p_string.find(p_pattern);
+         position != std::string_view::npos;
+         position = p_string.find(p_pattern, position + 1))
+    {
+        count++;
+    }
+
+    return count;
+}
+
+auto read_file(const std::filesystem::path& p_path) -> std::string
+{
+    std::ifstream file_stream{p_path};
+    std::stringstream contents;
+    contents << file_stream.rdbuf();
+    return contents.str();
+}
+
+} // namespace
+
+auto main() -> int
+{
+    const auto path =
+        std::filesystem::temp_directory_path() / "vulkan-scene-trace.json";
+
+    // Nothing gets recorded while tracing is off.
+    {
+        vulkan_scene::cpu_trace_scope_t scope{"disabled"};
+    }
+
+    vulkan_scene::enable_cpu_trace(true);
+    vulkan_scene::set_cpu_trace_thread_name("main \"thread\"");
+
+    {
+        vulkan_scene::cpu_trace_scope_t outer{"outer"};
+        vulkan_scene::cpu_trace_scope_t inner{"inner"};
+        inner.end();
+        inner.end();
+    }
+
+    // The worker records more than fits, so only its newest events are kept.
+    // The oldest one of those is left out as well, since the worker could have
+    // been overwriting it while the trace was written.
+    std::thread worker{
+        []
+        {
+            for (size_t i = 0; i < vulkan_scene::CPU_TRACE_CAPACITY + 100; i++)
+            {
+                vulkan_scene::cpu_trace_scope_t scope{"worker"};
+            }
+        }
+    };
+    worker.join();
+
+    kirho::empty_t error;
+    assert(!vulkan_scene::write_cpu_trace(path.string()).is_error(error));
+
+    const auto trace = read_file(path);
+    assert(trace.starts_with("{\"displayTimeUnit\":\"ms\",\"traceEvents\":["));
+    assert(trace.ends_with("]}\n"));
+
+    assert(count_occurrences(trace, "\"disabled\"") == 0);
+    assert(count_occurrences(trace, "\"outer\"") == 1);
+    assert(count_occurrences(trace, "\"inner\"") == 1);
+    assert(
+        count_occurrences(trace, "\"worker\"") ==
+        vulkan_scene::CPU_TRACE_CAPACITY - 1
+    );
+
+    assert(count_occurrences(trace, "\"ph\":\"M\"") == 2);
+    assert(count_occurrences(trace, "\"main \\\"thread\\\"\"") == 1);
+    assert(count_occurrences(trace, "\"thread 1\"") == 1);
+
+    std::filesystem::remove(path);
+}
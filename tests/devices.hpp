@@ -13,11 +13,14 @@ auto test_devices(bool p_enable_validation) noexcept -> void
                               .unwrap();
     const auto surface =
         vulkan_scene::create_surface(instance, window).unwrap();
-    const auto [physical_device, graphics_queue_family, present_queue_family] =
-        vulkan_scene::choose_physical_device(instance, surface).unwrap();
+    const auto
+        [physical_device, graphics_queue_family, present_queue_family,
+         transfer_queue_family] =
+            vulkan_scene::choose_physical_device(instance, surface).unwrap();
     const auto device =
         vulkan_scene::create_logical_device(
-            physical_device, graphics_queue_family, present_queue_family
+            physical_device, graphics_queue_family, present_queue_family,
+            transfer_queue_family
         )
             .unwrap();
 
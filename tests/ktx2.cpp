@@ -0,0 +1,148 @@
+#include <cassert>
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include <ktx2.hpp>
+
+namespace
+{
+
+auto temporary_path(std::string_view p_name) -> std::string
+{
+    return (std::filesystem::temp_directory_path() / p_name).string();
+}
+
+// Every byte gets a value based on its position, so that mixed up levels show.
+auto make_texture(VkFormat p_format, uint32_t p_width, uint32_t p_height)
+    -> vulkan_scene::ktx2_texture_t
+{
+    const auto block = vulkan_scene::get_format_block(p_format).value();
+    const auto level_count = vulkan_scene::mip_level_count(p_width, p_height);
+
+    vulkan_scene::ktx2_texture_t texture{
+        .format = p_format,
+        .width = p_width,
+        .height = p_height,
+        .levels = {},
+        .data = {},
+    };
+
+    size_t offset = 0;
+    for (uint32_t i = 0; i < level_count; i++)
+    {
+        const auto width = std::max(p_width >> i, 1u);
+        const auto height = std::max(p_height >> i, 1u);
+        const auto size = vulkan_scene::get_level_size(block, width, height);
+
+        texture.levels.push_back(vulkan_scene::mip_level_t{
+            .width = width,
+            .height = height,
+            .offset = offset,
+            .size = size,
+        });
+        offset += size;
+    }
+
+    texture.data.resize(offset);
+    for (size_t i = 0; i < texture.data.size(); i++)
+    {
+        texture.data[i] = static_cast<uint8_t>(i * 7 + i / 251);
+    }
+
+    return texture;
+}
+
+auto test_level_size() -> void
+{
+    const auto bc1 =
+        vulkan_scene::get_format_block(VK_FORMAT_BC1_RGB_SRGB_BLOCK).value();
+    const auto bc7 =
+        vulkan_scene::get_format_block(VK_FORMAT_BC7_SRGB_BLOCK).value();
+    const auto rgba =
+        vulkan_scene::get_format_block(VK_FORMAT_R8G8B8A8_SRGB).value();
+
+    assert(vulkan_scene::get_level_size(bc1, 8, 8) == 4 * 8);
+    assert(vulkan_scene::get_level_size(bc7, 8, 8) == 4 * 16);
+    assert(vulkan_scene::get_level_size(rgba, 8, 8) == 8 * 8 * 4);
+
+    // Partial blocks round up, all the way down to 1x1.
+    assert(vulkan_scene::get_level_size(bc7, 9, 5) == 3 * 2 * 16);
+    assert(vulkan_scene::get_level_size(bc1, 1, 1) == 8);
+
+    assert(!vulkan_scene::get_format_block(VK_FORMAT_D32_SFLOAT).has_value());
+}
+
+auto test_round_trip(VkFormat p_format, uint32_t p_width, uint32_t p_height)
+    -> void
+{
+    const auto path = temporary_path("vulkan-scene-test.ktx2");
+    const auto texture = make_texture(p_format, p_width, p_height);
+
+    kirho::empty_t error;
+    assert(!vulkan_scene::write_ktx2(path, texture).is_error(error));
+
+    const auto read_result = vulkan_scene::read_ktx2(path);
+    assert(!read_result.is_error(error));
+
+    const auto read = read_result.unwrap();
+
+    assert(read.format == texture.format);
+    assert(read.width == texture.width && read.height == texture.height);
+    assert(read.levels.size() == texture.levels.size());
+
+    for (size_t i = 0; i < read.levels.size(); i++)
+    {
+        const auto& expected = texture.levels[i];
+        const auto& level = read.levels[i];
+
+        assert(level.width == expected.width);
+        assert(level.height == expected.height);
+        assert(level.size == expected.size);
+        assert(level.offset % vulkan_scene::KTX2_LEVEL_ALIGNMENT == 0);
+
+        assert(std::equal(
+            read.data.begin() + level.offset,
+            read.data.begin() + level.offset + level.size,
+            texture.data.begin() + expected.offset
+        ));
+    }
+
+    std::filesystem::remove(path);
+}
+
+auto test_rejects_garbage() -> void
+{
+    const auto path = temporary_path("vulkan-scene-garbage.ktx2");
+
+    {
+        std::ofstream file_stream{path, std::ios::binary};
+        file_stream << "definitely not a texture, but long enough to have a "
+                       "header's worth of bytes in it, or close to it.";
+    }
+
+    kirho::empty_t error;
+    assert(vulkan_scene::read_ktx2(path).is_error(error));
+
+    // A valid file that got cut off somewhere in its level data.
+    const auto texture = make_texture(VK_FORMAT_BC7_SRGB_BLOCK, 64, 64);
+    assert(!vulkan_scene::write_ktx2(path, texture).is_error(error));
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) - 100);
+    assert(vulkan_scene::read_ktx2(path).is_error(error));
+
+    std::filesystem::remove(path);
+
+    assert(vulkan_scene::read_ktx2(path).is_error(error));
+}
+
+} // namespace
+
+auto main() -> int
+{
+    test_level_size();
+    test_round_trip(VK_FORMAT_BC7_SRGB_BLOCK, 9, 5);
+    test_round_trip(VK_FORMAT_BC1_RGB_SRGB_BLOCK, 64, 16);
+    test_round_trip(VK_FORMAT_R8G8B8A8_SRGB, 7, 3);
+    test_rejects_garbage();
+}
@@ -0,0 +1,247 @@
+#include <cassert>
+#include <cmath>
+#include <cstring>
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include <mesh-loader.hpp>
+
+namespace
+{
+
+using vulkan_scene::mesh_t;
+
+auto temporary_path(std::string_view p_name) -> std::string
+{
+    return (std::filesystem::temp_directory_path() / p_name).string();
+}
+
+auto write_file(const std::string& p_path, std::string_view p_contents) -> void
+{
+    std::ofstream file_stream{p_path, std::ios::binary};
+    file_stream.write(
+        p_contents.data(), static_cast<std::streamsize>(p_contents.size())
+    );
+    assert(file_stream);
+}
+
+auto near(float p_a, float p_b) -> bool
+{
+    return std::abs(p_a - p_b) < 1e-5f;
+}
+
+auto near(glm::vec3 p_a, glm::vec3 p_b) -> bool
+{
+    return near(p_a.x, p_b.x) && near(p_a.y, p_b.y) && near(p_a.z, p_b.z);
+}
+
+auto encode_base64(std::span<const uint8_t> p_bytes) -> std::string
+{
+    constexpr std::string_view ALPHABET =
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+    std::string text;
+    for (size_t i = 0; i < p_bytes.size(); i += 3)
+    {
+        const auto remaining = std::min(p_bytes.size() - i, size_t{3});
+
+        uint32_t bits = 0;
+        for (size_t j = 0; j < 3; j++)
+        {
+            bits = (bits << 8) | (j < remaining ? p_bytes[i + j] : 0u);
+        }
+
+        for (size_t j = 0; j < 4; j++)
+        {
+            text.push_back(
+                j <= remaining ? ALPHABET[(bits >> (18 - 6 * j)) & 0x3F] : '='
+            );
+        }
+    }
+
+    return text;
+}
+
+// A square made of two triangles, with texture coordinates and normals.
+constexpr std::string_view SQUARE_OBJ = "# A square\n"
+                                        "v 0 0 0\n"
+                                        "v 2 0 0\n"
+                                        "v 2 2 0\n"
+                                        "v 0 2 0\n"
+                                        "vt 0 0\n"
+                                        "vt 1 0\n"
+                                        "vt 1 1\n"
+                                        "vt 0 1\n"
+                                        "vn 0 0 1\n"
+                                        "f 1/1/1 2/2/1 3/3/1 -1/-1/-1\n";
+
+auto test_read_obj() -> void
+{
+    const auto path = temporary_path("vulkan-scene-square.obj");
+    write_file(path, SQUARE_OBJ);
+
+    const auto mesh = vulkan_scene::read_obj(path).unwrap();
+    std::filesystem::remove(path);
+
+    // The quad gets split into two triangles, each with vertices of its own.
+    assert(mesh.indices.size() == 6);
+    assert(mesh.vertices.size() == 6);
+
+    const auto& corner = mesh.vertices[mesh.indices[5]];
+    assert(near(corner.position, {0.0f, 2.0f, 0.0f}));
+    assert(near(corner.normal, {0.0f, 0.0f, 1.0f}));
+
+    // The texture coordinates get flipped vertically.
+    assert(near(corner.uv.x, 0.0f) && near(corner.uv.y, 0.0f));
+    assert(near(mesh.vertices[mesh.indices[0]].uv.y, 1.0f));
+}
+
+auto test_read_obj_without_normals() -> void
+{
+    const auto path = temporary_path("vulkan-scene-triangle.obj");
+    write_file(path, "v 0 0 0\nv 0 1 0\nv 0 0 1\nf 1 2 3\n");
+
+    const auto mesh = vulkan_scene::read_obj(path).unwrap();
+    std::filesystem::remove(path);
+
+    assert(mesh.indices.size() == 3);
+    for (const auto& vertex : mesh.vertices)
+    {
+        assert(near(vertex.normal, {1.0f, 0.0f, 0.0f}));
+    }
+}
+
+auto test_read_invalid_obj() -> void
+{
+    const auto path = temporary_path("vulkan-scene-invalid.obj");
+
+    // The face refers to a vertex that doesn't exist.
+    write_file(path, "v 0 0 0\nv 0 1 0\nv 0 0 1\nf 1 2 4\n");
+
+    kirho::empty_t error;
+    assert(vulkan_scene::read_obj(path).is_error(error));
+
+    write_file(path, "v 0 0 zero\n");
+    assert(vulkan_scene::read_obj(path).is_error(error));
+
+    std::filesystem::remove(path);
+}
+
+auto test_read_gltf() -> void
+{
+    // One triangle, indexed with 16-bit indices.
+    const float positions[] = {0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f,
+                               0.0f, 1.0f, 0.0f};
+    const uint16_t indices[] = {0, 1, 2};
+
+    std::vector<uint8_t> buffer(sizeof(positions) + sizeof(indices));
+    std::memcpy(buffer.data(), positions, sizeof(positions));
+    std::memcpy(buffer.data() + sizeof(positions), indices, sizeof(indices));
+
+    // The node moves the triangle and mirrors it along x, which also flips
+    // its winding.
+    const auto gltf =
+        R"({"asset": {"version": "2.0"}, "scene": 0,)"
+        R"("scenes": [{"nodes": [0]}],)"
+        R"("nodes": [{"children": [1], "translation": [0, 0, 5]},)"
+        R"({"mesh": 0, "scale": [-1, 1, 1]}],)"
+        R"("meshes": [{"primitives": [{"attributes": {"POSITION": 0},)"
+        R"("indices": 1}]}],)"
+        R"("accessors": [)"
+        R"({"bufferView": 0, "componentType": 5126, "count": 3,)"
+        R"("type": "VEC3"},)"
+        R"({"bufferView": 1, "componentType": 5123, "count": 3,)"
+        R"("type": "SCALAR"}],)"
+        R"("bufferViews": [{"buffer": 0, "byteLength": 36},)"
+        R"({"buffer": 0, "byteOffset": 36, "byteLength": 6}],)"
+        R"("buffers": [{"byteLength": 42, "uri": )"
+        R"("data:application/octet-stream;base64,)" +
+        encode_base64(buffer) + R"("}]})";
+
+    const auto path = temporary_path("vulkan-scene-triangle.gltf");
+    write_file(path, gltf);
+
+    const auto mesh = vulkan_scene::read_gltf(path).unwrap();
+    std::filesystem::remove(path);
+
+    assert(mesh.vertices.size() == 3);
+    assert(mesh.indices.size() == 3);
+
+    assert(near(mesh.vertices[1].position, {-1.0f, 0.0f, 5.0f}));
+    assert(near(mesh.vertices[2].position, {0.0f, 1.0f, 5.0f}));
+
+    // The generated normal faced +z before the mirroring, and the mirroring
+    // keeps it the same since it's along x.
+    assert(near(mesh.vertices[0].normal, {0.0f, 0.0f, 1.0f}));
+    assert(mesh.indices[0] == 0 && mesh.indices[1] == 2 &&
+           mesh.indices[2] == 1);
+}
+
+auto test_load_mesh() -> void
+{
+    const auto path = temporary_path("vulkan-scene-cached-square.obj");
+    const auto cache_path =
+        path + std::string{vulkan_scene::MESH_CACHE_EXTENSION};
+
+    std::filesystem::remove(cache_path);
+    write_file(path, SQUARE_OBJ);
+
+    const auto mesh = vulkan_scene::load_mesh(path).unwrap();
+    assert(std::filesystem::exists(cache_path));
+
+    // The duplicate corners get welded, and the square gets fit into the unit
+    // cube.
+    assert(mesh.vertices.size() == 4);
+    assert(mesh.index_count == 6);
+    assert(mesh.index_type == VK_INDEX_TYPE_UINT16);
+    assert(mesh.submeshes.size() == 1);
+    assert(mesh.submeshes[0].index_count == 6);
+
+    for (const auto& vertex : mesh.vertices)
+    {
+        assert(near(std::abs(vertex.position.x), 0.5f));
+        assert(near(std::abs(vertex.position.y), 0.5f));
+    }
+
+    const auto indices = static_cast<const uint16_t*>(mesh.indices);
+    for (uint32_t i = 0; i < mesh.index_count; i++)
+    {
+        assert(indices[i] < mesh.vertices.size());
+    }
+
+    vulkan_scene::unload_mesh(mesh);
+
+    // The second load comes straight from the cache.
+    const auto write_time = std::filesystem::last_write_time(cache_path);
+
+    const auto cached_mesh = vulkan_scene::load_mesh(path).unwrap();
+    assert(cached_mesh.vertices.size() == 4);
+    assert(cached_mesh.index_count == 6);
+    assert(std::filesystem::last_write_time(cache_path) == write_time);
+    vulkan_scene::unload_mesh(cached_mesh);
+
+    // A change to the mesh makes the cache stale.
+    write_file(
+        path, std::string{SQUARE_OBJ} + "v 1 1 1\nf 1/1/1 2/2/1 -1/1/1\n"
+    );
+
+    const auto changed_mesh = vulkan_scene::load_mesh(path).unwrap();
+    assert(changed_mesh.index_count == 9);
+    vulkan_scene::unload_mesh(changed_mesh);
+
+    std::filesystem::remove(path);
+    std::filesystem::remove(cache_path);
+}
+
+} // namespace
+
+auto main() -> int
+{
+    test_read_obj();
+    test_read_obj_without_normals();
+    test_read_invalid_obj();
+    test_read_gltf();
+    test_load_mesh();
+}
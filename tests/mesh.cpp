@@ -0,0 +1,430 @@
+#include <cassert>
+#include <cmath>
+#include <cstring>
+
+#include <random>
+#include <tuple>
+
+#include <mesh.hpp>
+
+namespace
+{
+
+using vulkan_scene::mesh_t;
+using vulkan_scene::vertex_t;
+
+auto make_vertex(float p_x, float p_y, float p_z) -> vertex_t
+{
+    return vertex_t{
+        .position = {p_x, p_y, p_z},
+        .uv = {p_x, p_y},
+        .normal = {0.0f, 0.0f, 1.0f},
+    };
+}
+
+// A flat grid of p_size by p_size quads, facing +z, with the triangles in a
+// random order.
+auto make_shuffled_grid(uint32_t p_size) -> mesh_t
+{
+    mesh_t mesh;
+    for (uint32_t y = 0; y <= p_size; y++)
+    {
+        for (uint32_t x = 0; x <= p_size; x++)
+        {
+            mesh.vertices.push_back(make_vertex(
+                static_cast<float>(x), static_cast<float>(y), 0.0f
+            ));
+        }
+    }
+
+    std::vector<std::array<uint32_t, 3>> triangles;
+    for (uint32_t y = 0; y < p_size; y++)
+    {
+        for (uint32_t x = 0; x < p_size; x++)
+        {
+            const auto corner = y * (p_size + 1) + x;
+            const auto above = corner + p_size + 1;
+            triangles.push_back({corner, corner + 1, above + 1});
+            triangles.push_back({corner, above + 1, above});
+        }
+    }
+
+    std::mt19937 random{42};
+    std::shuffle(triangles.begin(), triangles.end(), random);
+
+    for (const auto& triangle : triangles)
+    {
+        mesh.indices.insert(
+            mesh.indices.end(), triangle.begin(), triangle.end()
+        );
+    }
+
+    return mesh;
+}
+
+using position_t = std::tuple<float, float, float>;
+using triangle_t = std::array<position_t, 3>;
+
+// The triangles by their positions, each rotated so that the smallest position
+// comes first. Reordering the triangles or the vertices doesn't change the
+// result, but flipping the winding of a triangle does.
+auto get_triangles(const mesh_t& p_mesh) -> std::vector<triangle_t>
+{
+    std::vector<triangle_t> triangles;
+    for (size_t i = 0; i < p_mesh.indices.size(); i += 3)
+    {
+        triangle_t triangle;
+        for (size_t j = 0; j < 3; j++)
+        {
+            const auto& position =
+                p_mesh.vertices[p_mesh.indices[i + j]].position;
+            triangle[j] = {position.x, position.y, position.z};
+        }
+
+        std::rotate(
+            triangle.begin(),
+            std::min_element(triangle.begin(), triangle.end()), triangle.end()
+        );
+        triangles.push_back(triangle);
+    }
+
+    std::sort(triangles.begin(), triangles.end());
+    return triangles;
+}
+
+auto get_stats(const mesh_t& p_mesh) -> vulkan_scene::vertex_cache_stats_t
+{
+    return vulkan_scene::get_vertex_cache_stats(
+        p_mesh.indices, static_cast<uint32_t>(p_mesh.vertices.size())
+    );
+}
+
+auto test_vertex_cache_stats() -> void
+{
+    // Every vertex of every triangle misses.
+    const std::vector<uint32_t> separate{0, 1, 2, 3, 4, 5};
+    const auto separate_stats =
+        vulkan_scene::get_vertex_cache_stats(separate, 6);
+    assert(separate_stats.acmr == 3.0f);
+    assert(separate_stats.atvr == 1.0f);
+
+    // The second triangle only adds one vertex.
+    const std::vector<uint32_t> strip{0, 1, 2, 2, 1, 3};
+    assert(vulkan_scene::get_vertex_cache_stats(strip, 4).acmr == 2.0f);
+
+    // With a cache of three, the first vertex is gone by the second triangle.
+    const std::vector<uint32_t> evicted{0, 1, 2, 3, 4, 0};
+    const auto evicted_stats =
+        vulkan_scene::get_vertex_cache_stats(evicted, 5, 3);
+    assert(evicted_stats.acmr == 3.0f);
+    assert(evicted_stats.atvr == 6.0f / 5.0f);
+
+    const auto empty = vulkan_scene::get_vertex_cache_stats({}, 0);
+    assert(empty.acmr == 0.0f && empty.atvr == 0.0f);
+}
+
+auto test_weld_vertices() -> void
+{
+    // Two triangles that share an edge, without sharing any vertices.
+    mesh_t mesh{
+        .vertices =
+            {
+                make_vertex(0.0f, 0.0f, 0.0f),
+                make_vertex(1.0f, 0.0f, 0.0f),
+                make_vertex(1.0f, 1.0f, 0.0f),
+                make_vertex(0.0f, 0.0f, 0.0f),
+                make_vertex(1.0f, 1.0f, 0.0f),
+                make_vertex(0.0f, 1.0f, 0.0f),
+            },
+        .indices = {0, 1, 2, 3, 4, 5},
+    };
+
+    // Same position, different normal, so it has to stay.
+    auto different = make_vertex(0.0f, 1.0f, 0.0f);
+    different.normal = {0.0f, 1.0f, 0.0f};
+    mesh.vertices.push_back(different);
+    mesh.indices.insert(mesh.indices.end(), {6, 5, 4});
+
+    const auto triangles = get_triangles(mesh);
+    vulkan_scene::weld_vertices(mesh);
+
+    assert(mesh.vertices.size() == 5);
+    assert((mesh.indices == std::vector<uint32_t>{0, 1, 2, 0, 2, 3, 4, 3, 2}));
+    assert(get_triangles(mesh) == triangles);
+}
+
+auto test_optimize_vertex_cache() -> void
+{
+    auto mesh = make_shuffled_grid(64);
+    const auto triangles = get_triangles(mesh);
+    const auto before = get_stats(mesh);
+
+    vulkan_scene::optimize_vertex_cache(
+        mesh.indices, static_cast<uint32_t>(mesh.vertices.size())
+    );
+    const auto after = get_stats(mesh);
+
+    assert(get_triangles(mesh) == triangles);
+
+    // A random order misses almost every time, while a good one gets close to
+    // 0.5 on a grid.
+    assert(before.acmr > 2.0f);
+    assert(after.acmr < 0.8f);
+    assert(after.atvr < 1.6f);
+}
+
+auto test_optimize_overdraw() -> void
+{
+    // Two quads facing +z, one behind the other. The one in front should be
+    // drawn first, since it covers the one behind.
+    mesh_t mesh{
+        .vertices =
+            {
+                make_vertex(0.0f, 0.0f, -1.0f),
+                make_vertex(1.0f, 0.0f, -1.0f),
+                make_vertex(1.0f, 1.0f, -1.0f),
+                make_vertex(0.0f, 1.0f, -1.0f),
+                make_vertex(0.0f, 0.0f, 1.0f),
+                make_vertex(1.0f, 0.0f, 1.0f),
+                make_vertex(1.0f, 1.0f, 1.0f),
+                make_vertex(0.0f, 1.0f, 1.0f),
+            },
+        .indices = {0, 1, 2, 0, 2, 3, 4, 5, 6, 4, 6, 7},
+    };
+
+    vulkan_scene::optimize_overdraw(mesh.indices, mesh.vertices);
+    assert((
+        mesh.indices ==
+        std::vector<uint32_t>{4, 5, 6, 4, 6, 7, 0, 1, 2, 0, 2, 3}
+    ));
+
+    // Nothing gets lost or flipped on a larger mesh either.
+    auto grid = make_shuffled_grid(32);
+    const auto triangles = get_triangles(grid);
+    vulkan_scene::optimize_vertex_cache(
+        grid.indices, static_cast<uint32_t>(grid.vertices.size())
+    );
+    vulkan_scene::optimize_overdraw(grid.indices, grid.vertices);
+    assert(get_triangles(grid) == triangles);
+}
+
+auto test_optimize_vertex_fetch() -> void
+{
+    mesh_t mesh{
+        .vertices =
+            {
+                make_vertex(0.0f, 0.0f, 0.0f),
+                make_vertex(1.0f, 0.0f, 0.0f),
+                make_vertex(2.0f, 0.0f, 0.0f),
+                make_vertex(3.0f, 0.0f, 0.0f),
+                make_vertex(4.0f, 0.0f, 0.0f),
+            },
+        .indices = {4, 2, 3, 3, 2, 1},
+    };
+
+    const auto triangles = get_triangles(mesh);
+    vulkan_scene::optimize_vertex_fetch(mesh);
+
+    // Nothing refers to the first vertex, so it's gone.
+    assert(mesh.vertices.size() == 4);
+    assert((mesh.indices == std::vector<uint32_t>{0, 1, 2, 2, 1, 3}));
+    assert(mesh.vertices[0].position.x == 4.0f);
+    assert(get_triangles(mesh) == triangles);
+}
+
+auto test_optimize_mesh() -> void
+{
+    // Every triangle with vertices of its own, the way a mesh comes out of a
+    // file format without indices.
+    const auto grid = make_shuffled_grid(48);
+    mesh_t mesh;
+    for (const auto index : grid.indices)
+    {
+        mesh.indices.push_back(static_cast<uint32_t>(mesh.vertices.size()));
+        mesh.vertices.push_back(grid.vertices[index]);
+    }
+
+    const auto triangles = get_triangles(mesh);
+    vulkan_scene::optimize_mesh(mesh);
+
+    assert(mesh.vertices.size() == grid.vertices.size());
+    assert(get_triangles(mesh) == triangles);
+    assert(get_stats(mesh).acmr < 0.8f);
+
+    // The vertices come in the order they are first used in.
+    uint32_t next_vertex = 0;
+    for (const auto index : mesh.indices)
+    {
+        assert(index <= next_vertex);
+        if (index == next_vertex)
+        {
+            next_vertex++;
+        }
+    }
+}
+
+// Undoes split_mesh, so that the result can be compared with get_triangles.
+auto join_submeshes(
+    const mesh_t& p_mesh, std::span<const vulkan_scene::submesh_t> p_submeshes
+) -> mesh_t
+{
+    mesh_t mesh{.vertices = p_mesh.vertices, .indices = {}};
+
+    uint32_t next_index = 0;
+    for (const auto& submesh : p_submeshes)
+    {
+        assert(submesh.first_index == next_index);
+        next_index += submesh.index_count;
+
+        for (uint32_t i = 0; i < submesh.index_count; i++)
+        {
+            const auto index = p_mesh.indices[submesh.first_index + i];
+            mesh.indices.push_back(
+                index + static_cast<uint32_t>(submesh.vertex_offset)
+            );
+        }
+    }
+
+    assert(next_index == p_mesh.indices.size());
+    return mesh;
+}
+
+auto test_split_mesh() -> void
+{
+    auto mesh = make_shuffled_grid(48);
+    vulkan_scene::optimize_mesh(mesh);
+    const auto triangles = get_triangles(mesh);
+
+    // Everything fits, so nothing changes.
+    auto unsplit_mesh = mesh;
+    const auto whole = vulkan_scene::split_mesh(unsplit_mesh);
+    assert(whole.size() == 1);
+    assert(whole[0].index_count == mesh.indices.size());
+    assert(unsplit_mesh.indices == mesh.indices);
+
+    constexpr uint32_t max_index_value = 255;
+    const auto submeshes = vulkan_scene::split_mesh(mesh, max_index_value);
+
+    // About 2400 vertices in runs of up to 256, with the ones on the borders
+    // between runs copied.
+    assert(submeshes.size() >= 10 && submeshes.size() < 16);
+    assert(mesh.vertices.size() < 3600);
+
+    for (size_t i = 0; i < submeshes.size(); i++)
+    {
+        const auto vertex_end =
+            i + 1 < submeshes.size()
+                ? static_cast<uint32_t>(submeshes[i + 1].vertex_offset)
+                : static_cast<uint32_t>(mesh.vertices.size());
+        const auto vertex_count =
+            vertex_end - static_cast<uint32_t>(submeshes[i].vertex_offset);
+        assert(vertex_count <= max_index_value + 1);
+
+        for (uint32_t j = 0; j < submeshes[i].index_count; j++)
+        {
+            assert(mesh.indices[submeshes[i].first_index + j] < vertex_count);
+        }
+    }
+
+    assert(get_triangles(join_submeshes(mesh, submeshes)) == triangles);
+}
+
+auto test_index_type() -> void
+{
+    const std::vector<uint32_t> small_indices{0, 1, 65535};
+    const std::vector<uint32_t> large_indices{0, 1, 65536};
+
+    assert(
+        vulkan_scene::choose_index_type(small_indices) == VK_INDEX_TYPE_UINT16
+    );
+    assert(
+        vulkan_scene::choose_index_type(large_indices) == VK_INDEX_TYPE_UINT32
+    );
+
+    const auto packed =
+        vulkan_scene::pack_indices(small_indices, VK_INDEX_TYPE_UINT16);
+    assert(packed.size() == 3 * sizeof(uint16_t));
+
+    uint16_t last_index;
+    std::memcpy(&last_index, packed.data() + 4, sizeof(last_index));
+    assert(last_index == 65535);
+
+    assert(
+        vulkan_scene::pack_indices(large_indices, VK_INDEX_TYPE_UINT32)
+            .size() == 3 * sizeof(uint32_t)
+    );
+}
+
+auto test_pack_vertex() -> void
+{
+    std::mt19937 random{7};
+    std::uniform_real_distribution<float> distribution{-1.0f, 1.0f};
+
+    std::vector<vertex_t> vertices;
+    for (int i = 0; i < 1000; i++)
+    {
+        const auto normal = glm::vec3{
+            distribution(random), distribution(random), distribution(random)
+        };
+
+        vertices.push_back(vertex_t{
+            .position =
+                {4.0f * distribution(random), distribution(random), 0.5f},
+            .uv = {distribution(random), distribution(random)},
+            .normal = glm::length(normal) > 0.01f ? normal : glm::vec3{0, 0, 1},
+        });
+    }
+
+    // Normals right on the axes are where the octahedron folds over.
+    vertices[0].normal = {0.0f, 0.0f, -1.0f};
+    vertices[1].normal = {-1.0f, 0.0f, 0.0f};
+    vertices[2].normal = {0.0f, 1.0f, 0.0f};
+
+    const auto quantization = vulkan_scene::get_vertex_quantization(vertices);
+
+    // The vertices are flat along z.
+    assert(quantization.scale.z == 1.0f);
+
+    const auto packed_vertices =
+        vulkan_scene::pack_vertices(vertices, quantization);
+    assert(packed_vertices.size() == vertices.size());
+
+    for (size_t i = 0; i < vertices.size(); i++)
+    {
+        const auto& vertex = vertices[i];
+        const auto unpacked =
+            vulkan_scene::unpack_vertex(packed_vertices[i], quantization);
+
+        // Half of a step of the quantization on each axis, and a bit.
+        const auto position_error =
+            glm::abs(unpacked.position - vertex.position);
+        assert(glm::all(glm::lessThanEqual(
+            position_error, quantization.scale * (0.5f / 65535.0f) + 1e-6f
+        )));
+
+        // Half floats have 11 bits of precision.
+        const auto uv_error = glm::abs(unpacked.uv - vertex.uv);
+        assert(uv_error.x < 1e-3f && uv_error.y < 1e-3f);
+
+        // Well under a tenth of a degree.
+        const auto cosine =
+            glm::dot(unpacked.normal, glm::normalize(vertex.normal));
+        assert(std::abs(glm::length(unpacked.normal) - 1.0f) < 1e-5f);
+        assert(cosine > 0.999999f);
+    }
+}
+
+} // namespace
+
+auto main() -> int
+{
+    test_vertex_cache_stats();
+    test_weld_vertices();
+    test_optimize_vertex_cache();
+    test_optimize_overdraw();
+    test_optimize_vertex_fetch();
+    test_optimize_mesh();
+    test_split_mesh();
+    test_index_type();
+    test_pack_vertex();
+}
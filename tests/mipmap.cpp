@@ -0,0 +1,94 @@
+#include <cassert>
+
+#include <mipmap.hpp>
+
+namespace
+{
+
+auto test_level_count() -> void
+{
+    assert(vulkan_scene::mip_level_count(1, 1) == 1);
+    assert(vulkan_scene::mip_level_count(2, 2) == 2);
+    assert(vulkan_scene::mip_level_count(800, 800) == 10);
+    assert(vulkan_scene::mip_level_count(1024, 1) == 11);
+    assert(vulkan_scene::mip_level_count(5, 3) == 3);
+}
+
+auto test_layout() -> void
+{
+    const auto levels = vulkan_scene::mip_chain_layout(5, 3, 3);
+
+    assert(levels.size() == 3);
+
+    assert(levels[0].width == 5 && levels[0].height == 3);
+    assert(levels[0].offset == 0 && levels[0].size == 5 * 3 * 4);
+
+    assert(levels[1].width == 2 && levels[1].height == 1);
+    assert(levels[1].offset == 60 && levels[1].size == 2 * 1 * 4);
+
+    assert(levels[2].width == 1 && levels[2].height == 1);
+    assert(levels[2].offset == 68 && levels[2].size == 4);
+}
+
+auto test_box_filter() -> void
+{
+    // A 2x2 checkerboard of black and white with varying alpha.
+    const std::array<uint8_t, 16> pixels{
+        0,   0,   0,   0,   255, 255, 255, 255,
+        255, 255, 255, 255, 0,   0,   0,   0,
+    };
+
+    const auto linear =
+        vulkan_scene::generate_mip_chain(pixels.data(), 2, 2, 2, false);
+
+    assert(linear.size() == 16 + 4);
+    assert(std::equal(pixels.begin(), pixels.end(), linear.begin()));
+    for (size_t i = 16; i < 20; i++)
+    {
+        assert(linear[i] == 128);
+    }
+
+    // Half of the light in sRGB is a lot brighter than 128, but alpha still
+    // gets averaged linearly.
+    const auto srgb =
+        vulkan_scene::generate_mip_chain(pixels.data(), 2, 2, 2, true);
+
+    assert(srgb[16] == 188 && srgb[17] == 188 && srgb[18] == 188);
+    assert(srgb[19] == 128);
+}
+
+auto test_uniform_color() -> void
+{
+    // A single color must survive all the way down to 1x1, odd sizes and all.
+    std::vector<uint8_t> pixels(7 * 3 * 4);
+    for (size_t i = 0; i < pixels.size(); i += 4)
+    {
+        pixels[i + 0] = 10;
+        pixels[i + 1] = 100;
+        pixels[i + 2] = 200;
+        pixels[i + 3] = 255;
+    }
+
+    const auto level_count = vulkan_scene::mip_level_count(7, 3);
+    const auto chain = vulkan_scene::generate_mip_chain(
+        pixels.data(), 7, 3, level_count, true
+    );
+    const auto last = vulkan_scene::mip_chain_layout(7, 3, level_count).back();
+
+    assert(last.width == 1 && last.height == 1);
+    assert(chain.size() == last.offset + last.size);
+    assert(chain[last.offset + 0] == 10);
+    assert(chain[last.offset + 1] == 100);
+    assert(chain[last.offset + 2] == 200);
+    assert(chain[last.offset + 3] == 255);
+}
+
+} // namespace
+
+auto main() -> int
+{
+    test_level_count();
+    test_layout();
+    test_box_filter();
+    test_uniform_color();
+}
@@ -0,0 +1,101 @@
+#include <cassert>
+#include <cmath>
+
+#include <scene.hpp>
+
+namespace
+{
+
+auto test_lattice() -> void
+{
+    // A single object is just the cube at the origin.
+    const auto single = vulkan_scene::create_lattice_scene(1);
+    assert(single.objects.size() == 1);
+    assert(single.objects[0].position.x == 0.0f);
+    assert(single.objects[0].position.y == 0.0f);
+    assert(single.objects[0].position.z == 0.0f);
+    assert(std::abs(single.radius - std::sqrt(3.0f) / 2) < 1e-5f);
+
+    // 10 objects need a 3x3x3 lattice, which isn't filled up all the way.
+    const auto partial = vulkan_scene::create_lattice_scene(10);
+    assert(partial.objects.size() == 10);
+
+    for (const auto& object : partial.objects)
+    {
+        const auto distance = std::sqrt(
+            object.position.x * object.position.x +
+            object.position.y * object.position.y +
+            object.position.z * object.position.z
+        );
+        assert(distance + std::sqrt(3.0f) / 2 <= partial.radius + 1e-5f);
+    }
+
+    assert(vulkan_scene::create_lattice_scene(27).objects.size() == 27);
+}
+
+auto test_sort_draws() -> void
+{
+    const auto scene = vulkan_scene::create_lattice_scene(27);
+
+    // Ten units in front of the camera, looking down -z.
+    glm::mat4 model_view{1.0f};
+    model_view[3][2] = -10.0f;
+
+    std::vector<vulkan_scene::draw_t> draws;
+
+    vulkan_scene::sort_draws(
+        scene.objects, model_view, vulkan_scene::draw_order_t::FRONT_TO_BACK,
+        draws
+    );
+    assert(draws.size() == scene.objects.size());
+
+    for (size_t i = 1; i < draws.size(); i++)
+    {
+        assert(draws[i - 1].depth >= draws[i].depth);
+    }
+
+    // The closest layer has the largest z.
+    const auto& closest = scene.objects[draws.front().object_index];
+    assert(closest.position.z == vulkan_scene::LATTICE_SPACING);
+    assert(draws.front().depth == vulkan_scene::LATTICE_SPACING - 10.0f);
+
+    vulkan_scene::sort_draws(
+        scene.objects, model_view, vulkan_scene::draw_order_t::BACK_TO_FRONT,
+        draws
+    );
+    assert(draws.size() == scene.objects.size());
+
+    for (size_t i = 1; i < draws.size(); i++)
+    {
+        assert(draws[i - 1].depth <= draws[i].depth);
+    }
+
+    vulkan_scene::sort_draws(
+        scene.objects, model_view, vulkan_scene::draw_order_t::UNSORTED, draws
+    );
+
+    for (uint32_t i = 0; i < draws.size(); i++)
+    {
+        assert(draws[i].object_index == i);
+    }
+}
+
+auto test_parse_draw_order() -> void
+{
+    using vulkan_scene::draw_order_t;
+    using vulkan_scene::parse_draw_order;
+
+    assert(parse_draw_order("front-to-back") == draw_order_t::FRONT_TO_BACK);
+    assert(parse_draw_order("back-to-front") == draw_order_t::BACK_TO_FRONT);
+    assert(parse_draw_order("unsorted") == draw_order_t::UNSORTED);
+    assert(!parse_draw_order("sideways").has_value());
+}
+
+} // namespace
+
+auto main() -> int
+{
+    test_lattice();
+    test_sort_draws();
+    test_parse_draw_order();
+}
@@ -0,0 +1,48 @@
+#include <cassert>
+
+#include <statistics.hpp>
+
+auto main() -> int
+{
+    // 1 to 100, shuffled a bit.
+    std::vector<double> samples;
+    for (uint32_t i = 0; i < 100; i++)
+    {
+        samples.push_back(static_cast<double>((i * 37) % 100 + 1));
+    }
+
+    const auto stats = vulkan_scene::get_sample_stats(samples);
+    assert(stats.count == 100);
+    assert(stats.min == 1.0);
+    assert(stats.max == 100.0);
+    assert(stats.mean == 50.5);
+    assert(stats.median == 50.0);
+    assert(stats.p95 == 95.0);
+    assert(stats.p99 == 99.0);
+
+    const auto single = vulkan_scene::get_sample_stats(std::array{4.0});
+    assert(single.min == 4.0 && single.median == 4.0 && single.p99 == 4.0);
+
+    const auto empty = vulkan_scene::get_sample_stats({});
+    assert(empty.count == 0 && empty.mean == 0.0);
+
+    const auto histogram = vulkan_scene::get_histogram(samples, 11);
+    assert(histogram.start == 1.0);
+    assert(histogram.bucket_width == 9.0);
+    assert(histogram.counts.size() == 11);
+    assert(histogram.counts.front() == 9);
+    // The maximum goes into the last bucket rather than past it.
+    assert(histogram.counts.back() == 10);
+
+    uint32_t total = 0;
+    for (const auto count : histogram.counts)
+    {
+        total += count;
+    }
+    assert(total == 100);
+
+    // Identical samples all end up in the first bucket.
+    const auto flat =
+        vulkan_scene::get_histogram(std::array{2.0, 2.0, 2.0}, 4);
+    assert(flat.counts[0] == 3 && flat.bucket_width == 0.0);
+}
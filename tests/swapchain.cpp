@@ -10,11 +10,14 @@ auto main() -> int
         vulkan_scene::create_vulkan_instance(static_cast<bool>(false)).unwrap();
     const auto surface =
         vulkan_scene::create_surface(instance, window).unwrap();
-    const auto [physical_device, graphics_queue_family, present_queue_family] =
-        vulkan_scene::choose_physical_device(instance, surface).unwrap();
+    const auto
+        [physical_device, graphics_queue_family, present_queue_family,
+         transfer_queue_family] =
+            vulkan_scene::choose_physical_device(instance, surface).unwrap();
     const auto device =
         vulkan_scene::create_logical_device(
-            physical_device, graphics_queue_family, present_queue_family
+            physical_device, graphics_queue_family, present_queue_family,
+            transfer_queue_family
         )
             .unwrap();
 
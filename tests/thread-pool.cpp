@@ -0,0 +1,188 @@
+#include <cassert>
+
+#include <atomic>
+#include <chrono>
+
+#include <thread-pool.hpp>
+
+namespace
+{
+
+auto test_submit() -> void
+{
+    std::atomic<uint32_t> counter = 0;
+
+    vulkan_scene::thread_pool_t thread_pool{4};
+    for (uint32_t i = 0; i < 10000; i++)
+    {
+        thread_pool.submit([&counter] { counter++; });
+    }
+
+    thread_pool.wait_idle();
+    assert(counter == 10000);
+}
+
+auto test_dependencies() -> void
+{
+    vulkan_scene::thread_pool_t thread_pool{4};
+
+    // A diamond: first, then left and right in any order, then last.
+    std::atomic<uint32_t> step = 0;
+    std::atomic<uint32_t> left_step = 0, right_step = 0, last_step = 0;
+
+    const auto first = thread_pool.submit(
+        [&]
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            step++;
+        }
+    );
+    const auto left =
+        thread_pool.submit([&] { left_step = ++step; }, std::array{first});
+    const auto right =
+        thread_pool.submit([&] { right_step = ++step; }, std::array{first});
+    const auto last = thread_pool.submit(
+        [&] { last_step = ++step; }, std::array{left, right}
+    );
+
+    thread_pool.wait(last);
+    assert(left_step >= 2 && right_step >= 2);
+    assert(left_step != right_step);
+    assert(last_step == 4);
+
+    // Depending on a task that is already done doesn't hold anything up.
+    auto ran = false;
+    thread_pool.wait(thread_pool.submit([&] { ran = true; }, std::array{last}));
+    assert(ran);
+}
+
+auto test_pending_dependencies_on_destruction() -> void
+{
+    std::atomic<uint32_t> counter = 0;
+
+    {
+        vulkan_scene::thread_pool_t thread_pool{2};
+
+        auto previous = thread_pool.submit(
+            [&]
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                counter++;
+            }
+        );
+
+        for (uint32_t i = 0; i < 100; i++)
+        {
+            previous = thread_pool.submit(
+                [&counter] { counter++; }, std::array{previous}
+            );
+        }
+    }
+
+    assert(counter == 101);
+}
+
+auto test_parallel_for() -> void
+{
+    constexpr uint32_t count = 100000;
+
+    vulkan_scene::thread_pool_t thread_pool{4};
+
+    std::vector<std::atomic<uint32_t>> visits(count);
+    thread_pool.parallel_for(
+        0, count, 1000,
+        [&](uint32_t p_first, uint32_t p_last)
+        {
+            assert(p_last - p_first <= 1000);
+            for (auto i = p_first; i < p_last; i++)
+            {
+                visits[i]++;
+            }
+        }
+    );
+
+    for (const auto& visit_count : visits)
+    {
+        assert(visit_count == 1);
+    }
+
+    // Nothing happens on an empty range, and a grain size of 0 means 1.
+    auto called = false;
+    thread_pool.parallel_for(
+        5, 5, 1, [&](uint32_t, uint32_t) { called = true; }
+    );
+    assert(!called);
+
+    std::atomic<uint32_t> total = 0;
+    thread_pool.parallel_for(
+        0, 10, 0, [&](uint32_t p_first, uint32_t p_last)
+        { total += p_last - p_first; }
+    );
+    assert(total == 10);
+}
+
+auto test_nested_parallel_for() -> void
+{
+    // More outer ranges than workers, which would deadlock if waiting for the
+    // inner ones tied the workers up.
+    vulkan_scene::thread_pool_t thread_pool{2};
+
+    std::atomic<uint32_t> total = 0;
+    thread_pool.parallel_for(
+        0, 16, 1,
+        [&](uint32_t, uint32_t)
+        {
+            thread_pool.parallel_for(
+                0, 100, 10, [&](uint32_t p_first, uint32_t p_last)
+                { total += p_last - p_first; }
+            );
+        }
+    );
+
+    assert(total == 1600);
+}
+
+auto test_stealing() -> void
+{
+    vulkan_scene::thread_pool_t thread_pool{4};
+
+    // Everything lands on a single worker's deque, so the others have to steal
+    // to get any of it.
+    std::atomic<uint32_t> counter = 0;
+    thread_pool.submit(
+        [&]
+        {
+            for (uint32_t i = 0; i < 64; i++)
+            {
+                thread_pool.submit(
+                    [&counter]
+                    {
+                        std::this_thread::sleep_for(
+                            std::chrono::milliseconds(1)
+                        );
+                        counter++;
+                    }
+                );
+            }
+        }
+    );
+
+    // Not wait, which could run the root on this thread. The tasks it submits
+    // would then get spread across the workers.
+    thread_pool.wait_idle();
+
+    assert(counter == 64);
+    assert(thread_pool.steal_count() > 0);
+}
+
+} // namespace
+
+auto main() -> int
+{
+    test_submit();
+    test_dependencies();
+    test_pending_dependencies_on_destruction();
+    test_parallel_for();
+    test_nested_parallel_for();
+    test_stealing();
+}
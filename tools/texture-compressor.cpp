@@ -0,0 +1,251 @@
+// Converts PNG textures into KTX2 files with block-compressed, premade mip
+// chains, which create_image picks up instead of the PNGs.
+//
+// texture-compressor [--format bc7|bc1] <file.png>...
+//
+// Without --format, both a BC7 and a BC1 variant get written next to every
+// input (can-pooper.png becomes can-pooper.bc7.ktx2 and can-pooper.bc1.ktx2).
+
+#include <cstring>
+
+#include <filesystem>
+#include <string>
+
+#include <bc7enc.h>
+#include <stb_image.h>
+
+#define RGBCX_IMPLEMENTATION
+#include <rgbcx.h>
+
+#include "common.hpp"
+#include "ktx2.hpp"
+#include "mipmap.hpp"
+
+namespace
+{
+
+using vulkan_scene::print_error;
+
+// From 0 to 18, and nothing above 10 or so makes a visible difference.
+constexpr uint32_t BC1_QUALITY_LEVEL = 10;
+
+struct output_format_t
+{
+    std::string_view name;
+    VkFormat format;
+};
+
+constexpr std::array<output_format_t, 2> OUTPUT_FORMATS{{
+    // BC7 keeps alpha and looks much better, at twice the size.
+    {"bc7", VK_FORMAT_BC7_SRGB_BLOCK},
+    {"bc1", VK_FORMAT_BC1_RGB_SRGB_BLOCK},
+}};
+
+auto compress_block(
+    VkFormat p_format,
+    const bc7enc_compress_block_params& p_bc7_params,
+    const uint8_t* p_pixels,
+    uint8_t* p_block
+) noexcept -> void
+{
+    if (p_format == VK_FORMAT_BC7_SRGB_BLOCK)
+    {
+        bc7enc_compress_block(p_block, p_pixels, &p_bc7_params);
+    }
+    else
+    {
+        rgbcx::encode_bc1(BC1_QUALITY_LEVEL, p_block, p_pixels, true, false);
+    }
+}
+
+// Compresses one tightly packed RGBA8 level. Blocks that stick out past the
+// edges repeat the last row and column.
+auto compress_level(
+    VkFormat p_format,
+    const bc7enc_compress_block_params& p_bc7_params,
+    const uint8_t* p_pixels,
+    uint32_t p_width,
+    uint32_t p_height,
+    uint8_t* p_output
+) noexcept -> void
+{
+    const auto block = vulkan_scene::get_format_block(p_format).value();
+
+    std::array<uint8_t, 4 * 4 * 4> block_pixels;
+
+    for (uint32_t block_y = 0; block_y < p_height; block_y += 4)
+    {
+        for (uint32_t block_x = 0; block_x < p_width; block_x += 4)
+        {
+            for (uint32_t y = 0; y < 4; y++)
+            {
+                for (uint32_t x = 0; x < 4; x++)
+                {
+                    const auto source_x = std::min(block_x + x, p_width - 1);
+                    const auto source_y = std::min(block_y + y, p_height - 1);
+
+                    std::memcpy(
+                        block_pixels.data() + (y * 4 + x) * 4,
+                        p_pixels + (source_y * p_width + source_x) * 4, 4
+                    );
+                }
+            }
+
+            compress_block(
+                p_format, p_bc7_params, block_pixels.data(), p_output
+            );
+            p_output += block.size;
+        }
+    }
+}
+
+auto compress_texture(
+    std::string_view p_input_path,
+    std::span<const output_format_t> p_formats,
+    const bc7enc_compress_block_params& p_bc7_params
+) noexcept -> bool
+{
+    int width, height, channels;
+    const auto pixels =
+        stbi_load(p_input_path.data(), &width, &height, &channels, 4);
+    if (pixels == nullptr)
+    {
+        print_error("Failed to load ", p_input_path, '.');
+        return false;
+    }
+
+    const auto level_count = vulkan_scene::mip_level_count(width, height);
+
+    // The mips are built once from the uncompressed image and then compressed
+    // level by level, rather than from an already compressed level.
+    const auto chain = vulkan_scene::generate_mip_chain(
+        pixels, width, height, level_count, true
+    );
+    const auto chain_levels =
+        vulkan_scene::mip_chain_layout(width, height, level_count);
+
+    stbi_image_free(pixels);
+
+    for (const auto& output_format : p_formats)
+    {
+        const auto block =
+            vulkan_scene::get_format_block(output_format.format).value();
+
+        vulkan_scene::ktx2_texture_t texture{
+            .format = output_format.format,
+            .width = static_cast<uint32_t>(width),
+            .height = static_cast<uint32_t>(height),
+            .levels = {},
+            .data = {},
+        };
+
+        size_t offset = 0;
+        for (const auto& level : chain_levels)
+        {
+            offset = vulkan_scene::align_up(
+                offset, vulkan_scene::KTX2_LEVEL_ALIGNMENT
+            );
+
+            const auto size =
+                vulkan_scene::get_level_size(block, level.width, level.height);
+
+            texture.levels.push_back(vulkan_scene::mip_level_t{
+                .width = level.width,
+                .height = level.height,
+                .offset = offset,
+                .size = size,
+            });
+
+            offset += size;
+        }
+
+        texture.data.resize(offset);
+
+        for (size_t i = 0; i < chain_levels.size(); i++)
+        {
+            compress_level(
+                output_format.format, p_bc7_params,
+                chain.data() + chain_levels[i].offset, chain_levels[i].width,
+                chain_levels[i].height,
+                texture.data.data() + texture.levels[i].offset
+            );
+        }
+
+        const auto output_path =
+            std::filesystem::path{p_input_path}
+                .replace_extension(
+                    std::string{"."} + std::string{output_format.name} + ".ktx2"
+                )
+                .string();
+
+        kirho::empty_t error;
+        if (vulkan_scene::write_ktx2(output_path, texture).is_error(error))
+        {
+            return false;
+        }
+
+        std::cout << "[INFO]: Wrote " << output_path << " ("
+                  << texture.data.size() / 1024 << " KiB, down from "
+                  << chain.size() / 1024 << " KiB).\n";
+    }
+
+    return true;
+}
+
+} // namespace
+
+auto main(int argc, char** argv) noexcept -> int
+{
+    std::span<const output_format_t> formats = OUTPUT_FORMATS;
+    std::vector<std::string_view> input_paths;
+
+    for (const char* const* arg = argv + 1; arg < argv + argc; arg++)
+    {
+        const auto has_value = arg + 1 < argv + argc;
+
+        if (std::strcmp(*arg, "--format") == 0 && has_value)
+        {
+            arg++;
+
+            const auto format = std::find_if(
+                OUTPUT_FORMATS.begin(), OUTPUT_FORMATS.end(),
+                [arg](const output_format_t& p_format)
+                { return p_format.name == *arg; }
+            );
+            if (format == OUTPUT_FORMATS.end())
+            {
+                print_error("Unknown format ", *arg, '.');
+                return 1;
+            }
+
+            formats = std::span{format, 1};
+        }
+        else
+        {
+            input_paths.push_back(*arg);
+        }
+    }
+
+    if (input_paths.empty())
+    {
+        std::cerr << "Usage: " << argv[0]
+                  << " [--format bc7|bc1] <file.png>...\n";
+        return 1;
+    }
+
+    rgbcx::init();
+    bc7enc_compress_block_init();
+
+    bc7enc_compress_block_params bc7_params;
+    bc7enc_compress_block_params_init(&bc7_params);
+
+    for (const auto input_path : input_paths)
+    {
+        if (!compress_texture(input_path, formats, bc7_params))
+        {
+            return 1;
+        }
+    }
+
+    return 0;
+}